@@ -26,7 +26,8 @@ private:
 private:
     DRW::Version version{DRW::UNKNOWNV};
     std::string cp;
-    std::unique_ptr< DRW_Converter> conv;
+    //converters are stateless, copies of the codec share them
+    std::shared_ptr< DRW_Converter> conv;
 };
 
 class DRW_Converter
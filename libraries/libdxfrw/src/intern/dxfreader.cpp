@@ -10,7 +10,9 @@
 **  along with this program.  If not, see <http://www.gnu.org/licenses/>.    **
 ******************************************************************************/
 
+#include <charconv>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <string>
 #include <sstream>
@@ -95,7 +97,7 @@ bool dxfReader::readRec(int *codeData) {
         //break in binary files because the conduct is unpredictable
         return false;
 
-    return (filestr->good());
+    return good();
 }
 int dxfReader::getHandleId(){
     int res;
@@ -205,28 +207,98 @@ bool dxfReaderBinary::readBool() {
     return (filestr->good());
 }
 
+namespace {
+//skips blanks and plus sign in front of a number, as std::from_chars doesn't accept them
+const char *skipNumberPrefix(const char *first, const char *last) {
+    while (first != last && (*first == ' ' || *first == '\t'))
+        ++first;
+    if (first != last && *first == '+')
+        ++first;
+    return first;
+}
+}
+
+bool dxfReaderAscii::readLine(std::string_view *line) {
+    size_t searchStart = lineStart;
+    const char *lineEnd = nullptr;
+    for (;;) {
+        if (searchStart < dataEnd) {
+            lineEnd = static_cast<const char *>(memchr(buffer.data() + searchStart, '\n', dataEnd - searchStart));
+            if (lineEnd != nullptr)
+                break;
+        }
+        if (streamEnd)
+            break;
+        //move the incomplete line to the front and read the next block after it
+        size_t rest = dataEnd - lineStart;
+        if (lineStart > 0 && rest > 0)
+            memmove(buffer.data(), buffer.data() + lineStart, rest);
+        lineStart = 0;
+        dataEnd = rest;
+        searchStart = rest;
+        if (buffer.size() < rest + BLOCK_SIZE)
+            buffer.resize(rest + BLOCK_SIZE);
+        filestr->read(buffer.data() + rest, BLOCK_SIZE);
+        dataEnd += static_cast<size_t>(filestr->gcount());
+        streamEnd = !filestr->good();
+    }
+
+    const char *first = buffer.data() + lineStart;
+    const char *last = nullptr;
+    if (lineEnd != nullptr) {
+        last = lineEnd;
+        lineStart = static_cast<size_t>(lineEnd - buffer.data()) + 1;
+    } else {
+        //end of the stream without the line end, std::getline sets eof for it
+        last = buffer.data() + dataEnd;
+        lineStart = dataEnd;
+        lineGood = false;
+    }
+    if (last != first && *(last - 1) == '\r')
+        --last;
+    *line = std::string_view(first, static_cast<size_t>(last - first));
+    return lineGood;
+}
+
+bool dxfReaderAscii::readIntLine(int *value) {
+    std::string_view text;
+    bool isOk = readLine(&text);
+    const char *last = text.data() + text.size();
+    const char *first = skipNumberPrefix(text.data(), last);
+    //values out of the int range are truncated as atoi does
+    long long number {0};
+    if (std::from_chars(first, last, number).ec != std::errc())
+        number = 0;
+    *value = static_cast<int>(number);
+    return isOk;
+}
+
 bool dxfReaderAscii::readCode(int *code) {
-    std::string text;
-    std::getline(*filestr, text);
-    *code = atoi(text.c_str());
+    readIntLine(code);
     DRW_DBG(*code); DRW_DBG("\n");
-    return (filestr->good());
+    return lineGood;
 }
+bool dxfReaderAscii::readRawRec(int *code, std::string_view *value) {
+    if (!readCode(code))
+        return false;
+    return readLine(value);
+}
+
 bool dxfReaderAscii::readString(std::string *text) {
     type = STRING;
-    std::getline(*filestr, *text);
-    if (!text->empty() && text->at(text->size()-1) == '\r')
-        text->erase(text->size()-1);
-    return (filestr->good());
+    std::string_view line;
+    bool isOk = readLine(&line);
+    text->assign(line);
+    return isOk;
 }
 
 bool dxfReaderAscii::readString() {
     type = STRING;
-    std::getline(*filestr, strData);
-    if (!strData.empty() && strData.at(strData.size()-1) == '\r')
-        strData.erase(strData.size()-1);
+    std::string_view line;
+    bool isOk = readLine(&line);
+    strData.assign(line);
     DRW_DBG(strData); DRW_DBG("\n");
-    return (filestr->good());
+    return isOk;
 }
 
 bool dxfReaderAscii::readBinary() {
@@ -235,9 +307,9 @@ bool dxfReaderAscii::readBinary() {
 
 bool dxfReaderAscii::readInt16() {
     type = INT32;
-    std::string text;
-    if (readString(&text)){
-        intData = atoi(text.c_str());
+    int value {0};
+    if (readIntLine(&value)){
+        intData = value;
         DRW_DBG(intData); DRW_DBG("\n");
         return true;
     } else
@@ -256,18 +328,22 @@ bool dxfReaderAscii::readInt64() {
 
 bool dxfReaderAscii::readDouble() {
     type = DOUBLE;
-    std::string text;
-    if (readString(&text)){
+    std::string_view text;
+    if (readLine(&text)){
 #if defined(__APPLE__)
-        int succeeded=sscanf( & (text[0]), "%lg", &doubleData);
+        //floating point std::from_chars is not available with all Apple toolchains
+        std::string number(text);
+        int succeeded=sscanf( number.c_str(), "%lg", &doubleData);
         if(succeeded != 1) {
             DRW_DBG("dxfReaderAscii::readDouble(): reading double error: ");
-            DRW_DBG(text);
+            DRW_DBG(number);
             DRW_DBG('\n');
         }
 #else
-        std::istringstream sd(text);
-        sd >> doubleData;
+        const char *last = text.data() + text.size();
+        const char *first = skipNumberPrefix(text.data(), last);
+        if (std::from_chars(first, last, doubleData).ec != std::errc())
+            doubleData = 0.0;
         DRW_DBG(doubleData); DRW_DBG('\n');
 #endif
         return true;
@@ -278,9 +354,9 @@ bool dxfReaderAscii::readDouble() {
 //saved as int or add a bool member??
 bool dxfReaderAscii::readBool() {
     type = BOOL;
-    std::string text;
-    if (readString(&text)){
-        intData = atoi(text.c_str());
+    int value {0};
+    if (readIntLine(&value)){
+        intData = value;
         DRW_DBG(intData); DRW_DBG("\n");
         return true;
     } else
@@ -13,6 +13,9 @@
 #ifndef DXFREADER_H
 #define DXFREADER_H
 
+#include <istream>
+#include <string_view>
+#include <vector>
 #include "drw_textcodec.h"
 
 class dxfReader {
@@ -46,9 +49,15 @@ public:
     void setVersion(const std::string &v, bool dxfFormat){decoder.setVersion(v, dxfFormat);}
     void setCodePage(const std::string &c){decoder.setCodePage(c, true);}
     std::string getCodePage(){ return decoder.getCodePage();}
+    //sets up the reader to read as the other does: version, code page and comments
+    void copySettings(const dxfReader &other){
+        decoder = other.decoder;
+        m_bIgnoreComments = other.m_bIgnoreComments;
+    }
     void setIgnoreComments(const bool bValue) {m_bIgnoreComments = bValue;}
 
 protected:
+    virtual bool good() const {return filestr->good();} //false after EOF or an error
     virtual bool readCode(int *code) = 0; //return true if successful (not EOF)
     virtual bool readString(std::string *text) = 0;
     virtual bool readString() = 0;
@@ -85,6 +94,10 @@ public:
     bool readBool() override;
 };
 
+/**
+ * Reader of ascii dxf. The stream is read in large blocks and lines are
+ * tokenized in place, numbers are converted without copying them to strings.
+ */
 class dxfReaderAscii : public dxfReader {
 public:
     dxfReaderAscii(std::istream *stream):dxfReader(stream){skip = true; }
@@ -97,6 +110,24 @@ public:
     bool readInt32() override;
     bool readInt64() override;
     bool readBool() override;
+    //reads the next record without converting its value, the value is valid until the next read
+    bool readRawRec(int *code, std::string_view *value);
+
+protected:
+    bool good() const override {return lineGood;}
+
+private:
+    //reads the next line without the line end, the line is valid until the next read
+    bool readLine(std::string_view *line);
+    //reads the next line as integer, 0 if the line is not a number (as atoi)
+    bool readIntLine(int *value);
+
+    static constexpr size_t BLOCK_SIZE {1 << 20};
+    std::vector<char> buffer;
+    size_t lineStart {0}; //start of the unread data in buffer
+    size_t dataEnd {0}; //end of the data in buffer
+    bool streamEnd {false};
+    bool lineGood {true}; //same as good() of the stream after std::getline
 };
 
 #endif // DXFREADER_H
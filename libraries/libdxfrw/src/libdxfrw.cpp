@@ -18,6 +18,12 @@
 #include <sstream>
 #include <cassert>
 #include <functional>
+#include <atomic>
+#include <charconv>
+#include <exception>
+#include <memory>
+#include <streambuf>
+#include <thread>
 
 #include "intern/drw_textcodec.h"
 #include "intern/dxfreader.h"
@@ -27,6 +33,125 @@
 
 #define FIRSTHANDLE 48
 
+namespace {
+//minimal size of the text of ENTITIES section parsed as one task
+constexpr size_t ENTITIES_RANGE_SIZE {1 << 18};
+
+//reads a range of the ENTITIES section in place, followed by the end of the section
+class DRW_RangeBuffer : public std::streambuf {
+public:
+    DRW_RangeBuffer(char *first, char *last) {
+        setg(first, first, last);
+    }
+
+protected:
+    int_type underflow() override {
+        if (sectionEnded) {
+            return traits_type::eof();
+        }
+        sectionEnded = true;
+        setg(sectionEnd, sectionEnd, sectionEnd + sizeof(sectionEnd) - 1);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    char sectionEnd[10] {"0\nENDSEC\n"};
+    bool sectionEnded {false};
+};
+
+/**
+ * Keeps the entities parsed by a worker thread until they can be passed
+ * to the application in the order of the file.
+ */
+class DRW_EntityRecorder : public DRW_Interface {
+public:
+    void replay(DRW_Interface *iface) {
+        for (const auto &record : records) {
+            record(iface);
+        }
+        records.clear();
+    }
+
+    void addPoint(const DRW_Point& data) override {record(data, &DRW_Interface::addPoint);}
+    void addLine(const DRW_Line& data) override {record(data, &DRW_Interface::addLine);}
+    void addRay(const DRW_Ray& data) override {record(data, &DRW_Interface::addRay);}
+    void addXline(const DRW_Xline& data) override {record(data, &DRW_Interface::addXline);}
+    void addArc(const DRW_Arc& data) override {record(data, &DRW_Interface::addArc);}
+    void addCircle(const DRW_Circle& data) override {record(data, &DRW_Interface::addCircle);}
+    void addEllipse(const DRW_Ellipse& data) override {record(data, &DRW_Interface::addEllipse);}
+    void addLWPolyline(const DRW_LWPolyline& data) override {record(data, &DRW_Interface::addLWPolyline);}
+    void addPolyline(const DRW_Polyline& data) override {record(data, &DRW_Interface::addPolyline);}
+    void addSpline(const DRW_Spline* data) override {record(data, &DRW_Interface::addSpline);}
+    void addInsert(const DRW_Insert& data) override {record(data, &DRW_Interface::addInsert);}
+    void addTrace(const DRW_Trace& data) override {record(data, &DRW_Interface::addTrace);}
+    void add3dFace(const DRW_3Dface& data) override {record(data, &DRW_Interface::add3dFace);}
+    void addSolid(const DRW_Solid& data) override {record(data, &DRW_Interface::addSolid);}
+    void addMText(const DRW_MText& data) override {record(data, &DRW_Interface::addMText);}
+    void addText(const DRW_Text& data) override {record(data, &DRW_Interface::addText);}
+    void addTolerance(const DRW_Tolerance& data) override {record(data, &DRW_Interface::addTolerance);}
+    void addDimAlign(const DRW_DimAligned *data) override {record(data, &DRW_Interface::addDimAlign);}
+    void addDimLinear(const DRW_DimLinear *data) override {record(data, &DRW_Interface::addDimLinear);}
+    void addDimRadial(const DRW_DimRadial *data) override {record(data, &DRW_Interface::addDimRadial);}
+    void addDimDiametric(const DRW_DimDiametric *data) override {record(data, &DRW_Interface::addDimDiametric);}
+    void addDimAngular(const DRW_DimAngular *data) override {record(data, &DRW_Interface::addDimAngular);}
+    void addDimAngular3P(const DRW_DimAngular3p *data) override {record(data, &DRW_Interface::addDimAngular3P);}
+    void addDimOrdinate(const DRW_DimOrdinate *data) override {record(data, &DRW_Interface::addDimOrdinate);}
+    void addLeader(const DRW_Leader *data) override {record(data, &DRW_Interface::addLeader);}
+    void addHatch(const DRW_Hatch *data) override {record(data, &DRW_Interface::addHatch);}
+    void addViewport(const DRW_Viewport& data) override {record(data, &DRW_Interface::addViewport);}
+    void addImage(const DRW_Image *data) override {record(data, &DRW_Interface::addImage);}
+
+    //not used for ENTITIES section
+    void addKnot(const DRW_Entity&) override {}
+    void addHeader(const DRW_Header*) override {}
+    void addLType(const DRW_LType&) override {}
+    void addLayer(const DRW_Layer&) override {}
+    void addDimStyle(const DRW_Dimstyle&) override {}
+    void addVport(const DRW_Vport&) override {}
+    void addView(const DRW_View&) override {}
+    void addUCS(const DRW_UCS&) override {}
+    void addTextStyle(const DRW_Textstyle&) override {}
+    void addAppId(const DRW_AppId&) override {}
+    void addBlock(const DRW_Block&) override {}
+    void setBlock(const int) override {}
+    void endBlock() override {}
+    void linkImage(const DRW_ImageDef*) override {}
+    void addComment(const char*) override {}
+    void addPlotSettings(const DRW_PlotSettings*) override {}
+
+    void writeHeader(DRW_Header&) override {}
+    void writeBlocks() override {}
+    void writeBlockRecords() override {}
+    void writeEntities() override {}
+    void writeLTypes() override {}
+    void writeLayers() override {}
+    void writeViews() override {}
+    void writeUCSs() override {}
+    void writeTextstyles() override {}
+    void writeVports() override {}
+    void writeDimstyles() override {}
+    void writeObjects() override {}
+    void writeAppId() override {}
+
+private:
+    template <class T>
+    void record(const T& data, void (DRW_Interface::*add)(const T&)) {
+        records.emplace_back([data, add](DRW_Interface *iface) {
+            (iface->*add)(data);
+        });
+    }
+
+    template <class T>
+    void record(const T* data, void (DRW_Interface::*add)(const T*)) {
+        records.emplace_back([copy = *data, add](DRW_Interface *iface) {
+            (iface->*add)(&copy);
+        });
+    }
+
+    std::vector<std::function<void(DRW_Interface*)>> records;
+};
+}
+
 
 dxfRW::dxfRW(const char* name){
     DRW_DBGSL(DRW_dbg::Level::None);
@@ -2682,6 +2807,14 @@ bool dxfRW::processEntities(bool isblock) {
         return setError(DRW::BAD_READ_ENTITIES);  //first record in entities is 0
     }
 
+    //debug output of worker threads would be interleaved, parse sequentially then
+    if (!isblock && DRW_DBGGL == DRW_dbg::Level::None && std::thread::hardware_concurrency() > 1) {
+        auto asciiReader = dynamic_cast<dxfReaderAscii*>(reader);
+        if (nullptr != asciiReader) {
+            return processEntitiesParallel(asciiReader);
+        }
+    }
+
     bool processed {false};
     do {
         if (nextentity == "ENDSEC" || nextentity == "ENDBLK") {
@@ -2747,6 +2880,147 @@ bool dxfRW::processEntities(bool isblock) {
     return setError(DRW::BAD_READ_ENTITIES);
 }
 
+/**
+ * Parses ENTITIES section of ascii files in two phases.
+ * First the records of the section are read and split into ranges, a range starts
+ * with an entity and keeps POLYLINE together with its vertices.
+ * Then the ranges are parsed in place by worker threads, which are set up as this
+ * reader, and the parsed entities are passed to the interface in the order of the
+ * file. The first range is parsed straight into the interface while the workers
+ * parse the others.
+ */
+bool dxfRW::processEntitiesParallel(dxfReaderAscii *asciiReader) {
+    DRW_DBG("dxfRW::processEntitiesParallel\n");
+    if (nextentity == "ENDSEC" || nextentity == "ENDBLK") {
+        return true;  //found ENDSEC or ENDBLK terminate
+    }
+
+    std::string section;
+    std::vector<size_t> rangeStarts {0};
+    auto appendRecord = [&section](int code, std::string_view value) {
+        char codeText[16];
+        auto result = std::to_chars(codeText, codeText + sizeof(codeText), code);
+        section.append(codeText, result.ptr).append(1, '\n').append(value).append(1, '\n');
+    };
+
+    appendRecord(0, nextentity);
+    size_t entityStart {0};
+    bool sectionEnd {false};
+    int code;
+    std::string_view value;
+    while (asciiReader->readRawRec(&code, &value)) {
+        if (0 == code) {
+            if ("ENDSEC" == value || "ENDBLK" == value) {
+                nextentity = value;
+                sectionEnd = true;
+                break;
+            }
+            if ("VERTEX" != value && "SEQEND" != value) {
+                if (section.size() - rangeStarts.back() >= ENTITIES_RANGE_SIZE) {
+                    rangeStarts.push_back(section.size());
+                }
+                entityStart = section.size();
+            }
+        }
+        appendRecord(code, value);
+    }
+    if (!sectionEnd) {
+        section.resize(entityStart);  //the last entity is incomplete, as in sequential parsing it is not added
+    }
+    while (!rangeStarts.empty() && rangeStarts.back() >= section.size()) {
+        rangeStarts.pop_back();
+    }
+    const size_t rangeCount {rangeStarts.size()};
+    rangeStarts.push_back(section.size());
+
+    //a range is parsed as block, it must not be split again
+    auto parseRange = [asciiReader, &section, &rangeStarts](dxfRW &worker, size_t i, DRW_Interface *target) {
+        DRW_RangeBuffer buffer(section.data() + rangeStarts[i], section.data() + rangeStarts[i + 1]);
+        std::istream stream(&buffer);
+        dxfReaderAscii rangeReader(&stream);
+        rangeReader.copySettings(*asciiReader);
+        worker.reader = &rangeReader;
+        worker.iface = target;
+        worker.error = DRW::BAD_NONE;
+        bool isOk {worker.processEntities(true)};
+        worker.reader = nullptr;
+        if (isOk) {
+            return DRW::BAD_NONE;
+        }
+        return DRW::BAD_NONE == worker.error ? DRW::BAD_READ_ENTITIES : worker.error;
+    };
+
+    struct ParsedRange {
+        DRW_EntityRecorder recorder;
+        DRW::error error {DRW::BAD_NONE};
+        std::exception_ptr exception;
+    };
+    std::vector<ParsedRange> parsed(rangeCount);
+    std::atomic<size_t> nextRange {1};
+    auto parseRanges = [&parseRange, &parsed, &nextRange](dxfRW &worker) {
+        for (size_t i = nextRange++; i < parsed.size(); i = nextRange++) {
+            try {
+                parsed[i].error = parseRange(worker, i, &parsed[i].recorder);
+            } catch (...) {
+                parsed[i].exception = std::current_exception();
+            }
+        }
+    };
+
+    //workers are created here as constructor of dxfRW sets the debug level,
+    //they parse as this reader does: version, code page and extrusion are the same
+    size_t threadCount {std::thread::hardware_concurrency() - 1};
+    threadCount = std::min(threadCount, rangeCount > 1 ? rangeCount - 1 : 0);
+    std::vector<std::unique_ptr<dxfRW>> workers;
+    for (size_t i = 0; i <= threadCount; ++i) {
+        auto worker = std::make_unique<dxfRW>(fileName.c_str());
+        worker->setVersion(static_cast<DRW::Version>(asciiReader->getVersion()));
+        worker->codePage = asciiReader->getCodePage();
+        worker->applyExt = applyExt;
+        worker->binFile = binFile;
+        worker->elParts = elParts;
+        workers.push_back(std::move(worker));
+    }
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i <= threadCount; ++i) {
+        threads.emplace_back(parseRanges, std::ref(*workers[i]));
+    }
+
+    DRW::error firstError {DRW::BAD_NONE};
+    std::exception_ptr firstException;
+    if (rangeCount > 0) {
+        try {
+            firstError = parseRange(*workers[0], 0, iface);
+        } catch (...) {
+            firstException = std::current_exception();
+        }
+        parseRanges(*workers[0]);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    if (firstException) {
+        std::rethrow_exception(firstException);
+    }
+    if (DRW::BAD_NONE != firstError) {
+        return setError(firstError);
+    }
+    for (auto &p : parsed) {
+        p.recorder.replay(iface);
+        if (p.exception) {
+            std::rethrow_exception(p.exception);
+        }
+        if (DRW::BAD_NONE != p.error) {
+            return setError(p.error);
+        }
+    }
+    if (!sectionEnd) {
+        return setError(DRW::BAD_READ_ENTITIES);  //end of file without ENDSEC
+    }
+    return true;
+}
+
 bool dxfRW::doProcessEntity(DRW_Entity& ent, DRW_EntityFunc applyFunc) {
     int code;
     while (readRec(&code)) {
@@ -24,6 +24,7 @@
 
 
 class dxfReader;
+class dxfReaderAscii;
 class dxfWriter;
 
 using DRW_TableEntryFunc = std::function<void(DRW_TableEntry*)>;
@@ -117,6 +118,7 @@ private:
     bool processBlocks();
     bool processBlock();
     bool processEntities(bool isblock);
+    bool processEntitiesParallel(dxfReaderAscii *asciiReader);
     bool doProcessEntity(DRW_Entity& ent, DRW_EntityFunc applyFunc);
     bool doProcessParseable(DRW_ParseableEntity& ent, DRW_ParseableFunc applyFunc, DRW::error sectionError = DRW::BAD_READ_ENTITIES);
     bool processObjects();
@@ -40,7 +40,12 @@ RS_ActionBlocksSave::RS_ActionBlocksSave(LC_ActionContext *actionContext)
 
 /*recursive add blocks in graphic*/
 void RS_ActionBlocksSave::addBlock(RS_Insert *in, RS_Graphic *g) {
-    for (auto e: *in) {
+    // inserts of the block, the insert may not have created its copies of them
+    RS_Block* block = in->getBlockForInsert();
+    if (block == nullptr) {
+        return;
+    }
+    for (auto e: *block) {
         if (e->rtti() == RS2::EntityInsert) {
             auto *insert = static_cast<RS_Insert *>(e);
             addBlock(insert, g);
@@ -71,8 +71,8 @@ void RS_ActionLayersToggleLock::deselectEntitiesOnLockedLayer(RS_Layer* layer)
     if (!layer) return;
     if (!layer->isLocked()) return;
 
-    for(auto e: *m_container){ // fixme - sand -  interation over all entities in container
-        if (e && e->isVisible() && e->getLayer() == layer) {
+    for(auto e: m_container->getEntitiesOnLayer(layer)){
+        if (e->isVisible()) {
             e->setSelected(false);
         }
     }
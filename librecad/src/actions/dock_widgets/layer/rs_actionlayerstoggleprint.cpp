@@ -72,8 +72,8 @@ void RS_ActionLayersTogglePrint::deselectEntities(RS_Layer* layer)
 {
     if (!layer) return;
 
-    for(auto e: *m_container){ // // fixme - sand -  iteration over all entities in container
-        if (e && e->isVisible() && e->getLayer() == layer) {
+    for(auto e: m_container->getEntitiesOnLayer(layer)){
+        if (e->isVisible()) {
             e->setSelected(false);
         }
     }
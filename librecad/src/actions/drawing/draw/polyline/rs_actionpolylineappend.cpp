@@ -72,6 +72,8 @@ void RS_ActionPolylineAppend::onMouseMoveEvent(int status, LC_MouseEvent *e) {
                 highlightHover(polyline);
 
                 if (m_showRefEntitiesOnPreview) {
+                    // the end segments are compared with the nearest segment found
+                    polyline->prepareEntities();
                     auto entFirst = polyline->firstEntity();
                     auto entLast = polyline->lastEntity();
 
@@ -126,6 +128,7 @@ bool RS_ActionPolylineAppend::setPolylineToModify(RS_Entity* entity, const RS_Ve
         return false;
     } else {
         auto *op = m_originalPolyline;
+        op->prepareEntities();
         auto entFirst = op->firstEntity();
         auto entLast = op->lastEntity();
 
@@ -118,6 +118,8 @@ void RS_ActionPolylineDelBetween::setPolylineToModify(RS_Entity* en) {
         commandMessage(tr("Entity must be a polyline."));
     } else {
         m_polylineToModify = dynamic_cast<RS_Polyline *>(en);
+        // segments between the nodes are collected for removal
+        m_polylineToModify->prepareEntities();
         m_polylineToModify->setSelected(true);
         setStatus(SetVertex1);
         redraw();
@@ -125,9 +125,16 @@ void RS_ActionPolylineEquidistant::makeContour(RS_Polyline*  originalPolyline, b
                         "RS_ActionPolylineEquidistant::makeContour: no valid container");
     }
 
+    // the segments are only read, a compact polyline provides copies of them
+    RS_EntityContainer copies{nullptr, true};
+    if (originalPolyline->hasDeferredEntities()) {
+        copies.adoptTemporaryEntities(*originalPolyline);
+    }
+    const RS_EntityContainer& segments = originalPolyline->hasDeferredEntities() ? copies : *originalPolyline;
+
     //create a list of entities to offset without length = 0
     QList<RS_Entity *> entities;
-    for (auto en: *originalPolyline) {
+    for (auto en: segments) {
         if (en->getLength() > 1.0e-12) {
             entities.append(en);
         }
@@ -354,21 +361,25 @@ void RS_ActionPolylineEquidistant::onMouseRightButtonRelease(int status, [[maybe
 
 bool RS_ActionPolylineEquidistant::isPointOnRightSideOfPolyline(const RS_Polyline *polyline, const RS_Vector &snapPoint) const{
     bool pointOnRightSide = false;
-    double d = toGraphDX(m_catchEntityGuiRange) * 0.9;
-    auto segment = polyline->getNearestEntity(snapPoint, &d, RS2::ResolveNone);
-    if (isLine(segment)){ // fixme - support of polyline
-        auto line = dynamic_cast<RS_Line *>(segment);
-        double ang = line->getAngle1();
-        double ang1 = line->getStartpoint().angleTo(snapPoint);
-        if (ang > ang1 || ang + M_PI < ang1) {
-            pointOnRightSide = true;
+    double minDist = RS_MAXDOUBLE;
+    // segments of a compact polyline are visited as temporary copies, so the side is found during the visit
+    polyline->visitEntities([this, &pointOnRightSide, &minDist, &snapPoint](RS_Entity* segment) {
+        double dist = segment->getDistanceToPoint(snapPoint);
+        if (dist >= minDist) {
+            return true;
         }
-    } else {
-        RS_Vector cen = ((RS_Arc *) segment)->getCenter();
-        if (cen.distanceTo(snapPoint) > ((RS_Arc *) segment)->getRadius() && ((RS_Arc *) segment)->getBulge() > 0) {
-            pointOnRightSide = true;
+        minDist = dist;
+        if (isLine(segment)){ // fixme - support of polyline
+            auto line = dynamic_cast<RS_Line *>(segment);
+            double ang = line->getAngle1();
+            double ang1 = line->getStartpoint().angleTo(snapPoint);
+            pointOnRightSide = ang > ang1 || ang + M_PI < ang1;
+        } else {
+            auto arc = static_cast<RS_Arc *>(segment);
+            pointOnRightSide = arc->getCenter().distanceTo(snapPoint) > arc->getRadius() && arc->getBulge() > 0;
         }
-    }
+        return true;
+    });
     return pointOnRightSide;
 }
 RS2::CursorType RS_ActionPolylineEquidistant::doGetMouseCursor([[maybe_unused]] int status){
@@ -25,6 +25,7 @@
 **********************************************************************/
 #include "rs_actionpolylinesegment.h"
 
+#include "lc_endpointindex.h"
 #include "rs_arc.h"
 #include "rs_debug.h"
 #include "rs_entitycontainer.h"
@@ -103,7 +104,14 @@ void RS_ActionPolylineSegment::init(int status){
 RS_Vector RS_ActionPolylineSegment::appendPol(RS_Polyline *current, RS_Polyline *toAdd, bool reversed) {
     QList<RS_Entity *> entities;
 
-    for (auto v: *toAdd) {
+    // the segments are only read, a compact polyline provides copies of them
+    RS_EntityContainer copies{nullptr, true};
+    if (toAdd->hasDeferredEntities()) {
+        copies.adoptTemporaryEntities(*toAdd);
+    }
+    const RS_EntityContainer& segments = toAdd->hasDeferredEntities() ? copies : *toAdd;
+
+    for (auto v: segments) {
         if (reversed) {
             entities.prepend(v);
         }
@@ -199,35 +207,30 @@ RS_Polyline* RS_ActionPolylineSegment::convertPolyline(RS_EntityContainer* cnt,
     }
 
         // find all connected entities:
-    bool done = true;
-    do {
-        done = true;
-        for (int i = (remaining.size() - 1); i >= 0; --i) {
-            RS_Entity *e = remaining.at(i);
-            const RS_Vector &endpoint = e->getEndpoint();
-            if (endpoint.distanceTo(start) < 1.0e-4){  // fixme = RS_TOLERANCE??
-                completed.prepend(e);
-                start = e->getStartpoint();
-                remaining.removeAt(i);
-                done = false;
-            } else if (e->getStartpoint().distanceTo(start) < 1.0e-4){
-                completed.prepend(e);
-                start = endpoint;
-                remaining.removeAt(i);
-                done = false;
-            } else if (endpoint.distanceTo(end) < 1.0e-4){
-                completed.append(e);
-                end = e->getStartpoint();
-                remaining.removeAt(i);
-                done = false;
-            } else if (e->getStartpoint().distanceTo(end) < 1.0e-4){
-                completed.append(e);
-                end = endpoint;
-                remaining.removeAt(i);
-                done = false;
-            }
+    LC_EndpointIndex endpoints;
+    for (RS_Entity *e: remaining) {
+        endpoints.insert(e);
+    }
+    // as scanned from the back of the list before, the last connected entity is taken
+    auto takeConnected = [&endpoints](RS_Vector &point) -> RS_Entity* {
+        std::vector<RS_Entity *> connected = endpoints.entitiesAt(point);
+        if (connected.empty()) {
+            return nullptr;
         }
-    } while (!done);
+        RS_Entity *e = connected.back();
+        point = (e->getEndpoint().distanceTo(point) < 1.0e-4) ? e->getStartpoint() : e->getEndpoint();
+        endpoints.remove(e);
+        return e;
+    };
+    for (;;) {
+        if (RS_Entity *e = takeConnected(start)) {
+            completed.prepend(e);
+        } else if (RS_Entity *e = takeConnected(end)) {
+            completed.append(e);
+        } else {
+            break;
+        }
+    }
 
     //cleanup for no more needed list
     remaining.clear();
@@ -214,7 +214,8 @@ RS_Entity* LC_ActionSplineFromPolyline::createSplineForPolyline(RS_Entity *p) {
 void LC_ActionSplineFromPolyline::fillControlPointsListFromPolyline(const RS_Polyline *polyline, std::vector<RS_Vector> &controlPoints) const {
     controlPoints.reserve(polyline->count() * (m_segmentMiddlePoints + 1) + 1);
     controlPoints.push_back(polyline->getStartpoint());
-    for(RS_Entity* entity: lc::LC_ContainerTraverser{*polyline, RS2::ResolveAll}.entities()) {
+    lc::LC_ContainerTraverser traverser{*polyline, RS2::ResolveAll};
+    for(RS_Entity* entity: traverser.entities()) {
         if (!isAtomic(entity)){
             continue;
         }
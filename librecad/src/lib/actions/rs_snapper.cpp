@@ -25,6 +25,8 @@
 **********************************************************************/
 
 
+#include <utility>
+
 #include <QMouseEvent>
 
 #include "lc_actioncontext.h"
@@ -348,36 +350,27 @@ RS_Vector RS_Snapper::snapPoint(QMouseEvent* e){
     RS_Vector mouseCoord = toGraph(e);
     double ds2Min=RS_MAXDOUBLE*RS_MAXDOUBLE;
 
-    if (m_snapMode.snapEndpoint) {
-        t = snapEndpoint(mouseCoord);
-        double ds2=mouseCoord.squaredTo(t);
-
-        if (t.valid && ds2 < ds2Min){
-            ds2Min=ds2;
-            pImpData->snapSpot = t;
-            pImpData->snapType = SnapType::ENDPOINT;
-        }
-    }
-    if (m_snapMode.snapCenter) {
-        t = snapCenter(mouseCoord);
-        double ds2=mouseCoord.squaredTo(t);
-        if (ds2 < ds2Min){
-            ds2Min=ds2;
-            pImpData->snapSpot = t;
-            pImpData->snapType = SnapType::CENTER;
+    if (m_snapMode.snapEndpoint || m_snapMode.snapCenter || m_snapMode.snapMiddle) {
+        if (m_snapMode.snapMiddle) {
+            //todo: accept value from widget QG_SnapMiddleOptions
+            m_actionContext->requestSnapMiddleOptions(&m_middlePoints, m_snapMode.snapMiddle);
         }
-    }
-    if (m_snapMode.snapMiddle) {
-        //this is still brutal force
-        //todo: accept value from widget QG_SnapMiddleOptions
-
-        m_actionContext->requestSnapMiddleOptions(&m_middlePoints, m_snapMode.snapMiddle);
-        t = snapMiddle(mouseCoord);
-        double ds2=mouseCoord.squaredTo(t);
-        if (ds2 < ds2Min){
-            ds2Min=ds2;
-            pImpData->snapSpot = t;
-            pImpData->snapType = SnapType::MIDDLE;
+        // endpoints, centers and middles are searched in a single pass,
+        // equally distant points are preferred in this order
+        const RS_EntityContainer::SnapPoints points = m_container->getNearestSnapPoints(
+            mouseCoord, m_snapMode.snapEndpoint, m_snapMode.snapCenter, m_snapMode.snapMiddle, m_middlePoints);
+        const std::pair<RS_Vector, SnapType> candidates[] = {
+            {points.endpoint, SnapType::ENDPOINT},
+            {points.center, SnapType::CENTER},
+            {points.middle, SnapType::MIDDLE}
+        };
+        for (const auto& [point, snapType]: candidates) {
+            double ds2 = mouseCoord.squaredTo(point);
+            if (point.valid && ds2 < ds2Min) {
+                ds2Min = ds2;
+                pImpData->snapSpot = point;
+                pImpData->snapType = snapType;
+            }
         }
     }
     if (m_snapMode.snapDistance) {
@@ -722,14 +715,9 @@ RS_Entity* RS_Snapper::catchEntity(const RS_Vector& pos,
 
     RS_Entity* entity = m_container->getNearestEntity(pos, &dist, level);
 
-    int idx = -1;
-    if (entity != nullptr && entity->getParent()) {
-        idx = entity->getParent()->findEntity(entity);
-    }
-
     if (entity != nullptr && dist <= getCatchDistance(getSnapRange(), m_catchEntityGuiRange)) {
         // highlight:
-        RS_DEBUG->print("RS_Snapper::catchEntity: found: %d", idx);
+        RS_DEBUG->print("RS_Snapper::catchEntity: found: %llu", entity->getId());
         return entity;
     } else {
         RS_DEBUG->print("RS_Snapper::catchEntity: not found");
@@ -767,8 +755,19 @@ RS_Entity* RS_Snapper::catchEntity(const RS_Vector& pos, RS2::EntityType enType,
             break;
     }
 
-    // fixme - iteration over all elements of drawing
-    for(RS_Entity* en: lc::LC_ContainerTraverser{*m_container, level}.entities()){
+    // entities further than the catch distance are rejected anyway, so only entities
+    // with boxes around the position are candidates
+    double catchDistance = getCatchDistance(getSnapRange(), m_catchEntityGuiRange);
+    RS_Vector catchRange{catchDistance, catchDistance};
+    RS_EntityContainer candidates(nullptr, false);
+    for (RS_Entity* candidate: m_container->getCandidatesInBox(pos - catchRange, pos + catchRange)) {
+        // traversing creates deferred entities of containers, so only those within reach are traversed
+        if (candidate->getDistanceToPoint(pos, nullptr, RS2::ResolveNone) <= catchDistance) {
+            candidates.push_back(candidate);
+        }
+    }
+
+    for(RS_Entity* en: lc::LC_ContainerTraverser{candidates, level}.entities()){
         if(!en->isVisible())
             continue;
         if(en->rtti() != enType && isContainer){
@@ -795,14 +794,9 @@ RS_Entity* RS_Snapper::catchEntity(const RS_Vector& pos, RS2::EntityType enType,
 
     RS_Entity* entity = ec.getNearestEntity(pos, &dist, RS2::ResolveNone);
 
-    int idx = -1;
-    if (entity != nullptr && entity->getParent()) {
-        idx = entity->getParent()->findEntity(entity);
-    }
-
-    if (entity != nullptr && dist <= getCatchDistance(getSnapRange(), m_catchEntityGuiRange)) {
+    if (entity != nullptr && dist <= catchDistance) {
         // highlight:
-        RS_DEBUG->print("RS_Snapper::catchEntity: found: %d", idx);
+        RS_DEBUG->print("RS_Snapper::catchEntity: found: %llu", entity->getId());
         return entity;
     } else {
         RS_DEBUG->print("RS_Snapper::catchEntity: not found");
@@ -53,6 +53,7 @@ RS_BlockList::RS_BlockList(bool owner) {
  */
 void RS_BlockList::clear() {
     m_blocks.clear();
+    m_nameIndex.clear();
 	m_activeBlock = nullptr;
 	setModified(true);
 }
@@ -98,6 +99,7 @@ bool RS_BlockList::add(RS_Block* block, bool notify) {
     RS_Block* b = find(block->getName());
 	if (!b) {
         m_blocks.append(block);
+        m_nameIndex.insert(block);
 
         if (notify) {
             addNotification();
@@ -135,6 +137,7 @@ void RS_BlockList::remove(RS_Block* block) {
 
     // here the block is removed from the list but not deleted
     m_blocks.removeOne(block);
+    m_nameIndex.remove(block);
 
 	for(auto l: m_blockListListeners){
 		l->blockRemoved(block);
@@ -168,6 +171,7 @@ bool RS_BlockList:: rename(RS_Block* block, const QString& name) {
 		if (!find(name)) {
 			QString oldName = block->getName();
 			block->setName(name);
+			m_nameIndex.rename(block);
 			setModified(true);
 
 			// when the renamed block is nested within other block, we need to rename its inserts as well
@@ -212,15 +216,11 @@ RS_Block* RS_BlockList::find(const QString& name) {
         RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): wrong name to find");
         return nullptr;
     }
-	// Todo : reduce this from O(N) to O(log(N)) complexity based on sorted list or hash
-	//DFS
-	for(RS_Block* b: m_blocks) {
-		if (b->getName()==name) {
-			return b;
-		}
+	RS_Block* b = m_nameIndex.find(name, m_blocks);
+	if (b == nullptr) {
+		RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): bad");
 	}
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): bad");
-	return nullptr;
+	return b;
 }
 
 RS_Block* RS_BlockList::findCaseInsensitive(const QString& name) const {
@@ -231,15 +231,11 @@ RS_Block* RS_BlockList::findCaseInsensitive(const QString& name) const {
         RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): wrong name to find");
         return nullptr;
     }
-    // Todo : reduce this from O(N) to O(log(N)) complexity based on sorted list or hash
-    //DFS
-    for(RS_Block* b: m_blocks) {
-        if (b->getName().compare(name, Qt::CaseInsensitive) == 0) {
-            return b;
-        }
+    RS_Block* b = m_nameIndex.findCaseInsensitive(name, m_blocks);
+    if (b == nullptr) {
+        RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): bad");
     }
-    RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_BlockList::find(): bad");
-    return nullptr;
+    return b;
 }
 
 /**
@@ -30,6 +30,8 @@
 
 #include <QList>
 
+#include "lc_nameindex.h"
+
 class QString;
 class RS_Block;
 class RS_BlockListListener;
@@ -105,6 +107,8 @@ private:
     bool m_owner = false;
     //! Blocks in the graphic
     QList<RS_Block*> m_blocks;
+    //! Blocks by name, mutable for const lookups
+    mutable LC_NameIndex<RS_Block> m_nameIndex;
     //! List of registered BlockListListeners
     QList<RS_BlockListListener*> m_blockListListeners;
     //! Currently active block
@@ -25,6 +25,8 @@
 
 #include "lc_containertraverser.h"
 
+#include <unordered_map>
+
 #include "rs.h"
 #include "rs_entity.h"
 #include "rs_entitycontainer.h"
@@ -36,9 +38,10 @@ namespace {
 // ParentNode used to track containers during traversing
 struct ParentNode
 {
-    ParentNode(const RS_EntityContainer* container, int index):
+    ParentNode(const RS_EntityContainer* container, int index, bool temporary = false):
         container{container}
         , index{index}
+        , temporary{temporary}
     {}
 
     // Whether the index is valid within the current parent node
@@ -48,6 +51,8 @@ struct ParentNode
     }
     const RS_EntityContainer* container = nullptr;
     int index = 0;
+    // whether entities of the container are temporary copies owned by the traverser
+    bool temporary = false;
 };
 
 bool isText(const RS_Entity& entity)
@@ -61,17 +66,35 @@ bool isText(const RS_Entity& entity)
     }
 }
 
+// temporary copies of deferred entities by the containers they are copied from
+using Temporaries = std::unordered_map<const RS_EntityContainer*, std::unique_ptr<RS_EntityContainer>>;
+
 } // namespace
 
 namespace lc {
 
 // pImp struct
 struct LC_ContainerTraverser::Data {
-    Data(const RS_EntityContainer& container, RS2::ResolveLevel level):
+    Data(const RS_EntityContainer& container, RS2::ResolveLevel level, bool editable,
+         std::shared_ptr<Temporaries> temporaries = std::make_shared<Temporaries>()):
         container{&container}
-        , indices{{&container, 0}}
         , level{level}
+        , editable{editable}
+        , temporaries{std::move(temporaries)}
     {
+        if (container.hasDeferredEntities() && !editable) {
+            this->container = copyOf(container);
+            rootTemporary = true;
+        }
+        indices = {{this->container, 0, rootTemporary}};
+    }
+
+    // the same traversal from its start, sharing the temporary copies
+    std::unique_ptr<Data> restart() const
+    {
+        auto data = std::make_unique<Data>(*this);
+        data->indices = {{container, 0, rootTemporary}};
+        return data;
     }
 
     // whether to traverse into
@@ -93,15 +116,61 @@ struct LC_ContainerTraverser::Data {
             return true;
         }
     }
+
+    // the node of the container to traverse into, with its deferred entities either created or copied
+    ParentNode enter(RS_Entity* entity, bool parentTemporary)
+    {
+        auto* container = static_cast<RS_EntityContainer*>(entity);
+        if (!container->hasDeferredEntities()) {
+            return {container, 0, parentTemporary};
+        }
+        if (editable || parentTemporary) {
+            // copies owned by the traverser are completed as well
+            container->prepareEntities();
+            return {container, 0, parentTemporary};
+        }
+        return {copyOf(*container), 0, true};
+    }
+
+    const RS_EntityContainer* copyOf(const RS_EntityContainer& source)
+    {
+        std::unique_ptr<RS_EntityContainer>& copy = (*temporaries)[&source];
+        if (copy == nullptr) {
+            copy = std::make_unique<RS_EntityContainer>(nullptr, true);
+            copy->adoptTemporaryEntities(source);
+        }
+        return copy.get();
+    }
+
     const RS_EntityContainer* container = nullptr;
     std::vector<ParentNode> indices;
     RS2::ResolveLevel level = RS2::ResolveNone;
+    // traversing a non-const container, whose deferred entities are created
+    bool editable = false;
+    bool rootTemporary = false;
+    std::shared_ptr<Temporaries> temporaries;
 };
 
+LC_ContainerTraverser::LC_ContainerTraverser(RS_EntityContainer& container,
+                                             RS2::ResolveLevel level,
+                                             LC_ContainerTraverser::Direction direction):
+    m_direction{direction}
+{
+    container.prepareEntities();
+    m_pImp = std::make_unique<LC_ContainerTraverser::Data>(container, level, true);
+}
+
 LC_ContainerTraverser::LC_ContainerTraverser(const RS_EntityContainer& container,
                                              RS2::ResolveLevel level,
                                              LC_ContainerTraverser::Direction direction):
-    m_pImp{std::make_unique<LC_ContainerTraverser::Data>(container, level)}
+    m_pImp{std::make_unique<LC_ContainerTraverser::Data>(container, level, false)}
+    , m_direction{direction}
+{
+}
+
+LC_ContainerTraverser::LC_ContainerTraverser(std::unique_ptr<LC_ContainerTraverser::Data> data,
+                                             LC_ContainerTraverser::Direction direction):
+    m_pImp{std::move(data)}
     , m_direction{direction}
 {
 }
@@ -112,11 +181,11 @@ std::vector<RS_Entity*> LC_ContainerTraverser::entities()
 {
     std::vector<RS_Entity*> ret;
     // collecting entities by the DFS order
-    collect(ret, m_pImp->container);
+    collect(ret, m_pImp->container, m_pImp->rootTemporary);
     return ret;
 }
 
-void LC_ContainerTraverser::collect(std::vector<RS_Entity*>& items, const RS_EntityContainer* container) const
+void LC_ContainerTraverser::collect(std::vector<RS_Entity*>& items, const RS_EntityContainer* container, bool temporary) const
 {
     if (container == nullptr)
         return;
@@ -126,7 +195,8 @@ void LC_ContainerTraverser::collect(std::vector<RS_Entity*>& items, const RS_Ent
             continue;
 
         if (entity->isContainer() && m_pImp->canResolve(container)) {
-            collect(items, static_cast<RS_EntityContainer*>(entity));
+            const ParentNode node = m_pImp->enter(entity, temporary);
+            collect(items, node.container, node.temporary);
         } else {
             items.push_back(entity);
         }
@@ -135,7 +205,7 @@ void LC_ContainerTraverser::collect(std::vector<RS_Entity*>& items, const RS_Ent
 
 RS_Entity* LC_ContainerTraverser::first()
 {
-    m_pImp->indices = std::vector<ParentNode>{{m_pImp->container, 0}};
+    m_pImp->indices = std::vector<ParentNode>{{m_pImp->container, 0, m_pImp->rootTemporary}};
     return get();
 }
 
@@ -148,7 +218,7 @@ RS_Entity* LC_ContainerTraverser::prev()
 {
     // create a traverser with reverted direction
     // so the next traversed node is the previous of the current traverser
-    LC_ContainerTraverser revTraverser{*m_pImp->container, m_pImp->level, LC_ContainerTraverser::Direction::Backword};
+    LC_ContainerTraverser revTraverser{m_pImp->restart(), LC_ContainerTraverser::Direction::Backword};
     revTraverser.m_direction = (m_direction == Direction::Forward) ?
                                    Direction::Backword : Direction::Backword;
 
@@ -169,7 +239,7 @@ RS_Entity* LC_ContainerTraverser::prev()
 
 RS_Entity* LC_ContainerTraverser::last()
 {
-    LC_ContainerTraverser revTraverser{*m_pImp->container, m_pImp->level, LC_ContainerTraverser::Direction::Backword};
+    LC_ContainerTraverser revTraverser{m_pImp->restart(), LC_ContainerTraverser::Direction::Backword};
     return revTraverser.get();
 }
 
@@ -177,18 +247,19 @@ RS_Entity* LC_ContainerTraverser::get()
 {
     if (m_pImp->indices.empty())
         return nullptr;
-    auto& [container, ii] = m_pImp->indices.back();
-    if (ii < 0 || size_t(ii) >= container->count()) {
+    ParentNode& node = m_pImp->indices.back();
+    if (node.index < 0 || size_t(node.index) >= node.container->count()) {
         // exhausted the current
         m_pImp->indices.pop_back();
         return get();
     }
 
-    RS_Entity* current = container->entityAt(currentIndex());
+    RS_Entity* current = node.container->entityAt(currentIndex());
     // advance the index, pointing to the next candidate
-    ++ii;
+    ++node.index;
     if (current->isContainer() && m_pImp->canResolve(current)) {
-        m_pImp->indices.emplace_back(static_cast<RS_EntityContainer*>(current), 0);
+        ParentNode child = m_pImp->enter(current, node.temporary);
+        m_pImp->indices.push_back(child);
         return get();
     }
     return current;
@@ -60,6 +60,13 @@ namespace lc {
  *   The difference between those two new methods is whether to generate a list
  *   of container entities before looping through them. The difference is only
  *   important, if traverse must be customized based on the current entity.
+ *
+ *   Traversing a non-const container creates deferred entities of the containers
+ *   traversed, as the entities found may be modified. Traversing a const container
+ *   doesn't create them, temporary copies are traversed instead. The copies are owned
+ *   by the traverser, so entities found must not be used after the traverser is gone:
+ *     LC_ContainerTraverser traverser{std::as_const(container), level};
+ *     for(auto* entity: traverser.entities());
  * @author Dongxu Li
  */
 class LC_ContainerTraverser {
@@ -72,6 +79,9 @@ public:
         Backword = 1 // traversing backwards
     };
 
+    LC_ContainerTraverser(RS_EntityContainer& container,
+                          RS2::ResolveLevel level,
+                          LC_ContainerTraverser::Direction direction = Direction::Forward);
     LC_ContainerTraverser(const RS_EntityContainer& container,
                           RS2::ResolveLevel level,
                           LC_ContainerTraverser::Direction direction = Direction::Forward);
@@ -116,14 +126,16 @@ public:
     std::vector<RS_Entity*> entities();
 
 private:
+    struct Data;
+    LC_ContainerTraverser(std::unique_ptr<LC_ContainerTraverser::Data> data,
+                          LC_ContainerTraverser::Direction direction);
     // traverse by one step
     RS_Entity* get();
     // Collect entities in the container by the DFS order
-    void collect(std::vector<RS_Entity*>& items, const RS_EntityContainer* container) const;
+    void collect(std::vector<RS_Entity*>& items, const RS_EntityContainer* container, bool temporary) const;
     // for forward/backward support
     size_t currentIndex() const;
 
-    struct Data;
     std::unique_ptr<LC_ContainerTraverser::Data> m_pImp;
     LC_ContainerTraverser::Direction m_direction = Direction::Forward;
 };
@@ -0,0 +1,121 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "lc_endpointindex.h"
+#include "rs_entity.h"
+
+namespace {
+// cell coordinates are clamped, far beyond any drawing extent at sensible tolerances
+constexpr double maxCell = 1.0e18;
+}
+
+LC_EndpointIndex::LC_EndpointIndex(double tolerance)
+    : m_tolerance{tolerance > 0. ? tolerance : 1.0e-4} {
+}
+
+LC_EndpointIndex::Cell LC_EndpointIndex::cellOf(const RS_Vector& point) const {
+    auto cell = [this](double v) {
+        return static_cast<long long>(std::clamp(std::floor(v / m_tolerance), -maxCell, maxCell));
+    };
+    return {cell(point.x), cell(point.y)};
+}
+
+void LC_EndpointIndex::insert(RS_Entity* entity) {
+    if (entity == nullptr) {
+        return;
+    }
+    remove(entity);
+    Item item{entity->getStartpoint(), entity->getEndpoint(), m_nextOrder++};
+    addToCell(item.start, entity);
+    addToCell(item.end, entity);
+    m_items.emplace(entity, item);
+}
+
+void LC_EndpointIndex::remove(const RS_Entity* entity) {
+    auto it = m_items.find(entity);
+    if (it == m_items.end()) {
+        return;
+    }
+    removeFromCell(it->second.start, entity);
+    removeFromCell(it->second.end, entity);
+    m_items.erase(it);
+}
+
+bool LC_EndpointIndex::contains(const RS_Entity* entity) const {
+    return m_items.count(entity) > 0;
+}
+
+std::vector<RS_Entity*> LC_EndpointIndex::entitiesAt(const RS_Vector& point) const {
+    std::vector<RS_Entity*> result;
+    if (!point.valid) {
+        return result;
+    }
+    // a point closer than the tolerance lies in the same or in a neighbouring cell
+    const Cell center = cellOf(point);
+    for (long long dx = -1; dx <= 1; ++dx) {
+        for (long long dy = -1; dy <= 1; ++dy) {
+            auto cellIt = m_cells.find({center.first + dx, center.second + dy});
+            if (cellIt == m_cells.end()) {
+                continue;
+            }
+            for (RS_Entity* entity: cellIt->second) {
+                const Item& item = m_items.at(entity);
+                if (item.start.distanceTo(point) < m_tolerance || item.end.distanceTo(point) < m_tolerance) {
+                    result.push_back(entity);
+                }
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [this](const RS_Entity* a, const RS_Entity* b) {
+        return m_items.at(a).order < m_items.at(b).order;
+    });
+    // both end points of short entities may be found
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+void LC_EndpointIndex::addToCell(const RS_Vector& point, RS_Entity* entity) {
+    if (point.valid) {
+        m_cells[cellOf(point)].push_back(entity);
+    }
+}
+
+void LC_EndpointIndex::removeFromCell(const RS_Vector& point, const RS_Entity* entity) {
+    if (!point.valid) {
+        return;
+    }
+    auto cellIt = m_cells.find(cellOf(point));
+    if (cellIt == m_cells.end()) {
+        return;
+    }
+    std::vector<RS_Entity*>& entities = cellIt->second;
+    // the entity is listed twice in the cell holding both of its end points, each call removes one
+    auto it = std::find(entities.begin(), entities.end(), entity);
+    if (it != entities.end()) {
+        entities.erase(it);
+    }
+    if (entities.empty()) {
+        m_cells.erase(cellIt);
+    }
+}
@@ -0,0 +1,83 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_ENDPOINTINDEX_H
+#define LC_ENDPOINTINDEX_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rs_vector.h"
+
+class RS_Entity;
+
+/**
+ * @brief The LC_EndpointIndex class
+ *        Hash grid of start and end points of entities, answering which entities have an end
+ *        point within a tolerance of a given point. It replaces repeated scans of all entities
+ *        when chains of connected entities are followed (contour selection, polyline joining).
+ *
+ *        Points are quantized to cells of the tolerance size, so a query checks the 3x3 cells
+ *        around the point and compares the exact distances. End points are taken when the
+ *        entity is inserted; entities modified afterwards must be inserted again.
+ */
+class LC_EndpointIndex {
+public:
+    explicit LC_EndpointIndex(double tolerance = 1.0e-4);
+
+    void insert(RS_Entity* entity);
+    void remove(const RS_Entity* entity);
+    bool contains(const RS_Entity* entity) const;
+    bool isEmpty() const {return m_items.empty();}
+
+    /**
+     * @brief entitiesAt - entities with the start or end point closer than the tolerance to the point
+     * @return entities in the order they were inserted
+     */
+    std::vector<RS_Entity*> entitiesAt(const RS_Vector& point) const;
+
+private:
+    using Cell = std::pair<long long, long long>;
+    struct CellHash {
+        size_t operator()(const Cell& cell) const {
+            size_t h = std::hash<long long>()(cell.first);
+            return h ^ (std::hash<long long>()(cell.second) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+        }
+    };
+    struct Item {
+        RS_Vector start;
+        RS_Vector end;
+        size_t order = 0;
+    };
+
+    Cell cellOf(const RS_Vector& point) const;
+    void addToCell(const RS_Vector& point, RS_Entity* entity);
+    void removeFromCell(const RS_Vector& point, const RS_Entity* entity);
+
+    double m_tolerance = 1.0e-4;
+    std::unordered_map<Cell, std::vector<RS_Entity*>, CellHash> m_cells;
+    std::unordered_map<const RS_Entity*, Item> m_items;
+    size_t m_nextOrder = 0;
+};
+
+#endif // LC_ENDPOINTINDEX_H
@@ -0,0 +1,414 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+
+#include "lc_spatialindex.h"
+#include "rs.h"
+#include "rs_entity.h"
+#include "rs_entitycontainer.h"
+#include "rs_vector.h"
+
+namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+namespace {
+
+using BPoint = bg::model::point<double, 2, bg::cs::cartesian>;
+using BBox = bg::model::box<BPoint>;
+using TreeValue = std::pair<BBox, RS_Entity*>;
+using Tree = bgi::rtree<TreeValue, bgi::quadratic<16>>;
+
+// gap between order keys of neighbours, leaves room for inserting entities in between
+constexpr long long orderStep = 1LL << 20;
+
+// Bounds accumulated over an entity and its children
+struct PickBounds {
+    double minX = RS_MAXDOUBLE;
+    double minY = RS_MAXDOUBLE;
+    double maxX = RS_MINDOUBLE;
+    double maxY = RS_MINDOUBLE;
+
+    void extend(double x, double y)
+    {
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+    }
+
+    bool isEmpty() const
+    {
+        return minX > maxX || minY > maxY;
+    }
+};
+
+bool hasFiniteBorders(const RS_Entity& entity)
+{
+    const RS_Vector lo = entity.getMin();
+    const RS_Vector hi = entity.getMax();
+    // borders are reset to (MAXDOUBLE, MINDOUBLE), NaN fails all comparisons
+    return lo.x <= hi.x && lo.y <= hi.y
+           && lo.x > RS_MINDOUBLE && lo.y > RS_MINDOUBLE
+           && hi.x < RS_MAXDOUBLE && hi.y < RS_MAXDOUBLE;
+}
+
+/**
+ * Extends bounds by all points the entity may measure its distance to. Besides the
+ * borders, RS_Entity::getDistanceToPoint() considers the center of arcs and
+ * ellipses, and containers forward the distance query to their children.
+ * @return false, if the entity can't be bounded (construction lines, missing borders)
+ */
+bool extendPickBounds(const RS_Entity& entity, PickBounds& bounds)
+{
+    if (entity.rtti() == RS2::EntityConstructionLine) {
+        return false;
+    }
+    if (entity.isContainer()) {
+        // deferred entities are bounded by their temporary copies
+        const bool bounded = static_cast<const RS_EntityContainer&>(entity).visitEntities([&bounds](RS_Entity* child) {
+            return child == nullptr || extendPickBounds(*child, bounds);
+        });
+        if (!bounded) {
+            return false;
+        }
+        if (hasFiniteBorders(entity)) {
+            bounds.extend(entity.getMin().x, entity.getMin().y);
+            bounds.extend(entity.getMax().x, entity.getMax().y);
+        }
+        return true;
+    }
+    if (!hasFiniteBorders(entity)) {
+        return false;
+    }
+    bounds.extend(entity.getMin().x, entity.getMin().y);
+    bounds.extend(entity.getMax().x, entity.getMax().y);
+    const RS_Vector center = entity.getCenter();
+    if (center.valid) {
+        bounds.extend(center.x, center.y);
+    }
+    return true;
+}
+
+bool pickBox(const RS_Entity& entity, BBox& box)
+{
+    PickBounds bounds;
+    if (!extendPickBounds(entity, bounds) || bounds.isEmpty()) {
+        return false;
+    }
+    box = BBox{{bounds.minX, bounds.minY}, {bounds.maxX, bounds.maxY}};
+    return true;
+}
+
+bool sameBox(const BBox& a, const BBox& b)
+{
+    return a.min_corner().get<0>() == b.min_corner().get<0>()
+           && a.min_corner().get<1>() == b.min_corner().get<1>()
+           && a.max_corner().get<0>() == b.max_corner().get<0>()
+           && a.max_corner().get<1>() == b.max_corner().get<1>();
+}
+
+struct Entry {
+    BBox box;
+    long long order = 0;
+    bool bounded = false;
+};
+} // namespace
+
+struct LC_SpatialIndex::Impl {
+    using ChangeListener = LC_SpatialIndex::ChangeListener;
+
+    Tree tree;
+    std::unordered_map<const RS_Entity*, Entry> entries;
+    // entities without a finite pick box
+    std::unordered_set<RS_Entity*> unbounded;
+    // entities whose boxes may be changed, see updateOutdated()
+    std::unordered_set<const RS_Entity*> outdated;
+    bool allOutdated = false;
+
+    void add(RS_Entity* entity, long long order)
+    {
+        Entry entry;
+        entry.order = order;
+        entry.bounded = pickBox(*entity, entry.box);
+        if (entry.bounded) {
+            tree.insert({entry.box, entity});
+        } else {
+            unbounded.insert(entity);
+        }
+        entries[entity] = entry;
+    }
+
+    void detach(RS_Entity* entity, const Entry& entry)
+    {
+        if (entry.bounded) {
+            tree.remove(TreeValue{entry.box, entity});
+        } else {
+            unbounded.erase(entity);
+        }
+    }
+
+    // refreshes the box of an entry, the listener is notified if the entry was changed
+    void refresh(RS_Entity* entity, Entry& entry, const ChangeListener& listener)
+    {
+        BBox box;
+        bool bounded = pickBox(*entity, box);
+        if (bounded == entry.bounded && (!bounded || sameBox(box, entry.box))) {
+            return;
+        }
+        if (listener) {
+            if (entry.bounded) {
+                listener(entity,
+                         RS_Vector{entry.box.min_corner().get<0>(), entry.box.min_corner().get<1>()},
+                         RS_Vector{entry.box.max_corner().get<0>(), entry.box.max_corner().get<1>()});
+            } else {
+                listener(entity, RS_Vector{false}, RS_Vector{false});
+            }
+        }
+        detach(entity, entry);
+        entry.bounded = bounded;
+        if (bounded) {
+            entry.box = box;
+            tree.insert({box, entity});
+        } else {
+            unbounded.insert(entity);
+        }
+    }
+};
+
+LC_SpatialIndex::LC_SpatialIndex():
+    m_pImpl{std::make_unique<Impl>()}
+{}
+
+LC_SpatialIndex::~LC_SpatialIndex() = default;
+
+void LC_SpatialIndex::build(const QList<RS_Entity*>& entities)
+{
+    clear();
+    std::vector<TreeValue> values;
+    values.reserve(entities.size());
+    m_pImpl->entries.reserve(entities.size());
+    long long order = 0;
+    for (RS_Entity* entity: entities) {
+        if (entity == nullptr) {
+            continue;
+        }
+        Entry entry;
+        entry.order = order;
+        entry.bounded = pickBox(*entity, entry.box);
+        if (entry.bounded) {
+            values.emplace_back(entry.box, entity);
+        } else {
+            m_pImpl->unbounded.insert(entity);
+        }
+        m_pImpl->entries[entity] = entry;
+        order += orderStep;
+    }
+    // the packing algorithm of the range constructor gives a better tree than repeated insertion
+    m_pImpl->tree = Tree{values.cbegin(), values.cend()};
+}
+
+void LC_SpatialIndex::clear()
+{
+    m_pImpl->tree.clear();
+    m_pImpl->entries.clear();
+    m_pImpl->unbounded.clear();
+    m_pImpl->outdated.clear();
+    m_pImpl->allOutdated = false;
+}
+
+bool LC_SpatialIndex::insert(RS_Entity* entity, const RS_Entity* previous, const RS_Entity* next)
+{
+    if (entity == nullptr || contains(entity)) {
+        return false;
+    }
+    const auto& entries = m_pImpl->entries;
+    auto prevIt = (previous != nullptr) ? entries.find(previous) : entries.cend();
+    auto nextIt = (next != nullptr) ? entries.find(next) : entries.cend();
+    if ((previous != nullptr && prevIt == entries.cend()) || (next != nullptr && nextIt == entries.cend())) {
+        return false;
+    }
+
+    long long order = 0;
+    if (previous != nullptr && next != nullptr) {
+        const long long low = prevIt->second.order;
+        const long long high = nextIt->second.order;
+        if (high - low < 2) {
+            return false;
+        }
+        order = low + (high - low) / 2;
+    } else if (previous != nullptr) {
+        order = prevIt->second.order + orderStep;
+    } else if (next != nullptr) {
+        order = nextIt->second.order - orderStep;
+    }
+    m_pImpl->add(entity, order);
+    return true;
+}
+
+void LC_SpatialIndex::replace(RS_Entity* oldEntity, RS_Entity* newEntity)
+{
+    auto it = m_pImpl->entries.find(oldEntity);
+    if (it == m_pImpl->entries.end() || newEntity == nullptr) {
+        return;
+    }
+    const long long order = it->second.order;
+    m_pImpl->detach(oldEntity, it->second);
+    m_pImpl->entries.erase(it);
+    m_pImpl->outdated.erase(oldEntity);
+    m_pImpl->add(newEntity, order);
+}
+
+bool LC_SpatialIndex::remove(RS_Entity* entity)
+{
+    auto it = m_pImpl->entries.find(entity);
+    if (it == m_pImpl->entries.end()) {
+        return false;
+    }
+    m_pImpl->detach(entity, it->second);
+    m_pImpl->entries.erase(it);
+    m_pImpl->outdated.erase(entity);
+    return true;
+}
+
+bool LC_SpatialIndex::update(RS_Entity* entity, const ChangeListener& listener)
+{
+    auto it = m_pImpl->entries.find(entity);
+    if (it == m_pImpl->entries.end()) {
+        return false;
+    }
+    m_pImpl->refresh(entity, it->second, listener);
+    m_pImpl->outdated.erase(entity);
+    return true;
+}
+
+void LC_SpatialIndex::updateAll(const ChangeListener& listener)
+{
+    for (auto& [entity, entry]: m_pImpl->entries) {
+        m_pImpl->refresh(const_cast<RS_Entity*>(entity), entry, listener);
+    }
+    m_pImpl->outdated.clear();
+    m_pImpl->allOutdated = false;
+}
+
+void LC_SpatialIndex::invalidate(const RS_Entity* entity)
+{
+    if (!m_pImpl->allOutdated && contains(entity)) {
+        m_pImpl->outdated.insert(entity);
+    }
+}
+
+void LC_SpatialIndex::invalidateAll()
+{
+    m_pImpl->outdated.clear();
+    m_pImpl->allOutdated = true;
+}
+
+bool LC_SpatialIndex::isOutdated() const
+{
+    return m_pImpl->allOutdated || !m_pImpl->outdated.empty();
+}
+
+void LC_SpatialIndex::updateOutdated(const ChangeListener& listener)
+{
+    if (m_pImpl->allOutdated) {
+        updateAll(listener);
+        return;
+    }
+    std::unordered_set<const RS_Entity*> outdated;
+    outdated.swap(m_pImpl->outdated);
+    for (const RS_Entity* entity: outdated) {
+        m_pImpl->refresh(const_cast<RS_Entity*>(entity), m_pImpl->entries.at(entity), listener);
+    }
+}
+
+bool LC_SpatialIndex::contains(const RS_Entity* entity) const
+{
+    return m_pImpl->entries.count(entity) > 0;
+}
+
+size_t LC_SpatialIndex::size() const
+{
+    return m_pImpl->entries.size();
+}
+
+bool LC_SpatialIndex::isBefore(const RS_Entity* a, const RS_Entity* b) const
+{
+    auto itA = m_pImpl->entries.find(a);
+    auto itB = m_pImpl->entries.find(b);
+    if (itA == m_pImpl->entries.end() || itB == m_pImpl->entries.end()) {
+        return false;
+    }
+    return itA->second.order < itB->second.order;
+}
+
+std::vector<RS_Entity*> LC_SpatialIndex::entitiesInBox(const RS_Vector& corner1, const RS_Vector& corner2) const
+{
+    const BBox box{{std::min(corner1.x, corner2.x), std::min(corner1.y, corner2.y)},
+                   {std::max(corner1.x, corner2.x), std::max(corner1.y, corner2.y)}};
+    std::vector<TreeValue> found;
+    m_pImpl->tree.query(bgi::intersects(box), std::back_inserter(found));
+
+    std::vector<std::pair<long long, RS_Entity*>> ordered;
+    ordered.reserve(found.size() + m_pImpl->unbounded.size());
+    for (const auto& [valueBox, entity]: found) {
+        ordered.emplace_back(m_pImpl->entries.at(entity).order, entity);
+    }
+    for (RS_Entity* entity: m_pImpl->unbounded) {
+        ordered.emplace_back(m_pImpl->entries.at(entity).order, entity);
+    }
+    std::sort(ordered.begin(), ordered.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    std::vector<RS_Entity*> ret;
+    ret.reserve(ordered.size());
+    for (const auto& item: ordered) {
+        ret.push_back(item.second);
+    }
+    return ret;
+}
+
+void LC_SpatialIndex::visitNearest(const RS_Vector& point,
+                                   const std::function<bool(RS_Entity*, double)>& visitor) const
+{
+    for (RS_Entity* entity: m_pImpl->unbounded) {
+        if (!visitor(entity, 0.)) {
+            return;
+        }
+    }
+    const Tree& tree = m_pImpl->tree;
+    if (tree.empty()) {
+        return;
+    }
+    const BPoint queryPoint{point.x, point.y};
+    // the nearest query iterator is incremental: values are produced by increasing distance
+    for (auto it = tree.qbegin(bgi::nearest(queryPoint, static_cast<unsigned>(tree.size()))); it != tree.qend(); ++it) {
+        if (!visitor(it->second, bg::distance(queryPoint, it->first))) {
+            return;
+        }
+    }
+}
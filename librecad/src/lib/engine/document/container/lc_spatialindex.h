@@ -0,0 +1,136 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_SPATIALINDEX_H
+#define LC_SPATIALINDEX_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <QList>
+
+class RS_Entity;
+class RS_Vector;
+
+/**
+ * @brief The LC_SpatialIndex class
+ *        Bounding box R-tree over the direct children of an entity container.
+ *
+ *        Each entity is stored with its "pick box": the bounding box of the entity
+ *        extended by every point getDistanceToPoint() may measure to (e.g. centers
+ *        of arcs, including arcs nested in sub-containers). Hence the distance
+ *        from a point to the pick box is a lower bound of the entity distance,
+ *        which allows best-first nearest entity searches.
+ *
+ *        Entities without a finite box (construction lines, empty containers,
+ *        entities without calculated borders) are kept aside and are reported
+ *        by every query.
+ *
+ *        The index also keeps a sparse order key per entity, so query results
+ *        can be returned in the container (i.e. drawing) order.
+ *
+ *        The index never owns or dereferences removed entities; the owning
+ *        container is responsible to keep it in sync.
+ */
+class LC_SpatialIndex {
+public:
+    /**
+     * Called for entities with changed boxes, the corners of the previous box
+     * are invalid if the entity had no box.
+     */
+    using ChangeListener = std::function<void(RS_Entity* entity, const RS_Vector& oldCorner1, const RS_Vector& oldCorner2)>;
+
+    LC_SpatialIndex();
+    ~LC_SpatialIndex();
+
+    /**
+     * @brief build - (re)builds the index by bulk loading
+     * @param entities - entities in container order
+     */
+    void build(const QList<RS_Entity*>& entities);
+    void clear();
+
+    /**
+     * @brief insert - adds an entity placed between two neighbours in container order
+     * @param entity - the entity to add
+     * @param previous - the entity preceding the new one, nullptr at the front
+     * @param next - the entity following the new one, nullptr at the back
+     * @return false, if no order key is available between the neighbours. The index
+     *         must be rebuilt in that case.
+     */
+    bool insert(RS_Entity* entity, const RS_Entity* previous, const RS_Entity* next);
+    /**
+     * @brief replace - puts a new entity at the container position of an indexed one
+     */
+    void replace(RS_Entity* oldEntity, RS_Entity* newEntity);
+    bool remove(RS_Entity* entity);
+
+    /**
+     * @brief update - refreshes the box of an entity after its geometry was changed
+     * @return false, if the entity is not indexed
+     */
+    bool update(RS_Entity* entity, const ChangeListener& listener = nullptr);
+    /**
+     * @brief updateAll - refreshes boxes of all entities, only changed entries are re-inserted
+     */
+    void updateAll(const ChangeListener& listener = nullptr);
+    /**
+     * @brief invalidate - marks the box of an entity as outdated, see updateOutdated()
+     */
+    void invalidate(const RS_Entity* entity);
+    /**
+     * @brief invalidateAll - marks boxes of all entities as outdated, see updateOutdated()
+     */
+    void invalidateAll();
+    bool isOutdated() const;
+    /**
+     * @brief updateOutdated - refreshes the boxes marked as outdated only
+     */
+    void updateOutdated(const ChangeListener& listener = nullptr);
+
+    bool contains(const RS_Entity* entity) const;
+    size_t size() const;
+    /**
+     * @brief isBefore - whether entity a is placed before entity b in container order
+     */
+    bool isBefore(const RS_Entity* a, const RS_Entity* b) const;
+
+    /**
+     * @brief entitiesInBox - entities whose pick boxes intersect the box defined by two corners
+     * @return entities in container order
+     */
+    std::vector<RS_Entity*> entitiesInBox(const RS_Vector& corner1, const RS_Vector& corner2) const;
+
+    /**
+     * @brief visitNearest - visits entities by increasing distance of their pick boxes to a point.
+     *        Entities without a box are visited first with the box distance of zero.
+     * @param point - the query point
+     * @param visitor - called with the entity and its box distance; return false to stop the search
+     */
+    void visitNearest(const RS_Vector& point, const std::function<bool(RS_Entity*, double)>& visitor) const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_pImpl;
+};
+
+#endif // LC_SPATIALINDEX_H
@@ -25,25 +25,33 @@
 **
 **********************************************************************/
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <iostream>
 #include <set>
+#include <unordered_map>
 
 #include <QList>
 #include <QObject>
 
-#include "lc_containertraverser.h"
+#include "lc_entitygeometry.h"
+#include "lc_intersectioncache.h"
 #include "lc_looputils.h"
+#include "lc_selectionset.h"
+#include "lc_spatialindex.h"
 #include "qg_dialogfactory.h"
 #include "rs_constructionline.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
 #include "rs_dimension.h"
+#include "rs_document.h"
 #include "rs_ellipse.h"
 #include "rs_entitycontainer.h"
 #include "rs_information.h"
 #include "rs_insert.h"
 #include "rs_layer.h"
+#include "rs_layerlist.h"
 #include "rs_line.h"
 #include "rs_painter.h"
 #include "rs_solid.h"
@@ -56,6 +64,9 @@ namespace {
 // the tolerance used to check topology of contours in hatching
     constexpr double contourTolerance = 1e-8;
 
+// documents with fewer entities are searched linearly, without a spatial index
+    constexpr int spatialIndexMinSize = 256;
+
 // For validate hatch contours, whether an entity in the contour is a closed
 // loop itself
     bool isClosedLoop(RS_Entity &entity) {
@@ -77,6 +88,101 @@ namespace {
         entity.getNearestEndpoint(point, &distance);
         return distance;
     }
+
+// Compact polylines intersect other entities without creating their segments, see RS_Polyline::getIntersection()
+    bool isCompactPolyline(const RS_Entity& entity) {
+        return entity.rtti() == RS2::EntityPolyline && static_cast<const RS_EntityContainer&>(entity).hasDeferredEntities();
+    }
+
+// Visits the entity or its sub-entities as iterated with RS2::ResolveAllButTextImage, with the parent
+// of each. Deferred entities of containers are visited as temporary copies, which have no parent.
+    template <typename Visitor>
+    void visitResolvedAllButTextImage(RS_Entity* entity, const RS_EntityContainer* parent, bool temporary,
+                                      Visitor&& visitor) {
+        if (entity->isContainer() && entity->rtti() != RS2::EntityText && entity->rtti() != RS2::EntityMText
+            && !isCompactPolyline(*entity)) {
+            auto* container = static_cast<const RS_EntityContainer*>(entity);
+            const bool temporaryChildren = temporary || container->hasDeferredEntities();
+            container->visitEntities([container, temporaryChildren, &visitor](RS_Entity* child) {
+                visitResolvedAllButTextImage(child, container, temporaryChildren, visitor);
+                return true;
+            });
+        } else {
+            visitor(entity, parent, temporary);
+        }
+    }
+
+// The nearest entity as found with RS2::ResolveAllButTextImage, without creating deferred entities
+    struct ResolvedNearest {
+        // the entity reported by the container, which may be a container with deferred entities
+        RS_Entity* reported = nullptr;
+        // the nearest entity, either the reported one or the copy
+        RS_Entity* entity = nullptr;
+        // copy of the nearest temporary entity of the reported container and its position in the visit
+        std::unique_ptr<RS_Entity> copy;
+        size_t copyIndex = 0;
+    };
+
+    ResolvedNearest findResolvedNearest(const RS_EntityContainer& container, const RS_Vector& coord) {
+        ResolvedNearest nearest;
+        nearest.reported = container.getNearestEntity(coord, nullptr, RS2::ResolveAllButTextImage);
+        nearest.entity = nearest.reported;
+        RS_Entity* reported = nearest.reported;
+        if (reported == nullptr || !reported->isContainer() || isCompactPolyline(*reported)
+            || !static_cast<const RS_EntityContainer*>(reported)->hasDeferredEntities()) {
+            return nearest;
+        }
+        double minDist = RS_MAXDOUBLE;
+        size_t index = 0;
+        visitResolvedAllButTextImage(reported, reported->getParent(), false,
+                                     [&](RS_Entity* e, const RS_EntityContainer*, bool) {
+            if (e->isVisible() && e->rtti() != RS2::EntityImage) {
+                const double curDist = e->getDistanceToPoint(coord, nullptr, RS2::ResolveNone);
+                if (curDist < minDist) {
+                    minDist = curDist;
+                    nearest.copy.reset(e->clone());
+                    nearest.copyIndex = index;
+                }
+            }
+            index++;
+        });
+        nearest.entity = nearest.copy.get();
+        return nearest;
+    }
+
+// Whether the entity (or a sub-entity of a container) intersects the edges of the window
+    bool crossesWindow(RS_Entity& entity, const RS_Vector& v1, const RS_Vector& v2, const RS_EntityContainer& edges) {
+        auto crosses = [&v1, &v2, &edges](RS_Entity* e) {
+            if (e->rtti() == RS2::EntitySolid) {
+                return static_cast<RS_Solid*>(e)->isInCrossWindow(v1, v2);
+            }
+            for (RS_Entity* line: edges) {
+                if (RS_Information::getIntersection(e, line, true).hasValid()) {
+                    return true;
+                }
+            }
+            return false;
+        };
+        if (!entity.isContainer() || isCompactPolyline(entity)) {
+            return crosses(&entity);
+        }
+        // deferred entities of inserts are tested as temporary copies, without creating them
+        return !static_cast<const RS_EntityContainer&>(entity).visitEntities([&v1, &v2, &edges](RS_Entity* child) {
+            return !crossesWindow(*child, v1, v2, edges);
+        });
+    }
+
+// Entities on construction layers are drawn infinite, so they may intersect beyond their borders
+    bool hasConstructionLayers(const RS_EntityContainer& container) {
+        RS_Document* document = container.getDocument();
+        RS_LayerList* layers = (document != nullptr) ? document->getLayerList() : nullptr;
+        if (layers == nullptr) {
+            return true;
+        }
+        return std::any_of(layers->begin(), layers->end(), [](const RS_Layer* layer) {
+            return layer->isConstruction();
+        });
+    }
 }
 
 /**
@@ -103,9 +209,10 @@ RS_EntityContainer::RS_EntityContainer(const RS_EntityContainer& other):
     , m_entities{other.m_entities}
     , m_autoUpdateBorders{other.m_autoUpdateBorders}
     , entIdx{other.entIdx}
-    , autoDelete{other.autoDelete}{
+    , autoDelete{other.autoDelete}
+    , m_entitiesDeferred{other.m_entitiesDeferred}{
     if (autoDelete) { // fixme - sand - check this logic, looks suspicious!
-        for(auto it = begin(); it != end(); ++it) {
+        for(auto it = m_entities.begin(); it != m_entities.end(); ++it) {
             if ((*it)->isContainer()) {
                 *it = (*it)->clone();
             }
@@ -121,8 +228,9 @@ RS_EntityContainer::RS_EntityContainer(const RS_EntityContainer& other, bool cop
     autoDelete = other.autoDelete;
     if (copyChildren) {
         m_entities = other.m_entities;
+        m_entitiesDeferred = other.m_entitiesDeferred;
         if (autoDelete) {  // fixme - sand - check this logic, looks suspicious!
-            for(auto it = begin(); it != end(); ++it) {
+            for(auto it = m_entities.begin(); it != m_entities.end(); ++it) {
                 if ((*it)->isContainer()) {
                     *it = (*it)->clone();
                 }
@@ -137,11 +245,14 @@ RS_EntityContainer& RS_EntityContainer::operator = (const RS_EntityContainer& ot
     this->RS_Entity::operator = (other);
     subContainer=other.subContainer;
     m_entities = other.m_entities;
+    resetSpatialIndex();
+    positionsChanged(0);
     m_autoUpdateBorders = other.m_autoUpdateBorders;
     entIdx = other.entIdx;
     autoDelete = other.autoDelete;
+    m_entitiesDeferred = other.m_entitiesDeferred;
     if (autoDelete) {
-        for(auto it = begin(); it != end(); ++it) {
+        for(auto it = m_entities.begin(); it != m_entities.end(); ++it) {
             if ((*it)->isContainer()) {
                 *it = (*it)->clone();
             }
@@ -156,16 +267,24 @@ RS_EntityContainer::RS_EntityContainer(RS_EntityContainer&& other):
     , m_entities{std::move(other.m_entities)}
     , m_autoUpdateBorders{other.m_autoUpdateBorders}
     , entIdx{other.entIdx}
-    , autoDelete{other.autoDelete}{
+    , autoDelete{other.autoDelete}
+    , m_entitiesDeferred{other.m_entitiesDeferred}{
+    other.resetSpatialIndex();
+    other.positionsChanged(0);
 }
 
 RS_EntityContainer& RS_EntityContainer::operator = (RS_EntityContainer&& other){
     this->RS_Entity::operator = (other);
     subContainer=other.subContainer;
     m_entities = std::move(other.m_entities);
+    resetSpatialIndex();
+    other.resetSpatialIndex();
+    positionsChanged(0);
+    other.positionsChanged(0);
     m_autoUpdateBorders = other.m_autoUpdateBorders;
     entIdx = other.entIdx;
     autoDelete = other.autoDelete;
+    m_entitiesDeferred = other.m_entitiesDeferred;
     return *this;
 }
 
@@ -185,7 +304,9 @@ RS_Entity *RS_EntityContainer::clone() const {
     RS_DEBUG->print("RS_EntityContainer::clone: ori autoDel: %d",autoDelete);
 
     auto *ec = new RS_EntityContainer(getParent(), isOwner());
-    if (isOwner()) {
+    if (isOwner() && m_entitiesDeferred) {
+        ec->adoptTemporaryEntities(*this);
+    } else if (isOwner()) {
         for (const RS_Entity *entity: std::as_const(m_entities)) {
             if (entity != nullptr) {
                 ec->m_entities.push_back(entity->clone());
@@ -201,11 +322,29 @@ RS_Entity *RS_EntityContainer::clone() const {
     return ec;
 }
 
+std::size_t RS_EntityContainer::getMemoryUsage() const {
+    return sizeof(RS_EntityContainer) + getEntitiesMemoryUsage();
+}
+
+std::size_t RS_EntityContainer::getEntitiesMemoryUsage() const {
+    if (!isOwner()) {
+        return m_entities.size() * sizeof(RS_Entity*);
+    }
+    std::size_t bytes = 0;
+    for (const RS_Entity* entity: std::as_const(m_entities)) {
+        bytes += sizeof(RS_Entity*) + entity->getMemoryUsage();
+    }
+    return bytes;
+}
+
 RS_Entity *RS_EntityContainer::cloneProxy() const {
     RS_DEBUG->print("RS_EntityContainer::cloneproxy: ori autoDel: %d", autoDelete);
 
     auto *ec = new RS_EntityContainer(getParent(), isOwner());
-    if (isOwner()) {
+    if (isOwner() && m_entitiesDeferred) {
+        // copies of deferred entities are as good as proxies of them
+        ec->adoptTemporaryEntities(*this);
+    } else if (isOwner()) {
         for (const RS_Entity *entity: std::as_const(m_entities)) {
             if (entity != nullptr) {
                 ec->m_entities.push_back(entity->cloneProxy());
@@ -231,15 +370,17 @@ void RS_EntityContainer::detach() {
     RS_DEBUG->print("RS_EntityContainer::detach: autoDel: %d",(int) autoDel);
     setOwner(false);
 
-    // make deep copies of all entities:
-    for(RS_Entity* e: *this) {
+    // make deep copies of all entities (deferred ones are created by the copy itself):
+    for(RS_Entity* e: std::as_const(m_entities)) {
         if (!e->getFlag(RS2::FlagTemp)) {
             tmp.append(e->clone());
         }
     }
 
     // clear shared pointers:
+    bool deferred = m_entitiesDeferred;
     clear();
+    m_entitiesDeferred = deferred;
     setOwner(autoDel);
 
     // point to new deep copies:
@@ -253,7 +394,7 @@ void RS_EntityContainer::reparent(RS_EntityContainer *parent) {
     RS_Entity::reparent(parent);
 
     // All sub-entities:
-    for (RS_Entity* e: *this) {
+    for (RS_Entity* e: std::as_const(m_entities)) {
         e->reparent(parent);
     }
 }
@@ -296,8 +437,8 @@ double RS_EntityContainer::getLength() const {
 bool RS_EntityContainer::setSelected(bool select) {
     // This entity's select:
     if (RS_Entity::setSelected(select)) {
-        // All sub-entity's select:
-        for (RS_Entity* e: *this) {
+        // All sub-entity's select (deferred entities take the state of the container on creation):
+        for (RS_Entity* e: std::as_const(m_entities)) {
             if (e->isVisible()) {
                 e->setSelected(select);
             }
@@ -316,7 +457,7 @@ bool RS_EntityContainer::toggleSelected() {
 }
 
 void RS_EntityContainer::setHighlighted(bool on){
-    for (RS_Entity* e: *this) {
+    for (RS_Entity* e: std::as_const(m_entities)) {
         e->setHighlighted(on);
     }
     RS_Entity::setHighlighted(on);
@@ -332,59 +473,9 @@ void RS_EntityContainer::setHighlighted(bool on){
 void RS_EntityContainer::selectWindow(
     enum RS2::EntityType typeToSelect, RS_Vector v1, RS_Vector v2,
     bool select, bool cross){
-    for (RS_Entity* e: *this) {
-        bool included = false;
-        if (e->isVisible()) {
-            if (e->isInWindow(v1, v2)) {
-                //e->setSelected(select);
-                included = true;
-            } else if (cross) {
-                RS_EntityContainer l;
-                l.addRectangle(v1, v2);
-                RS_VectorSolutions sol;
-
-                if (e->isContainer()) {
-                    auto *ec = (RS_EntityContainer *) e;
-                    lc::LC_ContainerTraverser traverser{*ec, RS2::ResolveAll};
-                    for (RS_Entity *se = traverser.first(); se != nullptr && !included; se = traverser.next()){
-                        if (se->rtti() == RS2::EntitySolid) {
-                            included = static_cast<RS_Solid *>(se)->isInCrossWindow(v1, v2);
-                        } else {
-                            for (RS_Entity* line: l) {
-                                sol = RS_Information::getIntersection(se, line, true);
-                                if (sol.hasValid()) {
-                                    included = true;
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                } else if (e->rtti() == RS2::EntitySolid) {
-                    included = static_cast<RS_Solid *>(e)->isInCrossWindow(v1, v2);
-                } else {
-                    for (RS_Entity* line: l) {
-                        sol = RS_Information::getIntersection(e, line, true);
-                        if (sol.hasValid()) {
-                            included = true;
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-
-        if (included) {
-            if (typeToSelect != RS2::EntityType::EntityUnknown) {
-                if (typeToSelect == e->rtti()) {
-                    e->setSelected(select);
-                } else {
-                    //Do not select
-                }
-            } else {
-                e->setSelected(select);
-            }
-        }
-    }
+    selectInWindow([typeToSelect](const RS_Entity* e) {
+        return typeToSelect == RS2::EntityType::EntityUnknown || typeToSelect == e->rtti();
+    }, v1, v2, select, cross);
 }
 /**
  * Selects all entities within the given area with given types.
@@ -394,61 +485,35 @@ void RS_EntityContainer::selectWindow(
 void RS_EntityContainer::selectWindow(
     const QList<RS2::EntityType> &typesToSelect, RS_Vector v1, RS_Vector v2,
     bool select, bool cross){
-    for (RS_Entity* e: *this) {
-        if (!typesToSelect.contains(e->rtti())){
+    selectInWindow([&typesToSelect](const RS_Entity* e) {
+        return typesToSelect.contains(e->rtti());
+    }, v1, v2, select, cross);
+}
+
+void RS_EntityContainer::selectInWindow(const std::function<bool(const RS_Entity*)>& typeFilter,
+                                        const RS_Vector& v1, const RS_Vector& v2, bool select, bool cross) {
+    std::vector<RS_Entity*> candidates;
+    if (cross && hasConstructionLayers(*this)) {
+        // entities on construction layers cross the window as infinite lines
+        prepareEntities();
+        candidates.assign(m_entities.cbegin(), m_entities.cend());
+    } else {
+        // entities within the window or crossing it overlap the window with their borders
+        const RS_Vector margin{RS_TOLERANCE, RS_TOLERANCE};
+        candidates = getCandidatesInBox(RS_Vector::minimum(v1, v2) - margin, RS_Vector::maximum(v1, v2) + margin);
+    }
+    RS_EntityContainer edges;
+    if (cross) {
+        edges.addRectangle(v1, v2);
+    }
+
+    for (RS_Entity* e: candidates) {
+        if (!typeFilter(e) || !e->isVisible()) {
             continue;
         }
-        bool included = false;
-        if (e->isVisible()) {
-            if (e->isInWindow(v1, v2)) {
-                //e->setSelected(select);
-                included = true;
-            } else if (cross) {
-                RS_EntityContainer l;
-                l.addRectangle(v1, v2);
-                RS_VectorSolutions sol;
-
-                if (e->isContainer()) {
-                    auto *ec = (RS_EntityContainer *) e;
-                    lc::LC_ContainerTraverser traverser{*ec, RS2::ResolveAll};
-                    for (RS_Entity* se = traverser.first(); se != nullptr && !included; se = traverser.next()) {
-                        if (se->rtti() == RS2::EntitySolid) {
-                            included = dynamic_cast<RS_Solid *>(se)->isInCrossWindow(v1, v2);
-                        } else {
-                            for (auto line: l) {
-                                sol = RS_Information::getIntersection(
-                                    se, line, true);
-                                if (sol.hasValid()) {
-                                    included = true;
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                } else if (e->rtti() == RS2::EntitySolid) {
-                    included = dynamic_cast<RS_Solid *>(e)->isInCrossWindow(v1, v2);
-                } else {
-                    for (auto line: l) {
-                        sol = RS_Information::getIntersection(e, line, true);
-                        if (sol.hasValid()) {
-                            included = true;
-                            break;
-                        }
-                    }
-                }
-            }
-        }
-
-        if (included) {
-          /*  if (typeToSelect != RS2::EntityType::EntityUnknown) {
-                if (typeToSelect == e->rtti()) {
-                    e->setSelected(select);
-                } else {
-                    //Do not select
-                }
-            } else {*/
-                e->setSelected(select);
-//            }
+        // only entities whose boxes straddle the window edges need the exact crossing test
+        if (e->isInWindow(v1, v2) || (cross && crossesWindow(*e, v1, v2, edges))) {
+            e->setSelected(select);
         }
     }
 }
@@ -475,8 +540,10 @@ void RS_EntityContainer::addEntity(RS_Entity *entity) {
     }
     if (entity->rtti() == RS2::EntityImage || entity->rtti() == RS2::EntityHatch) {
         m_entities.prepend(entity);
+        entityAdded(0);
     } else {
         m_entities.append(entity);
+        entityAdded(m_entities.size() - 1);
     }
     adjustBordersIfNeeded(entity);
 }
@@ -490,6 +557,7 @@ void RS_EntityContainer::appendEntity(RS_Entity *entity) {
         return;
     }
     m_entities.append(entity);
+    entityAdded(m_entities.size() - 1);
     adjustBordersIfNeeded(entity);
 }
 
@@ -502,6 +570,7 @@ void RS_EntityContainer::prependEntity(RS_Entity *entity) {
         return;
     }
     m_entities.prepend(entity);
+    entityAdded(0);
     adjustBordersIfNeeded(entity);
 }
 
@@ -540,6 +609,10 @@ void RS_EntityContainer::moveEntity(int index, QList<RS_Entity *> &entList) {
     for (auto e: entList) {
         m_entities.insert(ci++, e);
     }
+    // the drawing order was changed
+    childAreaChanged(RS_Vector{false}, RS_Vector{false});
+    resetSpatialIndex();
+    positionsChanged(0);
 }
 
 void RS_EntityContainer::adjustBordersIfNeeded(RS_Entity* entity) {
@@ -558,25 +631,174 @@ void RS_EntityContainer::insertEntity(int index, RS_Entity *entity) {
     }
 
     m_entities.insert(index, entity);
+    entityAdded(index);
     adjustBordersIfNeeded(entity);
 }
 /**
  * Removes an entity from this container and updates the borders of
  * this entity-container if autoUpdateBorders is true.
+ * The entity is found by the position map, but the list is still shifted, so a
+ * removal is linear in the size of the container. Callers removing several entities
+ * use removeEntities() or takeEntities(), which remove all of them in a single pass.
  */
 bool RS_EntityContainer::removeEntity(RS_Entity *entity) {
     //RLZ TODO: in Q3PtrList if 'entity' is nullptr remove the current item-> at.(entIdx)
     //    and sets 'entIdx' in next() or last() if 'entity' is the last item in the list.
     //    in LibreCAD is never called with nullptr
-    bool ret = m_entities.removeOne(entity);
-
-    if (autoDelete && ret) {
-        delete entity;
+    const int position = positionOf(entity);
+    bool ret = position >= 0;
+    if (ret) {
+        m_entities.removeAt(position);
+        entityRemoved(entity);
+        bool bordersAffected = isOnBorders(entity);
+        if (autoDelete) {
+            delete entity;
+        }
+        if (bordersAffected) {
+            updateBordersAfterRemoval();
+        }
     }
-    calculateBordersIfNeeded();
     return ret;
 }
 
+int RS_EntityContainer::removeEntities(const std::vector<RS_Entity*>& entities) {
+    std::vector<int> positions = takeEntities(entities);
+    int removed = 0;
+    for (size_t i = 0; i < entities.size(); i++) {
+        if (positions[i] >= 0) {
+            removed++;
+            if (autoDelete) {
+                delete entities[i];
+            }
+        }
+    }
+    return removed;
+}
+
+std::vector<int> RS_EntityContainer::takeEntities(const std::vector<RS_Entity*>& entities) {
+    std::vector<int> positions(entities.size(), -1);
+    // deferred entities are not created yet, so none of the given ones is among them
+    if (entities.empty() || m_entitiesDeferred) {
+        return positions;
+    }
+    std::unordered_map<const RS_Entity*, size_t> toRemove;
+    for (size_t i = 0; i < entities.size(); i++) {
+        toRemove.emplace(entities[i], i);
+    }
+    std::vector<RS_Entity*> removed;
+    removed.reserve(toRemove.size());
+    // keeps the order of remaining entities, only the first occurrence is removed, as by removeEntity()
+    int position = 0;
+    auto last = std::remove_if(m_entities.begin(), m_entities.end(), [&](RS_Entity* e) {
+        auto it = toRemove.find(e);
+        const bool found = it != toRemove.end();
+        if (found) {
+            positions[it->second] = position;
+            removed.push_back(e);
+            toRemove.erase(it);
+        }
+        position++;
+        return found;
+    });
+    if (removed.empty()) {
+        return positions;
+    }
+    m_entities.erase(last, m_entities.end());
+
+    bool bordersAffected = false;
+    for (RS_Entity* e: removed) {
+        entityRemoved(e);
+        bordersAffected = bordersAffected || isOnBorders(e);
+    }
+    if (bordersAffected) {
+        updateBordersAfterRemoval();
+    }
+    return positions;
+}
+
+void RS_EntityContainer::insertEntities(std::vector<std::pair<int, RS_Entity*>> entities) {
+    if (entities.empty()) {
+        return;
+    }
+    // positions refer to the created entities
+    prepareEntities();
+    std::stable_sort(entities.begin(), entities.end(), [](const auto& e1, const auto& e2) {
+        return e1.first < e2.first;
+    });
+    // merges the entities into the list at once, instead of moving the list for each of them
+    QList<RS_Entity*> merged;
+    merged.reserve(m_entities.size() + static_cast<int>(entities.size()));
+    std::vector<int> inserted;
+    inserted.reserve(entities.size());
+    auto remaining = m_entities.cbegin();
+    for (const auto& [position, entity]: entities) {
+        while (merged.size() < position && remaining != m_entities.cend()) {
+            merged.append(*remaining++);
+        }
+        inserted.push_back(static_cast<int>(merged.size()));
+        merged.append(entity);
+    }
+    while (remaining != m_entities.cend()) {
+        merged.append(*remaining++);
+    }
+    m_entities = std::move(merged);
+    positionsChanged(inserted.front());
+
+    // in ascending order the previous entity is known to the spatial index, the next
+    // known one is the next entity which was in the list already
+    size_t next = 0;
+    for (int index: inserted) {
+        RS_Entity* entity = m_entities.at(index);
+        childChanged(entity);
+        childAdded(entity);
+        if (m_spatialIndex != nullptr) {
+            while (next < inserted.size() && inserted[next] <= index) {
+                next++;
+            }
+            int nextIndex = index + 1;
+            for (size_t k = next; k < inserted.size() && inserted[k] == nextIndex; k++) {
+                nextIndex++;
+            }
+            RS_Entity* previous = (index > 0) ? m_entities.at(index - 1) : nullptr;
+            RS_Entity* nextEntity = (nextIndex < static_cast<int>(m_entities.size())) ? m_entities.at(nextIndex) : nullptr;
+            if (!m_spatialIndex->insert(entity, previous, nextEntity)) {
+                // no room for the order key, rebuild on the next query
+                resetSpatialIndex();
+            }
+        }
+        adjustBordersIfNeeded(entity);
+    }
+}
+
+/**
+ * Borders of the container are defined by entities touching them, removal of
+ * an entity strictly inside of the borders leaves them unchanged.
+ */
+bool RS_EntityContainer::isOnBorders(const RS_Entity* entity) const {
+    const RS_Vector& entityMin = entity->getMin();
+    const RS_Vector& entityMax = entity->getMax();
+    return !(entityMin.x > minV.x && entityMin.y > minV.y && entityMax.x < maxV.x && entityMax.y < maxV.y);
+}
+
+void RS_EntityContainer::updateBordersAfterRemoval() {
+    if (!m_autoUpdateBorders) {
+        return;
+    }
+    if (m_bordersUpdateDeferred) {
+        // borders which are too large are still valid bounds, shrink them later
+        m_bordersOutdated = true;
+        return;
+    }
+    calculateBorders();
+}
+
+void RS_EntityContainer::setBordersUpdateDeferred(bool deferred) {
+    m_bordersUpdateDeferred = deferred;
+    if (!deferred && m_bordersOutdated) {
+        updateBordersAfterRemoval();
+    }
+}
+
 /**
  * Erases all entities in this container and resets the borders..
  */
@@ -589,11 +811,51 @@ void RS_EntityContainer::clear() {
     } else {
         m_entities.clear();
     }
+    m_entitiesDeferred = false;
+    childAreaChanged(RS_Vector{false}, RS_Vector{false});
+    resetSpatialIndex();
+    positionsChanged(0);
+    childrenCleared();
     resetBorders();
 }
 
 unsigned int RS_EntityContainer::count() const {
-    return m_entities.size();
+    return m_entitiesDeferred ? countDeferredEntities() : m_entities.size();
+}
+
+unsigned RS_EntityContainer::countDeferredEntities() const {
+    unsigned count = 0;
+    createTemporaryEntities([&count](std::unique_ptr<RS_Entity>) {
+        count++;
+        return true;
+    });
+    return count;
+}
+
+bool RS_EntityContainer::visitEntities(const std::function<bool(RS_Entity*)>& visitor) const {
+    if (m_entitiesDeferred) {
+        return createTemporaryEntities([&visitor](std::unique_ptr<RS_Entity> entity) {
+            return visitor(entity.get());
+        });
+    }
+    for (RS_Entity* entity: m_entities) {
+        if (!visitor(entity)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RS_EntityContainer::createTemporaryEntities([[maybe_unused]] const std::function<bool(std::unique_ptr<RS_Entity>)>& consumer) const {
+    return true;
+}
+
+void RS_EntityContainer::adoptTemporaryEntities(const RS_EntityContainer& source) {
+    source.createTemporaryEntities([this](std::unique_ptr<RS_Entity> entity) {
+        entity->setParent(this);
+        m_entities.push_back(entity.release());
+        return true;
+    });
 }
 
 /**
@@ -614,7 +876,7 @@ unsigned RS_EntityContainer::countSelected(bool deep, QList<RS2::EntityType> con
     unsigned count = 0;
     std::set<RS2::EntityType> type{types.cbegin(), types.cend()};
 
-    for (RS_Entity *entity: *this) {
+    for (RS_Entity *entity: getSelectionCandidates()) {
         if (entity->isSelected()) {
             if (!types.size() || type.count(entity->rtti())) {
                 count++;
@@ -629,7 +891,7 @@ unsigned RS_EntityContainer::countSelected(bool deep, QList<RS2::EntityType> con
 
 void RS_EntityContainer::collectSelected(std::vector<RS_Entity*> &collect, bool deep, QList<RS2::EntityType> const &types) {    
     std::set<RS2::EntityType> type{types.cbegin(), types.cend()};
-    for (RS_Entity *e: std::as_const(m_entities)) {
+    for (RS_Entity *e: getSelectionCandidates()) {
         if (e != nullptr) {
             if (e->isSelected()) {
                 if (types.empty() || type.count(e->rtti())) {
@@ -643,11 +905,10 @@ void RS_EntityContainer::collectSelected(std::vector<RS_Entity*> &collect, bool
         }
     }
 }
-// fixme - sand - avoid usage in actions as it enumerates all entities. Rework or rely on entities list!!!!
 RS_EntityContainer::LC_SelectionInfo RS_EntityContainer::getSelectionInfo(/*bool deep, */const QList<RS2::EntityType> &types) {
     LC_SelectionInfo result;
     std::set<RS2::EntityType> type{types.cbegin(), types.cend()};
-    for (RS_Entity *e: *this) {
+    for (RS_Entity *e: getSelectionCandidates()) {
         if (e != nullptr) {
             if (e->isSelected()) {
                 if (types.empty() || type.count(e->rtti())) {
@@ -664,13 +925,12 @@ RS_EntityContainer::LC_SelectionInfo RS_EntityContainer::getSelectionInfo(/*bool
     return result;
 }
 
-// fixme - sand - avoid usage in actions as it enumerates all entities. Rework or rely on entities list!!!!
 /**
  * Counts the selected entities in this container.
  */
 double RS_EntityContainer::totalSelectedLength() {
     double ret(0.0);
-    for (RS_Entity *e: *this) {
+    for (RS_Entity *e: getSelectionCandidates()) {
         if (e->isVisible() && e->isSelected()) {
             double l = e->getLength();
             if (l >= 0.) {
@@ -691,7 +951,8 @@ void RS_EntityContainer::adjustBorders(RS_Entity *entity) {
     if (entity) {
         // make sure a container is not empty (otherwise the border
         //   would get extended to 0/0):
-        if (!entity->isContainer() || entity->count() > 0) {
+        // deferred entities are not counted, yet the container is not empty
+        if (!entity->isContainer() || static_cast<RS_EntityContainer*>(entity)->hasDeferredEntities() || entity->count() > 0) {
             minV = RS_Vector::minimum(entity->getMin(), minV);
             maxV = RS_Vector::maximum(entity->getMax(), maxV);
         }
@@ -711,12 +972,16 @@ void RS_EntityContainer::calculateBorders() {
     RS_DEBUG->print("RS_EntityContainer::calculateBorders");
 
     resetBorders();
+    m_bordersOutdated = false;
     for (RS_Entity *e: *this) {
         //        RS_DEBUG->print("RS_EntityContainer::calculateBorders: "
         //                        "isVisible: %d", (int)e->isVisible());
 
         if (e != nullptr && e->isVisible()) {
+            const RS_Vector oldMin = e->getMin();
+            const RS_Vector oldMax = e->getMax();
             e->calculateBorders();
+            invalidateSpatialIndex(e, oldMin, oldMax);
             adjustBorders(e);
         }
     }
@@ -751,8 +1016,15 @@ void RS_EntityContainer::calculateBorders() {
  */
 void RS_EntityContainer::forcedCalculateBorders() {
     //RS_DEBUG->print("RS_EntityContainer::calculateBorders");
+    if (m_entitiesDeferred) {
+        // borders of entities which are not created yet are known to the container only
+        calculateBorders();
+        return;
+    }
     resetBorders();
     for (RS_Entity* e : *this) {
+        const RS_Vector oldMin = e->getMin();
+        const RS_Vector oldMax = e->getMax();
         if (e->isContainer()) {
             auto container = static_cast<RS_EntityContainer*>(e);
             container->forcedCalculateBorders();
@@ -760,6 +1032,7 @@ void RS_EntityContainer::forcedCalculateBorders() {
         else {
             e->calculateBorders();
         }
+        invalidateSpatialIndex(e, oldMin, oldMax);
         adjustBorders(e);
     }
 
@@ -791,6 +1064,10 @@ void RS_EntityContainer::forcedCalculateBorders() {
  */
 int RS_EntityContainer::updateDimensions(bool autoText) {
     RS_DEBUG->print("RS_EntityContainer::updateDimensions()");
+    if (m_entitiesDeferred) {
+        RS_EntityContainer* source = getDeferredEntitiesSource();
+        return source != nullptr ? source->updateDimensions(autoText) : 0;
+    }
     int updatedDimsCount = 0;
 
     for (RS_Entity *e: *this) {
@@ -800,17 +1077,23 @@ int RS_EntityContainer::updateDimensions(bool autoText) {
         if (e->rtti() == RS2::EntityDimLeader) {
             updatedDimsCount ++;
             e->update();
+            invalidateSpatialIndex(e);
         }
         if (RS_Information::isDimension(e->rtti())) {
             auto dimension = static_cast<RS_Dimension*>(e);
             // update and reposition label:
             // dimension->updateDim(autoText);
             dimension->update();
+            invalidateSpatialIndex(e);
             updatedDimsCount ++;
         }
         else if (e->isContainer()) {
             auto container = static_cast<RS_EntityContainer*>(e);
-            updatedDimsCount += container->updateDimensions(autoText);
+            const int updated = container->updateDimensions(autoText);
+            if (updated > 0) {
+                updatedDimsCount += updated;
+                invalidateSpatialIndex(e);
+            }
         }
     }
 
@@ -820,22 +1103,32 @@ int RS_EntityContainer::updateDimensions(bool autoText) {
 
 int RS_EntityContainer::updateVisibleDimensions(bool autoText) {
     RS_DEBUG->print("RS_EntityContainer::updateVisibleDimensions()");
+    if (m_entitiesDeferred) {
+        RS_EntityContainer* source = getDeferredEntitiesSource();
+        return source != nullptr ? source->updateVisibleDimensions(autoText) : 0;
+    }
     int updatedDimsCount = 0;
     for (RS_Entity *e: *this) {
         if (e->isVisible()) {
             if (e->rtti() == RS2::EntityDimLeader) {
                 e->update();
+                invalidateSpatialIndex(e);
                 updatedDimsCount ++;
             }
             else if (RS_Information::isDimension(e->rtti())) {
                 auto dimension = static_cast<RS_Dimension*>(e);
                 // update and reposition label:
                 dimension->updateDim(autoText);
+                invalidateSpatialIndex(e);
                 updatedDimsCount ++;
             }
             else if (e->isContainer()) {
                 auto container = static_cast<RS_EntityContainer*>(e);
-                updatedDimsCount += container->updateVisibleDimensions(autoText);
+                const int updated = container->updateVisibleDimensions(autoText);
+                if (updated > 0) {
+                    updatedDimsCount += updated;
+                    invalidateSpatialIndex(e);
+                }
             }
         }
     }
@@ -850,11 +1143,16 @@ int RS_EntityContainer::updateVisibleDimensions(bool autoText) {
 void RS_EntityContainer::updateInserts() {
     std::string idTypeId = std::to_string(getId()) + "/" + std::to_string(rtti());
     RS_DEBUG->print("RS_EntityContainer::updateInserts() ID/type: %s", idTypeId.c_str());
+    if (m_entitiesDeferred) {
+        // deferred entities are created from the current blocks
+        return;
+    }
 
     for (RS_Entity *e: std::as_const(*this)) {
         //// Only update our own inserts and not inserts of inserts
         if (e != nullptr && e->getId() != 0 && e->rtti() == RS2::EntityInsert  /*&& e->getParent()==this*/) {
             static_cast<RS_Insert*>(e)->update();
+            invalidateSpatialIndex(e);
 
             RS_DEBUG->print("RS_EntityContainer::updateInserts: updated ID/type: %s", idTypeId.c_str());
         } else if (e != nullptr && e->isContainer()) {
@@ -865,6 +1163,7 @@ void RS_EntityContainer::updateInserts() {
                 RS_DEBUG->print("RS_EntityContainer::updateInserts: update container ID/type: %s", idTypeId.c_str());
 
                 static_cast<RS_EntityContainer*>(e)->updateInserts();
+                invalidateSpatialIndex(e);
             }
         } else {
             RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_EntityContainer::updateInserts: skip entity ID/type: %s",
@@ -900,12 +1199,21 @@ void RS_EntityContainer::renameInserts(const QString &oldName,const QString &new
  */
 void RS_EntityContainer::updateSplines() {
     RS_DEBUG->print("RS_EntityContainer::updateSplines()");
+    if (m_entitiesDeferred) {
+        RS_EntityContainer* source = getDeferredEntitiesSource();
+        if (source != nullptr) {
+            source->updateSplines();
+        }
+        return;
+    }
     for (RS_Entity *e: *this) {
         //// Only update our own inserts and not inserts of inserts
         if (e->rtti() == RS2::EntitySpline  /*&& e->getParent()==this*/) {
             e->update();
+            invalidateSpatialIndex(e);
         } else if (e->isContainer() && e->rtti() != RS2::EntityHatch) {
             static_cast<RS_EntityContainer *>(e)->updateSplines();
+            invalidateSpatialIndex(e);
         }
     }
     RS_DEBUG->print("RS_EntityContainer::updateSplines() OK");
@@ -917,6 +1225,7 @@ void RS_EntityContainer::updateSplines() {
 void RS_EntityContainer::update() {
     for (RS_Entity *e: *this) {
         e->update();
+        invalidateSpatialIndex(e);
     }
 }
 
@@ -936,9 +1245,11 @@ void RS_EntityContainer::addRectangle(RS_Vector const& v0, RS_Vector const& v1,R
 
 /**
  * Returns the first entity or nullptr if this graphic is empty.
+ * Resolving levels hand out entities of sub-containers, so their deferred entities are created.
  * @param level
  */
 RS_Entity *RS_EntityContainer::firstEntity(RS2::ResolveLevel level) const {
+    checkEntitiesCreated();
     RS_Entity *e = nullptr;
     entIdx = -1;
     switch (level) {
@@ -957,6 +1268,7 @@ RS_Entity *RS_EntityContainer::firstEntity(RS2::ResolveLevel level) const {
             }
             if (e && e->isContainer() && e->rtti() != RS2::EntityInsert) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->firstEntity(level);
                 // empty container:
                 if (e == nullptr) {
@@ -975,6 +1287,7 @@ RS_Entity *RS_EntityContainer::firstEntity(RS2::ResolveLevel level) const {
             }
             if (e != nullptr && e->isContainer() && e->rtti() != RS2::EntityText && e->rtti() != RS2::EntityMText) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->firstEntity(level);
                 // empty container:
                 if (e == nullptr) {
@@ -992,6 +1305,7 @@ RS_Entity *RS_EntityContainer::firstEntity(RS2::ResolveLevel level) const {
             }
             if (e != nullptr && e->isContainer()) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->firstEntity(level);
                 // empty container:
                 if (e == nullptr) {
@@ -1013,6 +1327,7 @@ RS_Entity *RS_EntityContainer::firstEntity(RS2::ResolveLevel level) const {
  *              \li \p 2 all Entity Containers are resolved
  */
 RS_Entity *RS_EntityContainer::lastEntity(RS2::ResolveLevel level) const {
+    checkEntitiesCreated();
     RS_Entity *e = nullptr;
     if (m_entities.empty()) {
         return nullptr;
@@ -1032,6 +1347,7 @@ RS_Entity *RS_EntityContainer::lastEntity(RS2::ResolveLevel level) const {
             subContainer = nullptr;
             if (e != nullptr && e->isContainer() && e->rtti() != RS2::EntityInsert) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->lastEntity(level);
             }
             return e;
@@ -1044,6 +1360,7 @@ RS_Entity *RS_EntityContainer::lastEntity(RS2::ResolveLevel level) const {
             subContainer = nullptr;
             if (e != nullptr && e->isContainer() && e->rtti() != RS2::EntityText && e->rtti() != RS2::EntityMText) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->lastEntity(level);
             }
             return e;
@@ -1055,6 +1372,7 @@ RS_Entity *RS_EntityContainer::lastEntity(RS2::ResolveLevel level) const {
             subContainer = nullptr;
             if (e != nullptr && e->isContainer()) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->lastEntity(level);
             }
             return e;
@@ -1063,6 +1381,16 @@ RS_Entity *RS_EntityContainer::lastEntity(RS2::ResolveLevel level) const {
     return nullptr;
 }
 
+RS_Entity *RS_EntityContainer::firstEntity(RS2::ResolveLevel level) {
+    checkEntitiesPrepared();
+    return std::as_const(*this).firstEntity(level);
+}
+
+RS_Entity *RS_EntityContainer::lastEntity(RS2::ResolveLevel level) {
+    checkEntitiesPrepared();
+    return std::as_const(*this).lastEntity(level);
+}
+
 /**
  * Returns the next entity or container or \p nullptr if the last entity
  * returned by \p next() was the last entity in the container.
@@ -1096,6 +1424,7 @@ RS_Entity *RS_EntityContainer::nextEntity(RS2::ResolveLevel level) const {
             }
             if (e != nullptr && e->isContainer() && e->rtti() != RS2::EntityInsert) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->firstEntity(level);
                 // empty container:
                 if (e == nullptr) {
@@ -1127,6 +1456,7 @@ RS_Entity *RS_EntityContainer::nextEntity(RS2::ResolveLevel level) const {
             }
             if (e != nullptr && e->isContainer() && e->rtti() != RS2::EntityText && e->rtti() != RS2::EntityMText) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->firstEntity(level);
                 // empty container:
                 if (e == nullptr) {
@@ -1155,6 +1485,7 @@ RS_Entity *RS_EntityContainer::nextEntity(RS2::ResolveLevel level) const {
             }
             if (e != nullptr && e->isContainer()) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->firstEntity(level);
                 // empty container:
                 if (e == nullptr) {
@@ -1202,6 +1533,7 @@ RS_Entity *RS_EntityContainer::prevEntity(RS2::ResolveLevel level) const {
             }
             if (e != nullptr && e->isContainer() && e->rtti() != RS2::EntityInsert) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->lastEntity(level);
                 // empty container:
                 if (e == nullptr) {
@@ -1230,6 +1562,7 @@ RS_Entity *RS_EntityContainer::prevEntity(RS2::ResolveLevel level) const {
             }
             if (e != nullptr && e->isContainer() && e->rtti() != RS2::EntityText && e->rtti() != RS2::EntityMText) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->lastEntity(level);
                 // empty container:
                 if (e == nullptr) {
@@ -1258,6 +1591,7 @@ RS_Entity *RS_EntityContainer::prevEntity(RS2::ResolveLevel level) const {
             }
             if (e != nullptr && e->isContainer()) {
                 subContainer = static_cast<RS_EntityContainer*>(e);
+                subContainer->prepareEntities();
                 e = subContainer->lastEntity(level);
                 // empty container:
                 if (e == nullptr) {
@@ -1275,6 +1609,7 @@ RS_Entity *RS_EntityContainer::prevEntity(RS2::ResolveLevel level) const {
  * @return Entity at the given index or nullptr if the index is out of range.
  */
 RS_Entity *RS_EntityContainer::entityAt(int index) const{
+    checkEntitiesCreated();
     if (m_entities.size() > index && index >= 0) {
         return m_entities.at(index);
     }
@@ -1283,9 +1618,33 @@ RS_Entity *RS_EntityContainer::entityAt(int index) const{
     }
 }
 
+RS_Entity *RS_EntityContainer::entityAt(int index) {
+    checkEntitiesPrepared();
+    return std::as_const(*this).entityAt(index);
+}
+
 void RS_EntityContainer::setEntityAt(int index, RS_Entity *en) {
-    if (autoDelete && m_entities.at(index)) {
-        delete m_entities.at(index);
+    checkEntitiesPrepared();
+    RS_Entity* old = m_entities.at(index);
+    if (old != nullptr) {
+        childChanged(old);
+        childRemoved(old);
+    }
+    if (en != nullptr) {
+        childChanged(en);
+        childAdded(en);
+    }
+    if (m_spatialIndex != nullptr) {
+        if (old != nullptr && en != nullptr) {
+            m_spatialIndex->replace(old, en);
+        } else {
+            resetSpatialIndex();
+        }
+    }
+    m_positions.erase(old);
+    positionsChanged(index);
+    if (autoDelete && old) {
+        delete old;
     }
     m_entities[index] = en;
 }
@@ -1294,16 +1653,19 @@ void RS_EntityContainer::setEntityAt(int index, RS_Entity *en) {
  * Finds the given entity and makes it the current entity if found.
  */
 int RS_EntityContainer::findEntity(RS_Entity const *const entity) {
-    entIdx = m_entities.indexOf(const_cast<RS_Entity *>(entity));
+    checkEntitiesPrepared();
+    entIdx = positionOf(entity);
     return entIdx;
 }
 
 int RS_EntityContainer::findEntityIndex(RS_Entity const *const entity) {
-    return m_entities.indexOf(const_cast<RS_Entity *>(entity));
+    checkEntitiesPrepared();
+    return positionOf(entity);
 }
 
 bool  RS_EntityContainer::areNeighborsEntities(RS_Entity const *const  e1, RS_Entity const *const  e2) {
-   return abs(m_entities.indexOf(e1) - m_entities.indexOf(e2)) <= 1;
+   checkEntitiesPrepared();
+   return abs(positionOf(e1) - positionOf(e2)) <= 1;
 }
 
 /**
@@ -1311,31 +1673,11 @@ bool  RS_EntityContainer::areNeighborsEntities(RS_Entity const *const  e1, RS_En
  * (one of the vertices)
  */
 RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector &coord,double *dist) const{
-    double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist = 0.;                 // currently measured distance
-    RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
-
-    for(RS_Entity* en : *this) {
-        if (en != nullptr && en->getId() != 0 && en->isVisible()){
-            auto parent = en->getParent();
-            bool checkForEndpoint = true;
-            if (parent != nullptr){
-                checkForEndpoint = !parent->ignoredOnModification();
-            }
-            if (checkForEndpoint) {//no end point for Insert, text, Dim
-                point = en->getNearestEndpoint(coord, &curDist);
-                if (point.valid && curDist < minDist) {
-                    closestPoint = point;
-                    minDist = curDist;
-                    if (dist) {
-                        *dist = minDist;
-                    }
-                }
-            }
-        }
+    SnapPoints points = getNearestSnapPoints(coord, true, false, false);
+    if (dist != nullptr && points.endpoint.valid) {
+        *dist = points.endpointDist;
     }
-    return closestPoint;
+    return points.endpoint;
 }
 
 /**
@@ -1348,6 +1690,14 @@ RS_Vector RS_EntityContainer::getNearestEndpoint(const RS_Vector &coord,double *
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
 
+    if (m_entitiesDeferred) {
+        // deferred entities can't be reported, the container is reported instead
+        closestPoint = getNearestEndpoint(coord, dist);
+        if (pEntity != nullptr && closestPoint.valid) {
+            *pEntity = const_cast<RS_EntityContainer*>(this);
+        }
+        return closestPoint;
+    }
     for (auto en: m_entities) {
         if (en->getParent() == nullptr || !en->getParent()->ignoredOnModification()) {//no end point for Insert, text, Dim
             //            std::cout<<"find nearest for entity "<<i0<<std::endl;
@@ -1381,47 +1731,95 @@ RS_Vector RS_EntityContainer::getNearestPointOnEntity(const RS_Vector &coord,boo
 }
 
 RS_Vector RS_EntityContainer::getNearestCenter(const RS_Vector &coord,double *dist) const {
-    double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist = RS_MAXDOUBLE;  // currently measured distance
-    RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
-
-    for (auto en: m_entities) {
-        if (en != nullptr && en->getId() != 0 && en->isVisible() && !en->getParent()->ignoredSnap() ) {//no center point for spline, text, Dim
-            point = en->getNearestCenter(coord, &curDist);
-            if (point.valid && curDist < minDist) {
-                closestPoint = point;
-                minDist = curDist;
-            }
-        }
-    }
+    SnapPoints points = getNearestSnapPoints(coord, false, true, false);
     if (dist) {
-        *dist = minDist;
+        *dist = points.centerDist;
     }
-    return closestPoint;
+    return points.center;
 }
 
 /** @return the nearest of equidistant middle points of the line. */
 
 RS_Vector RS_EntityContainer::getNearestMiddle(const RS_Vector &coord,double *dist,int middlePoints ) const {
-    double minDist = RS_MAXDOUBLE;  // minimum measured distance
-    double curDist = RS_MAXDOUBLE;  // currently measured distance
-    RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Vector point;                // endpoint found
+    SnapPoints points = getNearestSnapPoints(coord, false, false, true, middlePoints);
+    if (dist) {
+        *dist = points.middleDist;
+    }
+    return points.middle;
+}
 
-    for (auto en: m_entities) {
-        if (en->isVisible() && !en->getParent()->ignoredSnap() ) {//no midle point for spline, text, Dim
-            point = en->getNearestMiddle(coord, &curDist, middlePoints);
-            if (point.valid && curDist < minDist) {
-                closestPoint = point;
-                minDist = curDist;
+RS_EntityContainer::SnapPoints RS_EntityContainer::getNearestSnapPoints(const RS_Vector &coord, bool endpoints, bool centers,
+                                                                        bool middles, int middlePoints) const {
+    SnapPoints result;
+    // children holding the points found, to resolve ties by the container order
+    const RS_Entity* endpointEntity = nullptr;
+    const RS_Entity* centerEntity = nullptr;
+    const RS_Entity* middleEntity = nullptr;
+    double minDist = RS_MAXDOUBLE; // nearest point of any type
+
+    LC_SpatialIndex* index = spatialIndex();
+
+    // as in a loop in container order, the first of equally distant points is kept
+    auto closer = [index](double curDist, double bestDist, const RS_Entity* e, const RS_Entity* bestEntity) {
+        if (curDist != bestDist) {
+            return curDist < bestDist;
+        }
+        return index != nullptr && bestEntity != nullptr && index->isBefore(e, bestEntity);
+    };
+
+    auto measure = [&](RS_Entity* en) {
+        if (en == nullptr || !en->isVisible()) {
+            return;
+        }
+        const RS_EntityContainer* parent = en->getParent();
+        if (endpoints && en->getId() != 0 && (parent == nullptr || !parent->ignoredOnModification())) {//no end point for Insert, text, Dim
+            double curDist = RS_MAXDOUBLE;
+            RS_Vector point = en->getNearestEndpoint(coord, &curDist);
+            if (point.valid && closer(curDist, result.endpointDist, en, endpointEntity)) {
+                result.endpoint = point;
+                result.endpointDist = curDist;
+                endpointEntity = en;
             }
         }
+        if (parent != nullptr && parent->ignoredSnap()) {//no center or middle point for spline, text, Dim
+            return;
+        }
+        if (centers && en->getId() != 0) {
+            double curDist = RS_MAXDOUBLE;
+            RS_Vector point = en->getNearestCenter(coord, &curDist);
+            if (point.valid && closer(curDist, result.centerDist, en, centerEntity)) {
+                result.center = point;
+                result.centerDist = curDist;
+                centerEntity = en;
+            }
+        }
+        if (middles) {
+            double curDist = RS_MAXDOUBLE;
+            RS_Vector point = en->getNearestMiddle(coord, &curDist, middlePoints);
+            if (point.valid && closer(curDist, result.middleDist, en, middleEntity)) {
+                result.middle = point;
+                result.middleDist = curDist;
+                middleEntity = en;
+            }
+        }
+        minDist = std::min({result.endpointDist, result.centerDist, result.middleDist});
+    };
+
+    if (index != nullptr) {
+        // best-first search: characteristic points lie within the boxes of their entities
+        index->visitNearest(coord, [&](RS_Entity* e, double boxDistance) {
+            if (boxDistance > minDist) {
+                return false;
+            }
+            measure(e);
+            return true;
+        });
+    } else {
+        for (RS_Entity* e: *this) {
+            measure(e);
+        }
     }
-    if (dist) {
-        *dist = minDist;
-    }
-    return closestPoint;
+    return result;
 }
 
 RS_Vector RS_EntityContainer::getNearestDist(double distance,const RS_Vector &coord, double *dist) const {
@@ -1436,27 +1834,45 @@ RS_Vector RS_EntityContainer::getNearestDist(double distance,const RS_Vector &co
 RS_Vector RS_EntityContainer::getNearestIntersection(const RS_Vector &coord, double *dist){
     double minDist = RS_MAXDOUBLE;  // minimum measured distance
     RS_Vector closestPoint(false);  // closest found endpoint
-    RS_Entity* closestEntity = getNearestEntity(coord, nullptr, RS2::ResolveAllButTextImage);
+    // snapping doesn't create deferred entities, e.g. of inserts, temporary copies are intersected instead
+    ResolvedNearest nearest = findResolvedNearest(*this, coord);
+    RS_Entity* closestEntity = nearest.entity;
 
     if (closestEntity) {
-        // fixme - sand - why not via traverser?
-        for (RS_Entity *en = firstEntity(RS2::ResolveAllButTextImage);en;en = nextEntity(RS2::ResolveAllButTextImage)) {
-            auto parent = en->getParent();
+        LC_IntersectionCache* cache = intersectionCache();
+        auto intersect = [&](RS_Entity* en, const RS_EntityContainer* parent, bool temporary) {
             bool ignoredSnap = false;
             if (parent != nullptr) { // may be null in block editing?
                 ignoredSnap = parent->ignoredSnap();
             }
             if (!en->isVisible() || ignoredSnap) {
-                continue;
+                return;
             }
 
-            RS_VectorSolutions sol = RS_Information::getIntersection(closestEntity, en, true);
+            // the cache is keyed by entities, which temporary copies are not
+            const bool cached = cache != nullptr && !temporary && nearest.copy == nullptr;
+            RS_VectorSolutions sol = cached ? cache->getIntersection(closestEntity, en)
+                                            : RS_Information::getIntersection(closestEntity, en, true);
             double curDist = RS_MAXDOUBLE;  // currently measured distance
             RS_Vector point = sol.getClosest(coord, &curDist, nullptr);
             if (sol.getNumber() > 0 && curDist < minDist) {
                 closestPoint = point;
                 minDist = curDist;
             }
+        };
+        for (RS_Entity* child: getIntersectionCandidates(*nearest.reported)) {
+            if (child == nearest.reported && nearest.copy != nullptr) {
+                // the copy doesn't intersect the temporary entity it was copied from
+                size_t index = 0;
+                visitResolvedAllButTextImage(child, child->getParent(), false,
+                                             [&](RS_Entity* en, const RS_EntityContainer* parent, bool temporary) {
+                    if (index++ != nearest.copyIndex) {
+                        intersect(en, parent, temporary);
+                    }
+                });
+            } else {
+                visitResolvedAllButTextImage(child, child->getParent(), false, intersect);
+            }
         }
     }
     if (dist && closestPoint.valid) {
@@ -1465,8 +1881,31 @@ RS_Vector RS_EntityContainer::getNearestIntersection(const RS_Vector &coord, dou
     return closestPoint;
 }
 
+std::vector<RS_Entity*> RS_EntityContainer::getIntersectionCandidates(const RS_Entity& entity) const {
+    // intersections on entities lie within the borders of both, unless one of them is drawn infinite
+    bool bounded = entity.rtti() != RS2::EntityConstructionLine && !entity.isConstruction()
+                   && !hasConstructionLayers(*this);
+    const RS_Vector min = entity.getMin();
+    const RS_Vector max = entity.getMax();
+    if (bounded && min.x <= max.x && min.y <= max.y
+        && min.x > RS_MINDOUBLE && min.y > RS_MINDOUBLE && max.x < RS_MAXDOUBLE && max.y < RS_MAXDOUBLE) {
+        const RS_Vector margin{10. * RS_TOLERANCE, 10. * RS_TOLERANCE};
+        return getCandidatesInBox(min - margin, max + margin);
+    }
+    return {m_entities.cbegin(), m_entities.cend()};
+}
+
+LC_IntersectionCache* RS_EntityContainer::intersectionCache() const {
+    return nullptr;
+}
+
+LC_SelectionSet* RS_EntityContainer::selectionSet() const {
+    return nullptr;
+}
+
 RS_Vector RS_EntityContainer::getNearestVirtualIntersection(const RS_Vector &coord, const double &angle, double *dist) {
-    RS_Entity* closestEntity = getNearestEntity(coord, nullptr, RS2::ResolveAllButTextImage);
+    ResolvedNearest nearest = findResolvedNearest(*this, coord);
+    RS_Entity* closestEntity = nearest.entity;
     if (closestEntity != nullptr) {
         RS_Vector second_coord{angle};
         RS_ConstructionLineData data(coord, coord + second_coord);
@@ -1489,7 +1928,7 @@ RS_Vector RS_EntityContainer::getNearestRef(const RS_Vector &coord, double *dist
     RS_Vector closestPoint(false);  // closest found endpoint
     RS_Vector point;                // endpoint found
 
-    for (RS_Entity* en: *this) {
+    visitEntities([&](RS_Entity* en) {
         if (en->isVisible()) {
             point = en->getNearestRef(coord, &curDist);
             if (point.valid && curDist < minDist) {
@@ -1500,7 +1939,8 @@ RS_Vector RS_EntityContainer::getNearestRef(const RS_Vector &coord, double *dist
                 }
             }
         }
-    }
+        return true;
+    });
     return closestPoint;
 }
 
@@ -1535,41 +1975,69 @@ RS_EntityContainer::RefInfo RS_EntityContainer::getNearestSelectedRefInfo(const
 double RS_EntityContainer::getDistanceToPoint(const RS_Vector &coord,RS_Entity **entity,RS2::ResolveLevel level,double solidDist) const{
     RS_DEBUG->print("RS_EntityContainer::getDistanceToPoint");
     double minDist = RS_MAXDOUBLE;      // minimum measured distance
-    double curDist = 0.;                     // currently measured distance
     RS_Entity *closestEntity = nullptr;    // closest entity found
-    RS_Entity *subEntity = nullptr;
+    const RS_Entity *closestChild = nullptr; // the child of this container holding the closest entity
 
-    for (RS_Entity* e: *this) {
+    LC_SpatialIndex* index = spatialIndex();
+
+    auto measure = [&](RS_Entity* e) {
         auto entityLayer = e->getLayer();
-        if (e->isVisible() && (entityLayer == nullptr || !entityLayer->isLocked())) {
-            RS_DEBUG->print("entity: getDistanceToPoint");
-            RS_DEBUG->print("entity: %d", e->rtti());
-            // bug#426, need to ignore Images to find nearest intersections
-            if (level == RS2::ResolveAllButTextImage && e->rtti() == RS2::EntityImage) continue;
-            curDist = e->getDistanceToPoint(coord, &subEntity, level, solidDist);
-
-            RS_DEBUG->print("entity: getDistanceToPoint: OK");
-
-            /*
-             * By using '<=', we will prefer the *last* item in the container if there are multiple
-             * entities that are *exactly* the same distance away, which should tend to be the one
-             * drawn most recently, and the one most likely to be visible (as it is also the order
-             * that the software draws the entities). This makes a difference when one entity is
-             * drawn directly over top of another, and it's reasonable to assume that humans will
-             * tend to want to reference entities that they see or have recently drawn as opposed
-             * to deeper more forgotten and invisible ones...
-             */
-            if (curDist <= minDist) {
-                switch (level) {
-                case RS2::ResolveAll:
-                case RS2::ResolveAllButTextImage:
-                    closestEntity = subEntity;
-                    break;
-                default:
-                    closestEntity = e;
-                }
-                minDist = curDist;
+        if (!e->isVisible() || (entityLayer != nullptr && entityLayer->isLocked())) {
+            return;
+        }
+        RS_DEBUG->print("entity: getDistanceToPoint");
+        RS_DEBUG->print("entity: %d", e->rtti());
+        // bug#426, need to ignore Images to find nearest intersections
+        if (level == RS2::ResolveAllButTextImage && e->rtti() == RS2::EntityImage) {
+            return;
+        }
+        RS_Entity *subEntity = nullptr;
+        double curDist = e->getDistanceToPoint(coord, &subEntity, level, solidDist);
+
+        RS_DEBUG->print("entity: getDistanceToPoint: OK");
+
+        /*
+         * By using '<=', we will prefer the *last* item in the container if there are multiple
+         * entities that are *exactly* the same distance away, which should tend to be the one
+         * drawn most recently, and the one most likely to be visible (as it is also the order
+         * that the software draws the entities). This makes a difference when one entity is
+         * drawn directly over top of another, and it's reasonable to assume that humans will
+         * tend to want to reference entities that they see or have recently drawn as opposed
+         * to deeper more forgotten and invisible ones...
+         * The spatial index doesn't visit entities in the container order, so ties are
+         * resolved by the order kept in the index.
+         */
+        bool closer = curDist < minDist;
+        if (!closer && curDist == minDist) {
+            closer = index == nullptr || closestChild == nullptr || index->isBefore(closestChild, e);
+        }
+        if (closer) {
+            switch (level) {
+            case RS2::ResolveAll:
+            case RS2::ResolveAllButTextImage:
+                closestEntity = subEntity;
+                break;
+            default:
+                closestEntity = e;
             }
+            closestChild = e;
+            minDist = curDist;
+        }
+    };
+
+    if (index != nullptr) {
+        // best-first search: entities are visited by the distance to their boxes
+        index->visitNearest(coord, [&](RS_Entity* e, double boxDistance) {
+            if (boxDistance > minDist) {
+                // none of the remaining entities can be closer
+                return false;
+            }
+            measure(e);
+            return true;
+        });
+    } else {
+        for (RS_Entity* e: *this) {
+            measure(e);
         }
     }
 
@@ -1605,6 +2073,23 @@ RS_Entity* RS_EntityContainer::getNearestEntity(const RS_Vector& coord,double* d
     return e;
 }
 
+RS_Entity* RS_EntityContainer::getNearestEntity(const RS_Vector& coord, double* dist, RS2::ResolveLevel level) {
+    const double solidDist = (dist != nullptr) ? *dist : RS_MAXDOUBLE;
+    RS_Entity* e = std::as_const(*this).getNearestEntity(coord, dist, level);
+    if (e == nullptr || !e->isContainer() || (level != RS2::ResolveAll && level != RS2::ResolveAllButTextImage)) {
+        return e;
+    }
+    auto* container = static_cast<RS_EntityContainer*>(e);
+    if (!container->hasDeferredEntities()) {
+        return e;
+    }
+    // the entity found is handed out, so the entities of the container holding it are created
+    container->prepareEntities();
+    double subDist = solidDist;
+    RS_Entity* subEntity = container->getNearestEntity(coord, &subDist, level);
+    return (subEntity != nullptr) ? subEntity : e;
+}
+
 /**
  * Rearranges the atomic entities in this container in a way that connected
  * entities are stored in the right order and direction.
@@ -1620,6 +2105,7 @@ bool RS_EntityContainer::optimizeContours() {
     //    DEBUG_HEADER
     //    std::cout<<"loop with count()="<<count()<<std::endl;
     RS_DEBUG->print("RS_EntityContainer::optimizeContours");
+    prepareEntities();
 
     RS_EntityContainer tmp;
     tmp.setAutoUpdateBorders(false);
@@ -1656,9 +2142,7 @@ bool RS_EntityContainer::optimizeContours() {
     //    std::cout<<"RS_EntityContainer::optimizeContours: 1"<<std::endl;
 
     /** remove unsupported entities */
-    for (RS_Entity *it: std::as_const(enList)) {
-        removeEntity(it);
-    }
+    removeEntities({enList.cbegin(), enList.cend()});
 
     /** check and form a closed contour **/
     //    std::cout<<"RS_EntityContainer::optimizeContours: 2"<<std::endl;
@@ -1751,8 +2235,8 @@ bool RS_EntityContainer::optimizeContours() {
 }
 
 bool RS_EntityContainer::hasEndpointsWithinWindow(const RS_Vector &v1, const RS_Vector &v2) const{
-    return std::any_of(cbegin(), cend(), [&v1, &v2](const RS_Entity* entity) {
-        return entity->hasEndpointsWithinWindow(v1, v2);
+    return !visitEntities([&v1, &v2](const RS_Entity* entity) {
+        return !entity->hasEndpointsWithinWindow(v1, v2);
     });
 }
 
@@ -1762,6 +2246,7 @@ void RS_EntityContainer::move(const RS_Vector &offset) {
         e->move(offset);
         adjustBorders(e);
     }
+    invalidateSpatialIndex();
     calculateBordersIfNeeded();
 }
 
@@ -1775,6 +2260,7 @@ void RS_EntityContainer::rotate(const RS_Vector &center, const RS_Vector &angleV
         e->rotate(center, angleVector);
         adjustBorders(e);
     }
+    invalidateSpatialIndex();
     calculateBordersIfNeeded();
 }
 
@@ -1785,10 +2271,32 @@ void RS_EntityContainer::scale(const RS_Vector &center, const RS_Vector &factor)
             e->scale(center, factor);
             adjustBorders(e);
         }
+        invalidateSpatialIndex();
         calculateBordersIfNeeded();
     }
 }
 
+bool RS_EntityContainer::saveEntitiesGeometry(LC_EntityGeometry& geometry) const {
+    geometry.entities.reserve(m_entities.size());
+    for (const RS_Entity* e: m_entities) {
+        std::unique_ptr<LC_EntityGeometry> entityGeometry = e->saveGeometry();
+        if (entityGeometry == nullptr) {
+            return false;
+        }
+        geometry.entities.push_back(std::move(entityGeometry));
+    }
+    return true;
+}
+
+void RS_EntityContainer::restoreEntitiesGeometry(const LC_EntityGeometry& geometry) {
+    // transformations keep the entities, so they match the saved geometry
+    const int count = std::min(static_cast<int>(geometry.entities.size()), static_cast<int>(m_entities.size()));
+    for (int i = 0; i < count; ++i) {
+        m_entities.at(i)->restoreGeometry(*geometry.entities[i]);
+    }
+    invalidateSpatialIndex();
+}
+
 void RS_EntityContainer::mirror(const RS_Vector &axisPoint1, const RS_Vector &axisPoint2) {
     if (axisPoint1.distanceTo(axisPoint2) > RS_TOLERANCE) {
         resetBorders();
@@ -1796,10 +2304,12 @@ void RS_EntityContainer::mirror(const RS_Vector &axisPoint1, const RS_Vector &ax
             e->mirror(axisPoint1, axisPoint2);
             adjustBorders(e);
         }
+        invalidateSpatialIndex();
     }
 }
 
 RS_Entity &RS_EntityContainer::shear(double k) {
+    prepareEntities();
     for (RS_Entity *e: *this) {
         e->shear(k);
     }
@@ -1811,6 +2321,7 @@ void RS_EntityContainer::stretch(const RS_Vector &firstCorner,const RS_Vector &s
     if (getMin().isInWindow(firstCorner, secondCorner) && getMax().isInWindow(firstCorner, secondCorner)) {
         move(offset);
     } else {
+        prepareEntities();
         for (RS_Entity *e: *this) {
             e->stretch(firstCorner, secondCorner, offset);
         }
@@ -1825,25 +2336,236 @@ void RS_EntityContainer::calculateBordersIfNeeded() {
     }
 }
 
+bool RS_EntityContainer::updateSpatialIndex(RS_Entity* entity) {
+    if (m_spatialIndex == nullptr || entity == nullptr) {
+        return false;
+    }
+    return m_spatialIndex->update(entity, [this](RS_Entity* e, const RS_Vector& oldCorner1, const RS_Vector& oldCorner2) {
+        indexedBoxChanged(e, oldCorner1, oldCorner2);
+    });
+}
+
+void RS_EntityContainer::indexedBoxChanged(RS_Entity* entity, const RS_Vector& oldCorner1, const RS_Vector& oldCorner2) const {
+    childAreaChanged(oldCorner1, oldCorner2);
+    childChanged(entity);
+}
+
+void RS_EntityContainer::refreshSpatialIndex() const {
+    spatialIndex();
+}
+
+void RS_EntityContainer::invalidateSpatialIndex() {
+    if (m_spatialIndex != nullptr) {
+        m_spatialIndex->invalidateAll();
+    }
+}
+
+void RS_EntityContainer::invalidateSpatialIndex(const RS_Entity* entity) {
+    if (m_spatialIndex != nullptr) {
+        m_spatialIndex->invalidate(entity);
+    }
+}
+
+void RS_EntityContainer::invalidateSpatialIndex(const RS_Entity* entity, const RS_Vector& oldMin, const RS_Vector& oldMax) {
+    if (m_spatialIndex == nullptr) {
+        return;
+    }
+    // exact comparison, as the indexed boxes are compared exactly
+    const RS_Vector min = entity->getMin();
+    const RS_Vector max = entity->getMax();
+    if (min.x != oldMin.x || min.y != oldMin.y || max.x != oldMax.x || max.y != oldMax.y) {
+        m_spatialIndex->invalidate(entity);
+    }
+}
+
+std::vector<RS_Entity*> RS_EntityContainer::getCandidatesInBox(const RS_Vector& corner1, const RS_Vector& corner2) const {
+    LC_SpatialIndex* index = spatialIndex();
+    if (index != nullptr) {
+        return index->entitiesInBox(corner1, corner2);
+    }
+    return std::vector<RS_Entity*>(m_entities.cbegin(), m_entities.cend());
+}
+
+std::vector<RS_Entity*> RS_EntityContainer::getSelectionCandidates() const {
+    const LC_SelectionSet* selection = selectionSet();
+    LC_SpatialIndex* index = (selection != nullptr) ? spatialIndex() : nullptr;
+    if (index == nullptr) {
+        // small containers are cheap to enumerate, and there is no index to order the selection
+        return std::vector<RS_Entity*>(m_entities.cbegin(), m_entities.cend());
+    }
+    std::vector<RS_Entity*> result = selection->entities();
+    sortInContainerOrder(result);
+    return result;
+}
+
+std::vector<RS_Entity*> RS_EntityContainer::getEntitiesOnLayer(const RS_Layer* layer) const {
+    std::vector<RS_Entity*> result;
+    for (RS_Entity* e: *this) {
+        if (e->getLayer() == layer) {
+            result.push_back(e);
+        }
+    }
+    return result;
+}
+
+void RS_EntityContainer::sortInContainerOrder(std::vector<RS_Entity*>& entities) const {
+    if (LC_SpatialIndex* index = spatialIndex()) {
+        std::sort(entities.begin(), entities.end(), [index](const RS_Entity* a, const RS_Entity* b) {
+            return index->isBefore(a, b);
+        });
+        return;
+    }
+    std::unordered_map<const RS_Entity*, int> positions;
+    for (int i = 0; i < m_entities.size(); i++) {
+        positions.emplace(m_entities.at(i), i);
+    }
+    std::sort(entities.begin(), entities.end(), [&positions](const RS_Entity* a, const RS_Entity* b) {
+        return positions[a] < positions[b];
+    });
+}
+
+LC_SpatialIndex* RS_EntityContainer::spatialIndex() const {
+    if (m_spatialIndex == nullptr) {
+        // only documents are large enough to benefit from the index
+        if (m_entities.size() < spatialIndexMinSize || !isDocument()) {
+            return nullptr;
+        }
+        m_spatialIndex = std::make_unique<LC_SpatialIndex>();
+        m_spatialIndex->build(m_entities);
+    } else if (m_spatialIndex->isOutdated()) {
+        m_spatialIndex->updateOutdated([this](RS_Entity* e, const RS_Vector& oldCorner1, const RS_Vector& oldCorner2) {
+            indexedBoxChanged(e, oldCorner1, oldCorner2);
+        });
+    }
+    return m_spatialIndex.get();
+}
+
+void RS_EntityContainer::entityAdded(int index) {
+    positionsChanged(index);
+    childChanged(m_entities.at(index));
+    childAdded(m_entities.at(index));
+    if (m_spatialIndex == nullptr) {
+        return;
+    }
+    RS_Entity* previous = (index > 0) ? m_entities.at(index - 1) : nullptr;
+    RS_Entity* next = (index + 1 < m_entities.size()) ? m_entities.at(index + 1) : nullptr;
+    if (!m_spatialIndex->insert(m_entities.at(index), previous, next)) {
+        // no room for the order key, rebuild on the next query
+        resetSpatialIndex();
+    }
+}
+
+void RS_EntityContainer::entityRemoved(RS_Entity* entity) {
+    auto it = m_positions.find(entity);
+    if (it != m_positions.end()) {
+        // an entity without an exact position was after the exact ones
+        positionsChanged(it->second);
+        m_positions.erase(it);
+    }
+    childChanged(entity);
+    childRemoved(entity);
+    if (m_spatialIndex != nullptr) {
+        m_spatialIndex->remove(entity);
+    }
+}
+
+void RS_EntityContainer::resetSpatialIndex() {
+    m_spatialIndex.reset();
+}
+
+/**
+ * Accessors of the entities don't create deferred entities, the caller does it explicitly by
+ * prepareEntities(). A caller missing it is a bug; in release builds it is reported and the
+ * entities are created, so the caller still gets the entities it expects.
+ */
+void RS_EntityContainer::checkEntitiesPrepared() {
+    if (m_entitiesDeferred) {
+        assert(!"deferred entities are accessed without prepareEntities()");
+        LC_ERR << "RS_EntityContainer::" << __func__ << "(): deferred entities of" << rtti()
+               << "are accessed without prepareEntities()";
+        createDeferredEntities();
+    }
+}
+
+/**
+ * Const accessors can't create deferred entities, a read-only caller visits temporary copies of
+ * them by visitEntities(). A caller iterating them instead would see no entities at all.
+ */
+void RS_EntityContainer::checkEntitiesCreated() const {
+    if (m_entitiesDeferred) {
+        assert(!"deferred entities are iterated instead of visitEntities()");
+        LC_ERR << "RS_EntityContainer::" << __func__ << "(): deferred entities of" << rtti()
+               << "are iterated instead of visitEntities()";
+    }
+}
+
+int RS_EntityContainer::positionOf(const RS_Entity* entity) const {
+    // a linear search is faster than hashing for a few entities
+    constexpr int minIndexedCount = 32;
+    if (m_entities.size() < minIndexedCount) {
+        if (!m_positions.empty()) {
+            positionsChanged(0);
+        }
+        return m_entities.indexOf(const_cast<RS_Entity*>(entity));
+    }
+    auto it = m_positions.find(entity);
+    if (it != m_positions.end() && it->second < m_positionsIndexed && m_entities.at(it->second) == entity) {
+        return it->second;
+    }
+    if (it != m_positions.end() && it->second < m_positionsIndexed) {
+        // the list was changed without notification
+        positionsChanged(0);
+    }
+    for (int i = m_positionsIndexed; i < m_entities.size(); ++i) {
+        auto [indexed, inserted] = m_positions.try_emplace(m_entities.at(i), i);
+        // the first of duplicated entries is found, as by QList::indexOf()
+        if (!inserted && (indexed->second >= m_positionsIndexed || m_entities.at(indexed->second) != indexed->first)) {
+            indexed->second = i;
+        }
+    }
+    m_positionsIndexed = m_entities.size();
+    it = m_positions.find(entity);
+    return (it != m_positions.end()) ? it->second : -1;
+}
+
+void RS_EntityContainer::positionsChanged(int from) const {
+    if (from <= 0) {
+        m_positions.clear();
+        m_positionsIndexed = 0;
+    } else {
+        m_positionsIndexed = std::min(m_positionsIndexed, from);
+    }
+}
+
 void RS_EntityContainer::moveRef(const RS_Vector &ref,const RS_Vector &offset) {
+    prepareEntities();
     resetBorders();
     for (RS_Entity *e: *this) {
+        const RS_Vector oldMin = e->getMin();
+        const RS_Vector oldMax = e->getMax();
         e->moveRef(ref, offset);
+        invalidateSpatialIndex(e, oldMin, oldMax);
         adjustBorders(e);
     }
     calculateBordersIfNeeded();
 }
 
 void RS_EntityContainer::moveSelectedRef(const RS_Vector &ref,const RS_Vector &offset) {
+    prepareEntities();
     resetBorders();
     for (RS_Entity *e: *this) {
+        const RS_Vector oldMin = e->getMin();
+        const RS_Vector oldMax = e->getMax();
         e->moveSelectedRef(ref, offset);
+        invalidateSpatialIndex(e, oldMin, oldMax);
         adjustBorders(e);
     }
     calculateBordersIfNeeded();
 }
 
 void RS_EntityContainer::revertDirection() {
+    prepareEntities();
+    positionsChanged(0);
     // revert entity order in the container
     for (int k = 0; k < m_entities.size() / 2; ++k) {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 13, 0))
@@ -1857,6 +2579,8 @@ void RS_EntityContainer::revertDirection() {
     for (RS_Entity *entity: std::as_const(m_entities)) {
         entity->revertDirection();
     }
+    childAreaChanged(RS_Vector{false}, RS_Vector{false});
+    resetSpatialIndex();
 }
 
 /**
@@ -1865,19 +2589,22 @@ void RS_EntityContainer::revertDirection() {
  * @param view
  */
  void RS_EntityContainer::draw(RS_Painter *painter) {
-    for(RS_Entity *e: *this){
+    // drawing is read-only, tiles may be drawn concurrently
+    visitEntities([painter](RS_Entity* e) {
         if (e!=nullptr && e->getId() != 0) {
             painter->drawEntity(e);
         }
-    }
+        return true;
+    });
 }
 
 void RS_EntityContainer::drawAsChild(RS_Painter *painter) {
-    for(RS_Entity *e: *this){
+    visitEntities([painter](RS_Entity* e) {
         if (e!=nullptr && e->getId() != 0) {
             painter->drawAsChild(e);
         }
-    }
+        return true;
+    });
 }
 
 /**
@@ -1886,6 +2613,13 @@ void RS_EntityContainer::drawAsChild(RS_Painter *painter) {
  * @return line integral \oint x dy along the entity
  */
 double RS_EntityContainer::areaLineIntegral() const {
+    if (m_entitiesDeferred) {
+        // the area enclosed by temporary copies of the deferred entities
+        RS_EntityContainer copies{nullptr, true};
+        copies.setLayer(getLayer());
+        copies.adoptTemporaryEntities(*this);
+        return copies.areaLineIntegral();
+    }
     //TODO make sure all contour integral is by counter-clockwise
     double contourArea = 0.;
     //closed area is always positive
@@ -1956,26 +2690,32 @@ bool RS_EntityContainer::ignoredSnap() const{
 }
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::begin() const{
+    checkEntitiesCreated();
     return m_entities.begin();
 }
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::end() const{
+    checkEntitiesCreated();
     return m_entities.end();
 }
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::cbegin() const{
+    checkEntitiesCreated();
     return m_entities.cbegin();
 }
 
 QList<RS_Entity *>::const_iterator RS_EntityContainer::cend() const{
+    checkEntitiesCreated();
     return m_entities.cend();
 }
 
 QList<RS_Entity *>::iterator RS_EntityContainer::begin(){
+    checkEntitiesPrepared();
     return m_entities.begin();
 }
 
 QList<RS_Entity *>::iterator RS_EntityContainer::end() {
+    checkEntitiesPrepared();
     return m_entities.end();
 }
 
@@ -2029,15 +2769,40 @@ std::ostream &operator<<(std::ostream &os, RS_EntityContainer &ec) {
     return os;
 }
 
+void RS_EntityContainer::push_back(RS_Entity* entity) {
+    m_entities.push_back(entity);
+    entityAdded(m_entities.size() - 1);
+}
+
+void RS_EntityContainer::pop_back() {
+    if (!isEmpty()) {
+        entityRemoved(m_entities.last());
+        m_entities.pop_back();
+    }
+}
+
 RS_Entity *RS_EntityContainer::first() const {
+    checkEntitiesCreated();
     return m_entities.first();
 }
 
 RS_Entity *RS_EntityContainer::last() const {
+    checkEntitiesCreated();
+    return m_entities.last();
+}
+
+RS_Entity *RS_EntityContainer::first() {
+    checkEntitiesPrepared();
+    return m_entities.first();
+}
+
+RS_Entity *RS_EntityContainer::last() {
+    checkEntitiesPrepared();
     return m_entities.last();
 }
 
 const QList<RS_Entity *> &RS_EntityContainer::getEntityList() {
+    checkEntitiesPrepared();
     return m_entities;
 }
 
@@ -2050,7 +2815,10 @@ std::vector<std::unique_ptr<RS_EntityContainer>> RS_EntityContainer::getLoops()
     for(RS_Entity* en: *this){
         if (en != nullptr && en->isContainer()){
             if (en->isContainer()){
-                auto subLoops = static_cast<RS_EntityContainer*>(en)->getLoops();
+                // edges of loops are kept, so they are created
+                auto container = static_cast<RS_EntityContainer*>(en);
+                container->prepareEntities();
+                auto subLoops = container->getLoops();
                 for (auto& subLoop: subLoops) {
                     loops.push_back(std::move(subLoop));
                 }
@@ -28,9 +28,19 @@
 #ifndef RS_ENTITYCONTAINER_H
 #define RS_ENTITYCONTAINER_H
 
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include <QList>
 #include "rs_entity.h"
 
+class LC_IntersectionCache;
+class LC_SelectionSet;
+class LC_SpatialIndex;
+
 /**
  * Class representing a tree of entities.
  * Typical entity containers are graphics, polylines, groups, texts, ...)
@@ -63,6 +73,7 @@ public:
     ~RS_EntityContainer() override;
 
     RS_Entity* clone() const override;
+    std::size_t getMemoryUsage() const override;
     virtual void detach();
 
     /** @return RS2::EntityContainer */
@@ -110,6 +121,23 @@ public:
     void adjustBordersIfNeeded(RS_Entity* entity);
     virtual void insertEntity(int index, RS_Entity* entity);
     virtual bool removeEntity(RS_Entity* entity);
+    /**
+     * @brief removeEntities - removes all given entities in a single pass over the container,
+     *        instead of a search for each of them
+     * @return number of removed entities
+     */
+    int removeEntities(const std::vector<RS_Entity*>& entities);
+    /**
+     * @brief takeEntities - removes the given entities as removeEntities(), without deleting them
+     * @return positions of the entities in the container before the removal, in the order of
+     *         the given entities, -1 for entities which are not in the container
+     */
+    std::vector<int> takeEntities(const std::vector<RS_Entity*>& entities);
+    /**
+     * @brief insertEntities - inserts entities at once, each entity is at the given position of
+     *        the container afterwards, as by insertEntity() in ascending order of positions
+     */
+    void insertEntities(std::vector<std::pair<int, RS_Entity*>> entities);
 
 //!
 //! \brief addRectangle add four lines to form a rectangle by
@@ -121,9 +149,12 @@ public:
 
     virtual RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone) const;
     virtual RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone) const;
+    RS_Entity* firstEntity(RS2::ResolveLevel level=RS2::ResolveNone);
+    RS_Entity* lastEntity(RS2::ResolveLevel level=RS2::ResolveNone);
     virtual RS_Entity* nextEntity(RS2::ResolveLevel level=RS2::ResolveNone) const;
     virtual RS_Entity* prevEntity(RS2::ResolveLevel level=RS2::ResolveNone) const;
     virtual RS_Entity* entityAt(int index) const;
+    RS_Entity* entityAt(int index);
     virtual void setEntityAt(int index,RS_Entity* en);
     virtual int findEntity(RS_Entity const* const entity);
     int findEntityIndex(RS_Entity const* const entity);
@@ -134,17 +165,54 @@ public:
     //	return count(false);
     //}
     virtual bool isEmpty() const {
-        return count()==0;
+        return m_entities.isEmpty() && !m_entitiesDeferred;
     }
     bool empty() const {
         return isEmpty();
     }
+    /**
+     * Number of entities, including deferred ones which are not created yet.
+     */
     unsigned count() const override;
     unsigned countDeep() const override;
     size_t size() const
     {
-        return m_entities.size();
+        return count();
     }
+    /**
+     * @return true, if the entities of the container are not created yet. They are created
+     *         by prepareEntities(), e.g. before they are modified
+     */
+    bool hasDeferredEntities() const {return m_entitiesDeferred;}
+    /**
+     * Creates deferred entities of the container. This is the only way they are created:
+     * accessors of the entities (begin(), entityAt(), firstEntity(), ...) don't create them,
+     * a caller which modifies the entities or hands them out prepares them first. Read-only
+     * queries don't need them, they use visitEntities() instead.
+     */
+    void prepareEntities() {
+        if (m_entitiesDeferred) {
+            createDeferredEntities();
+        }
+    }
+    /**
+     * Visits the entities of the container in order, until the visitor returns false. Deferred
+     * entities are not created, temporary copies of them are visited instead, which are valid
+     * during the call of the visitor only.
+     * @return false, if the visit was stopped by the visitor
+     */
+    bool visitEntities(const std::function<bool(RS_Entity*)>& visitor) const;
+    /**
+     * Creates copies of the deferred entities one by one, as they would be created by
+     * prepareEntities(), but without a parent and without adding them to the container.
+     * @return false, if the creation was stopped by the consumer
+     */
+    virtual bool createTemporaryEntities(const std::function<bool(std::unique_ptr<RS_Entity>)>& consumer) const;
+    /**
+     * Adds temporary copies of the deferred entities of the source to this container, which
+     * keeps them e.g. for a read-only traversal.
+     */
+    void adoptTemporaryEntities(const RS_EntityContainer& source);
 //virtual unsigned long int countLayerEntities(RS_Layer* layer);
 /** \brief countSelected number of selected
 * @param deep count sub-containers, if true
@@ -165,6 +233,11 @@ public:
     bool getAutoUpdateBorders() const {
         return m_autoUpdateBorders;
     }
+    /**
+     * Defers recalculation of borders on entity removals, e.g. during bulk deletes. Borders
+     * may be larger than needed meanwhile, they are recalculated once the deferral ends.
+     */
+    void setBordersUpdateDeferred(bool deferred);
     virtual void adjustBorders(RS_Entity* entity);
     void calculateBorders() override;
     void forcedCalculateBorders();
@@ -181,9 +254,16 @@ public:
     RS_Vector getNearestEndpoint(const RS_Vector& coord,
                                  double* dist, RS_Entity** pEntity ) const;
 
+    /**
+     * The const lookup reports containers with deferred entities instead of their entities, the
+     * non-const one creates the entities of the container found to report the nearest of them.
+     */
     RS_Entity* getNearestEntity(const RS_Vector& point,
                                 double* dist = nullptr,
                                 RS2::ResolveLevel level=RS2::ResolveAll) const;
+    RS_Entity* getNearestEntity(const RS_Vector& point,
+                                double* dist = nullptr,
+                                RS2::ResolveLevel level=RS2::ResolveAll);
 
     RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
                                       bool onEntity = true,
@@ -196,6 +276,29 @@ public:
                                double* dist = nullptr,
                                int middlePoints = 1
     )const override;
+
+    /**
+     * Nearest characteristic points of the children, see getNearestSnapPoints().
+     * Points of types which were not requested or not found are invalid.
+     */
+    struct SnapPoints {
+        RS_Vector endpoint{false};
+        RS_Vector center{false};
+        RS_Vector middle{false};
+        double endpointDist = RS_MAXDOUBLE;
+        double centerDist = RS_MAXDOUBLE;
+        double middleDist = RS_MAXDOUBLE;
+    };
+    /**
+     * @brief getNearestSnapPoints - nearest endpoint, center and middle point, found in a single
+     *        pass over the children with the same filters as getNearestEndpoint(), getNearestCenter()
+     *        and getNearestMiddle(). Large containers visit children by the distance of their
+     *        spatial index boxes, which contain all characteristic points, and stop as soon as no
+     *        box is closer than the nearest point of any requested type. Hence a point of one type
+     *        farther away than the nearest point of another type may not be the nearest of its type.
+     */
+    SnapPoints getNearestSnapPoints(const RS_Vector& coord, bool endpoints, bool centers,
+                                    bool middles, int middlePoints = 1) const;
     RS_Vector getNearestDist(double distance,
                              const RS_Vector& coord,
                              double* dist = nullptr) const override;
@@ -232,6 +335,45 @@ public:
                  const RS_Vector& secondCorner,
                  const RS_Vector& offset) override;
     void calculateBordersIfNeeded();
+    /**
+     * Refreshes the spatial index entry of a child entity, whose geometry was
+     * modified in place (i.e. without removing and adding it again).
+     * @return false, if the entity is not indexed
+     */
+    bool updateSpatialIndex(RS_Entity* entity);
+    /**
+     * Refreshes outdated boxes of the spatial index now, reporting changed children.
+     */
+    void refreshSpatialIndex() const;
+    /**
+     * Marks boxes of all indexed children as outdated. They are refreshed before
+     * the next spatial query.
+     */
+    void invalidateSpatialIndex();
+    /**
+     * Marks the box of a child as outdated, it is refreshed before the next spatial query.
+     */
+    void invalidateSpatialIndex(const RS_Entity* entity);
+    /**
+     * @brief getCandidatesInBox - children which may intersect the box defined by two corners,
+     *        in container order. Large documents answer it with the spatial index, otherwise all
+     *        children are returned, so callers must still apply their exact tests.
+     */
+    std::vector<RS_Entity*> getCandidatesInBox(const RS_Vector& corner1, const RS_Vector& corner2) const;
+    /**
+     * @brief getSelectionCandidates - children which may be selected or contain selected entities,
+     *        in container order. Large documents answer it with their selection set, otherwise all
+     *        children are returned, so callers must still check the selection state.
+     */
+    std::vector<RS_Entity*> getSelectionCandidates() const;
+    /**
+     * @brief getEntitiesOnLayer - children placed on the given layer, in container order
+     */
+    virtual std::vector<RS_Entity*> getEntitiesOnLayer(const RS_Layer* layer) const;
+    /**
+     * @brief sortInContainerOrder - sorts children of the container in drawing order
+     */
+    void sortInContainerOrder(std::vector<RS_Entity*>& entities) const;
     void moveRef(const RS_Vector& ref, const RS_Vector& offset) override;
     void moveSelectedRef(const RS_Vector& ref, const RS_Vector& offset) override;
     void revertDirection() override;
@@ -256,15 +398,11 @@ public:
      */
     bool ignoredOnModification() const;
 
-    void push_back(RS_Entity* entity) {
-        m_entities.push_back(entity);
-    }
-    void pop_back() {
-        if (!isEmpty())
-            m_entities.pop_back();
-    }
+    void push_back(RS_Entity* entity);
+    void pop_back();
 /**
- * @brief begin/end to support range based loop
+ * @brief begin/end to support range based loop. Const iteration doesn't see deferred entities,
+ * read-only callers of a container which may defer them use visitEntities() instead.
  * @return iterator
  */
     QList<RS_Entity *>::const_iterator begin() const;
@@ -278,6 +416,8 @@ public:
 //! not empty
     RS_Entity* last() const;
     RS_Entity* first() const;
+    RS_Entity* last();
+    RS_Entity* first();
 //! \}
 
     const QList<RS_Entity*>& getEntityList();
@@ -293,14 +433,104 @@ protected:
      */
     virtual std::vector<std::unique_ptr<RS_EntityContainer>> getLoops() const;
 
+    /**
+     * @return memory used by the created children, deferred entities use none
+     */
+    std::size_t getEntitiesMemoryUsage() const;
+
     /** sub container used only temporarily for iteration. */
     mutable RS_EntityContainer* subContainer = nullptr;
-private:
+
+    /**
+     * Notifications about changes of direct children which affect the drawing:
+     * added, removed or reordered children, or children with changed geometry
+     * detected by the spatial index. Documents use them to track changed areas.
+     */
+    virtual void childChanged([[maybe_unused]] const RS_Entity* child) const {}
+    /**
+     * @brief childAreaChanged - the area given by two corners was changed, invalid
+     *        corners mean the change can't be bounded
+     */
+    virtual void childAreaChanged([[maybe_unused]] const RS_Vector& corner1, [[maybe_unused]] const RS_Vector& corner2) const {}
+    /**
+     * Notifications about membership of direct children, used by documents to keep
+     * their indices of children up to date.
+     */
+    virtual void childAdded([[maybe_unused]] RS_Entity* child) {}
+    virtual void childRemoved([[maybe_unused]] RS_Entity* child) {}
+    virtual void childrenCleared() {}
+    /**
+     * Containers which may postpone creation of their entities (e.g. inserts, which create copies of
+     * the block only if they are really needed) mark them as deferred. Entities are created by
+     * createDeferredEntities(), see prepareEntities().
+     */
+    void setEntitiesDeferred(bool deferred) {m_entitiesDeferred = deferred;}
+    /**
+     * Creates deferred entities of the container and resets the deferred state.
+     */
+    virtual void createDeferredEntities() {m_entitiesDeferred = false;}
+    /**
+     * @return the container deferred entities are created from. Updates requested for the entities
+     *         (e.g. of dimensions) are applied to it, while the entities are not created.
+     */
+    virtual RS_EntityContainer* getDeferredEntitiesSource() const {return nullptr;}
+    /**
+     * @return number of the deferred entities, as created by createDeferredEntities()
+     */
+    virtual unsigned countDeferredEntities() const;
+    /**
+     * @return cache of intersection points used by getNearestIntersection(), nullptr if
+     *         intersections are not cached. Documents keep one in sync with their changes.
+     */
+    virtual LC_IntersectionCache* intersectionCache() const;
+    /**
+     * @return set of selected children used by getSelectionCandidates(), nullptr if the selection
+     *         is not tracked. Documents keep one in sync with selection changes.
+     */
+    virtual LC_SelectionSet* selectionSet() const;
+    /**
+     * Saves the geometry of the entities of the container into the geometry of the container,
+     * see RS_Entity::saveGeometry().
+     * @return false if some entity doesn't support it
+     */
+    bool saveEntitiesGeometry(LC_EntityGeometry& geometry) const;
+    void restoreEntitiesGeometry(const LC_EntityGeometry& geometry);
 /**
  * @brief ignoredSnap whether snapping is ignored
  * @return true when entity of this container won't be considered for snapping points
  */
     bool ignoredSnap() const;
+private:
+    /**
+     * @brief spatialIndex - the spatial index of the children, built on demand for large documents
+     * @return nullptr, if no index is used for the container
+     */
+    LC_SpatialIndex* spatialIndex() const;
+    // selects visible entities within or crossing the window, which pass the type filter
+    void selectInWindow(const std::function<bool(const RS_Entity*)>& typeFilter,
+                        const RS_Vector& v1, const RS_Vector& v2, bool select, bool cross);
+    // children which may hold entities intersecting the given one
+    std::vector<RS_Entity*> getIntersectionCandidates(const RS_Entity& entity) const;
+    // adds the child at the given position to the spatial index and notifies about it
+    void entityAdded(int index);
+    // removes the child from the spatial index and notifies about it
+    void entityRemoved(RS_Entity* entity);
+    // whether the entity touches the borders of the container, so its removal may shrink them
+    bool isOnBorders(const RS_Entity* entity) const;
+    void updateBordersAfterRemoval();
+    void resetSpatialIndex();
+    // reports a caller accessing deferred entities without prepareEntities()
+    void checkEntitiesPrepared();
+    // reports a read-only caller iterating deferred entities instead of visiting them
+    void checkEntitiesCreated() const;
+    // position of the child in m_entities, -1 if it isn't a child
+    int positionOf(const RS_Entity* entity) const;
+    // positions of children from the given one on are outdated
+    void positionsChanged(int from) const;
+    // marks the box of a child as outdated, if its borders differ from the given ones
+    void invalidateSpatialIndex(const RS_Entity* entity, const RS_Vector& oldMin, const RS_Vector& oldMax);
+    // notifies about in-place geometry changes detected by the spatial index
+    void indexedBoxChanged(RS_Entity* entity, const RS_Vector& oldCorner1, const RS_Vector& oldCorner2) const;
 
     /** m_entities in the container */
     QList<RS_Entity *> m_entities;
@@ -309,8 +539,22 @@ private:
      * are added or removed.
      */
     bool m_autoUpdateBorders = true;
+    /** removals don't recalculate borders, see setBordersUpdateDeferred() */
+    bool m_bordersUpdateDeferred = false;
+    /** borders may be larger than the entities, as removals were deferred */
+    bool m_bordersOutdated = false;
     mutable int entIdx = 0;
     bool autoDelete = false;
+    /** bounding box index of m_entities, used for nearest entity queries */
+    mutable std::unique_ptr<LC_SpatialIndex> m_spatialIndex;
+    /** entities are not created yet, see prepareEntities() */
+    bool m_entitiesDeferred = false;
+    /**
+     * positions of m_entities, built on demand for containers with many entities. Positions
+     * before m_positionsIndexed are exact, the others are indexed again when looked up.
+     */
+    mutable std::unordered_map<const RS_Entity*, int> m_positions;
+    mutable int m_positionsIndexed = 0;
 };
 
 #endif
@@ -0,0 +1,137 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD (librecad.org)
+**
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "lc_endpointindex.h"
+#include "rs_line.h"
+
+namespace {
+using Entities = std::vector<RS_Entity*>;
+}
+
+TEST_CASE("LC_EndpointIndex::insert") {
+    LC_EndpointIndex index{0.5};
+    REQUIRE(index.isEmpty());
+
+    RS_Line first{nullptr, {0., 0.}, {10., 0.}};
+    RS_Line second{nullptr, {10., 0.}, {10., 10.}};
+    RS_Line third{nullptr, {10., 10.}, {0., 0.}};
+    index.insert(&second);
+    index.insert(&first);
+    index.insert(&third);
+    index.insert(nullptr);
+    REQUIRE_FALSE(index.isEmpty());
+    REQUIRE(index.contains(&first));
+
+    // entities are found by both end points, in the order of insertion
+    REQUIRE(index.entitiesAt({10., 0.}) == Entities{&second, &first});
+    REQUIRE(index.entitiesAt({0., 0.}) == Entities{&first, &third});
+    REQUIRE(index.entitiesAt({10., 10.}) == Entities{&second, &third});
+
+    // middle points are not indexed
+    REQUIRE(index.entitiesAt({5., 0.}).empty());
+    REQUIRE(index.entitiesAt(RS_Vector{false}).empty());
+
+    // inserting again moves the entity to the end of the order
+    index.insert(&second);
+    REQUIRE(index.entitiesAt({10., 0.}) == Entities{&first, &second});
+
+    // an entity with both end points in one cell is reported once
+    RS_Line shortLine{nullptr, {20., 20.}, {20.1, 20.}};
+    index.insert(&shortLine);
+    REQUIRE(index.entitiesAt({20.05, 20.}) == Entities{&shortLine});
+}
+
+TEST_CASE("LC_EndpointIndex::entitiesAt tolerance") {
+    const double tolerance = 1.;
+    LC_EndpointIndex index{tolerance};
+    // the end point is at the upper border of its cell
+    RS_Line line{nullptr, {0.99, 0.99}, {-5., -5.}};
+    index.insert(&line);
+
+    // points closer than the tolerance are found in the neighbouring cells
+    REQUIRE(index.entitiesAt({1.01, 1.01}) == Entities{&line});
+    REQUIRE(index.entitiesAt({1.5, 0.99}) == Entities{&line});
+    REQUIRE(index.entitiesAt({0.99, 0.}) == Entities{&line});
+    // the distance is compared, not the cells
+    REQUIRE(index.entitiesAt({1.8, 1.8}).empty());
+    REQUIRE(index.entitiesAt({0.99, 1.995}).empty());
+    REQUIRE(index.entitiesAt({2.5, 0.99}).empty());
+
+    // negative coordinates are quantized the same way
+    REQUIRE(index.entitiesAt({-5.5, -5.}) == Entities{&line});
+    REQUIRE(index.entitiesAt({-3.9, -5.}).empty());
+}
+
+TEST_CASE("LC_EndpointIndex::remove") {
+    LC_EndpointIndex index{0.5};
+    RS_Line first{nullptr, {0., 0.}, {10., 0.}};
+    RS_Line second{nullptr, {0., 0.}, {0.1, 0.}};
+    index.insert(&first);
+    index.insert(&second);
+
+    index.remove(&first);
+    REQUIRE_FALSE(index.contains(&first));
+    REQUIRE(index.entitiesAt({10., 0.}).empty());
+    REQUIRE(index.entitiesAt({0., 0.}) == Entities{&second});
+
+    // removing twice or an entity not indexed changes nothing
+    index.remove(&first);
+    index.remove(nullptr);
+    REQUIRE(index.entitiesAt({0., 0.}) == Entities{&second});
+
+    // both entries of an entity with both end points in one cell are removed
+    index.remove(&second);
+    REQUIRE(index.entitiesAt({0., 0.}).empty());
+    REQUIRE(index.isEmpty());
+}
+
+TEST_CASE("LC_EndpointIndex::insert after move") {
+    LC_EndpointIndex index{0.5};
+    RS_Line line{nullptr, {0., 0.}, {10., 0.}};
+    RS_Line other{nullptr, {10., 0.}, {10., 10.}};
+    index.insert(&line);
+    index.insert(&other);
+
+    // end points are taken on insertion, moved entities are found where they were indexed
+    line.move({100., 50.});
+    REQUIRE(index.entitiesAt({0., 0.}) == Entities{&line});
+    REQUIRE(index.entitiesAt({100., 50.}).empty());
+
+    // inserting again moves the end points to their new cells
+    index.insert(&line);
+    REQUIRE(index.entitiesAt({0., 0.}).empty());
+    REQUIRE(index.entitiesAt({10., 0.}) == Entities{&other});
+    REQUIRE(index.entitiesAt({100., 50.}) == Entities{&line});
+    REQUIRE(index.entitiesAt({110., 50.}) == Entities{&line});
+
+    // a move within the tolerance keeps the entity found around its previous position
+    line.move({0.3, 0.});
+    index.insert(&line);
+    REQUIRE(index.entitiesAt({100., 50.}) == Entities{&line});
+    REQUIRE(index.entitiesAt({99.7, 50.}).empty());
+}
@@ -0,0 +1,110 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD (librecad.org)
+**
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "rs_entitycontainer.h"
+#include "rs_line.h"
+
+namespace {
+RS_Line* createLine(RS_EntityContainer* parent, int i) {
+    return new RS_Line{parent, {double(i), 0.}, {double(i), 1.}};
+}
+
+// positions found are the positions in the list
+void requirePositions(RS_EntityContainer& container) {
+    for (unsigned i = 0; i < container.count(); i++) {
+        REQUIRE(container.findEntityIndex(container.entityAt(i)) == int(i));
+    }
+}
+}
+
+TEST_CASE("RS_EntityContainer::findEntity") {
+    // large enough for the positions to be indexed
+    const int entityCount = 100;
+    RS_EntityContainer container{nullptr, true};
+    for (int i = 0; i < entityCount; i++) {
+        container.addEntity(createLine(&container, i));
+    }
+    requirePositions(container);
+
+    RS_Line other{nullptr, {0., 0.}, {1., 1.}};
+    REQUIRE(container.findEntity(&other) == -1);
+    REQUIRE_FALSE(container.removeEntity(&other));
+
+    SECTION("removal") {
+        RS_Entity* removed = container.entityAt(10);
+        RS_Entity* next = container.entityAt(11);
+        REQUIRE(container.removeEntity(removed));
+        REQUIRE(container.count() == entityCount - 1);
+        REQUIRE(container.findEntity(next) == 10);
+        requirePositions(container);
+        REQUIRE(container.removeEntity(container.entityAt(container.count() - 1)));
+        requirePositions(container);
+    }
+    SECTION("insertion") {
+        RS_Entity* line = createLine(&container, -1);
+        container.insertEntity(50, line);
+        REQUIRE(container.findEntity(line) == 50);
+        requirePositions(container);
+        container.prependEntity(createLine(&container, -2));
+        REQUIRE(container.findEntity(line) == 51);
+        requirePositions(container);
+    }
+    SECTION("replacement") {
+        RS_Entity* replacement = createLine(&container, -1);
+        container.setEntityAt(20, replacement);
+        REQUIRE(container.findEntity(replacement) == 20);
+        REQUIRE(container.count() == entityCount);
+        requirePositions(container);
+    }
+    SECTION("batch removal and insertion") {
+        std::vector<RS_Entity*> taken{container.entityAt(5), container.entityAt(70), container.entityAt(6)};
+        std::vector<int> positions = container.takeEntities(taken);
+        REQUIRE(positions == std::vector<int>{5, 70, 6});
+        REQUIRE(container.findEntity(taken[1]) == -1);
+        requirePositions(container);
+
+        container.insertEntities({{5, taken[0]}, {6, taken[2]}, {70, taken[1]}});
+        REQUIRE(container.findEntity(taken[0]) == 5);
+        REQUIRE(container.findEntity(taken[1]) == 70);
+        requirePositions(container);
+    }
+    SECTION("reverted order") {
+        RS_Entity* first = container.entityAt(0);
+        container.revertDirection();
+        REQUIRE(container.findEntity(first) == entityCount - 1);
+        requirePositions(container);
+    }
+    SECTION("removal down to a few entities") {
+        while (container.count() > 3) {
+            REQUIRE(container.removeEntity(container.entityAt(1)));
+        }
+        requirePositions(container);
+        container.clear();
+        REQUIRE(container.findEntity(&other) == -1);
+    }
+}
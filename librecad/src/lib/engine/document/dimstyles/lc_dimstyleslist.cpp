@@ -34,13 +34,12 @@ LC_DimStylesList::~LC_DimStylesList() {
 }
 
 LC_DimStyle *LC_DimStylesList::findByName(const QString &name) const {
-    //
-    for (auto v: m_stylesList){
-        if (v->getName().compare(name, Qt::CaseInsensitive) == 0){
-            return v;
-        }
+    LC_DimStyle* result = m_nameIndex.findCaseInsensitive(name, m_stylesList);
+    // styles are renamed by style editors directly
+    if (result == nullptr && m_nameIndex.refresh(m_stylesList)) {
+        result = m_nameIndex.findCaseInsensitive(name, m_stylesList);
     }
-    return nullptr;
+    return result;
 }
 
 LC_DimStyle *LC_DimStylesList::findByBaseNameAndType(const QString &name, RS2::EntityType dimType) const {
@@ -118,6 +117,7 @@ LC_DimStyle* LC_DimStylesList::resolveByName(const QString& name, RS2::EntityTyp
 void LC_DimStylesList::addDimStyle(LC_DimStyle *style) {
     // fixme - sand - dims - check for duplicated name?
     m_stylesList.append(style);
+    m_nameIndex.insert(style);
     setModified(true);
 }
 
@@ -128,6 +128,7 @@ void LC_DimStylesList::deleteDimStyle([[maybe_unused]]QString &name) {
 
 void LC_DimStylesList::clear() {
     m_stylesList.clear();
+    m_nameIndex.clear();
     setModified(true);
 }
 
@@ -167,6 +168,7 @@ void LC_DimStylesList::replaceStyles(const QList<LC_DimStyle*>& list) {
     qDeleteAll(m_stylesList);
     m_stylesList.clear();
     m_stylesList.append(list);
+    m_nameIndex.rebuild(m_stylesList);
     mergeStyles();
     setModified(true);
 }
@@ -25,6 +25,7 @@
 
 #include <memory>
 #include <QList>
+#include "lc_nameindex.h"
 #include "rs.h"
 
 class LC_DimStyle;
@@ -52,6 +53,8 @@ protected:
     /** Flag set if the layer list was modified and not yet saved. */
     bool m_modified = false;
     QList<LC_DimStyle*> m_stylesList;
+    /** styles by name, mutable for const lookups */
+    mutable LC_NameIndex<LC_DimStyle> m_nameIndex;
     std::unique_ptr<LC_DimStyle> m_fallbackDimStyleFromVars;
 };
 
@@ -0,0 +1,57 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_ENTITYGEOMETRY_H
+#define LC_ENTITYGEOMETRY_H
+
+#include <memory>
+#include <vector>
+
+#include "rs_vector.h"
+
+/**
+ * Geometry of an entity saved by RS_Entity::saveGeometry(). It restores the entity exactly after it was
+ * moved, rotated or scaled in place, which reverting the transformation doesn't.
+ */
+class LC_EntityGeometry {
+public:
+    virtual ~LC_EntityGeometry() = default;
+
+    RS_Vector minV;
+    RS_Vector maxV;
+    /** geometry of the entities of a container, in the order of the entities */
+    std::vector<std::unique_ptr<LC_EntityGeometry>> entities;
+};
+
+/**
+ * Geometry of an entity kept as a copy of its data
+ */
+template <class Data>
+class LC_EntityGeometryData : public LC_EntityGeometry {
+public:
+    explicit LC_EntityGeometryData(const Data& data):
+        data{data} {
+    }
+
+    Data data;
+};
+
+#endif // LC_ENTITYGEOMETRY_H
@@ -279,6 +279,10 @@ RS_Entity *LC_Hyperbola::clone() const {
   return new LC_Hyperbola(*this);
 }
 
+std::size_t LC_Hyperbola::getMemoryUsage() const {
+    return sizeof(LC_Hyperbola);
+}
+
 RS_VectorSolutions LC_Hyperbola::getFoci() const {
   double e = std::sqrt(1.0 + data.ratio * data.ratio);
   RS_Vector vp = data.majorP * e;
@@ -92,6 +92,7 @@ public:
   bool createFromQuadratic(const std::vector<double> &coeffs);
 
   RS_Entity *clone() const override;
+  std::size_t getMemoryUsage() const override;
 
   RS2::EntityType rtti() const override { return RS2::EntityHyperbola; }
   bool isValid() const { return m_bValid; }
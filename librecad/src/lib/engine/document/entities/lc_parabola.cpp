@@ -23,6 +23,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "lc_parabola.h"
 
+#include "lc_entitygeometry.h"
 #include "rs_debug.h"
 #include "rs_information.h"
 #include "rs_line.h"
@@ -506,6 +507,15 @@ void LC_Parabola::scale(const RS_Vector& center, const RS_Vector& factor)
         point.scale(center, factor);
     update();
 }
+
+std::unique_ptr<LC_EntityGeometry> LC_Parabola::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<LC_ParabolaData>>(data);
+}
+
+void LC_Parabola::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<LC_ParabolaData>&>(geometry).data;
+    update();
+}
 void LC_Parabola::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2)
 {
     for(auto& point: data.m_controlPoints)
@@ -185,6 +185,9 @@ public:
      */
     std::unique_ptr<LC_Parabola> approximateOffset(double dist) const;
 
+protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
 private:
     // rotate a point around the parabola vertex so, the parabola is y= ax^2 + bx + c, with a > 0 after the
     // same rotation
@@ -26,6 +26,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include <QPainterPath>
 
+#include "lc_entitygeometry.h"
 #include "lc_quadratic.h"
 #include "rs_circle.h"
 #include "rs_information.h"
@@ -578,6 +579,10 @@ RS_Entity* LC_SplinePoints::clone() const
 	return l;
 }
 
+std::size_t LC_SplinePoints::getMemoryUsage() const {
+    return sizeof(LC_SplinePoints) + (data.splinePoints.capacity() + data.controlPoints.capacity()) * sizeof(RS_Vector);
+}
+
 void LC_SplinePoints::update()
 {
 	UpdateControlPoints();
@@ -1117,6 +1122,15 @@ void LC_SplinePoints::scale(const RS_Vector& center, const RS_Vector& factor){
     update();
 }
 
+std::unique_ptr<LC_EntityGeometry> LC_SplinePoints::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<LC_SplinePointsData>>(data);
+}
+
+void LC_SplinePoints::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<LC_SplinePointsData>&>(geometry).data;
+    update();
+}
+
 void LC_SplinePoints::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2){
     for(auto & v: data.splinePoints){
         v.mirror(axisPoint1, axisPoint2);
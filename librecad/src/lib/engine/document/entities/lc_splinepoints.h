@@ -85,6 +85,8 @@ private:
     LC_SplinePointsData data;
 
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
     /**
 * @return The length of the line.
 */
@@ -92,6 +94,7 @@ protected:
 public:
     LC_SplinePoints(RS_EntityContainer* parent, LC_SplinePointsData d);
     RS_Entity* clone() const override;
+    std::size_t getMemoryUsage() const override;
 
 /**	@return RS2::EntitySpline */
     RS2::EntityType rtti() const override;
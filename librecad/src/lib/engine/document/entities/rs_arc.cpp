@@ -29,6 +29,7 @@
 
 #include "rs_arc.h"
 
+#include "lc_entitygeometry.h"
 #include "lc_quadratic.h"
 #include "lc_rect.h"
 #include "rs_debug.h"
@@ -125,6 +126,10 @@ RS_Entity* RS_Arc::clone() const {
 	return a;
 }
 
+std::size_t RS_Arc::getMemoryUsage() const {
+    return sizeof(RS_Arc);
+}
+
 /**
  * Creates this arc from 3 given points which define the arc line.
  *
@@ -893,6 +898,15 @@ void RS_Arc::scale(const RS_Vector& center, const RS_Vector& factor) {
     calculateBorders();
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_Arc::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_ArcData>>(data);
+}
+
+void RS_Arc::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_ArcData>&>(geometry).data;
+    calculateBorders();
+}
+
 /**
      * @description:    Implementation of the Shear/Skew the entity
      *                  The shear transform is
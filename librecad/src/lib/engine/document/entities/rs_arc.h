@@ -78,6 +78,7 @@ public:
     RS_Arc(const RS_ArcData& d);
 
     RS_Entity* clone() const override;
+    std::size_t getMemoryUsage() const override;
 
     /**	@return RS2::EntityArc */
     RS2::EntityType rtti() const override
@@ -278,6 +279,8 @@ m0 x + m1 y + m2 =0
 
     void updateMiddlePoint();
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
     RS_ArcData data{};
 private:
     // cached values for performance
@@ -31,6 +31,7 @@
 
 #include <QPainterPath>
 
+#include "lc_entitygeometry.h"
 #include "lc_quadratic.h"
 
 #include "rs_circle.h"
@@ -108,6 +109,10 @@ RS_Entity* RS_Circle::clone() const {
     return c;
 }
 
+std::size_t RS_Circle::getMemoryUsage() const {
+    return sizeof(RS_Circle);
+}
+
 void RS_Circle::calculateBorders() {
     RS_Vector r{data.radius, data.radius};
     minV = data.center - r;
@@ -781,6 +786,15 @@ void RS_Circle::scale(const RS_Vector& center, const RS_Vector& factor) {
     scaleBorders(center,factor);
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_Circle::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_CircleData>>(data);
+}
+
+void RS_Circle::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_CircleData>&>(geometry).data;
+    calculateBorders();
+}
+
 double RS_Circle::getDirection1() const{
 		return M_PI_2;
 }
@@ -63,6 +63,7 @@ public:
 	~RS_Circle() = default;
 
 	RS_Entity* clone() const override;
+	std::size_t getMemoryUsage() const override;
 
     /**	@return RS2::EntityCircle */
     RS2::EntityType rtti() const override{
@@ -203,6 +204,8 @@ m0 x + m1 y + m2 =0
     void calculateBorders() override;
 
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
     RS_CircleData data;
     void updateLength() override;
 };
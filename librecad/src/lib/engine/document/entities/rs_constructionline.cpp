@@ -27,6 +27,7 @@
 
 #include "rs_constructionline.h"
 
+#include "lc_entitygeometry.h"
 #include "lc_quadratic.h"
 #include "rs_debug.h"
 #include "rs_math.h"
@@ -68,6 +69,10 @@ RS_Entity* RS_ConstructionLine::clone() const {
     return c;
 }
 
+std::size_t RS_ConstructionLine::getMemoryUsage() const {
+    return sizeof(RS_ConstructionLine);
+}
+
 void RS_ConstructionLine::calculateBorders() {
     minV = RS_Vector::minimum(data.point1, data.point2);
     maxV = RS_Vector::maximum(data.point1, data.point2);
@@ -259,6 +264,15 @@ void RS_ConstructionLine::scale(const RS_Vector& center, const RS_Vector& factor
     //calculateBorders();
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_ConstructionLine::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_ConstructionLineData>>(data);
+}
+
+void RS_ConstructionLine::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_ConstructionLineData>&>(geometry).data;
+    calculateBorders();
+}
+
 void RS_ConstructionLine::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
     data.point1.mirror(axisPoint1, axisPoint2);
     data.point2.mirror(axisPoint1, axisPoint2);
@@ -61,6 +61,7 @@ public:
     RS_ConstructionLine(const RS_Vector& point1, const RS_Vector& point2);
 
      RS_Entity* clone() const override;
+     std::size_t getMemoryUsage() const override;
 
 	virtual ~RS_ConstructionLine()=default;
 
@@ -128,6 +129,9 @@ m0 x + m1 y + m2 =0
 
 
 
+protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
 private:
     RS_ConstructionLineData data{};
 };
@@ -293,27 +293,30 @@ RS_VectorSolutions RS_Dimension::getIntersectionsLineContainer(
 
     // Find all intersections, including those beyond limits of container
     // entities.
-    for (RS_Entity* e : *c) {
+    // entities are visited, as the container may defer them
+    c->visitEntities([&](RS_Entity* e) {
         solutions_initial.push_back(RS_Information::getIntersection(l, e, false));
-    }
+        return true;
+    });
 
     // Filter solutions based on whether they are actually on any entities.
     for (const RS_Vector& vp : solutions_initial) {
-        for (RS_Entity* e : *c) {
+        c->visitEntities([&](RS_Entity* e) {
             if (e->isConstruction(true) || e->isPointOnEntity(vp, tol)) {
                 // the intersection is at least on the container, now check the line:
                 if (infiniteLine) {
                     // The line is treated as infinitely long so we don't need to
                     // check if the intersection is on the line.
                     solutions_filtered.push_back(vp);
-                    break;
+                    return false;
                 }
                 else if (l->isConstruction(true) || l->isPointOnEntity(vp, tol)) {
                     solutions_filtered.push_back(vp);
-                    break;
+                    return false;
                 }
             }
-        }
+            return true;
+        });
     }
 
     /**
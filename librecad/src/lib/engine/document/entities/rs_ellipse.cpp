@@ -28,6 +28,7 @@
 #include <QPainterPath>
 #include "rs_ellipse.h"
 
+#include "lc_entitygeometry.h"
 #include "lc_quadratic.h"
 #include "lc_rect.h"
 #include "rs_circle.h"
@@ -241,6 +242,10 @@ RS_Entity* RS_Ellipse::clone() const {
 	return e;
 }
 
+std::size_t RS_Ellipse::getMemoryUsage() const {
+    return sizeof(RS_Ellipse);
+}
+
 /**
  * Calculates the boundary box of this ellipse.
   * @author Dongxu Li
@@ -1512,6 +1517,15 @@ void RS_Ellipse::scale(const RS_Vector& center, const RS_Vector& factor) {
 
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_Ellipse::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_EllipseData>>(data);
+}
+
+void RS_Ellipse::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_EllipseData>&>(geometry).data;
+    calculateBorders();
+}
+
 /**
  * @author{Dongxu Li}
  */
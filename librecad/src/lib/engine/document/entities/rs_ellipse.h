@@ -83,6 +83,7 @@ public:
     RS_Ellipse(RS_EntityContainer* parent, const RS_EllipseData& d);
 
     RS_Entity* clone() const override;
+    std::size_t getMemoryUsage() const override;
 
     /**	@return RS2::EntityEllipse */
     RS2::EntityType rtti() const override{
@@ -260,6 +261,8 @@ a quadratic contains coefficients for quadratic:
     double areaLineIntegral() const override;
 
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
     RS_EllipseData data; // fixme - renderperf - cache major and minor radiuses!
     void updateLength() override;
 private:
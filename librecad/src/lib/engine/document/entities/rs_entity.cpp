@@ -26,16 +26,26 @@
 **********************************************************************/
 
 
+#include <array>
+#include <atomic>
 #include <iostream>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <QPolygon>
 #include <QString>
 
+#include "lc_entitygeometry.h"
 #include "rs_arc.h"
 #include "rs_block.h"
 #include "rs_circle.h"
+#include "rs_debug.h"
 #include "rs_ellipse.h"
 #include "rs_entity.h"
 #include "rs_graphic.h"
@@ -53,27 +63,180 @@
 #include "lc_quadratic.h"
 
 
-struct RS_Entity::Impl {
-    //! pen (attributes) for this entity
-    RS_Pen pen{};
-    std::map<QString, QString> varList;
+namespace {
+/**
+ * Distinct pens of entities. Drawings use few distinct pens, so entities keep the index of their
+ * pen in this table instead of the pen. Pens are stored in chunks which are never moved, and the
+ * chunks are published through atomic pointers, so pens of entities may be read by concurrent
+ * renderers without a lock while new pens are added (e.g. by temporary entities of a tile worker).
+ *
+ * Entries are counted by the entities using them. An entry no longer used is reused for the next
+ * new pen, so the table holds at most as many pens as are used at the same time.
+ */
+class PenTable {
+public:
+    static PenTable& instance() {
+        // never destroyed, entities may outlive static objects
+        static auto* table = new PenTable();
+        return *table;
+    }
+
+    const RS_Pen& pen(unsigned index) const {
+        return entry(index).pen;
+    }
+
+    /**
+     * @return index of the pen, which is referenced once more until release()
+     */
+    unsigned acquire(const RS_Pen& pen) {
+        const size_t hash = hashOf(pen);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto range = m_indices.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (isSame(this->pen(it->second), pen)) {
+                acquire(it->second);
+                return it->second;
+            }
+        }
+        unsigned index = 0;
+        if (!m_freeIndices.empty()) {
+            index = m_freeIndices.back();
+            m_freeIndices.pop_back();
+        } else {
+            index = addEntry();
+        }
+        // an unused entry is read by no one
+        Entry& added = entry(index);
+        added.pen = pen;
+        added.references.store(1, std::memory_order_relaxed);
+        m_indices.emplace(hash, index);
+        return index;
+    }
+
+    /**
+     * References the pen of a copied entity once more
+     */
+    void acquire(unsigned index) {
+        // the default pen of new entities is kept
+        if (index != 0) {
+            entry(index).references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void release(unsigned index) {
+        if (index == 0 || entry(index).references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // the pen may be found again before the lock is taken, or be released by another thread
+        Entry& released = entry(index);
+        if (released.references.load(std::memory_order_relaxed) != 0) {
+            return;
+        }
+        auto range = m_indices.equal_range(hashOf(released.pen));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == index) {
+                m_indices.erase(it);
+                m_freeIndices.push_back(index);
+                return;
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        RS_Pen pen;
+        std::atomic<unsigned> references{0};
+    };
+
+    // an index is split into the directory, the chunk in the directory and the pen in the chunk
+    static constexpr unsigned ChunkBits = 10;
+    static constexpr unsigned ChunkSize = 1u << ChunkBits;
+    static constexpr unsigned DirectoryBits = 11;
+    static constexpr unsigned DirectorySize = 1u << DirectoryBits;
+    static constexpr unsigned MaxDirectories = 1u << (32 - ChunkBits - DirectoryBits);
+    using Directory = std::array<std::atomic<Entry*>, DirectorySize>;
+
+    // the default pen has index 0, as for entities which are just created
+    PenTable() {
+        acquire(RS_Pen{});
+    }
+
+    Entry& entry(unsigned index) const {
+        const Directory* directory = m_directories[index >> (ChunkBits + DirectoryBits)].load(std::memory_order_acquire);
+        Entry* chunk = (*directory)[(index >> ChunkBits) & (DirectorySize - 1)].load(std::memory_order_acquire);
+        return chunk[index & (ChunkSize - 1)];
+    }
 
-    void fromOther(Impl* other) {
-        if (other != nullptr) {
-            pen = other->pen;
-            varList = other->varList;
+    // appends an entry, called with the lock held
+    unsigned addEntry() {
+        if (m_size > std::numeric_limits<unsigned>::max()) {
+            throw std::length_error("RS_Entity: too many distinct pens");
+        }
+        const auto index = static_cast<unsigned>(m_size++);
+        // the table is never destroyed, neither are its chunks
+        std::atomic<Directory*>& directory = m_directories[index >> (ChunkBits + DirectoryBits)];
+        if (directory.load(std::memory_order_relaxed) == nullptr) {
+            directory.store(new Directory(), std::memory_order_release);
+        }
+        std::atomic<Entry*>& chunk = (*directory.load(std::memory_order_relaxed))[(index >> ChunkBits) & (DirectorySize - 1)];
+        if (chunk.load(std::memory_order_relaxed) == nullptr) {
+            chunk.store(new Entry[ChunkSize], std::memory_order_release);
         }
+        return index;
+    }
+
+    // RS_Pen::operator==() compares drawing attributes only
+    static bool isSame(const RS_Pen& p1, const RS_Pen& p2) {
+        return p1 == p2 && p1.getFlags() == p2.getFlags() && p1.getAlpha() == p2.getAlpha()
+               && p1.getScreenWidth() == p2.getScreenWidth() && p1.dashOffset() == p2.dashOffset();
+    }
+
+    static size_t hashOf(const RS_Pen& pen) {
+        const RS_Color color = pen.getColor();
+        size_t hash = std::hash<unsigned>{}(color.rgba());
+        hash = hash * 31 + color.getFlags();
+        hash = hash * 31 + static_cast<size_t>(pen.getLineType());
+        hash = hash * 31 + static_cast<size_t>(pen.getWidth());
+        return hash * 31 + pen.getFlags();
     }
+
+    std::array<std::atomic<Directory*>, MaxDirectories> m_directories{};
+    unsigned long long m_size = 0;
+    std::unordered_multimap<size_t, unsigned> m_indices;
+    // entries no longer used by any entity
+    std::vector<unsigned> m_freeIndices;
+    std::mutex m_mutex;
 };
 
+/**
+ * User defined variables of entities which are not in a graphic
+ */
+LC_UserDefVars& detachedUserDefVars() {
+    // never destroyed, entities may outlive static objects
+    static auto* vars = new LC_UserDefVars();
+    return *vars;
+}
+
+// user defined variables of entities copied by concurrent tile renderers are copied too
+std::mutex& userDefVarsMutex() {
+    static auto* mutex = new std::mutex();
+    return *mutex;
+}
+
+// the variables of the graphic the entity is in
+LC_UserDefVars& userDefVarsOf(const RS_Graphic* graphic) {
+    return graphic != nullptr ? const_cast<RS_Graphic*>(graphic)->getUserDefVars() : detachedUserDefVars();
+}
+}
+
 /**
  * @param parent The parent entity of this entity.
  *               E.g. a line might have a graphic entity or
  *               a polyline entity as parent.
  */
 RS_Entity::RS_Entity(RS_EntityContainer *parent)
-    : parent{parent}
-    , m_pImpl{std::make_unique<Impl>()}{
+    : parent{parent}{
     init(true);
 }
 
@@ -89,21 +252,34 @@ RS_Entity::RS_Entity(const RS_Entity& other):
                                                , maxV {other.maxV}
                                                , m_layer {other.m_layer}
                                                , updateEnabled {other.updateEnabled}
-                                               , m_pImpl{std::make_unique<Impl>(*other.m_pImpl)}{
+                                               , m_penIndex{other.m_penIndex}{
+  PenTable::instance().acquire(m_penIndex);
   setFlag(RS2::FlagVisible);
   initId();
+  if (other.m_hasUserDefVars) {
+      copyUserDefVars(other);
+  }
 }
 
 RS_Entity& RS_Entity::operator = (const RS_Entity& other){
   if (this != &other) {
-    parent = other.parent;
+    setParent(other.parent);
     minV  = other.minV;
     maxV  = other.maxV;
     m_layer  = other.m_layer;
     updateEnabled = other.updateEnabled;
-    m_pImpl = std::make_unique<Impl>(*other.m_pImpl);
+    PenTable::instance().acquire(other.m_penIndex);
+    PenTable::instance().release(m_penIndex);
+    m_penIndex = other.m_penIndex;
     setFlag(RS2::FlagVisible);
     initId();
+    if (other.m_hasUserDefVars) {
+        copyUserDefVars(other);
+    } else if (m_hasUserDefVars) {
+        const std::lock_guard<std::mutex> lock{userDefVarsMutex()};
+        userDefVars().erase(m_id);
+        m_hasUserDefVars = false;
+    }
   }
   return *this;
 }
@@ -114,26 +290,48 @@ RS_Entity::RS_Entity(RS_Entity&& other):
                                           , maxV {other.maxV}
                                           , m_layer {other.m_layer}
                                           , updateEnabled {other.updateEnabled}
-                                          , m_pImpl{std::move(other.m_pImpl)}{
+                                          , m_hasUserDefVars{other.m_hasUserDefVars}
+                                          , m_penIndex{other.m_penIndex}
+                                          , m_id{other.m_id}{
   setFlag(RS2::FlagVisible);
   initId();
+  // the moved-from entity has no id, and the default pen
+  other.m_hasUserDefVars = false;
+  other.m_id = 0;
+  other.m_penIndex = 0;
 }
 
 RS_Entity& RS_Entity::operator = (RS_Entity&& other){
   if (this != &other) {
-    parent = other.parent;
+    setParent(other.parent);
     minV  = other.minV;
     maxV  = other.maxV;
     m_layer  = other.m_layer;
     updateEnabled = other.updateEnabled;
-    m_pImpl = std::move(other.m_pImpl);
+    PenTable::instance().release(m_penIndex);
+    m_penIndex = other.m_penIndex;
+    other.m_penIndex = 0;
+    if (m_hasUserDefVars) {
+        const std::lock_guard<std::mutex> lock{userDefVarsMutex()};
+        userDefVars().erase(m_id);
+    }
+    m_hasUserDefVars = other.m_hasUserDefVars;
+    m_id = other.m_id;
     setFlag(RS2::FlagVisible);
     initId();
+    other.m_hasUserDefVars = false;
+    other.m_id = 0;
   }
   return *this;
 }
 
-RS_Entity::~RS_Entity() = default;
+RS_Entity::~RS_Entity() {
+    PenTable::instance().release(m_penIndex);
+    if (m_hasUserDefVars) {
+        const std::lock_guard<std::mutex> lock{userDefVarsMutex()};
+        userDefVars().erase(m_id);
+    }
+}
 
 /**
  * Copy constructor.
@@ -153,9 +351,6 @@ RS_Entity::~RS_Entity() = default;
  * Initialisation. Called from all constructors.
  */
 void RS_Entity::init(bool setPenAndLayerToActive) {
-    if (m_pImpl == nullptr) {
-        m_pImpl = std::make_unique<Impl>();
-    }
     resetBorders();
     setFlag(RS2::FlagVisible);
     updateEnabled = true;
@@ -170,14 +365,74 @@ void RS_Entity::init(bool setPenAndLayerToActive) {
  * Gives this entity a new unique m_id.
  */
 void RS_Entity::initId() {
-    static unsigned long long idCounter=0;
+    // temporary entities are created by concurrent tile renderers too
+    static std::atomic<unsigned long long> idCounter{0};
+    unsigned long long oldId = m_id;
     m_id = ++idCounter;
+    if (m_hasUserDefVars) {
+        userDefVarsMoved(oldId);
+    }
+}
+
+void RS_Entity::userDefVarsMoved(unsigned long long oldId) {
+    const std::lock_guard<std::mutex> lock{userDefVarsMutex()};
+    auto& vars = userDefVars();
+    auto node = vars.extract(oldId);
+    if (!node.empty()) {
+        node.key() = m_id;
+        vars.insert(std::move(node));
+    }
+}
+
+LC_UserDefVars& RS_Entity::userDefVars() const {
+    return userDefVarsOf(getGraphic());
+}
+
+void RS_Entity::copyUserDefVars(const RS_Entity& other) {
+    const std::lock_guard<std::mutex> lock{userDefVarsMutex()};
+    const LC_UserDefVars& otherVars = other.userDefVars();
+    auto it = otherVars.find(other.m_id);
+    if (it != otherVars.end()) {
+        std::map<QString, QString> vars = it->second;
+        userDefVars()[m_id] = std::move(vars);
+        m_hasUserDefVars = true;
+    }
+}
+
+void RS_Entity::userDefVarsReparented(RS_EntityContainer* newParent) {
+    const std::lock_guard<std::mutex> lock{userDefVarsMutex()};
+    LC_UserDefVars& vars = userDefVars();
+    LC_UserDefVars& newVars = userDefVarsOf(newParent != nullptr ? newParent->getGraphic() : nullptr);
+    if (&vars != &newVars) {
+        auto node = vars.extract(m_id);
+        if (!node.empty()) {
+            newVars.insert(std::move(node));
+        }
+    }
+}
+
+/**
+ * Reparents this entity, user defined variables move to the graphic of the new parent.
+ */
+void RS_Entity::setParent(RS_EntityContainer* p) {
+    if (m_hasUserDefVars) {
+        userDefVarsReparented(p);
+    }
+    parent = p;
+}
+
+void RS_Entity::reparent(RS_EntityContainer* parent) {
+    setParent(parent);
 }
 
 RS_Entity *RS_Entity::cloneProxy() const {
     return clone();
 }
 
+std::size_t RS_Entity::getMemoryUsage() const {
+    return sizeof(RS_Entity);
+}
+
 /**
  * Resets the borders of this element.
  */
@@ -212,12 +467,24 @@ bool RS_Entity::setSelected(bool select) {
         return false;
     }
 
+    if (select == getFlag(RS2::FlagSelected)) {
+        return true;
+    }
+
     if (select) {
         setFlag(RS2::FlagSelected);
     } else {
         delFlag(RS2::FlagSelected);
     }
 
+    // selected entities are drawn differently and are tracked by the document, so report the change
+    RS_Entity* topLevel = this;
+    while (topLevel->parent != nullptr && !topLevel->parent->isDocument()) {
+        topLevel = topLevel->parent;
+    }
+    if (topLevel->parent != nullptr && !isDocument()) {
+        static_cast<RS_Document*>(topLevel->parent)->selectionChanged(topLevel, *this);
+    }
     return true;
 }
 
@@ -757,19 +1024,23 @@ RS_Layer* RS_Entity::getLayer(bool resolve) const {
  * Sets the layer of this entity to the layer with the given name
  */
 void RS_Entity::setLayer(const QString& name) {
+    RS_Layer* oldLayer = m_layer;
     RS_Graphic* graphic = getGraphic();
     if (graphic) {
         m_layer = graphic->findLayer(name);
     } else {
         m_layer = nullptr;
     }
+    notifyLayerChanged(oldLayer);
 }
 
 /**
  * Sets the layer of this entity to the layer given.
  */
 void RS_Entity::setLayer(RS_Layer* l) {
+    RS_Layer* oldLayer = m_layer;
     m_layer = l;
+    notifyLayerChanged(oldLayer);
 }
 
 /**
@@ -778,6 +1049,7 @@ void RS_Entity::setLayer(RS_Layer* l) {
  * of its parents) are in a graphic the layer is set to nullptr.
  */
 void RS_Entity::setLayerToActive() {
+    RS_Layer* oldLayer = m_layer;
     RS_Graphic* graphic = getGraphic();
 
     if (graphic) {
@@ -785,10 +1057,17 @@ void RS_Entity::setLayerToActive() {
     } else {
         m_layer = nullptr;
     }
+    notifyLayerChanged(oldLayer);
+}
+
+void RS_Entity::notifyLayerChanged(const RS_Layer* oldLayer) {
+    if (m_layer != oldLayer && parent != nullptr && parent->isDocument()) {
+        static_cast<RS_Document*>(parent)->layerChanged(this, oldLayer);
+    }
 }
 
 RS_Pen RS_Entity::getPenResolved() const {
-    RS_Pen p = m_pImpl->pen;
+    RS_Pen p = PenTable::instance().pen(m_penIndex);
     // use parental attributes (e.g. vertex of a polyline, block
     // entities when they are drawn in block documents):
     if (parent != nullptr && parent->rtti() != RS2::EntityGraphic) {
@@ -863,11 +1142,20 @@ RS_Pen RS_Entity::getPenResolved() const {
  * @return Pen for this entity.
  */
 RS_Pen RS_Entity::getPen(bool resolve) const {
-    return resolve ? getPenResolved() : m_pImpl->pen;
+    return resolve ? getPenResolved() : PenTable::instance().pen(m_penIndex);
 }
 
 void RS_Entity::setPen(const RS_Pen& pen) {
-    m_pImpl->pen = pen;
+    const unsigned penIndex = PenTable::instance().acquire(pen);
+    PenTable::instance().release(m_penIndex);
+    if (penIndex == m_penIndex) {
+        return;
+    }
+    m_penIndex = penIndex;
+    // the bounding box is kept, but the entity is drawn differently
+    if (parent != nullptr && parent->isDocument()) {
+        static_cast<RS_Document*>(parent)->markChanged(*this);
+    }
 }
 
 /**
@@ -878,7 +1166,7 @@ void RS_Entity::setPen(const RS_Pen& pen) {
 void RS_Entity::setPenToActive() {
     RS_Document* doc = getDocument();
     if (doc != nullptr) {
-        m_pImpl->pen = doc->getActivePen();
+        setPen(doc->getActivePen());
     } else {
         //RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Entity::setPenToActive(): "
         //                "No document / active pen linked to this entity.");
@@ -904,6 +1192,23 @@ void RS_Entity::stretch(const RS_Vector& firstCorner,
         move(offset);
     }
 }
+
+std::unique_ptr<LC_EntityGeometry> RS_Entity::saveGeometry() const {
+    std::unique_ptr<LC_EntityGeometry> geometry = doSaveGeometry();
+    if (geometry != nullptr) {
+        geometry->minV = minV;
+        geometry->maxV = maxV;
+    }
+    return geometry;
+}
+
+void RS_Entity::restoreGeometry(const LC_EntityGeometry& geometry) {
+    doRestoreGeometry(geometry);
+    // borders are not recalculated, moved borders may differ in the last bits
+    minV = geometry.minV;
+    maxV = geometry.maxV;
+}
+
 // fixme - sand - it seems  this method is   not used
 /**
  * @return Factor for scaling the line styles considering the current
@@ -958,8 +1263,17 @@ void RS_Entity::stretch(const RS_Vector& firstCorner,
  * @return User defined variable connected to this entity or nullptr if not found.
  */
 QString RS_Entity::getUserDefVar(const QString& key) const {
-    auto it=m_pImpl->varList.find(key);
-    return (it == m_pImpl->varList.end()) ? QString{} : it->second;
+    if (!m_hasUserDefVars) {
+        return QString{};
+    }
+    const std::lock_guard<std::mutex> lock{userDefVarsMutex()};
+    const LC_UserDefVars& vars = userDefVars();
+    auto varList = vars.find(m_id);
+    if (varList == vars.end()) {
+        return QString{};
+    }
+    auto it = varList->second.find(key);
+    return (it == varList->second.end()) ? QString{} : it->second;
 }
 
 /*
@@ -979,14 +1293,29 @@ RS_Vector RS_Entity::getNearestOrthTan(const RS_Vector& /*coord*/,
  * Add a user defined variable to this entity.
  */
 void RS_Entity::setUserDefVar(QString key, QString val) {
-    m_pImpl->varList.emplace(key, val);
+    const std::lock_guard<std::mutex> lock{userDefVarsMutex()};
+    userDefVars()[m_id].emplace(key, val);
+    m_hasUserDefVars = true;
 }
 
 /**
  * Deletes the given user defined variable.
  */
 void RS_Entity::delUserDefVar(QString key) {
-    m_pImpl->varList.erase(key);
+    if (!m_hasUserDefVars) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock{userDefVarsMutex()};
+    auto& vars = userDefVars();
+    auto it = vars.find(m_id);
+    if (it != vars.end()) {
+        it->second.erase(key);
+        if (!it->second.empty()) {
+            return;
+        }
+        vars.erase(it);
+    }
+    m_hasUserDefVars = false;
 }
 
 /**
@@ -994,7 +1323,16 @@ void RS_Entity::delUserDefVar(QString key) {
  */
 std::vector<QString> RS_Entity::getAllKeys() const{
     std::vector<QString> ret;
-    for(auto const& [key, val]: m_pImpl->varList){
+    if (!m_hasUserDefVars) {
+        return ret;
+    }
+    const std::lock_guard<std::mutex> lock{userDefVarsMutex()};
+    const LC_UserDefVars& vars = userDefVars();
+    auto varList = vars.find(m_id);
+    if (varList == vars.end()) {
+        return ret;
+    }
+    for(auto const& [key, val]: varList->second){
         ret.push_back(key);
     }
     return ret;
@@ -1082,12 +1420,12 @@ std::ostream& operator << (std::ostream& os, RS_Entity& e) {
         os << " layer address: " << e.m_layer << " ";
     }
 
-    os << e.m_pImpl->pen << "\n";
+    os << e.getPen(false) << "\n";
 
     os << "variable list:\n";
-    for(auto const& v: e.m_pImpl->varList){
-        os << v.first.toLatin1().data()<< ": "
-           << v.second.toLatin1().data()
+    for(auto const& key: e.getAllKeys()){
+        os << key.toLatin1().data()<< ": "
+           << e.getUserDefVar(key).toLatin1().data()
            << ", ";
     }
 
@@ -1145,5 +1483,13 @@ bool RS_Entity::isParentIgnoredOnModifications() const {
 
 unsigned long long RS_Entity::getId() const
 {
-    return m_pImpl != nullptr ? m_id : 0ULL;
+    return m_id;
+}
+
+void RS_Entity::restoreId(unsigned long long id) {
+    unsigned long long oldId = m_id;
+    m_id = id;
+    if (m_hasUserDefVars) {
+        userDefVarsMoved(oldId);
+    }
 }
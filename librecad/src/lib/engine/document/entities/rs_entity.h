@@ -28,6 +28,10 @@
 #ifndef RS_ENTITY_H
 #define RS_ENTITY_H
 
+#include <map>
+#include <memory>
+#include <unordered_map>
+
 #include <QString>
 
 #include "lc_drawable.h"
@@ -43,6 +47,13 @@ class RS_Block;
 class RS_Graphic;
 class RS_EntityContainer;
 class LC_Quadratic;
+class LC_EntityGeometry;
+
+/**
+ * User defined variables of entities by entity id, see RS_Entity::setUserDefVar(). Almost no entity
+ * has them, so each graphic keeps them aside of its entities.
+ */
+using LC_UserDefVars = std::unordered_map<unsigned long long, std::map<QString, QString>>;
 
 /**
  * Base class for an entity (line, arc, circle, ...)
@@ -62,10 +73,13 @@ public:
 
     virtual RS_Entity *clone() const = 0;
     virtual RS_Entity *cloneProxy() const;
+    /**
+     * @return estimated number of bytes held in memory by this entity, including
+     * owned children and dynamically allocated data
+     */
+    virtual std::size_t getMemoryUsage() const;
 
-    virtual void reparent(RS_EntityContainer *parent){
-        this->parent = parent;
-    }
+    virtual void reparent(RS_EntityContainer *parent);
 
     void resetBorders();
     void moveBorders(const RS_Vector &offset);
@@ -84,6 +98,11 @@ public:
      * @return Unique Id of this entity.
      */
     unsigned long long getId() const;
+    /**
+     * Gives this entity the id of an entity it replaces, e.g. an undone entity read back
+     * from a temporary file. The replaced entity is gone, so the id stays unique.
+     */
+    void restoreId(unsigned long long id);
 
     /**
      * This method must be overwritten in subclasses and return the
@@ -114,9 +133,7 @@ public:
     /**
      * Reparents this entity.
      */
-    void setParent(RS_EntityContainer *p){
-        parent = p;
-    }
+    void setParent(RS_EntityContainer *p);
     /** @return The center point (x) of this arc */
     //get center for entities arc, circle and ellipse
     virtual RS_Vector getCenter() const;
@@ -470,6 +487,18 @@ public:
         scale(RS_Vector(0., 0.), factor);
     }
 
+    /**
+     * Saves the geometry changed by move(), rotate() and scale(), so the entity transformed in place
+     * may be restored exactly, see LC_UndoableTransform.
+     * @return nullptr if entities of this type don't support it
+     */
+    std::unique_ptr<LC_EntityGeometry> saveGeometry() const;
+    /**
+     * Restores the geometry saved by saveGeometry(). The entity must not be modified otherwise
+     * in between, except by the transformations.
+     */
+    void restoreGeometry(const LC_EntityGeometry& geometry);
+
     /**
      * Implementations must mirror the entity by the given axis.
      */
@@ -600,12 +629,33 @@ protected:
     void init(bool setPenAndLayerToActive);
     void initId();
 
+    /**
+     * Implementations save and restore the geometry of the entity, borders are handled by
+     * saveGeometry() and restoreGeometry()
+     */
+    virtual std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const {
+        return nullptr;
+    }
+    virtual void doRestoreGeometry([[maybe_unused]] const LC_EntityGeometry& geometry) {}
+
 private:
+    // reports the change of layer of a top-level entity to its document
+    void notifyLayerChanged(const RS_Layer* oldLayer);
+
+    // moves user defined variables of the entity to its new id
+    void userDefVarsMoved(unsigned long long oldId);
+    // user defined variables of the graphic of the entity
+    LC_UserDefVars& userDefVars() const;
+    void copyUserDefVars(const RS_Entity& other);
+    // moves user defined variables of the entity to the graphic of its new parent
+    void userDefVarsReparented(RS_EntityContainer* newParent);
+
+    //! user defined variables are stored for this entity, see setUserDefVar()
+    bool m_hasUserDefVars = false;
+    //! index of the pen (attributes) of this entity in the table of distinct pens
+    unsigned m_penIndex = 0;
     //! Entity m_id
     unsigned long long m_id = 0;
-    // pImp to delay pulling in Qt headers
-    struct Impl;
-    std::unique_ptr<Impl> m_pImpl;
 };
 
 #endif
@@ -118,6 +118,10 @@ RS_Entity* RS_Hatch::clone() const {
     return cloneHatch;
 }
 
+std::size_t RS_Hatch::getMemoryUsage() const {
+    return sizeof(RS_Hatch) + getEntitiesMemoryUsage();
+}
+
 /**
  * Validates the hatch boundaries by optimizing them into ordered loops and subcontainers.
  * This step is crucial for both solid and pattern hatches to ensure valid contours.
@@ -272,6 +276,7 @@ void RS_Hatch::update() {
         updateSolidHatch(layer, pen);
     } else {
         updatePatternHatch(layer, pen);
+        updatePatternSelection();
     }
 
     // Compute total area from loops
@@ -386,6 +391,31 @@ void RS_Hatch::updatePatternHatch(RS_Layer* layer, const RS_Pen& pen) {
                     addedCount);
 }
 
+/**
+ * Pattern lines are drawn with the selection state of the hatch, so they follow it
+ * here instead of while drawing.
+ */
+bool RS_Hatch::setSelected(bool select) {
+    if (!RS_EntityContainer::setSelected(select)) {
+        return false;
+    }
+    updatePatternSelection();
+    return true;
+}
+
+/**
+ * Helper: Sets the selection state of the hatch to its pattern lines.
+ */
+void RS_Hatch::updatePatternSelection() {
+    const bool selected = isSelected();
+    for (RS_Entity* subEntity : *this) {
+        if (subEntity && !subEntity->isContainer() && subEntity->getFlag(RS2::FlagHatchChild)
+            && subEntity->isSelected() != selected) {
+            subEntity->setSelected(selected);
+        }
+    }
+}
+
 /**
  * Toggles visibility of boundary contour entities in subcontainers.
  * Used during border calculation or for debugging.
@@ -445,15 +475,17 @@ void RS_Hatch::drawSolidFill(RS_Painter* painter) {
     fillBrush.setStyle(Qt::SolidPattern);
 
     painter->setBrush(fillBrush);
-    // Transform loops into painter paths
-    m_solidPath->clear();
+    // Transform loops into painter paths. Paths depend on the painter, so they are local:
+    // the same hatch may be drawn by several painters at once (tiles rendered concurrently)
+    std::vector<QPainterPath> solidPaths;
+    solidPaths.reserve(m_orderedLoops->size());
     std::transform(m_orderedLoops->begin(), m_orderedLoops->end(),
-                   std::back_inserter(*m_solidPath),
+                   std::back_inserter(solidPaths),
                    [painter](const LC_LoopUtils::LC_Loops& loop) {
                      return loop.getPainterPath(painter);
                    });
 
-    for (const QPainterPath& path : *m_solidPath) {
+    for (const QPainterPath& path : solidPaths) {
         painter->drawPath(path);
     }
 
@@ -466,11 +498,11 @@ void RS_Hatch::drawSolidFill(RS_Painter* painter) {
  * Skips subcontainers (boundaries).
  */
 void RS_Hatch::drawPatternLines(RS_Painter* painter) const {
-    const bool selected = isSelected();
+    // drawing is read-only (tiles may be drawn concurrently), the selection of pattern
+    // lines is kept by setSelected() and update()
     for (RS_Entity* subEntity : *this) {
         // Draw only direct atomic children with FlagHatchChild (patterns); skip subcontainers
         if (subEntity && !subEntity->isContainer() && subEntity->getFlag(RS2::FlagHatchChild)) {
-            subEntity->setSelected(selected);
             painter->drawEntity(subEntity);
         }
     }
@@ -91,6 +91,7 @@ public:
     RS_Hatch(RS_EntityContainer* parent, const RS_HatchData& d);
 
     RS_Entity* clone() const override;
+    std::size_t getMemoryUsage() const override;
 
     /** @return RS2::EntityHatch */
     RS2::EntityType rtti() const override { return RS2::EntityHatch; }
@@ -134,6 +135,7 @@ public:
 
     void calculateBorders() override;
     void update() override;
+    bool setSelected(bool select = true) override;
 
     /**
      * @return Last update error code.
@@ -175,6 +177,7 @@ private:
     void drawPatternLines(RS_Painter* painter) const;
     void drawSolidFill(RS_Painter* painter);
     void updatePatternHatch(RS_Layer* layer, const RS_Pen& pen);
+    void updatePatternSelection();
     void updateSolidHatch(RS_Layer* layer, const RS_Pen& pen);
     void prepareUpdate();
 
@@ -28,6 +28,7 @@
 #include <QDir>
 #include <QFileInfo>
 
+#include "lc_entitygeometry.h"
 #include "qc_applicationwindow.h"
 #include "rs_debug.h"
 #include "rs_entitycontainer.h"
@@ -114,6 +115,10 @@ RS_Entity* RS_Image::clone() const {
     return i;
 }
 
+std::size_t RS_Image::getMemoryUsage() const {
+    return sizeof(RS_Image);
+}
+
 void RS_Image::updateData(RS_Vector size, RS_Vector Uv, RS_Vector Vv) {
     data.size = size;
     data.uVector = Uv;
@@ -359,6 +364,15 @@ void RS_Image::scale(const RS_Vector& center, const RS_Vector& factor) {
     calculateBorders();
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_Image::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_ImageData>>(data);
+}
+
+void RS_Image::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_ImageData>&>(geometry).data;
+    calculateBorders();
+}
+
 void RS_Image::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
     data.insertionPoint.mirror(axisPoint1, axisPoint2);
     RS_Vector vp0(0.,0.);
@@ -81,6 +81,7 @@ public:
             const RS_ImageData& d);
 
     RS_Entity* clone() const override;
+    std::size_t getMemoryUsage() const override;
 
     RS_Entity *cloneProxy() const override;
 
@@ -213,6 +214,8 @@ public:
     void moveRef(const RS_Vector &vector, const RS_Vector &rsVector) override;
 
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
 // whether the point is within image
     bool containsPoint(const RS_Vector& coord) const;
     RS_ImageData data;
@@ -26,8 +26,11 @@
 
 #include "rs_insert.h"
 
+#include <algorithm>
+#include <cmath>
 #include<iostream>
 
+#include "lc_entitygeometry.h"
 #include "rs_arc.h"
 #include "rs_block.h"
 #include "rs_circle.h"
@@ -37,6 +40,7 @@
 #include "rs_graphic.h"
 #include "rs_layer.h"
 #include "rs_math.h"
+#include "rs_painter.h"
 #include "rs_pen.h"
 
 class RS_Circle;
@@ -67,6 +71,21 @@ RS_Pen updatePen(RS_Pen&& pen, const RS_Pen& blockPen) {
     return pen;
 }
 
+/**
+ * Pen of the copy of the entity of the block made by the insert with the given pen,
+ * before the attributes set by layer are resolved
+ */
+RS_Pen getBlockPen(const RS_Entity* e, const RS_Pen& insertPen) {
+    const RS_EntityContainer* parent = e->getParent();
+    RS_Pen parentPen = (parent == nullptr || parent->rtti() == RS2::EntityBlock)
+                           ? insertPen : getBlockPen(parent, insertPen);
+    RS_Pen pen = e->getPen(false);
+    if (!pen.isValid()) {
+        return parentPen;
+    }
+    return updatePen(std::move(pen), parentPen);
+}
+
 }
 RS_InsertData::RS_InsertData(const QString& _name,
 							 RS_Vector _insertionPoint,
@@ -124,6 +143,10 @@ RS_Entity* RS_Insert::clone() const{
 	return i;
 }
 
+std::size_t RS_Insert::getMemoryUsage() const {
+    return sizeof(RS_Insert) + getEntitiesMemoryUsage();
+}
+
 /**
  * Updates the entity buffer of this insert entity. This method
  * needs to be called whenever the block this insert is based on changes.
@@ -161,107 +184,560 @@ void RS_Insert::update() {
                     m_data.cols, m_data.rows);
     RS_DEBUG->print("RS_Insert::update: block has %d entities",
                     blk->count());
-        for(auto* e: *blk){
-            for (int c=0; c<m_data.cols; ++c) {
-//            RS_DEBUG->print("RS_Insert::update: col %d", c);
-                for (int r=0; r<m_data.rows; ++r) {
-//                i_en_counts++;
-//                RS_DEBUG->print("RS_Insert::update: row %d", r);
-                    // fixme - sand - this is quick fix for #2177 - yet it's necessary to check why undone entity is in block?
-                    if (e->isUndone()) {
-                        continue;
-                    }
-                    if (e->rtti()==RS2::EntityInsert &&
-                            m_data.updateMode!=RS2::PreviewUpdate) {
 
-//                                        RS_DEBUG->print("RS_Insert::update: updating sub-insert");
-                        e->update();
+    if (isInstanced() && !blk->isEmpty()) {
+        // the block is drawn as instances, copies of its entities are created on demand
+        for (RS_Entity* e: *blk) {
+            if (!e->isUndone() && e->rtti() == RS2::EntityInsert) {
+                e->update();
+            }
+        }
+        setEntitiesDeferred(true);
+    } else {
+        createEntities(blk);
+    }
+    calculateBorders();
+
+    RS_DEBUG->print("RS_Insert::update: OK");
+}
+
+bool RS_Insert::isInstanced() const {
+    const double scale = m_data.scaleFactor.x;
+    return m_data.updateMode != RS2::PreviewUpdate && scale > 0.
+           && std::abs(scale - m_data.scaleFactor.y) <= RS_TOLERANCE * scale;
+}
+
+void RS_Insert::createDeferredEntities() {
+    setEntitiesDeferred(false);
+    RS_Block* blk = getBlockForInsert();
+    if (blk != nullptr) {
+        createEntities(blk);
+        calculateBorders();
+    }
+}
+
+RS_EntityContainer* RS_Insert::getDeferredEntitiesSource() const {
+    return getBlockForInsert();
+}
+
+unsigned RS_Insert::countDeferredEntities() const {
+    const RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr) {
+        return 0;
+    }
+    const auto entities = std::count_if(blk->cbegin(), blk->cend(), [](const RS_Entity* e) {
+        return !e->isUndone();
+    });
+    return static_cast<unsigned>(entities) * m_data.cols * m_data.rows;
+}
+
+/**
+ * Creates copies of the entities of the block transformed by the insert.
+ */
+void RS_Insert::createEntities(RS_Block* blk) {
+    for (auto* e: *blk) {
+        // undone entities of the undo history are kept out of the block, see RS_Document, but
+        // entities undone without an undo cycle, e.g. by RS_Graphic::removeLayer(), are still there (#2177)
+        if (e->isUndone()) {
+            continue;
+        }
+        for (int c=0; c<m_data.cols; ++c) {
+            for (int r=0; r<m_data.rows; ++r) {
+                if (e->rtti()==RS2::EntityInsert &&
+                        m_data.updateMode!=RS2::PreviewUpdate) {
+                    e->update();
                 }
+                appendEntity(createInstanceEntity(*blk, *e, c, r, this));
+            }
+        }
+    }
+}
 
-//                                RS_DEBUG->print("RS_Insert::update: cloning entity");
-
-                    RS_Entity* ne = nullptr;
-                    if ( (m_data.scaleFactor.x - m_data.scaleFactor.y)>MIN_Scale_Factor) {
-                        if (e->rtti()== RS2::EntityArc) {
-                            auto a= static_cast<RS_Arc*>(e);
-                            ne = new RS_Ellipse{this,
-                            {a->getCenter(), {a->getRadius(), 0.},
-                                    1, a->getAngle1(), a->getAngle2(),
-                                    a->isReversed()}};
-                            ne->setLayer(e->getLayer());
-                            ne->setPen(e->getPen(false));
-                        } else if (e->rtti()== RS2::EntityCircle) {
-                            auto a= static_cast<RS_Circle*>(e);
-                            ne = new RS_Ellipse{this,
-                            { a->getCenter(), {a->getRadius(), 0.}, 1, 0., 2.*M_PI, false}};
-                            ne->setLayer(e->getLayer());
-                            ne->setPen(e->getPen(false));
-                        } else {
-                            ne = e->clone();
-                        }
-                    } else {
-                        ne = e->clone();
-                    }
-                    ne->setUpdateEnabled(false);
-                // if entity layer are 0 set to insert layer to allow "1 layer control" bug ID #3602152
-                    RS_Layer *l= ne->getLayer();//special fontchar block don't have
-                    if (l != nullptr  && ne->getLayer()->getName() == "0")
-                    ne->setLayer(getLayer());
-                    ne->setParent(this);
-                    ne->setVisible(getFlag(RS2::FlagVisible));
-
-//                                RS_DEBUG->print("RS_Insert::update: transforming entity");
-
-                // Move:
-//                                RS_DEBUG->print("RS_Insert::update: move 1");
-                    if (std::abs(m_data.scaleFactor.x)>MIN_Scale_Factor &&
-                            std::abs(m_data.scaleFactor.y)>MIN_Scale_Factor) {
-                        ne->move(m_data.insertionPoint +
-                                 RS_Vector(m_data.spacing.x/m_data.scaleFactor.x*c,
-                                           m_data.spacing.y/m_data.scaleFactor.y*r));
-                    }
-                    else {
-                        ne->move(m_data.insertionPoint);
-                    }
-                // Move because of block base point:
-//                                RS_DEBUG->print("RS_Insert::update: move 2");
-                    ne->move(blk->getBasePoint()*(-1));
-                // Scale:
-//                                RS_DEBUG->print("RS_Insert::update: scale");
-                    ne->scale(m_data.insertionPoint, m_data.scaleFactor);
-                // Rotate:
-//                                RS_DEBUG->print("RS_Insert::update: rotate");
-                    ne->rotate(m_data.insertionPoint, m_data.angle);
-
-                   // RS_DEBUG->print(RS_Debug::D_ERROR, "ne: angle: %lg\n", data.angle);
-                // Select:
-                    ne->setSelected(isSelected());
-
-                // individual entities can be on indiv. layers
-                    RS_Pen tmpPen = updatePen(ne->getPen(false), getPen());
-                // now that we've evaluated all flags, let's strip them:
-                // TODO: strip all flags (width, line type)
-                //tmpPen.setColor(tmpPen.getColor().stripFlags());
-                    ne->setPen(tmpPen);
-
-                    ne->setUpdateEnabled(true);
-
-                // insert must be updated even in preview mode
-                    if (m_data.updateMode != RS2::PreviewUpdate
-                            || ne->rtti() == RS2::EntityInsert) {
-                        //RS_DEBUG->print("RS_Insert::update: updating new entity");
-                        ne->update();
+bool RS_Insert::createTemporaryEntities(const std::function<bool(std::unique_ptr<RS_Entity>)>& consumer) const {
+    const RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr) {
+        return true;
+    }
+    // the same order as of the copies created by createEntities()
+    for (RS_Entity* e: *blk) {
+        if (e->isUndone()) {
+            continue;
+        }
+        for (int c = 0; c < m_data.cols; ++c) {
+            for (int r = 0; r < m_data.rows; ++r) {
+                if (!consumer(std::unique_ptr<RS_Entity>{createInstanceEntity(*blk, *e, c, r, nullptr)})) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Creates the copy of the entity of the block for the given cell of the array, as a child
+ * of the given parent.
+ */
+RS_Entity* RS_Insert::createInstanceEntity(const RS_Block& blk, const RS_Entity& e, int c, int r,
+                                           RS_EntityContainer* parent) const {
+    RS_Entity* ne = nullptr;
+    if ( (m_data.scaleFactor.x - m_data.scaleFactor.y)>MIN_Scale_Factor) {
+        if (e.rtti()== RS2::EntityArc) {
+            auto a= static_cast<const RS_Arc*>(&e);
+            ne = new RS_Ellipse{parent,
+            {a->getCenter(), {a->getRadius(), 0.},
+                    1, a->getAngle1(), a->getAngle2(),
+                    a->isReversed()}};
+            ne->setLayer(e.getLayer());
+            ne->setPen(e.getPen(false));
+        } else if (e.rtti()== RS2::EntityCircle) {
+            auto a= static_cast<const RS_Circle*>(&e);
+            ne = new RS_Ellipse{parent,
+            { a->getCenter(), {a->getRadius(), 0.}, 1, 0., 2.*M_PI, false}};
+            ne->setLayer(e.getLayer());
+            ne->setPen(e.getPen(false));
+        } else {
+            ne = e.clone();
+        }
+    } else {
+        ne = e.clone();
+    }
+    ne->setUpdateEnabled(false);
+    // if entity layer are 0 set to insert layer to allow "1 layer control" bug ID #3602152
+    RS_Layer *l= ne->getLayer();//special fontchar block don't have
+    if (l != nullptr  && ne->getLayer()->getName() == "0")
+        ne->setLayer(getLayer());
+    ne->setParent(parent);
+    ne->setVisible(getFlag(RS2::FlagVisible));
+
+    // Move:
+    if (std::abs(m_data.scaleFactor.x)>MIN_Scale_Factor &&
+            std::abs(m_data.scaleFactor.y)>MIN_Scale_Factor) {
+        ne->move(m_data.insertionPoint +
+                 RS_Vector(m_data.spacing.x/m_data.scaleFactor.x*c,
+                           m_data.spacing.y/m_data.scaleFactor.y*r));
+    }
+    else {
+        ne->move(m_data.insertionPoint);
+    }
+    // Move because of block base point:
+    ne->move(blk.getBasePoint()*(-1));
+    // Scale:
+    ne->scale(m_data.insertionPoint, m_data.scaleFactor);
+    // Rotate:
+    ne->rotate(m_data.insertionPoint, m_data.angle);
+
+    // Select:
+    ne->setSelected(isSelected());
+    if (getFlag(RS2::FlagHighlighted)) {
+        ne->setHighlighted(true);
+    }
+
+    // individual entities can be on indiv. layers
+    RS_Pen tmpPen = updatePen(ne->getPen(false), getPen());
+    // now that we've evaluated all flags, let's strip them:
+    // TODO: strip all flags (width, line type)
+    //tmpPen.setColor(tmpPen.getColor().stripFlags());
+    ne->setPen(tmpPen);
+
+    ne->setUpdateEnabled(true);
+
+    // insert must be updated even in preview mode
+    if (m_data.updateMode != RS2::PreviewUpdate
+            || ne->rtti() == RS2::EntityInsert) {
+        ne->update();
+    }
+    return ne;
+}
+
+/**
+ * Borders of instances are the borders of the block entities transformed to each cell of the array.
+ */
+void RS_Insert::calculateBorders() {
+    if (!hasDeferredEntities()) {
+        RS_EntityContainer::calculateBorders();
+        return;
+    }
+    resetBorders();
+    RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr) {
+        return;
+    }
+    RS_Layer* layer = getLayer();
+    for (RS_Entity* e: *blk) {
+        if (isInstanceVisible(e, layer)) {
+            adjustBorders(e);
+        }
+    }
+    const RS_Vector blockMin = minV;
+    const RS_Vector blockMax = maxV;
+    resetBorders();
+    if (blockMin.x > blockMax.x || blockMin.y > blockMax.y) {
+        // same as for the container with invisible entities only
+        minV = maxV = RS_Vector{0., 0.};
+        return;
+    }
+    const RS_Vector corners[] = {blockMin, blockMax, {blockMin.x, blockMax.y}, {blockMax.x, blockMin.y}};
+    for (int c = 0; c < m_data.cols; ++c) {
+        for (int r = 0; r < m_data.rows; ++r) {
+            for (const RS_Vector& corner: corners) {
+                const RS_Vector p = fromBlockCoordinates(corner, c, r);
+                minV = RS_Vector::minimum(p, minV);
+                maxV = RS_Vector::maximum(p, maxV);
+            }
+        }
+    }
+    invalidateSpatialIndex();
+}
+
+RS_Vector RS_Insert::getCellInsertionPoint(int col, int row) const {
+    return m_data.insertionPoint + RS_Vector{m_data.spacing.x * col, m_data.spacing.y * row}.rotate(m_data.angle);
+}
+
+RS_Vector RS_Insert::toBlockCoordinates(const RS_Vector& coord, int col, int row) const {
+    return m_block->getBasePoint() + (coord - getCellInsertionPoint(col, row)).rotate(-m_data.angle) / m_data.scaleFactor.x;
+}
+
+RS_Vector RS_Insert::fromBlockCoordinates(const RS_Vector& blockCoord, int col, int row) const {
+    return getCellInsertionPoint(col, row) + (blockCoord - m_block->getBasePoint()).rotate(m_data.angle) * m_data.scaleFactor.x;
+}
+
+/**
+ * Nearest point of all instances, found by the given search over the block in coordinates of the block.
+ */
+RS_Vector RS_Insert::getNearestInstancePoint(const RS_Vector& coord, double* dist,
+                                             const std::function<RS_Vector(const RS_Block*, const RS_Vector&, double*)>& nearest) const {
+    double minDist = RS_MAXDOUBLE;
+    RS_Vector closestPoint(false);
+    const RS_Block* blk = getBlockForInsert();
+    if (blk != nullptr) {
+        for (int c = 0; c < m_data.cols; ++c) {
+            for (int r = 0; r < m_data.rows; ++r) {
+                double curDist = RS_MAXDOUBLE;
+                RS_Vector point = nearest(blk, toBlockCoordinates(coord, c, r), &curDist);
+                if (point.valid) {
+                    point = fromBlockCoordinates(point, c, r);
+                    curDist = point.distanceTo(coord);
+                    if (curDist < minDist) {
+                        minDist = curDist;
+                        closestPoint = point;
                     }
+                }
+            }
+        }
+    }
+    if (dist != nullptr) {
+        *dist = minDist;
+    }
+    return closestPoint;
+}
+
+RS_Vector RS_Insert::getNearestSelectedRef(const RS_Vector& coord, double* dist) const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getNearestSelectedRef(coord, dist);
+    }
+    // entities of the block are never selected individually
+    if (dist != nullptr) {
+        *dist = RS_MAXDOUBLE;
+    }
+    return RS_Vector(false);
+}
+
+RS_Vector RS_Insert::getNearestEndpoint(const RS_Vector& coord, double* dist) const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getNearestEndpoint(coord, dist);
+    }
+    return getNearestInstancePoint(coord, dist, [](const RS_Block* blk, const RS_Vector& blockCoord, double* blockDist) {
+        return blk->getNearestEndpoint(blockCoord, blockDist);
+    });
+}
 
-//                                RS_DEBUG->print("RS_Insert::update: adding new entity");
-                    appendEntity(ne);
-//                std::cout<<"done # of entity: "<<i_en_counts<<std::endl;
+RS_Vector RS_Insert::getNearestPointOnEntity(const RS_Vector& coord, bool onEntity,
+                                             double* dist, RS_Entity** entity) const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+    }
+    // copies of entities of the block are not created for the query, the insert is reported instead
+    if (entity != nullptr) {
+        *entity = const_cast<RS_Insert*>(this);
+    }
+    return getNearestInstancePoint(coord, dist, [onEntity](const RS_Block* blk, const RS_Vector& blockCoord, double* blockDist) {
+        return blk->getNearestPointOnEntity(blockCoord, onEntity, blockDist);
+    });
+}
+
+RS_Vector RS_Insert::getNearestCenter(const RS_Vector& coord, double* dist) const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getNearestCenter(coord, dist);
+    }
+    return getNearestInstancePoint(coord, dist, [](const RS_Block* blk, const RS_Vector& blockCoord, double* blockDist) {
+        return blk->getNearestCenter(blockCoord, blockDist);
+    });
+}
+
+RS_Vector RS_Insert::getNearestMiddle(const RS_Vector& coord, double* dist, int middlePoints) const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getNearestMiddle(coord, dist, middlePoints);
+    }
+    return getNearestInstancePoint(coord, dist, [middlePoints](const RS_Block* blk, const RS_Vector& blockCoord, double* blockDist) {
+        return blk->getNearestMiddle(blockCoord, blockDist, middlePoints);
+    });
+}
+
+double RS_Insert::getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                                     RS2::ResolveLevel level, double solidDist) const {
+    // resolved levels report the insert as well, see RS_EntityContainer::getNearestEntity()
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+    }
+    const RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr) {
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+    }
+    const double scale = m_data.scaleFactor.x;
+    const double blockSolidDist = solidDist < RS_MAXDOUBLE ? solidDist / scale : solidDist;
+    RS_Layer* layer = getLayer();
+    double minDist = RS_MAXDOUBLE;
+    for (int c = 0; c < m_data.cols; ++c) {
+        for (int r = 0; r < m_data.rows; ++r) {
+            const RS_Vector blockCoord = toBlockCoordinates(coord, c, r);
+            for (RS_Entity* e: *blk) {
+                RS_Layer* entityLayer = getInstanceLayer(e, layer);
+                if (!isInstanceVisible(e, layer) || (entityLayer != nullptr && entityLayer->isLocked())) {
+                    continue;
+                }
+                double curDist = e->getDistanceToPoint(blockCoord, nullptr, RS2::ResolveNone, blockSolidDist);
+                if (curDist < RS_MAXDOUBLE) {
+                    curDist *= scale;
                 }
+                minDist = std::min(minDist, curDist);
             }
         }
-        calculateBorders();
+    }
+    if (entity != nullptr) {
+        *entity = const_cast<RS_Insert*>(this);
+    }
+    return minDist;
+}
 
-        RS_DEBUG->print("RS_Insert::update: OK");
+double RS_Insert::getLength() const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getLength();
+    }
+    const RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr) {
+        return RS_EntityContainer::getLength();
+    }
+    double blockLength = 0.0;
+    RS_Layer* layer = getLayer();
+    for (RS_Entity* e: *blk) {
+        if (isInstanceVisible(e, layer)) {
+            double length = e->getLength();
+            if (std::signbit(length)) {
+                return -1.0;
+            }
+            blockLength += length;
+        }
+    }
+    return blockLength * m_data.scaleFactor.x * m_data.cols * m_data.rows;
+}
+
+unsigned RS_Insert::countDeep() const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::countDeep();
+    }
+    const RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr) {
+        return RS_EntityContainer::countDeep();
+    }
+    return blk->countDeep() * m_data.cols * m_data.rows;
+}
+
+unsigned RS_Insert::countSelected(bool deep, QList<RS2::EntityType> const& types) {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::countSelected(deep, types);
+    }
+    if (getBlockForInsert() == nullptr) {
+        return RS_EntityContainer::countSelected(deep, types);
+    }
+    // copies of entities would take the selection of the insert
+    return isSelected() ? countInstanceEntities(types) : 0;
+}
+
+/**
+ * The same count as of the copies of entities of the block, with their children.
+ */
+unsigned RS_Insert::countInstanceEntities(const QList<RS2::EntityType>& types) const {
+    std::function<unsigned(const RS_EntityContainer*)> countChildren = [&countChildren](const RS_EntityContainer* container) {
+        if (container->rtti() == RS2::EntityInsert && container->hasDeferredEntities()) {
+            return static_cast<const RS_Insert*>(container)->countInstanceEntities({});
+        }
+        unsigned count = 0;
+        container->visitEntities([&count, &countChildren](RS_Entity* child) {
+            count++;
+            if (child->isContainer()) {
+                count += countChildren(static_cast<RS_EntityContainer*>(child));
+            }
+            return true;
+        });
+        return count;
+    };
+
+    const RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr) {
+        return 0;
+    }
+    unsigned count = 0;
+    for (RS_Entity* e: *blk) {
+        if (e->isUndone()) {
+            continue;
+        }
+        if (types.isEmpty() || types.contains(e->rtti())) {
+            count++;
+        }
+        if (e->isContainer()) {
+            count += countChildren(static_cast<RS_EntityContainer*>(e));
+        }
+    }
+    return count * m_data.cols * m_data.rows;
+}
+
+void RS_Insert::draw(RS_Painter* painter) {
+    if (!hasDeferredEntities()) {
+        RS_EntityContainer::draw(painter);
+        return;
+    }
+    drawInstances(painter, false);
+}
+
+void RS_Insert::drawAsChild(RS_Painter* painter) {
+    if (!hasDeferredEntities()) {
+        RS_EntityContainer::drawAsChild(painter);
+        return;
+    }
+    drawInstances(painter, true);
+}
+
+/**
+ * Draws entities of the block for each cell of the array, transformed by the painter
+ */
+void RS_Insert::drawInstances(RS_Painter* painter, bool asChild) {
+    RS_Block* blk = getBlockForInsert();
+    if (blk == nullptr) {
+        return;
+    }
+    RS_Painter::BlockInstance instance;
+    const RS_Painter::BlockInstance* outer = painter->getBlockInstance();
+    if (outer == nullptr) {
+        instance.pen = getPenResolved();
+        instance.layer = getLayer();
+        instance.selected = isSelected();
+        instance.highlighted = getFlag(RS2::FlagHighlighted);
+    } else if (outer->ownAttributes) {
+        // this insert is drawn transformed by the preview
+        instance.pen = getPenResolved();
+        instance.layer = getLayer();
+        instance.selected = outer->selected;
+        instance.highlighted = outer->highlighted;
+    } else {
+        // this insert is an entity of the block of the outer insert
+        instance.pen = getInstancePen(this, outer->pen, outer->layer);
+        instance.layer = getInstanceLayer(this, outer->layer);
+        instance.selected = outer->selected;
+        instance.highlighted = outer->highlighted;
+    }
+
+    const RS_Vector& basePoint = blk->getBasePoint();
+    for (int c = 0; c < m_data.cols; ++c) {
+        for (int r = 0; r < m_data.rows; ++r) {
+            painter->beginBlockInstance(getCellInsertionPoint(c, r), m_data.scaleFactor.x, m_data.angle,
+                                        basePoint, instance);
+            blk->visitEntities([painter, asChild](RS_Entity* e) {
+                if (e->isUndone() || e->getId() == 0) {
+                    return true;
+                }
+                if (asChild) {
+                    painter->drawAsChild(e);
+                } else {
+                    painter->drawEntity(e);
+                }
+                return true;
+            });
+            painter->endBlockInstance();
+        }
+    }
+}
+
+/**
+ * @return the layer of the copy of the entity: entities on the layer "0" take the layer of the insert
+ */
+RS_Layer* RS_Insert::getInstanceLayer(const RS_Entity* e, RS_Layer* insertLayer) {
+    for (const RS_Entity* x = e; x != nullptr && x->rtti() != RS2::EntityBlock; x = x->getParent()) {
+        RS_Layer* layer = x->getLayer(false);
+        if (layer != nullptr && layer->getName() != "0") {
+            return layer;
+        }
+    }
+    return insertLayer;
+}
+
+RS_Pen RS_Insert::getInstancePen(const RS_Entity* e, const RS_Pen& insertPen, RS_Layer* insertLayer) {
+    RS_Pen pen = getBlockPen(e, insertPen);
+    if (pen.isColorByLayer() || pen.isWidthByLayer() || pen.isLineTypeByLayer()) {
+        RS_Layer* layer = getInstanceLayer(e, insertLayer);
+        if (layer != nullptr) {
+            const RS_Pen& layerPen = layer->getPen();
+            if (pen.isColorByLayer()) {
+                pen.setColorFromPen(layerPen);
+            }
+            if (pen.isWidthByLayer()) {
+                pen.setWidthFromPen(layerPen);
+            }
+            if (pen.isLineTypeByLayer()) {
+                pen.setLineTypeFromPen(layerPen);
+            }
+        }
+    }
+    return pen;
+}
+
+bool RS_Insert::isInstanceVisible(const RS_Entity* e, RS_Layer* insertLayer) {
+    if (e->isUndone()) {
+        return false;
+    }
+    // copies of entities of the block take the visibility of the insert
+    const RS_EntityContainer* parent = e->getParent();
+    if (parent != nullptr && parent->rtti() != RS2::EntityBlock && !e->getFlag(RS2::FlagVisible)) {
+        return false;
+    }
+    RS_Layer* layer = getInstanceLayer(e, insertLayer);
+    if (layer != nullptr && layer->isFrozen()) {
+        return false;
+    }
+    if (e->rtti() == RS2::EntityInsert) {
+        const RS_Block* blk = static_cast<const RS_Insert*>(e)->getBlockForInsert();
+        if (blk != nullptr && blk->isFrozen()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RS_Insert::isInstanceConstruction(const RS_Entity* e, RS_Layer* insertLayer) {
+    // Issue #1773, hatch filling curves are not shown as infinite on construction layers
+    if (e->getLayer(false) == nullptr || e->getFlag(RS2::FlagHatchChild)) {
+        return false;
+    }
+    RS_Layer* layer = getInstanceLayer(e, insertLayer);
+    return layer != nullptr && layer->isConstruction();
+}
+
+bool RS_Insert::isInstancePrint(const RS_Entity* e, RS_Layer* insertLayer) {
+    if (e->getLayer(false) == nullptr) {
+        return true;
+    }
+    RS_Layer* layer = getInstanceLayer(e, insertLayer);
+    return layer == nullptr || layer->isPrint();
 }
 
 /**
@@ -367,6 +843,15 @@ void RS_Insert::scale(const RS_Vector& center, const RS_Vector& factor) {
 
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_Insert::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_InsertData>>(m_data);
+}
+
+void RS_Insert::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    m_data = static_cast<const LC_EntityGeometryData<RS_InsertData>&>(geometry).data;
+    update();
+}
+
 void RS_Insert::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
     m_data.insertionPoint.mirror(axisPoint1, axisPoint2);
     RS_Vector vec = RS_Vector::polar(1.0, m_data.angle);
@@ -28,9 +28,12 @@
 #ifndef RS_INSERT_H
 #define RS_INSERT_H
 
+#include <functional>
+
 #include "rs_entitycontainer.h"
 
 class RS_BlockList;
+class RS_Layer;
 
 /**
  * Holds the data that defines an insert.
@@ -88,6 +91,10 @@ std::ostream& operator << (std::ostream& os, const RS_InsertData& d);
  * refer to a block. However, to the outside world they act exactly
  * like EntityContainer.
  *
+ * If the block is only moved, rotated and uniformly scaled by the insert,
+ * the entities of the block are drawn as instances of the block and copies of
+ * them are created only when they are accessed.
+ *
  * @author Andrew Mustun
  */
 class RS_Insert : public RS_EntityContainer {
@@ -96,6 +103,7 @@ public:
               const RS_InsertData& d);
 
     RS_Entity* clone() const override;
+    std::size_t getMemoryUsage() const override;
 
     /** @return RS2::EntityInsert */
     RS2::EntityType rtti() const  override{
@@ -116,8 +124,15 @@ public:
     }
 
 	RS_Block* getBlockForInsert() const;
+    /**
+     * Sets the block of this insert, if it is known already, so it is not searched by name.
+     */
+    void setBlockForInsert(RS_Block* block) {
+        m_block = block;
+    }
 
     void update() override;
+    void calculateBorders() override;
 
     QString getName() const {
         return m_data.name;
@@ -182,6 +197,26 @@ public:
     }
     RS_Vector getNearestRef(const RS_Vector& coord,
                             double* dist = nullptr) const override;
+    RS_Vector getNearestSelectedRef(const RS_Vector& coord,
+                                    double* dist = nullptr) const override;
+    RS_Vector getNearestEndpoint(const RS_Vector& coord,
+                                 double* dist = nullptr) const override;
+    RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+                                      bool onEntity = true,
+                                      double* dist = nullptr,
+                                      RS_Entity** entity = nullptr) const override;
+    RS_Vector getNearestCenter(const RS_Vector& coord,
+                               double* dist = nullptr) const override;
+    RS_Vector getNearestMiddle(const RS_Vector& coord,
+                               double* dist = nullptr,
+                               int middlePoints = 1) const override;
+    double getDistanceToPoint(const RS_Vector& coord,
+                              RS_Entity** entity,
+                              RS2::ResolveLevel level = RS2::ResolveNone,
+                              double solidDist = RS_MAXDOUBLE) const override;
+    double getLength() const override;
+    unsigned countDeep() const override;
+    unsigned countSelected(bool deep = true, QList<RS2::EntityType> const& types = {}) override;
 
     void move(const RS_Vector& offset) override;
     void rotate(const RS_Vector& center, double angle) override;
@@ -189,11 +224,51 @@ public:
     void scale(const RS_Vector& center, const RS_Vector& factor) override;
     void mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) override;
 
+    void draw(RS_Painter* painter) override;
+    void drawAsChild(RS_Painter* painter) override;
+
+    /**
+     * Attributes of an entity of the block drawn as an instance, the same as of the copy of
+     * the entity created by the insert with the given resolved layer and pen.
+     */
+    static RS_Layer* getInstanceLayer(const RS_Entity* e, RS_Layer* insertLayer);
+    static RS_Pen getInstancePen(const RS_Entity* e, const RS_Pen& insertPen, RS_Layer* insertLayer);
+    static bool isInstanceVisible(const RS_Entity* e, RS_Layer* insertLayer);
+    static bool isInstanceConstruction(const RS_Entity* e, RS_Layer* insertLayer);
+    static bool isInstancePrint(const RS_Entity* e, RS_Layer* insertLayer);
+
+    bool createTemporaryEntities(const std::function<bool(std::unique_ptr<RS_Entity>)>& consumer) const override;
+
     friend std::ostream& operator << (std::ostream& os, const RS_Insert& i);
 
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
+    void createDeferredEntities() override;
+    RS_EntityContainer* getDeferredEntitiesSource() const override;
+    unsigned countDeferredEntities() const override;
+
     RS_InsertData m_data{};
     mutable RS_Block* m_block = nullptr;
+
+private:
+    /**
+     * @return true, if the block may be drawn as instances instead of copies of its entities
+     */
+    bool isInstanced() const;
+    void createEntities(RS_Block* blk);
+    RS_Entity* createInstanceEntity(const RS_Block& blk, const RS_Entity& e, int c, int r,
+                                    RS_EntityContainer* parent) const;
+    /**
+     * Transformations between coordinates of the drawing and of the block for the given cell of the array
+     */
+    RS_Vector getCellInsertionPoint(int col, int row) const;
+    RS_Vector toBlockCoordinates(const RS_Vector& coord, int col, int row) const;
+    RS_Vector fromBlockCoordinates(const RS_Vector& blockCoord, int col, int row) const;
+    RS_Vector getNearestInstancePoint(const RS_Vector& coord, double* dist,
+                                      const std::function<RS_Vector(const RS_Block*, const RS_Vector&, double*)>& nearest) const;
+    unsigned countInstanceEntities(const QList<RS2::EntityType>& types) const;
+    void drawInstances(RS_Painter* painter, bool asChild);
 };
 
 
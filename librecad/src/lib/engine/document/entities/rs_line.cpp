@@ -28,6 +28,7 @@
 
 #include "rs_line.h"
 
+#include "lc_entitygeometry.h"
 #include "lc_quadratic.h"
 #include "rs_circle.h"
 #include "rs_painter.h"
@@ -69,6 +70,10 @@ RS_Entity* RS_Line::clone() const {
 	return l;
 }
 
+std::size_t RS_Line::getMemoryUsage() const {
+    return sizeof(RS_Line);
+}
+
 void RS_Line::calculateBorders() {
     minV = RS_Vector::minimum(data.startpoint, data.endpoint);
     maxV = RS_Vector::maximum(data.startpoint, data.endpoint);
@@ -467,6 +472,15 @@ void RS_Line::scale(const RS_Vector& center, const RS_Vector& factor) {
     calculateBorders();
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_Line::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_LineData>>(data);
+}
+
+void RS_Line::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_LineData>&>(geometry).data;
+    calculateBorders();
+}
+
 void RS_Line::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
     data.startpoint.mirror(axisPoint1, axisPoint2);
     data.endpoint.mirror(axisPoint1, axisPoint2);
@@ -59,6 +59,7 @@ public:
     RS_Line(const RS_Vector& pStart, const RS_Vector& pEnd);
 
     RS_Entity* clone() const override;
+    std::size_t getMemoryUsage() const override;
 
     /** @return RS2::EntityLine */
     RS2::EntityType rtti() const override{
@@ -213,6 +214,8 @@ public:
      */
     double areaLineIntegral() const override;
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
     RS_LineData data;
 private:
     RS_Vector highlightedVertex;
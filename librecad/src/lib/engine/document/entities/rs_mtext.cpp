@@ -28,6 +28,8 @@
  #include <iostream>
 
 #include "rs_mtext.h"
+#include "lc_entitygeometry.h"
+#include "rs_block.h"
 #include "rs_debug.h"
 #include "rs_font.h"
 #include "rs_fontlist.h"
@@ -130,6 +132,10 @@ RS_Entity *RS_MText::clone() const {
     return t;
 }
 
+std::size_t RS_MText::getMemoryUsage() const {
+    return sizeof(RS_MText) + data.text.capacity() * sizeof(QChar) + getEntitiesMemoryUsage();
+}
+
 // fixme - test concept for using UI proxies for heavy entities on modification operation (rotate, scale etc).
 // potentially, it might be either expanded further or removed.
 class RS_MTextProxy:public RS_EntityContainer{
@@ -521,12 +527,12 @@ void RS_MText::rotateLinesRefs() const {
 void RS_MText::addLetter(LC_TextLine &oneLine, QChar letter,
                          RS_Font &font, const RS_Vector &letterSpace,
                          RS_Vector &letterPosition) {
-    QString letterText{QString(letter)};
-    if (nullptr == font.findLetter(letterText)) {
+    RS_Font::Glyph glyph = font.findGlyph(letter);
+    if (nullptr == glyph.block) {
         RS_DEBUG->print("RS_MText::update: missing font for letter( %s ), replaced "
                         "it with QChar(0xfffd)",
-                        qPrintable(letterText));
-        letterText = QChar(0xfffd);
+                        qPrintable(QString(letter)));
+        glyph = font.findGlyph(QChar(0xfffd));
     }
 
     LC_LOG << "RS_MText::update: insert a letter at pos:(" << letterPosition.x
@@ -535,17 +541,9 @@ void RS_MText::addLetter(LC_TextLine &oneLine, QChar letter,
     // adjust for right-to-left text: letter position start from the right
     bool righToLeft = std::signbit(letterSpace.x);
 
-    RS_InsertData d(letterText, letterPosition, RS_Vector(1.0, 1.0), 0.0, 1, 1,
-                    RS_Vector(0.0, 0.0), font.getLetterList(), RS2::NoUpdate);
-
-    RS_Insert *letterEntity{new RS_Insert(this, d)};
-    letterEntity->setPen(RS_Pen(RS2::FlagInvalid));
-    letterEntity->setLayer(nullptr);
-    letterEntity->update();
-    letterEntity->forcedCalculateBorders();
-
+    // the width is measured by the font, borders of an empty letter are at 0/0
+    double actualWidth = glyph.isEmpty() ? 0. : glyph.max.x - glyph.min.x;
     // Add spacing, if the font is actually wider than word spacing
-    double actualWidth = letterEntity->getMax().x - letterEntity->getMin().x;
     if (actualWidth >= font.getWordSpacing() + RS_TOLERANCE) {
         double letterSpacing = std::max(1., std::abs(letterSpace.x));
         double wordSpacing = font.getWordSpacing();
@@ -557,14 +555,21 @@ void RS_MText::addLetter(LC_TextLine &oneLine, QChar letter,
     // right-to-left text support
     letterWidth.x = std::copysign(letterWidth.x, letterSpace.x);
 
+    // For right-to-left text, need to align the current position with the right edge
+    RS_Vector letterInsertionPoint = righToLeft ? letterPosition + letterWidth : letterPosition;
     letterPosition += letterWidth;
 
-    // For right-to-left text, need to align the current position with the right edge
-    if (righToLeft) {
-        letterEntity->move(letterWidth);
-    }
+    if (glyph.block != nullptr) {
+        RS_InsertData d(glyph.block->getName(), letterInsertionPoint, RS_Vector(1.0, 1.0), 0.0, 1, 1,
+                        RS_Vector(0.0, 0.0), font.getLetterList(), RS2::NoUpdate);
 
-    oneLine.addEntity(letterEntity);
+        RS_Insert *letterEntity{new RS_Insert(this, d)};
+        letterEntity->setBlockForInsert(glyph.block);
+        letterEntity->setPen(RS_Pen(RS2::FlagInvalid));
+        letterEntity->setLayer(nullptr);
+        letterEntity->update();
+        oneLine.addEntity(letterEntity);
+    }
 
     // next letter position:
     letterPosition += letterSpace;
@@ -734,6 +739,15 @@ void RS_MText::scale(const RS_Vector &center, const RS_Vector &factor) {
     update();
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_MText::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_MTextData>>(data);
+}
+
+void RS_MText::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_MTextData>&>(geometry).data;
+    update();
+}
+
 void RS_MText::mirror(const RS_Vector &axisPoint1,
                       const RS_Vector &axisPoint2) {
     data.insertionPoint.mirror(axisPoint1, axisPoint2);
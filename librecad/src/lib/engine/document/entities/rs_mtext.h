@@ -146,6 +146,7 @@ public:
   virtual ~RS_MText() = default;
 
    RS_Entity *clone() const override;
+   std::size_t getMemoryUsage() const override;
 
   /**	@return RS2::EntityText */
    RS2::EntityType rtti() const override { return RS2::EntityMText; }
@@ -220,6 +221,8 @@ public:
     RS_Vector getNearestSelectedRef(const RS_Vector &coord, double *dist) const override;
     void moveSelectedRef(const RS_Vector &ref, const RS_Vector &offset) override;
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
     class LC_TextLine:public RS_EntityContainer{
     public:
         LC_TextLine(RS_EntityContainer* parent=nullptr, bool owner=true):RS_EntityContainer(parent, owner){}
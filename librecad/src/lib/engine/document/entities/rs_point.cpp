@@ -26,6 +26,7 @@
 #include<iostream>
 #include "rs_point.h"
 
+#include "lc_entitygeometry.h"
 #include "rs_circle.h"
 #include "rs_painter.h"
 #include "lc_quadratic.h"
@@ -41,6 +42,10 @@ RS_Entity* RS_Point::clone() const {
 	return p;
 }
 
+std::size_t RS_Point::getMemoryUsage() const {
+    return sizeof(RS_Point);
+}
+
 RS2::EntityType RS_Point::rtti() const{
     return RS2::EntityPoint;
 }
@@ -171,6 +176,15 @@ void RS_Point::scale(const RS_Vector& center, const RS_Vector& factor) {
     calculateBorders();
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_Point::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_PointData>>(data);
+}
+
+void RS_Point::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_PointData>&>(geometry).data;
+    calculateBorders();
+}
+
 void RS_Point::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
     data.pos.mirror(axisPoint1, axisPoint2);
     calculateBorders();
@@ -53,6 +53,7 @@ public:
         RS_EntityContainer *parent,
         const RS_PointData &d);
     RS_Entity *clone() const override;
+    std::size_t getMemoryUsage() const override;
     /**	@return RS_ENTITY_POINT */
     RS2::EntityType rtti() const override;
     /**
@@ -123,6 +124,8 @@ public:
     LC_Quadratic getQuadratic() const override;
 
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
     RS_PointData data;
 };
 #endif
@@ -31,6 +31,7 @@
 #include <QObject>
 
 #include "lc_containertraverser.h"
+#include "lc_entitygeometry.h"
 #include "rs_arc.h"
 #include "rs_debug.h"
 #include "rs_dialogfactory.h"
@@ -44,6 +45,49 @@
 #include "rs_pen.h"
 #include "rs_polyline.h"
 
+namespace {
+    // segments with tiny or infinite bulges are lines, see RS_Polyline::createVertex()
+    bool isLineBulge(double bulge) {
+        return std::abs(bulge) < RS_TOLERANCE || std::abs(bulge) >= RS_MAXDOUBLE;
+    }
+
+    // center and radius of the arc from start to end with the given bulge
+    RS_Vector bulgeArcCenter(const RS_Vector& start, const RS_Vector& end, double bulge, double& radius) {
+        bool reversed = std::signbit(bulge);
+        double alpha = std::atan(std::abs(bulge)) * 4.0;
+
+        RS_Vector middle = (start + end)/2.0;
+        double dist=start.distanceTo(end)/2.0;
+        double angle=start.angleTo(end);
+
+        // alpha can't be 0.0 at this point
+        radius = std::abs(dist / std::sin(alpha/2.0));
+
+        double const wu = std::abs(radius*radius - dist*dist);
+        double angleNew = reversed ? angle - M_PI_2 : angle + M_PI_2;
+        double h = (std::abs(alpha)>M_PI) ? -std::sqrt(wu) : std::sqrt(wu);
+
+        return middle + RS_Vector::polar(h, angleNew);
+    }
+
+    // the arc segment from start to end, the same as created by RS_Polyline::createVertex()
+    RS_ArcData segmentArcData(const RS_Vector& start, const RS_Vector& end, double bulge) {
+        double radius = 0.;
+        RS_Vector center = bulgeArcCenter(start, end, bulge, radius);
+        return {center, radius, center.angleTo(start), center.angleTo(end), std::signbit(bulge)};
+    }
+
+    // length of the segment from start to end, without creating it
+    double segmentLength(const RS_Vector& start, const RS_Vector& end, double bulge) {
+        double chord = start.distanceTo(end);
+        if (isLineBulge(bulge)) {
+            return chord;
+        }
+        double alpha = std::atan(std::abs(bulge)) * 4.0;
+        return std::abs(chord / 2.0 / std::sin(alpha / 2.0)) * alpha;
+    }
+}
+
 RS_PolylineData::RS_PolylineData(const RS_Vector& _startpoint,
                                  const RS_Vector& _endpoint,
                                  bool _closed):
@@ -86,10 +130,15 @@ RS_Entity* RS_Polyline::clone() const {
     return p;
 }
 
+std::size_t RS_Polyline::getMemoryUsage() const {
+    return sizeof(RS_Polyline) + m_vertices.capacity() * sizeof(Vertex) + getEntitiesMemoryUsage();
+}
+
 /**
  * Removes the last vertex of this polyline.
  */
 void RS_Polyline::removeLastVertex() {
+    prepareEntities();
     RS_Entity* l = last();
     if (l != nullptr) {
         removeEntity(l);
@@ -133,6 +182,8 @@ RS_Entity* RS_Polyline::addVertex(const RS_Vector& v, double bulge, bool prepend
 
         // consequent vertices:
     else {
+        // the added entity is returned, so segments of a compact polyline are needed
+        prepareEntities();
         // add entity to the polyline:
         std::unique_ptr<RS_Entity> vertex = createVertex(v, m_nextBulge, prepend);
         entity = vertex.get();
@@ -157,6 +208,8 @@ RS_Entity* RS_Polyline::addVertex(const RS_Vector& v, double bulge, bool prepend
  * sets the startpoint to the first point if not exist.
  *
  * The very first vertex added with this method is the startpoint if not exists.
+ * Vertices appended to a polyline without segments are kept compact, the segments
+ * are created once they are needed.
  *
  * @param vl list of vertexs coordinate to be added
  * @param Pair are RS_Vector of coord and the bulge of the arc or 0 for a line segment (see DXF documentation)
@@ -168,6 +221,10 @@ void RS_Polyline::appendVertexs(const std::vector< std::pair<RS_Vector, double>
     if (!vl.size()) {
         return;
     }
+    if (hasDeferredEntities() || RS_EntityContainer::isEmpty()) {
+        appendCompactVertexs(vl);
+        return;
+    }
     size_t idx = 0;
     // very first vertex:
     if (!data.startpoint.valid) {
@@ -188,6 +245,149 @@ void RS_Polyline::appendVertexs(const std::vector< std::pair<RS_Vector, double>
     endPolyline();
 }
 
+void RS_Polyline::appendCompactVertexs(const std::vector< std::pair<RS_Vector, double> >& vl) {
+    if (!hasDeferredEntities()) {
+        m_vertices.clear();
+        m_closingEntity = nullptr;
+        if (data.startpoint.valid) {
+            m_vertices.push_back({data.startpoint.x, data.startpoint.y, m_nextBulge});
+        }
+    }
+    m_vertices.reserve(m_vertices.size() + vl.size());
+    for (const auto& [v, bulge]: vl) {
+        m_vertices.push_back({v.x, v.y, bulge});
+    }
+
+    data.startpoint = m_vertices.front().position();
+    data.endpoint = m_vertices.back().position();
+    m_nextBulge = m_vertices.back().bulge;
+    if (m_vertices.size() < 2) {
+        // no segments, the same as the very first vertex added
+        m_vertices.clear();
+        return;
+    }
+    setEntitiesDeferred(true);
+    endPolyline();
+}
+
+void RS_Polyline::createDeferredEntities() {
+    setEntitiesDeferred(false);
+    std::vector<Vertex> vertices;
+    vertices.swap(m_vertices);
+    if (vertices.empty()) {
+        return;
+    }
+
+    data.endpoint = vertices.front().position();
+    for (size_t i = 1; i < vertices.size(); i++) {
+        std::unique_ptr<RS_Entity> vertex = createVertex(vertices[i].position(), vertices[i - 1].bulge, false);
+        data.endpoint = vertex->getEndpoint();
+        RS_EntityContainer::addEntity(vertex.release());
+    }
+    m_nextBulge = vertices.back().bulge;
+    endPolyline();
+}
+
+unsigned RS_Polyline::countDeferredEntities() const {
+    return static_cast<unsigned>(segmentCount());
+}
+
+size_t RS_Polyline::segmentCount() const {
+    if (m_vertices.size() < 2) {
+        return 0;
+    }
+    // the closing segment is created only if it's not degenerated, see endPolyline()
+    const Vertex& last = m_vertices.back();
+    bool closing = data.getFlag(RS2::FlagClosed)
+                   && segmentLength(last.position(), m_vertices.front().position(), last.bulge) > 1.0E-4;
+    return closing ? m_vertices.size() : m_vertices.size() - 1;
+}
+
+void RS_Polyline::visitCompactSegments(const std::function<void(RS_Entity*, size_t)>& visitor) const {
+    // temporary segments have no parent, which spares the lookup of the active layer and pen
+    const size_t segments = segmentCount();
+    for (size_t i = 0; i < segments; i++) {
+        const Vertex& vertex = m_vertices[i];
+        const RS_Vector start = vertex.position();
+        const RS_Vector end = m_vertices[(i + 1) % m_vertices.size()].position();
+        if (isLineBulge(vertex.bulge)) {
+            RS_Line line{nullptr, start, end};
+            visitor(&line, i);
+        } else {
+            RS_Arc arc{nullptr, segmentArcData(start, end, vertex.bulge)};
+            visitor(&arc, i);
+        }
+    }
+}
+
+bool RS_Polyline::createTemporaryEntities(const std::function<bool(std::unique_ptr<RS_Entity>)>& consumer) const {
+    // the layer and pen the segments would take from the polyline, see createVertex()
+    RS_Layer* layer = getLayer();
+    const RS_Pen pen = getPen();
+    const size_t segments = segmentCount();
+    for (size_t i = 0; i < segments; i++) {
+        const Vertex& vertex = m_vertices[i];
+        const RS_Vector start = vertex.position();
+        const RS_Vector end = m_vertices[(i + 1) % m_vertices.size()].position();
+        std::unique_ptr<RS_Entity> segment;
+        if (isLineBulge(vertex.bulge)) {
+            segment = std::make_unique<RS_Line>(nullptr, start, end);
+        } else {
+            segment = std::make_unique<RS_Arc>(nullptr, segmentArcData(start, end, vertex.bulge));
+        }
+        segment->setSelected(isSelected());
+        segment->setLayer(layer);
+        segment->setPen(pen);
+        if (!consumer(std::move(segment))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RS_Polyline::visitSegments(const std::function<void(RS_Entity*)>& visitor) const {
+    if (hasDeferredEntities()) {
+        visitCompactSegments([&visitor](RS_Entity* segment, size_t) {
+            visitor(segment);
+        });
+        return;
+    }
+    for (RS_Entity* e: *this) {
+        visitor(e);
+    }
+}
+
+RS_VectorSolutions RS_Polyline::getIntersection(const RS_Entity* other, bool onEntities) const {
+    RS_VectorSolutions ret;
+    visitSegments([&ret, other, onEntities](RS_Entity* segment) {
+        RS_VectorSolutions sol = RS_Information::getIntersection(segment, other, onEntities);
+        ret.push_back(sol);
+        if (sol.isTangent()) {
+            ret.setTangent(true);
+        }
+    });
+    return ret;
+}
+
+void RS_Polyline::setNextBulge(double bulge) {
+    m_nextBulge = bulge;
+    if (hasDeferredEntities()) {
+        m_vertices.back().bulge = bulge;
+    }
+}
+
+void RS_Polyline::transformVertices(const std::function<void(RS_Vector&)>& transform) {
+    for (Vertex& vertex: m_vertices) {
+        RS_Vector position = vertex.position();
+        transform(position);
+        vertex.x = position.x;
+        vertex.y = position.y;
+    }
+    transform(data.startpoint);
+    transform(data.endpoint);
+    calculateBorders();
+}
+
 /**
  * Creates a vertex from the endpoint of the last element or
  * sets the startpoint to the point 'v'.
@@ -208,28 +408,16 @@ std::unique_ptr<RS_Entity> RS_Polyline::createVertex(const RS_Vector& v, double
                     data.endpoint.x, data.endpoint.y, v.x, v.y, bulge);
 
     // create line for the polyline:
-    if (std::abs(bulge)<RS_TOLERANCE || std::abs(bulge) >= RS_MAXDOUBLE) {
+    if (isLineBulge(bulge)) {
         entity = std::make_unique<RS_Line>(this,
                                            prepend ? v : data.endpoint,
                                            prepend ? data.startpoint : v);
     } else {
         // create arc for the polyline:
         bool reversed = std::signbit(bulge);
-        double alpha = std::atan(std::abs(bulge)) * 4.0;
-
         RS_Vector start = prepend ? data.startpoint : data.endpoint;
-        RS_Vector middle = (start + v)/2.0;
-        double dist=start.distanceTo(v)/2.0;
-        double angle=start.angleTo(v);
-
-        // alpha can't be 0.0 at this point
-        double const radius = std::abs(dist / std::sin(alpha/2.0));
-
-        double const wu = std::abs(radius*radius - dist*dist);
-        double angleNew = reversed ? angle - M_PI_2 : angle + M_PI_2;
-        double h = (std::abs(alpha)>M_PI) ? -std::sqrt(wu) : std::sqrt(wu);
-
-        auto center = middle + RS_Vector::polar(h, angleNew);
+        double radius = 0.;
+        auto center = bulgeArcCenter(start, v, bulge, radius);
         double startAngle = center.angleTo(prepend ? v : data.endpoint);
         double endAngle = center.angleTo(prepend ? data.startpoint : v);
 
@@ -254,7 +442,8 @@ std::unique_ptr<RS_Entity> RS_Polyline::createVertex(const RS_Vector& v, double
 void RS_Polyline::endPolyline() {
     RS_DEBUG->print("RS_Polyline::endPolyline");
 
-    if (isClosed()) {
+    // the closing segment of a compact polyline is given by the flag
+    if (!hasDeferredEntities() && isClosed()) {
         RS_DEBUG->print("RS_Polyline::endPolyline: adding closing entity");
 
         // remove old closing entity:
@@ -276,6 +465,11 @@ void RS_Polyline::endPolyline() {
 
 //RLZ: rewrite this:
 void RS_Polyline::setClosed(bool cl, [[maybe_unused]] double bulge) {
+    if (hasDeferredEntities()) {
+        setClosed(cl);
+        calculateBorders();
+        return;
+    }
     bool areClosed = isClosed();
     setClosed(cl);
     if (isClosed()) {
@@ -306,16 +500,20 @@ void RS_Polyline::setEndpoint(RS_Vector const& v) {
 void RS_Polyline::setLayer(const QString& name) {
     RS_Entity::setLayer(name);
     // set layer for sub-entities
-    for(RS_Entity* e : *this) {
-        e->setLayer(m_layer);
+    if (!hasDeferredEntities()) {
+        for(RS_Entity* e : *this) {
+            e->setLayer(m_layer);
+        }
     }
 }
 
 void RS_Polyline::setLayer(RS_Layer* l) {
     m_layer = l;
     // set layer for sub-entities
-    for(RS_Entity* e : *this) {
-        e->setLayer(m_layer);
+    if (!hasDeferredEntities()) {
+        for(RS_Entity* e : *this) {
+            e->setLayer(m_layer);
+        }
     }
 }
 
@@ -328,7 +526,8 @@ RS_Vector RS_Polyline::getEndpoint() const {
  * @return The bulge of the closing entity.
  */
 double RS_Polyline::getClosingBulge() const{
-    if (isClosed()) {
+    // compact polylines have no elliptic segments
+    if (!hasDeferredEntities() && isClosed()) {
         RS_Entity const* e = last();
         if (e && e->rtti()==RS2::EntityEllipse) {
             return static_cast<RS_Ellipse const*>(e)->getBulge();
@@ -340,7 +539,8 @@ double RS_Polyline::getClosingBulge() const{
 
 bool RS_Polyline::isClosed() const {
     // Issue #2360, test coincidence of end points for closed polylines
-    return (count() > 2 && getStartpoint() == getEndpoint())
+    size_t segments = hasDeferredEntities() ? segmentCount() : count();
+    return (segments > 2 && getStartpoint() == getEndpoint())
         || data.getFlag(RS2::FlagClosed);
 }
 
@@ -357,6 +557,10 @@ void RS_Polyline::setClosed(bool cl) {
  * Sets the polylines start and endpoint to match the first and last vertex.
  */
 void RS_Polyline::updateEndpoints() {
+    if (hasDeferredEntities()) {
+        // endpoints of compact polylines are the vertices
+        return;
+    }
     using namespace lc;
     LC_ContainerTraverser traverser{*this, RS2::ResolveNone};
     RS_Entity* e1 = firstEntity();
@@ -393,14 +597,14 @@ void RS_Polyline::addEntity(RS_Entity* /*entity*/) {
 
 RS_VectorSolutions RS_Polyline::getRefPoints() const{
     RS_VectorSolutions ret{{data.startpoint}};
-    for(auto e: *this){
+    visitSegments([&ret](RS_Entity* e) {
         if (e->isAtomic()) {
             if (e->isArc()){
                 ret.push_back(e->getMiddlePoint());
             }
             ret.push_back(e->getEndpoint());
         }
-    }
+    });
     ret.push_back( data.endpoint);
     return ret;
 }
@@ -419,6 +623,196 @@ RS_Vector RS_Polyline::getNearestSelectedRef( const RS_Vector& coord,
     return RS_Entity::getNearestSelectedRef( coord, dist);
 }
 
+/**
+ * Borders of a compact polyline are the ones of its segments
+ */
+void RS_Polyline::calculateBorders() {
+    if (!hasDeferredEntities()) {
+        RS_EntityContainer::calculateBorders();
+        return;
+    }
+    resetBorders();
+    visitCompactSegments([this](RS_Entity* segment, size_t) {
+        adjustBorders(segment);
+    });
+}
+
+void RS_Polyline::update() {
+    // segments of a compact polyline have nothing to update
+    if (!hasDeferredEntities()) {
+        RS_EntityContainer::update();
+    }
+}
+
+/**
+ * Nearest of the points found for the segments of a compact polyline
+ */
+RS_Vector RS_Polyline::getNearestSegmentPoint(const RS_Vector& coord, double* dist,
+                                              const std::function<RS_Vector(const RS_Entity*, double*)>& nearest) const {
+    double minDist = RS_MAXDOUBLE;
+    RS_Vector closestPoint(false);
+    visitCompactSegments([&](RS_Entity* segment, size_t) {
+        double curDist = RS_MAXDOUBLE;
+        RS_Vector point = nearest(segment, &curDist);
+        if (point.valid && curDist < minDist) {
+            closestPoint = point;
+            minDist = curDist;
+        }
+    });
+    if (dist != nullptr) {
+        *dist = minDist;
+    }
+    return closestPoint;
+}
+
+RS_Vector RS_Polyline::getNearestEndpoint(const RS_Vector& coord, double* dist) const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getNearestEndpoint(coord, dist);
+    }
+    double minDist = RS_MAXDOUBLE;
+    RS_Vector closestPoint(false);
+    // endpoints of the segments are the vertices
+    if (!ignoredOnModification()) {
+        for (const Vertex& vertex: m_vertices) {
+            RS_Vector point = vertex.position();
+            double curDist = point.distanceTo(coord);
+            if (curDist < minDist) {
+                closestPoint = point;
+                minDist = curDist;
+            }
+        }
+    }
+    if (dist != nullptr) {
+        *dist = minDist;
+    }
+    return closestPoint;
+}
+
+RS_Vector RS_Polyline::getNearestPointOnEntity(const RS_Vector& coord, bool onEntity,
+                                               double* dist, RS_Entity** entity) const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getNearestPointOnEntity(coord, onEntity, dist, entity);
+    }
+    if (ignoredSnap()) {
+        return RS_Vector(false);
+    }
+    // segments are not created for the query, the polyline is reported instead
+    if (entity != nullptr) {
+        *entity = const_cast<RS_Polyline*>(this);
+    }
+    return getNearestSegmentPoint(coord, dist, [&coord, onEntity](const RS_Entity* segment, double* segmentDist) {
+        return segment->getNearestPointOnEntity(coord, onEntity, segmentDist);
+    });
+}
+
+RS_Vector RS_Polyline::getNearestCenter(const RS_Vector& coord, double* dist) const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getNearestCenter(coord, dist);
+    }
+    if (ignoredSnap()) {
+        if (dist != nullptr) {
+            *dist = RS_MAXDOUBLE;
+        }
+        return RS_Vector(false);
+    }
+    return getNearestSegmentPoint(coord, dist, [&coord](const RS_Entity* segment, double* segmentDist) {
+        return segment->getNearestCenter(coord, segmentDist);
+    });
+}
+
+RS_Vector RS_Polyline::getNearestMiddle(const RS_Vector& coord, double* dist, int middlePoints) const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getNearestMiddle(coord, dist, middlePoints);
+    }
+    if (ignoredSnap()) {
+        if (dist != nullptr) {
+            *dist = RS_MAXDOUBLE;
+        }
+        return RS_Vector(false);
+    }
+    return getNearestSegmentPoint(coord, dist, [&coord, middlePoints](const RS_Entity* segment, double* segmentDist) {
+        return segment->getNearestMiddle(coord, segmentDist, middlePoints);
+    });
+}
+
+RS_Vector RS_Polyline::getNearestDist(double distance, const RS_Vector& coord, double* dist) const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getNearestDist(distance, coord, dist);
+    }
+    // the point on the nearest segment, as for children
+    double minDist = RS_MAXDOUBLE;
+    size_t nearest = 0;
+    visitCompactSegments([&](RS_Entity* segment, size_t index) {
+        double curDist = segment->getDistanceToPoint(coord, nullptr, RS2::ResolveNone);
+        if (curDist <= minDist) {
+            minDist = curDist;
+            nearest = index;
+        }
+    });
+    RS_Vector point(false);
+    visitCompactSegments([&](RS_Entity* segment, size_t index) {
+        if (index == nearest) {
+            point = segment->getNearestDist(distance, coord, dist);
+        }
+    });
+    return point;
+}
+
+double RS_Polyline::getDistanceToPoint(const RS_Vector& coord, RS_Entity** entity,
+                                       RS2::ResolveLevel level, double solidDist) const {
+    // resolved levels report the polyline as well, see RS_EntityContainer::getNearestEntity()
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getDistanceToPoint(coord, entity, level, solidDist);
+    }
+    double minDist = RS_MAXDOUBLE;
+    visitCompactSegments([&](RS_Entity* segment, size_t) {
+        minDist = std::min(minDist, segment->getDistanceToPoint(coord, nullptr, RS2::ResolveNone, solidDist));
+    });
+    if (entity != nullptr) {
+        *entity = const_cast<RS_Polyline*>(this);
+    }
+    return minDist;
+}
+
+double RS_Polyline::getLength() const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::getLength();
+    }
+    double length = 0.;
+    const size_t segments = segmentCount();
+    for (size_t i = 0; i < segments; i++) {
+        const Vertex& vertex = m_vertices[i];
+        length += segmentLength(vertex.position(), m_vertices[(i + 1) % m_vertices.size()].position(), vertex.bulge);
+    }
+    return length;
+}
+
+unsigned RS_Polyline::countDeep() const {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::countDeep();
+    }
+    return segmentCount();
+}
+
+unsigned RS_Polyline::countSelected(bool deep, QList<RS2::EntityType> const& types) {
+    if (!hasDeferredEntities()) {
+        return RS_EntityContainer::countSelected(deep, types);
+    }
+    // segments would take the selection of the polyline, see createVertex()
+    if (!isSelected()) {
+        return 0;
+    }
+    unsigned count = 0;
+    const size_t segments = segmentCount();
+    for (size_t i = 0; i < segments; i++) {
+        RS2::EntityType type = isLineBulge(m_vertices[i].bulge) ? RS2::EntityLine : RS2::EntityArc;
+        if (types.isEmpty() || types.contains(type)) {
+            count++;
+        }
+    }
+    return count;
+}
+
 /**
   * this should handle modifyOffset
   *@ coord, indicate direction of offset
@@ -427,6 +821,8 @@ RS_Vector RS_Polyline::getNearestSelectedRef( const RS_Vector& coord,
   *@Author, Dongxu Li
   */
 bool RS_Polyline::offset(const RS_Vector& coord, const double& distance){
+    // the segments are offset and trimmed one by one
+    prepareEntities();
     double dist;
     //find the nearest one
     int length=count();
@@ -588,6 +984,12 @@ bool RS_Polyline::offset(const RS_Vector& coord, const double& distance){
 }
 
 void RS_Polyline::move(const RS_Vector& offset) {
+    if (hasDeferredEntities()) {
+        transformVertices([&offset](RS_Vector& v) {
+            v.move(offset);
+        });
+        return;
+    }
     RS_EntityContainer::move(offset);
     data.startpoint.move(offset);
     data.endpoint.move(offset);
@@ -599,6 +1001,12 @@ void RS_Polyline::rotate(const RS_Vector& center, double angle) {
 }
 
 void RS_Polyline::rotate(const RS_Vector& center, const RS_Vector& angleVector) {
+    if (hasDeferredEntities()) {
+        transformVertices([&center, &angleVector](RS_Vector& v) {
+            v.rotate(center, angleVector);
+        });
+        return;
+    }
     RS_EntityContainer::rotate(center, angleVector);
     data.startpoint.rotate(center, angleVector);
     data.endpoint.rotate(center, angleVector);
@@ -606,6 +1014,14 @@ void RS_Polyline::rotate(const RS_Vector& center, const RS_Vector& angleVector)
 }
 
 void RS_Polyline::scale(const RS_Vector& center, const RS_Vector& factor) {
+    // arcs become elliptic by non-uniform scaling, which compact polylines don't keep
+    if (hasDeferredEntities() && (RS_Math::equal(factor.x, factor.y) || !containsArc())) {
+        transformVertices([&center, &factor](RS_Vector& v) {
+            v.scale(center, factor);
+        });
+        return;
+    }
+    prepareEntities();
     if (!RS_Math::equal(factor.x, factor.y)) {
         for (size_t i = 0; i < count(); ++i) {
             RS_Entity* e = entityAt(i);
@@ -629,13 +1045,56 @@ void RS_Polyline::scale(const RS_Vector& center, const RS_Vector& factor) {
     calculateBorders();
 }
 
+namespace {
+    // geometry of a polyline, vertices are set for compact polylines
+    struct PolylineGeometry {
+        RS_PolylineData data;
+        std::vector<RS_Polyline::Vertex> vertices;
+    };
+}
+
+std::unique_ptr<LC_EntityGeometry> RS_Polyline::doSaveGeometry() const {
+    auto geometry = std::make_unique<LC_EntityGeometryData<PolylineGeometry>>(PolylineGeometry{data, m_vertices});
+    if (!saveEntitiesGeometry(*geometry)) {
+        return nullptr;
+    }
+    return geometry;
+}
+
+void RS_Polyline::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    const PolylineGeometry& polyline = static_cast<const LC_EntityGeometryData<PolylineGeometry>&>(geometry).data;
+    data = polyline.data;
+    m_vertices = polyline.vertices;
+    restoreEntitiesGeometry(geometry);
+}
+
 bool RS_Polyline::containsArc() const{
+    if (hasDeferredEntities()) {
+        const size_t segments = segmentCount();
+        for (size_t i = 0; i < segments; i++) {
+            if (!isLineBulge(m_vertices[i].bulge)) {
+                return true;
+            }
+        }
+        return false;
+    }
     return std::any_of(cbegin(), cend(), [](const RS_Entity* entity) {
         return entity->rtti() == RS2::EntityArc;
     });
 }
 
 void RS_Polyline::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
+    if (hasDeferredEntities()) {
+        // mirrored arcs turn the other way
+        for (Vertex& vertex: m_vertices) {
+            vertex.bulge = -vertex.bulge;
+        }
+        m_nextBulge = m_vertices.back().bulge;
+        transformVertices([&axisPoint1, &axisPoint2](RS_Vector& v) {
+            v.mirror(axisPoint1, axisPoint2);
+        });
+        return;
+    }
     RS_EntityContainer::mirror(axisPoint1, axisPoint2);
     data.startpoint.mirror(axisPoint1, axisPoint2);
     data.endpoint.mirror(axisPoint1, axisPoint2);
@@ -643,6 +1102,7 @@ void RS_Polyline::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint
 }
 
 void RS_Polyline::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
+    prepareEntities();
     RS_EntityContainer::moveRef(ref, offset);
     if (ref.distanceTo(data.startpoint)<1.0e-4) {
         data.startpoint.move(offset);
@@ -655,6 +1115,19 @@ void RS_Polyline::moveRef(const RS_Vector& ref, const RS_Vector& offset) {
 }
 
 void RS_Polyline::revertDirection() {
+    if (hasDeferredEntities()) {
+        // the segment from vertex i to i+1 becomes the one from n-2-i to n-1-i, turning the other way
+        const size_t n = m_vertices.size();
+        std::vector<Vertex> reverted(m_vertices.crbegin(), m_vertices.crend());
+        for (size_t i = 0; i + 1 < n; i++) {
+            reverted[i].bulge = -m_vertices[n - 2 - i].bulge;
+        }
+        reverted.back().bulge = -m_vertices.back().bulge;
+        m_vertices.swap(reverted);
+        m_nextBulge = m_vertices.back().bulge;
+        std::swap(data.startpoint, data.endpoint);
+        return;
+    }
     RS_EntityContainer::revertDirection();
     RS_Vector tmp = data.startpoint;
     data.startpoint = data.endpoint;
@@ -662,6 +1135,7 @@ void RS_Polyline::revertDirection() {
 }
 
 void RS_Polyline::stretch(const RS_Vector& firstCorner, const RS_Vector& secondCorner, const RS_Vector& offset) {
+    prepareEntities();
     if (data.startpoint.isInWindow(firstCorner, secondCorner)) {
         data.startpoint.move(offset);
     }
@@ -677,7 +1151,7 @@ void RS_Polyline::stretch(const RS_Vector& firstCorner, const RS_Vector& secondC
  * Slightly optimized drawing for polylines.
  */
 void RS_Polyline::draw(RS_Painter* painter) {
-    if (count() == 0){
+    if (!hasDeferredEntities() && count() == 0){
         return;
     }
     painter->drawEntityPolyline(this);
@@ -770,11 +1244,12 @@ std::ostream& operator << (std::ostream& os, const RS_Polyline& l) {
  */
 RS_Vector RS_Polyline::getRefPointAdjacentDirection(bool previousSegment, RS_Vector& refPoint) {
     RS_Vector previous = getStartpoint();
+    lc::LC_ContainerTraverser traverser{*this, RS2::ResolveAll};
     if (refPoint == previous){ // handle start point
-        return entityAt(0)->getEndpoint();
+        return traverser.first()->getEndpoint();
     }
     bool breakOnNextVertex = false;
-    for (RS_Entity *entity: lc::LC_ContainerTraverser{*this, RS2::ResolveAll}.entities()) {
+    for (RS_Entity *entity: traverser.entities()) {
         RS_Vector segmentEndPoint = entity->getEndpoint();
         if (breakOnNextVertex){
             return segmentEndPoint;
@@ -28,7 +28,9 @@
 #pragma once
 #ifndef RS_Polyline_INCLUDE_H
 
+#include <functional>
 #include <utility>
+#include <vector>
 
 #include "rs_entitycontainer.h"
 
@@ -53,13 +55,33 @@ std::ostream& operator << (std::ostream& os, const RS_PolylineData& pd);
 /**
  * Class for a poly line entity (lots of connected lines and arcs).
  *
+ * Polylines created from vertex lists (see appendVertexs()) are kept compact: their vertices
+ * and bulges are stored in an array, and the segments are created as child entities only
+ * when an operation needs them, see hasDeferredEntities(). Drawing, snapping, borders,
+ * length, intersections and transformations work on the array.
+ *
  * @author Andrew Mustun
  */
 class RS_Polyline:public RS_EntityContainer {
 public:
+    /**
+     * Vertex of a compact polyline. The bulge belongs to the segment starting at the vertex,
+     * the bulge of the last vertex to the closing segment (see DXF documentation).
+     */
+    struct Vertex {
+        double x = 0.;
+        double y = 0.;
+        double bulge = 0.;
+
+        RS_Vector position() const{
+            return {x, y};
+        }
+    };
+
     RS_Polyline(RS_EntityContainer *parent = nullptr);
     RS_Polyline(RS_EntityContainer *parent, const RS_PolylineData &d);
     RS_Entity *clone() const override;
+    std::size_t getMemoryUsage() const override;
 
     /**	@return RS2::EntityPolyline */
     RS2::EntityType rtti() const override{
@@ -110,9 +132,24 @@ public:
         double bulge = 0.0, bool prepend = false);
     void appendVertexs(const std::vector<std::pair<RS_Vector, double> > &vl);
 
-    void setNextBulge(double bulge){
-        m_nextBulge = bulge;
+    void setNextBulge(double bulge);
+
+    /**
+     * @return vertices of a compact polyline, empty once the segments were created
+     */
+    const std::vector<Vertex>& getVertices() const{
+        return m_vertices;
     }
+    /**
+     * Visits the segments of the polyline in order. Segments of a compact polyline are
+     * temporary lines and arcs, valid during the call of the visitor only.
+     */
+    void visitSegments(const std::function<void(RS_Entity*)>& visitor) const;
+    /**
+     * @return intersections of the segments with the given entity, see RS_Information::getIntersection()
+     */
+    RS_VectorSolutions getIntersection(const RS_Entity* other, bool onEntities) const;
+    bool createTemporaryEntities(const std::function<bool(std::unique_ptr<RS_Entity>)>& consumer) const override;
 
     void addEntity(RS_Entity *entity) override;
 //void addSegment(RS_Entity* entity) override;
@@ -121,6 +158,30 @@ public:
 
 //void reorder() override;
 
+    void calculateBorders() override;
+    void update() override;
+    RS_Vector getNearestEndpoint(const RS_Vector& coord,
+                                 double* dist = nullptr) const override;
+    RS_Vector getNearestPointOnEntity(const RS_Vector& coord,
+                                      bool onEntity = true,
+                                      double* dist = nullptr,
+                                      RS_Entity** entity = nullptr) const override;
+    RS_Vector getNearestCenter(const RS_Vector& coord,
+                               double* dist = nullptr) const override;
+    RS_Vector getNearestMiddle(const RS_Vector& coord,
+                               double* dist = nullptr,
+                               int middlePoints = 1) const override;
+    RS_Vector getNearestDist(double distance,
+                             const RS_Vector& coord,
+                             double* dist = nullptr) const override;
+    double getDistanceToPoint(const RS_Vector& coord,
+                              RS_Entity** entity,
+                              RS2::ResolveLevel level = RS2::ResolveNone,
+                              double solidDist = RS_MAXDOUBLE) const override;
+    double getLength() const override;
+    unsigned countDeep() const override;
+    unsigned countSelected(bool deep = true, QList<RS2::EntityType> const& types = {}) override;
+
     bool offset(const RS_Vector &coord, const double &distance) override;
     void move(const RS_Vector &offset) override;
     void rotate(const RS_Vector &center, double angle) override;
@@ -151,8 +212,30 @@ protected:
     std::unique_ptr<RS_Entity> createVertex(
         const RS_Vector &v,
         double bulge = 0.0, bool prepend = false);
+    /**
+     * Creates the segments of a compact polyline as child entities
+     */
+    void createDeferredEntities() override;
+    unsigned countDeferredEntities() const override;
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
 
 private:
+    /**
+     * @return number of segments of a compact polyline, including the closing one
+     */
+    size_t segmentCount() const;
+    /**
+     * Visits the segments of a compact polyline, the index is the one of the starting vertex
+     */
+    void visitCompactSegments(const std::function<void(RS_Entity*, size_t)>& visitor) const;
+    RS_Vector getNearestSegmentPoint(const RS_Vector& coord, double* dist,
+                                     const std::function<RS_Vector(const RS_Entity*, double*)>& nearest) const;
+    void appendCompactVertexs(const std::vector<std::pair<RS_Vector, double>>& vl);
+    /**
+     * Applies the transformation to the vertices of a compact polyline and its endpoints
+     */
+    void transformVertices(const std::function<void(RS_Vector&)>& transform);
     /**
      * @brief Converts all circular arc (RS_Arc) segments to equivalent elliptic arcs (RS_Ellipse)
      *        to correctly handle non-uniform scaling (factor.x != factor.y).
@@ -168,6 +251,8 @@ private:
     RS_PolylineData data;
     RS_Entity *m_closingEntity = nullptr;
     double m_nextBulge = 0.;
+    /** vertices of a compact polyline, while its segments are deferred */
+    std::vector<Vertex> m_vertices;
 };
 
 #endif // RS_Polyline_INCLUDE_H
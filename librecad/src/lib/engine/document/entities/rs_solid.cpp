@@ -32,6 +32,7 @@
 #include "rs_solid.h"
 
 
+#include "lc_entitygeometry.h"
 #include "rs_debug.h"
 #include "rs_information.h"
 #include "rs_line.h"
@@ -136,6 +137,10 @@ RS_Entity* RS_Solid::clone() const{
     return s;
 }
 
+std::size_t RS_Solid::getMemoryUsage() const {
+    return sizeof(RS_Solid);
+}
+
 /**
  * @return Corner number 'num'.
  */
@@ -443,6 +448,15 @@ void RS_Solid::scale(const RS_Vector& center, const RS_Vector& factor){
     calculateBorders();
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_Solid::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_SolidData>>(data);
+}
+
+void RS_Solid::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_SolidData>&>(geometry).data;
+    calculateBorders();
+}
+
 void RS_Solid::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2){
     for (int i = RS_SolidData::FirstCorner; i < RS_SolidData::MaxCorners; ++i) {
         if (data.corner[i].valid) {
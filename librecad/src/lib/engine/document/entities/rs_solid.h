@@ -81,6 +81,7 @@ public:
         RS_Solid(const RS_SolidData& d);
 
     RS_Entity* clone() const override;
+    std::size_t getMemoryUsage() const override;
 
     /** @return RS_ENTITY_POINT */
     RS2::EntityType rtti() const  override
@@ -146,6 +147,8 @@ public:
     bool isInCrossWindow(const RS_Vector& v1, const RS_Vector& v2) const;
 
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
     RS_SolidData data;
 
 private:
@@ -30,6 +30,7 @@
 #include <algorithm>
 #include <iostream>
 
+#include "lc_entitygeometry.h"
 #include "lc_splinehelper.h"
 #include "rs_debug.h"
 #include "rs_line.h"
@@ -106,6 +107,12 @@ RS_Entity *RS_Spline::clone() const {
   return l;
 }
 
+std::size_t RS_Spline::getMemoryUsage() const {
+    const std::size_t points = data.controlPoints.capacity() + data.fitPoints.capacity();
+    const std::size_t values = data.knotslist.capacity() + data.weights.capacity() + data.savedOpenKnots.capacity();
+    return sizeof(RS_Spline) + points * sizeof(RS_Vector) + values * sizeof(double) + getEntitiesMemoryUsage();
+}
+
 /** Data access */
 RS_SplineData &RS_Spline::getData() { return data; }
 const RS_SplineData &RS_Spline::getData() const { return data; }
@@ -347,6 +354,19 @@ void RS_Spline::scale(const RS_Vector &center, const RS_Vector &factor) {
   calculateBorders();
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_Spline::doSaveGeometry() const {
+    auto geometry = std::make_unique<LC_EntityGeometryData<RS_SplineData>>(data);
+    if (!saveEntitiesGeometry(*geometry)) {
+        return nullptr;
+    }
+    return geometry;
+}
+
+void RS_Spline::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_SplineData>&>(geometry).data;
+    restoreEntitiesGeometry(geometry);
+}
+
 RS_Entity &RS_Spline::shear(double k) {
   for (auto &cp : data.controlPoints)
     cp.shear(k);
@@ -105,6 +105,7 @@ public:
 
   /** Clone the spline */
   RS_Entity *clone() const override;
+  std::size_t getMemoryUsage() const override;
 
   /** Get spline data reference */
   RS_SplineData &getData();
@@ -321,6 +322,9 @@ public:
 
   friend class RS_FilterDXFRW;
 
+protected:
+  std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+  void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
 private:
   /** Internal spline data */
   RS_SplineData data;
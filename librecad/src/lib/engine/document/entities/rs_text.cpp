@@ -24,10 +24,15 @@
 **
 **********************************************************************/
 
+#include <cmath>
 #include<iostream>
+#include <utility>
+#include <vector>
 
 #include "rs_text.h"
 
+#include "lc_entitygeometry.h"
+#include "rs_block.h"
 #include "rs_debug.h"
 #include "rs_font.h"
 #include "rs_fontlist.h"
@@ -98,6 +103,10 @@ RS_Entity* RS_Text::clone() const{
     return t;
 }
 
+std::size_t RS_Text::getMemoryUsage() const {
+    return sizeof(RS_Text) + data.text.capacity() * sizeof(QChar) + getEntitiesMemoryUsage();
+}
+
 /**
  * Sets a new text. The entities representing the
  * text are updated.
@@ -260,11 +269,15 @@ void RS_Text::update() {
     RS_Vector letterSpace = RS_Vector(font->getLetterSpacing(), 0.0);
     RS_Vector space = RS_Vector(font->getWordSpacing(), 0.0);
 
-    // First every text line is created with
+    // First every letter is placed with
     //   alignment: top left
     //   angle: 0
     //   height: 9.0
-    // Rotation, scaling and centering is done later
+    // using the borders of glyphs measured by the font. Rotation, scaling and centering
+    // are applied to the positions later, so every letter is created only once.
+    std::vector<std::pair<RS_Block*, RS_Vector>> letters;
+    RS_Vector textMin(RS_MAXDOUBLE, RS_MAXDOUBLE);
+    RS_Vector textMax(RS_MINDOUBLE, RS_MINDOUBLE);
 
     // For every letter:
     for (int i=0; i<(int)data.text.length(); ++i) {
@@ -273,45 +286,42 @@ void RS_Text::update() {
             letterPos+=space;
         } else {
             // One Letter:
-            QString letterText = QString(data.text.at(i));
-            if (font->findLetter(letterText) == nullptr) {
-                RS_DEBUG->print("RS_Text::update: missing font for letter( %s ), replaced it with QChar(0xfffd)",qPrintable(letterText));
-                letterText = QChar(0xfffd);
+            RS_Font::Glyph glyph = font->findGlyph(data.text.at(i));
+            if (glyph.block == nullptr) {
+                RS_DEBUG->print("RS_Text::update: missing font for letter( %s ), replaced it with QChar(0xfffd)",
+                                qPrintable(QString(data.text.at(i))));
+                glyph = font->findGlyph(QChar(0xfffd));
             }
             RS_DEBUG->print("RS_Text::update: insert a "
                             "letter at pos: %f/%f", letterPos.x, letterPos.y);
 
-            RS_InsertData d(letterText,
-                            letterPos,
-                            RS_Vector(1.0, 1.0),
-                            0.0,
-                            1,1, RS_Vector(0.0,0.0),
-                            font->getLetterList(), RS2::NoUpdate);
-
-            auto* letter = new RS_Insert(this, d);
-            RS_Vector letterWidth;
-            letter->setPen(RS_Pen(RS2::FlagInvalid));
-            letter->setLayer(nullptr);
-            letter->update();
-            letter->forcedCalculateBorders();
-
-            letterWidth = RS_Vector(letter->getMax().x-letterPos.x, 0.0);
-            if (letterWidth.x < 0) {
-                letterWidth.x = -letterSpace.x;
+            double letterWidth = 0.0;
+            if (glyph.isEmpty()) {
+                // borders of an empty letter are at 0/0
+                letterWidth = -letterPos.x;
+            } else {
+                letterWidth = glyph.max.x;
+                textMin = RS_Vector::minimum(textMin, letterPos + glyph.min);
+                textMax = RS_Vector::maximum(textMax, letterPos + glyph.max);
+            }
+            if (letterWidth < 0) {
+                letterWidth = -letterSpace.x;
+            }
+            if (glyph.block != nullptr) {
+                letters.emplace_back(glyph.block, letterPos);
             }
-            addEntity(letter);
 
             // next letter position:
-            letterPos += letterWidth;
+            letterPos.x += letterWidth;
             letterPos += letterSpace;
         }
     }
 
-    if (!getAutoUpdateBorders()) {
-        //only update borders when needed
-        forcedCalculateBorders();
+    if (textMin.x > textMax.x) {
+        // same as borders of the container without visible letters
+        textMin = textMax = RS_Vector(0.0, 0.0);
     }
-    RS_Vector textSize = getSize();
+    RS_Vector textSize = textMax - textMin;
 
     RS_DEBUG->print("RS_Text::updateAddLine: width 2: %f", textSize.x);
 
@@ -344,7 +354,7 @@ void RS_Text::update() {
     // Horizontal Align:
     switch (data.halign) {
         case RS_TextData::HAMiddle:{
-            offset.move(RS_Vector(-textSize.x/2.0, -(vSize + textSize.y/2.0 + getMin().y) ));
+            offset.move(RS_Vector(-textSize.x/2.0, -(vSize + textSize.y/2.0 + textMin.y) ));
             break;
         }
         case RS_TextData::HACenter: {
@@ -363,30 +373,27 @@ void RS_Text::update() {
     if (data.halign!=RS_TextData::HAAligned && data.halign!=RS_TextData::HAFit){
         data.secondPoint = RS_Vector(offset.x, offset.y - vSize);
     }
-    RS_EntityContainer::move(offset);
-
 
     // Scale:
+    RS_Vector letterScale(1.0, 1.0);
     if (data.halign==RS_TextData::HAAligned){
         double dist = data.insertionPoint.distanceTo(data.secondPoint)/textSize.x;
         data.height = vSize*dist;
-        RS_EntityContainer::scale(RS_Vector(0.0,0.0),
-                                  RS_Vector(dist, dist));
+        letterScale = RS_Vector(dist, dist);
     } else if (data.halign==RS_TextData::HAFit){
         double dist = data.insertionPoint.distanceTo(data.secondPoint)/textSize.x;
-        RS_EntityContainer::scale(RS_Vector(0.0,0.0),
-                                  RS_Vector(dist, data.height/9.0));
+        letterScale = RS_Vector(dist, data.height/9.0);
     } else {
-        RS_EntityContainer::scale(RS_Vector(0.0,0.0),
-                                  RS_Vector(data.height*data.widthRel/9.0, data.height/9.0));
-        data.secondPoint.scale(RS_Vector(0.0,0.0),
-                               RS_Vector(data.height*data.widthRel/9.0, data.height/9.0));
+        letterScale = RS_Vector(data.height*data.widthRel/9.0, data.height/9.0);
+        data.secondPoint.scale(RS_Vector(0.0,0.0), letterScale);
+    }
+    // degenerated scaling is ignored, as for containers
+    if (std::abs(letterScale.x) <= RS_TOLERANCE || std::abs(letterScale.y) <= RS_TOLERANCE) {
+        letterScale = RS_Vector(1.0, 1.0);
     }
-
-    forcedCalculateBorders();
 
     // Update actual text size (before rotating, after scaling!):
-    usedTextWidth = getSize().x;
+    usedTextWidth = std::abs(textSize.x * letterScale.x);
     usedTextHeight = data.height;
 
     // Rotate:
@@ -397,10 +404,29 @@ void RS_Text::update() {
         data.secondPoint.rotate(RS_Vector(0.0,0.0), data.angle);
         data.secondPoint.move(data.insertionPoint);
     }
-    RS_EntityContainer::rotate(RS_Vector(0.0,0.0), data.angle);
 
-    // Move to insertion point:
-    RS_EntityContainer::move(data.insertionPoint);
+    // letters are created at their final place
+    const double letterAngle = RS_Math::correctAngle(data.angle);
+    for (const auto& [block, position]: letters) {
+        RS_Vector letterInsertionPoint = position + offset;
+        letterInsertionPoint.scale(letterScale);
+        letterInsertionPoint.rotate(data.angle);
+        letterInsertionPoint.move(data.insertionPoint);
+
+        RS_InsertData d(block->getName(),
+                        letterInsertionPoint,
+                        letterScale,
+                        letterAngle,
+                        1,1, RS_Vector(0.0,0.0),
+                        font->getLetterList(), RS2::NoUpdate);
+
+        auto* letter = new RS_Insert(this, d);
+        letter->setBlockForInsert(block);
+        letter->setPen(RS_Pen(RS2::FlagInvalid));
+        letter->setLayer(nullptr);
+        letter->update();
+        addEntity(letter);
+    }
 
     updateBaselinePoints();
 
@@ -478,6 +504,15 @@ void RS_Text::scale(const RS_Vector& center, const RS_Vector& factor) {
     update();
 }
 
+std::unique_ptr<LC_EntityGeometry> RS_Text::doSaveGeometry() const {
+    return std::make_unique<LC_EntityGeometryData<RS_TextData>>(data);
+}
+
+void RS_Text::doRestoreGeometry(const LC_EntityGeometry& geometry) {
+    data = static_cast<const LC_EntityGeometryData<RS_TextData>&>(geometry).data;
+    update();
+}
+
 void RS_Text::mirror(const RS_Vector& axisPoint1, const RS_Vector& axisPoint2) {
     bool readable = RS_Math::isAngleReadable(data.angle);
 
@@ -551,7 +586,7 @@ void RS_Text::draw(RS_Painter* painter){
         return;
     }
 
-    for(RS_Entity* e: *this){
+    for(RS_Entity* e: std::as_const(*this)){
        painter->drawAsChild(e);
     }
 }
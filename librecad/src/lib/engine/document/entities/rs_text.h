@@ -141,6 +141,7 @@ public:
             const RS_TextData& d);
 
     RS_Entity* clone() const override;
+    std::size_t getMemoryUsage() const override;
 
     /**	@return RS2::EntityText */
     RS2::EntityType rtti() const override{
@@ -247,6 +248,8 @@ public:
     RS_Vector getNearestRef(const RS_Vector &coord, double *dist) const override;
     void moveRef(const RS_Vector &ref, const RS_Vector &offset) override;
 protected:
+    std::unique_ptr<LC_EntityGeometry> doSaveGeometry() const override;
+    void doRestoreGeometry(const LC_EntityGeometry& geometry) override;
     RS_TextData data;
 
     /**
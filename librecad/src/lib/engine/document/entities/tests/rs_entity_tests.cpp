@@ -0,0 +1,157 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD (librecad.org)
+**
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+#include <memory>
+#include <utility>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "rs_entitycontainer.h"
+#include "rs_graphic.h"
+#include "rs_line.h"
+#include "rs_pen.h"
+#include "rs_point.h"
+#include "rs_settings.h"
+
+TEST_CASE("RS_Entity::user defined variables") {
+    RS_Line line(nullptr, {RS_Vector(0., 0.), RS_Vector(1., 0.)});
+    REQUIRE(line.getAllKeys().empty());
+    REQUIRE(line.getUserDefVar("key").isEmpty());
+
+    line.setUserDefVar("key", "value");
+    REQUIRE(line.getUserDefVar("key") == "value");
+    REQUIRE(line.getAllKeys().size() == 1);
+
+    // clones have their own variables
+    std::unique_ptr<RS_Entity> clone{line.clone()};
+    REQUIRE(clone->getId() != line.getId());
+    REQUIRE(clone->getUserDefVar("key") == "value");
+    clone->delUserDefVar("key");
+    REQUIRE(clone->getAllKeys().empty());
+    REQUIRE(line.getUserDefVar("key") == "value");
+
+    line.delUserDefVar("key");
+    REQUIRE(line.getAllKeys().empty());
+    REQUIRE(line.getUserDefVar("key").isEmpty());
+}
+
+TEST_CASE("RS_Entity::user defined variables of graphics") {
+    // graphics read their defaults from the settings
+    if (RS_Settings::instance() == nullptr) {
+        RS_Settings::init("LibreCAD", "LibreCAD_tests");
+    }
+    RS_Graphic graphic;
+    RS_Graphic other;
+    RS_Line line(&graphic, {RS_Vector(0., 0.), RS_Vector(1., 0.)});
+    line.setUserDefVar("key", "value");
+    REQUIRE(graphic.getUserDefVars().size() == 1);
+    REQUIRE(other.getUserDefVars().empty());
+
+    // lookups don't add variables
+    RS_Line plain(&graphic, {RS_Vector(0., 1.), RS_Vector(1., 1.)});
+    REQUIRE(plain.getUserDefVar("key").isEmpty());
+    REQUIRE(line.getUserDefVar("other").isEmpty());
+    REQUIRE(plain.getAllKeys().empty());
+    REQUIRE(graphic.getUserDefVars().size() == 1);
+
+    // variables move with the entity to another graphic
+    line.setParent(&other);
+    REQUIRE(graphic.getUserDefVars().empty());
+    REQUIRE(other.getUserDefVars().size() == 1);
+    REQUIRE(line.getUserDefVar("key") == "value");
+
+    // and are released with the entity
+    {
+        std::unique_ptr<RS_Entity> clone{line.clone()};
+        REQUIRE(clone->getUserDefVar("key") == "value");
+        REQUIRE(other.getUserDefVars().size() == 2);
+    }
+    REQUIRE(other.getUserDefVars().size() == 1);
+    line.delUserDefVar("key");
+    REQUIRE(other.getUserDefVars().empty());
+    REQUIRE(line.getAllKeys().empty());
+    REQUIRE(other.getUserDefVars().empty());
+}
+
+TEST_CASE("RS_Entity::pens") {
+    RS_Line line(nullptr, {RS_Vector(0., 0.), RS_Vector(1., 0.)});
+    RS_Line other(nullptr, {RS_Vector(0., 1.), RS_Vector(1., 1.)});
+
+    RS_Pen pen(RS_Color(255, 0, 0), RS2::Width13, RS2::DashLine);
+    line.setPen(pen);
+    other.setPen(pen);
+    REQUIRE(line.getPen(false) == pen);
+    REQUIRE(other.getPen(false) == pen);
+
+    // attributes not compared by RS_Pen::operator==() are kept too
+    pen.setAlpha(0.5f);
+    other.setPen(pen);
+    REQUIRE(other.getPen(false).getAlpha() == 0.5f);
+    REQUIRE(line.getPen(false).getAlpha() == 1.f);
+
+    RS_Pen byLayer(RS_Color(RS2::FlagByLayer), RS2::WidthByLayer, RS2::LineByLayer);
+    line.setPen(byLayer);
+    REQUIRE(line.getPen(false).isColorByLayer());
+    REQUIRE(line.getPen(false).isWidthByLayer());
+    REQUIRE(line.getPen(false).isLineTypeByLayer());
+}
+
+TEST_CASE("RS_Entity::pens no longer used") {
+    RS_Line line(nullptr, {RS_Vector(0., 0.), RS_Vector(1., 0.)});
+    RS_Pen kept(RS_Color(0, 0, 255), RS2::Width05, RS2::SolidLine);
+    line.setPen(kept);
+    {
+        RS_Line released(nullptr, {RS_Vector(0., 1.), RS_Vector(1., 1.)});
+        released.setPen(RS_Pen(RS_Color(0, 255, 0), RS2::Width09, RS2::DotLine));
+        std::unique_ptr<RS_Entity> copy{released.clone()};
+        REQUIRE(copy->getPen(false) == released.getPen(false));
+    }
+    // the entry of the released pen is reused, pens in use are kept
+    RS_Line other(nullptr, {RS_Vector(0., 2.), RS_Vector(1., 2.)});
+    RS_Pen added(RS_Color(255, 255, 0), RS2::Width13, RS2::DashLine);
+    other.setPen(added);
+    REQUIRE(other.getPen(false) == added);
+    REQUIRE(line.getPen(false) == kept);
+
+    RS_Line moved{std::move(other)};
+    REQUIRE(moved.getPen(false) == added);
+}
+
+TEST_CASE("RS_Entity::memory") {
+    // entities keep the index of their pen instead of a heap block with the pen,
+    // with that block an entity took 128 bytes on 64-bit platforms
+    REQUIRE(sizeof(RS_Entity) <= 128);
+    // atomic entities add their data only
+    REQUIRE(sizeof(RS_Point) <= sizeof(RS_Entity) + sizeof(RS_PointData));
+
+    RS_Line line(nullptr, {RS_Vector(0., 0.), RS_Vector(1., 0.)});
+    REQUIRE(line.getMemoryUsage() == sizeof(RS_Line));
+
+    // children are counted with their container
+    RS_EntityContainer container;
+    container.addEntity(new RS_Line(&container, {RS_Vector(0., 0.), RS_Vector(1., 0.)}));
+    container.addEntity(new RS_Point(&container, RS_PointData(RS_Vector(2., 0.))));
+    REQUIRE(container.getMemoryUsage()
+            == sizeof(RS_EntityContainer) + 2 * sizeof(RS_Entity*) + sizeof(RS_Line) + sizeof(RS_Point));
+}
@@ -0,0 +1,185 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD (librecad.org)
+**
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "lc_containertraverser.h"
+#include "rs_information.h"
+#include "rs_line.h"
+#include "rs_polyline.h"
+
+namespace {
+const std::vector<std::pair<RS_Vector, double>> vertices{
+    {{0., 0.}, 0.},
+    {{10., 0.}, 0.5},
+    {{10., 10.}, 0.},
+    {{0., 10.}, -0.25}
+};
+
+// the same polyline with segments created vertex by vertex
+std::unique_ptr<RS_Polyline> createWithSegments(bool closed) {
+    auto polyline = std::make_unique<RS_Polyline>(nullptr, RS_PolylineData{RS_Vector{}, RS_Vector{}, closed});
+    for (const auto& [v, bulge]: vertices) {
+        polyline->addVertex(v, bulge);
+    }
+    return polyline;
+}
+
+std::unique_ptr<RS_Polyline> createCompact(bool closed) {
+    auto polyline = std::make_unique<RS_Polyline>(nullptr, RS_PolylineData{RS_Vector{}, RS_Vector{}, closed});
+    polyline->appendVertexs(vertices);
+    return polyline;
+}
+
+bool equalPoints(const RS_Vector& p1, const RS_Vector& p2) {
+    return p1.valid == p2.valid && p1.distanceTo(p2) < 1e-9;
+}
+
+void requireSameSegments(const RS_Polyline& compact, const RS_Polyline& expected) {
+    std::vector<std::unique_ptr<RS_Entity>> segments;
+    compact.visitSegments([&segments](RS_Entity* segment) {
+        segments.emplace_back(segment->clone());
+    });
+    REQUIRE(segments.size() == expected.count());
+    for (size_t i = 0; i < segments.size(); i++) {
+        const RS_Entity* e = expected.entityAt(i);
+        REQUIRE(segments[i]->rtti() == e->rtti());
+        REQUIRE(equalPoints(segments[i]->getStartpoint(), e->getStartpoint()));
+        REQUIRE(equalPoints(segments[i]->getEndpoint(), e->getEndpoint()));
+    }
+}
+}
+
+TEST_CASE("RS_Polyline::compact vertices") {
+    for (bool closed: {false, true}) {
+        auto compact = createCompact(closed);
+        auto expected = createWithSegments(closed);
+        REQUIRE(compact->hasDeferredEntities());
+        REQUIRE(compact->getVertices().size() == vertices.size());
+        REQUIRE(compact->isClosed() == expected->isClosed());
+        requireSameSegments(*compact, *expected);
+
+        REQUIRE(std::abs(compact->getLength() - expected->getLength()) < 1e-9);
+        REQUIRE(equalPoints(compact->getMin(), expected->getMin()));
+        REQUIRE(equalPoints(compact->getMax(), expected->getMax()));
+
+        const RS_Vector coord{12., 5.};
+        double compactDist = 0., expectedDist = 0.;
+        REQUIRE(equalPoints(compact->getNearestPointOnEntity(coord, true, &compactDist),
+                            expected->getNearestPointOnEntity(coord, true, &expectedDist)));
+        REQUIRE(std::abs(compactDist - expectedDist) < 1e-9);
+        REQUIRE(equalPoints(compact->getNearestEndpoint(coord), expected->getNearestEndpoint(coord)));
+
+        RS_Line line{nullptr, {-5., 5.}, {20., 5.}};
+        REQUIRE(RS_Information::getIntersection(compact.get(), &line, true).size()
+                == (closed ? 2 : 1));
+        // none of the queries above needs the segments
+        REQUIRE(compact->count() == expected->count());
+        REQUIRE(compact->hasDeferredEntities());
+
+        // segments are created as for vertices added one by one
+        compact->prepareEntities();
+        REQUIRE_FALSE(compact->hasDeferredEntities());
+        REQUIRE(compact->count() == expected->count());
+        REQUIRE(compact->getVertices().empty());
+        requireSameSegments(*compact, *expected);
+    }
+}
+
+TEST_CASE("RS_Polyline::compact read-only traversal") {
+    auto compact = createCompact(true);
+    auto expected = createWithSegments(true);
+    const RS_Polyline& constCompact = *compact;
+
+    // accessors don't create the segments
+    REQUIRE(constCompact.count() == expected->count());
+    REQUIRE(constCompact.hasDeferredEntities());
+
+    // read-only traversals visit temporary segments
+    std::vector<std::unique_ptr<RS_Entity>> segments;
+    REQUIRE(constCompact.visitEntities([&segments](RS_Entity* segment) {
+        REQUIRE(segment->getParent() == nullptr);
+        segments.emplace_back(segment->clone());
+        return true;
+    }));
+    REQUIRE(segments.size() == expected->count());
+    {
+        lc::LC_ContainerTraverser traverser{constCompact, RS2::ResolveAll};
+        REQUIRE(traverser.entities().size() == expected->count());
+    }
+    double dist = 0.;
+    REQUIRE(constCompact.getNearestEntity({12., 5.}, &dist, RS2::ResolveAll) == compact.get());
+    REQUIRE(compact->hasDeferredEntities());
+
+    // traversals which may modify the entities found create the segments
+    lc::LC_ContainerTraverser traverser{*compact, RS2::ResolveAll};
+    REQUIRE_FALSE(compact->hasDeferredEntities());
+    REQUIRE(traverser.entities().size() == expected->count());
+    requireSameSegments(*compact, *expected);
+}
+
+TEST_CASE("RS_Polyline::compact transformations") {
+    for (bool closed: {false, true}) {
+        auto compact = createCompact(closed);
+        auto expected = createWithSegments(closed);
+
+        std::unique_ptr<RS_Polyline> clone{static_cast<RS_Polyline*>(compact->clone())};
+        REQUIRE(clone->hasDeferredEntities());
+        requireSameSegments(*clone, *expected);
+
+        const RS_Vector center{3., 4.};
+        for (RS_Polyline* polyline: {compact.get(), expected.get()}) {
+            polyline->move({1., 2.});
+            polyline->rotate(center, 0.5);
+            polyline->scale(center, {2., 2.});
+            polyline->mirror(center, {5., 0.});
+        }
+        REQUIRE(compact->hasDeferredEntities());
+        requireSameSegments(*compact, *expected);
+        REQUIRE(equalPoints(compact->getMin(), expected->getMin()));
+        REQUIRE(equalPoints(compact->getMax(), expected->getMax()));
+
+        // the segments of the reverted polyline are the reverted ones
+        auto original = createWithSegments(closed);
+        auto reverted = createCompact(closed);
+        reverted->revertDirection();
+        REQUIRE(reverted->hasDeferredEntities());
+        REQUIRE(std::abs(reverted->getLength() - original->getLength()) < 1e-9);
+        std::vector<std::unique_ptr<RS_Entity>> segments;
+        reverted->visitSegments([&segments](RS_Entity* segment) {
+            segments.emplace_back(segment->clone());
+        });
+        REQUIRE(segments.size() == original->count());
+        for (size_t i = 0; i < segments.size(); i++) {
+            const RS_Entity* e = original->entityAt(original->count() - 1 - i);
+            REQUIRE(equalPoints(segments[i]->getStartpoint(), e->getEndpoint()));
+            REQUIRE(equalPoints(segments[i]->getEndpoint(), e->getStartpoint()));
+            REQUIRE(equalPoints(segments[i]->getMiddlePoint(), e->getMiddlePoint()));
+        }
+    }
+}
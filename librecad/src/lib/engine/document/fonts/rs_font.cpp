@@ -503,6 +503,22 @@ RS_Block* RS_Font::findLetter(const QString& name) {
 
 }
 
+RS_Font::Glyph RS_Font::findGlyph(QChar ch) {
+    auto it = m_glyphs.constFind(ch);
+    if (it != m_glyphs.cend()) {
+        return it.value();
+    }
+    Glyph glyph;
+    glyph.block = findLetter(QString(ch));
+    if (glyph.block != nullptr && !glyph.block->isEmpty()) {
+        glyph.block->calculateBorders();
+        glyph.min = glyph.block->getMin() - glyph.block->getBasePoint();
+        glyph.max = glyph.block->getMax() - glyph.block->getBasePoint();
+    }
+    m_glyphs.insert(ch, glyph);
+    return glyph;
+}
+
 /**
  * Dumps the fonts data to stdout.
  */
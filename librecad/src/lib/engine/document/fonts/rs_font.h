@@ -28,10 +28,12 @@
 #ifndef RS_FONT_H
 #define RS_FONT_H
 
+#include <QHash>
 #include <QMap>
 #include <QStringList>
 
 #include "rs_blocklist.h"
+#include "rs_vector.h"
 
 
 class RS_BlockList;
@@ -44,6 +46,22 @@ class RS_BlockList;
  */
 class RS_Font {
 public:
+    /**
+     * Letter of the font, measured once and shared by all texts using it.
+     */
+    struct Glyph {
+        /** block of the letter, nullptr if the font has no such letter */
+        RS_Block* block = nullptr;
+        /** borders of the letter relative to the base point of the block */
+        RS_Vector min{false};
+        RS_Vector max{false};
+
+        /** @return true, if the letter has no entities, e.g. a space */
+        bool isEmpty() const {
+            return !min.valid;
+        }
+    };
+
     RS_Font(const QString& name, bool owner=true);
     //RS_Font(const char* name);
 
@@ -101,6 +119,10 @@ public:
         return &letterList;
     }
     RS_Block* findLetter(const QString& name);
+    /**
+     * @return the letter for the given character, with the block set to nullptr if there is no such letter
+     */
+    Glyph findGlyph(QChar ch);
     //    RS_Block* findLetter(const QString& name) {
     //		return letterList.find(name);
     //	}
@@ -123,6 +145,9 @@ private:
     //! block list (letters)
     RS_BlockList letterList;
 
+    //! letters already looked up, by character
+    QHash<QChar, Glyph> m_glyphs;
+
     //! Font file name
     QString m_fileName;
 
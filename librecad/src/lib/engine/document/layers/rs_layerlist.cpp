@@ -45,6 +45,7 @@ RS_LayerList::RS_LayerList() {
  */
 void RS_LayerList::clear() {
     m_layers.clear();
+    m_nameIndex.clear();
     setModified(true);
 }
 
@@ -128,6 +129,7 @@ void RS_LayerList::add(RS_Layer* layerToAdd) {
     RS_Layer* existingLayer = find(layerToAdd->getName());
     if (existingLayer == nullptr) {
         m_layers.append(layerToAdd);
+        m_nameIndex.insert(layerToAdd);
         this->sort();
         // notify listeners
         fireLayerAdded(layerToAdd);
@@ -177,6 +179,7 @@ void RS_LayerList::remove(RS_Layer* layerToRemove) {
 
     // here the layer is removed from the list but not deleted
     m_layers.removeOne(layerToRemove);
+    m_nameIndex.remove(layerToRemove);
 
     fireLayerRemoved(layerToRemove);
 
@@ -205,6 +208,12 @@ void RS_LayerList::edit(RS_Layer* layer, const RS_Layer& source) {
 }
 
 void RS_LayerList::fireEdit(RS_Layer* layer) {
+    // layers may be renamed before the edit is announced, nullptr stands for any layer
+    if (layer != nullptr) {
+        m_nameIndex.rename(layer);
+    } else {
+        m_nameIndex.rebuild(m_layers);
+    }
     for (auto l : m_layerListListeners) {
         l->layerEdited(layer);
     }
@@ -216,14 +225,7 @@ void RS_LayerList::fireEdit(RS_Layer* layer) {
  * \p nullptr if no such layer was found.
  */
 RS_Layer* RS_LayerList::find(const QString& name) {
-    RS_Layer* ret = nullptr;
-    for (auto l : m_layers) {
-        if (l->getName() == name) {
-            ret = l;
-            break;
-        }
-    }
-    return ret;
+    return m_nameIndex.find(name, m_layers);
 }
 
 /**
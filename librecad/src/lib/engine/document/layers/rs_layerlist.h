@@ -31,6 +31,8 @@
 
 #include <QList>
 
+#include "lc_nameindex.h"
+
 class RS_Layer;
 class RS_LayerListListener;
 
@@ -122,6 +124,8 @@ public:
 private:
 	//! layers in the graphic
     QList<RS_Layer*> m_layers;
+    //! layers by name
+    LC_NameIndex<RS_Layer> m_nameIndex;
     //! List of registered LayerListListeners
     QList<RS_LayerListListener*> m_layerListListeners;
     RS_Layer *m_activeLayer = nullptr;
@@ -0,0 +1,85 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include "lc_documentchangelog.h"
+
+#include "rs.h"
+#include "rs_entity.h"
+
+namespace {
+// beyond that many changes between two repaints, repainting everything is cheaper anyway
+constexpr size_t maxLoggedAreas = 4096;
+
+bool isSameArea(const LC_Rect& a, const LC_Rect& b) {
+    return a.minP() == b.minP() && a.maxP() == b.maxP();
+}
+}
+
+void LC_DocumentChangeLog::markChanged(const RS_Vector& corner1, const RS_Vector& corner2) {
+    if (!corner1.valid || !corner2.valid) {
+        markAllChanged();
+        return;
+    }
+    m_revision++;
+    LC_Rect area{corner1, corner2};
+    if (!m_areas.empty() && isSameArea(m_areas.back().second, area)) {
+        // the same entity is often reported several times in a row (e.g. selection of its children)
+        m_areas.back().first = m_revision;
+        return;
+    }
+    m_areas.emplace_back(m_revision, area);
+    if (m_areas.size() > maxLoggedAreas) {
+        m_unknownUpTo = m_areas.front().first;
+        m_areas.pop_front();
+    }
+}
+
+void LC_DocumentChangeLog::markChanged(const RS_Entity& entity) {
+    const RS_Vector min = entity.getMin();
+    const RS_Vector max = entity.getMax();
+    // lines on construction layers are drawn infinite
+    bool bounded = !entity.isConstruction()
+                   && min.x <= max.x && min.y <= max.y
+                   && min.x > RS_MINDOUBLE && min.y > RS_MINDOUBLE
+                   && max.x < RS_MAXDOUBLE && max.y < RS_MAXDOUBLE;
+    if (bounded) {
+        markChanged(min, max);
+    } else {
+        markAllChanged();
+    }
+}
+
+void LC_DocumentChangeLog::markAllChanged() {
+    m_revision++;
+    m_unknownUpTo = m_revision;
+    m_areas.clear();
+}
+
+bool LC_DocumentChangeLog::collectChangedAreas(unsigned long long sinceRevision, std::vector<LC_Rect>& areas) const {
+    if (sinceRevision < m_unknownUpTo) {
+        return false;
+    }
+    // entries are ordered by revision
+    for (auto it = m_areas.crbegin(); it != m_areas.crend() && it->first > sinceRevision; ++it) {
+        areas.push_back(it->second);
+    }
+    return true;
+}
@@ -0,0 +1,78 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_DOCUMENTCHANGELOG_H
+#define LC_DOCUMENTCHANGELOG_H
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "lc_rect.h"
+
+class RS_Entity;
+
+/**
+ * @brief The LC_DocumentChangeLog class
+ *        Revision counter of the drawing content with a bounded log of the areas
+ *        changed by each revision.
+ *
+ *        Views may cache rendered parts of the drawing together with the revision
+ *        they were rendered at, and later ask for the areas changed since that
+ *        revision to repaint only those. If the areas are not known (changes
+ *        which can't be bounded, or the log was trimmed), the whole drawing
+ *        has to be considered as changed.
+ */
+class LC_DocumentChangeLog {
+public:
+    LC_DocumentChangeLog() = default;
+
+    unsigned long long getRevision() const {return m_revision;}
+
+    /**
+     * @brief markChanged - records a change within the area given by two corners
+     */
+    void markChanged(const RS_Vector& corner1, const RS_Vector& corner2);
+    /**
+     * @brief markChanged - records a change of the area occupied by the entity
+     */
+    void markChanged(const RS_Entity& entity);
+    /**
+     * @brief markAllChanged - records a change that can't be bounded
+     */
+    void markAllChanged();
+
+    /**
+     * @brief collectChangedAreas - areas of all changes made after the given revision
+     * @param sinceRevision - revision known to the caller
+     * @param areas - receives the changed areas
+     * @return false, if the changed areas are not known, so everything should be considered as changed
+     */
+    bool collectChangedAreas(unsigned long long sinceRevision, std::vector<LC_Rect>& areas) const;
+
+private:
+    unsigned long long m_revision = 0;
+    /** areas are known only for revisions after this one */
+    unsigned long long m_unknownUpTo = 0;
+    std::deque<std::pair<unsigned long long, LC_Rect>> m_areas;
+};
+
+#endif // LC_DOCUMENTCHANGELOG_H
@@ -0,0 +1,118 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include <algorithm>
+#include <vector>
+
+#include "lc_documentchangelog.h"
+#include "lc_intersectioncache.h"
+#include "rs_entity.h"
+#include "rs_information.h"
+
+namespace {
+// the cache is cleared when it grows beyond that, entries of past hovers are rarely reused
+constexpr size_t maxEntries = 1 << 16;
+
+bool isSameVector(const RS_Vector& a, const RS_Vector& b) {
+    return a.valid == b.valid && (!a.valid || (a.x == b.x && a.y == b.y));
+}
+
+bool hasFiniteBorders(const RS_Entity& entity) {
+    const RS_Vector min = entity.getMin();
+    const RS_Vector max = entity.getMax();
+    return min.x <= max.x && min.y <= max.y
+           && min.x > RS_MINDOUBLE && min.y > RS_MINDOUBLE
+           && max.x < RS_MAXDOUBLE && max.y < RS_MAXDOUBLE;
+}
+
+bool isBounded(const RS_Entity& entity) {
+    // lines on construction layers are infinite
+    return entity.rtti() != RS2::EntityConstructionLine && !entity.isConstruction() && hasFiniteBorders(entity);
+}
+}
+
+LC_IntersectionCache::Signature::Signature(const RS_Entity& entity)
+    : type{entity.rtti()}
+    , min{entity.getMin()}
+    , max{entity.getMax()}
+    , start{entity.getStartpoint()}
+    , end{entity.getEndpoint()}
+    , construction{entity.isConstruction()} {
+}
+
+bool LC_IntersectionCache::Signature::operator == (const Signature& other) const {
+    return type == other.type && construction == other.construction
+           && isSameVector(min, other.min) && isSameVector(max, other.max)
+           && isSameVector(start, other.start) && isSameVector(end, other.end);
+}
+
+void LC_IntersectionCache::sync(const LC_DocumentChangeLog& changeLog) {
+    const unsigned long long revision = changeLog.getRevision();
+    if (revision == m_revision) {
+        return;
+    }
+    std::vector<LC_Rect> changedAreas;
+    if (!changeLog.collectChangedAreas(m_revision, changedAreas)) {
+        clear();
+    } else if (!m_entries.empty()) {
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            const Entry& entry = it->second;
+            bool changed = !entry.bounded
+                           || std::any_of(changedAreas.cbegin(), changedAreas.cend(), [&entry](const LC_Rect& area) {
+                                  return area.intersects(entry.area, RS_TOLERANCE);
+                              });
+            it = changed ? m_entries.erase(it) : std::next(it);
+        }
+    }
+    m_revision = revision;
+}
+
+void LC_IntersectionCache::clear() {
+    m_entries.clear();
+}
+
+RS_VectorSolutions LC_IntersectionCache::getIntersection(const RS_Entity* e1, const RS_Entity* e2) {
+    if (e1 == nullptr || e2 == nullptr) {
+        return RS_Information::getIntersection(e1, e2, true);
+    }
+    const Key key{e1, e2};
+    Signature first{*e1};
+    Signature second{*e2};
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        if (it->second.first == first && it->second.second == second) {
+            return it->second.solutions;
+        }
+        m_entries.erase(it);
+    }
+
+    RS_VectorSolutions solutions = RS_Information::getIntersection(e1, e2, true);
+    if (m_entries.size() >= maxEntries) {
+        clear();
+    }
+    Entry entry{first, second, {}, isBounded(*e1) && isBounded(*e2), solutions};
+    if (entry.bounded) {
+        LC_Rect area{e1->getMin(), e1->getMax()};
+        entry.area = area.merge(LC_Rect{e2->getMin(), e2->getMax()});
+    }
+    m_entries.emplace(key, std::move(entry));
+    return solutions;
+}
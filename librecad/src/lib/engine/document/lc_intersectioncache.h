@@ -0,0 +1,96 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_INTERSECTIONCACHE_H
+#define LC_INTERSECTIONCACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "lc_rect.h"
+#include "rs.h"
+#include "rs_vector.h"
+
+class LC_DocumentChangeLog;
+class RS_Entity;
+
+/**
+ * @brief The LC_IntersectionCache class
+ *        Memoized intersection points of pairs of entities, as used by intersection snapping.
+ *
+ *        Entries are dropped when the area of either entity is reported as changed by the
+ *        change log of the document. Each entry also keeps a signature of both entities
+ *        (type, borders, end points, construction state), so an entity modified without
+ *        a report, or a new entity allocated at the address of a deleted one, is not
+ *        answered from the cache.
+ */
+class LC_IntersectionCache {
+public:
+    /**
+     * @brief sync - drops entries of entities within areas changed since the last sync
+     */
+    void sync(const LC_DocumentChangeLog& changeLog);
+    void clear();
+
+    /**
+     * @brief getIntersection - intersection points on both entities, as returned by
+     *        RS_Information::getIntersection(e1, e2, true). They are computed only if not cached.
+     */
+    RS_VectorSolutions getIntersection(const RS_Entity* e1, const RS_Entity* e2);
+
+private:
+    struct Signature {
+        RS2::EntityType type = RS2::EntityUnknown;
+        RS_Vector min;
+        RS_Vector max;
+        RS_Vector start;
+        RS_Vector end;
+        bool construction = false;
+
+        explicit Signature(const RS_Entity& entity);
+        bool operator == (const Signature& other) const;
+    };
+
+    struct Entry {
+        Signature first;
+        Signature second;
+        /** area occupied by both entities, invalid if one of them is unbounded */
+        LC_Rect area;
+        bool bounded = false;
+        RS_VectorSolutions solutions;
+    };
+
+    using Key = std::pair<const RS_Entity*, const RS_Entity*>;
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            size_t h = std::hash<const RS_Entity*>()(key.first);
+            return h ^ (std::hash<const RS_Entity*>()(key.second) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+        }
+    };
+
+    std::unordered_map<Key, Entry, KeyHash> m_entries;
+    /** revision of the change log the entries are valid for */
+    unsigned long long m_revision = 0;
+};
+
+#endif // LC_INTERSECTIONCACHE_H
@@ -0,0 +1,72 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include "lc_layerindex.h"
+
+#include "rs_entity.h"
+
+void LC_LayerIndex::add(RS_Entity* entity) {
+    if (entity != nullptr) {
+        m_entities[entity->getLayer(false)].insert(entity);
+    }
+}
+
+void LC_LayerIndex::remove(RS_Entity* entity) {
+    auto it = m_entities.find(entity->getLayer(false));
+    if (it != m_entities.end() && it->second.erase(entity) > 0) {
+        if (it->second.empty()) {
+            m_entities.erase(it);
+        }
+        return;
+    }
+    // the layer was changed without notification, there are only a few layers to check
+    for (it = m_entities.begin(); it != m_entities.end(); ++it) {
+        if (it->second.erase(entity) > 0) {
+            if (it->second.empty()) {
+                m_entities.erase(it);
+            }
+            return;
+        }
+    }
+}
+
+void LC_LayerIndex::layerChanged(RS_Entity* entity, const RS_Layer* oldLayer) {
+    auto it = m_entities.find(oldLayer);
+    if (it == m_entities.end() || it->second.erase(entity) == 0) {
+        return;
+    }
+    if (it->second.empty()) {
+        m_entities.erase(it);
+    }
+    add(entity);
+}
+
+void LC_LayerIndex::clear() {
+    m_entities.clear();
+}
+
+std::vector<RS_Entity*> LC_LayerIndex::entities(const RS_Layer* layer) const {
+    auto it = m_entities.find(layer);
+    if (it == m_entities.end()) {
+        return {};
+    }
+    return {it->second.cbegin(), it->second.cend()};
+}
@@ -0,0 +1,60 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_LAYERINDEX_H
+#define LC_LAYERINDEX_H
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class RS_Entity;
+class RS_Layer;
+
+/**
+ * @brief The LC_LayerIndex class
+ *        Top-level entities of a graphic grouped by the layer they are on.
+ *
+ *        The graphic updates the index when entities are added or removed, and when the
+ *        layer of an entity is changed, so entities of a layer are found without visiting
+ *        the whole drawing.
+ */
+class LC_LayerIndex {
+public:
+    void add(RS_Entity* entity);
+    void remove(RS_Entity* entity);
+    /**
+     * @brief layerChanged - moves the entity from the old layer to its current one, entities that
+     *        are not indexed (e.g. not added to the graphic yet) are ignored
+     */
+    void layerChanged(RS_Entity* entity, const RS_Layer* oldLayer);
+    void clear();
+
+    /**
+     * @return entities on the layer in no particular order
+     */
+    std::vector<RS_Entity*> entities(const RS_Layer* layer) const;
+
+private:
+    std::unordered_map<const RS_Layer*, std::unordered_set<RS_Entity*>> m_entities;
+};
+
+#endif // LC_LAYERINDEX_H
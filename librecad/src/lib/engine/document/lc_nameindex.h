@@ -0,0 +1,150 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_NAMEINDEX_H
+#define LC_NAMEINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMultiHash>
+#include <QString>
+
+/**
+ * @brief The LC_NameIndex class
+ *        Hash index of named items (layers, blocks, styles) of a list, by exact
+ *        and by case folded name.
+ *
+ *        The owning list keeps the index in sync on add, remove and rename. An item
+ *        found under a name it no longer has (renamed behind the back of the list)
+ *        makes the index rebuild from the list, so lists declare the index mutable
+ *        to use it in const lookups. Items renamed to the name looked up are not found
+ *        that way, lists whose items are renamed directly call refresh() on a miss.
+ *        If several items share a name, the first one in the list is found, as a
+ *        linear search would do.
+ */
+template <class T>
+class LC_NameIndex {
+public:
+    void clear() {
+        m_byName.clear();
+        m_byFoldedName.clear();
+        m_indexedNames.clear();
+    }
+
+    void insert(T* item) {
+        if (item == nullptr || m_indexedNames.contains(item)) {
+            return;
+        }
+        const QString name = item->getName();
+        m_byName.insert(name, item);
+        m_byFoldedName.insert(name.toCaseFolded(), item);
+        m_indexedNames.insert(item, name);
+    }
+
+    void remove(T* item) {
+        auto it = m_indexedNames.find(item);
+        if (it == m_indexedNames.end()) {
+            return;
+        }
+        m_byName.remove(it.value(), item);
+        m_byFoldedName.remove(it.value().toCaseFolded(), item);
+        m_indexedNames.erase(it);
+    }
+
+    /**
+     * @brief rename - indexes the item by its current name, to be called after the item was renamed
+     */
+    void rename(T* item) {
+        remove(item);
+        insert(item);
+    }
+
+    /**
+     * @brief refresh - indexes items renamed since they were indexed by their current names
+     * @return true, if any item was renamed
+     */
+    bool refresh(const QList<T*>& items) {
+        bool renamed = false;
+        for (T* item : items) {
+            auto it = m_indexedNames.constFind(item);
+            if (it != m_indexedNames.cend() && it.value() != item->getName()) {
+                rename(item);
+                renamed = true;
+            }
+        }
+        return renamed;
+    }
+
+    void rebuild(const QList<T*>& items) {
+        clear();
+        for (T* item : items) {
+            insert(item);
+        }
+    }
+
+    T* find(const QString& name, const QList<T*>& items) {
+        T* item = select(m_byName, name, items);
+        if (item != nullptr && item->getName() != name) {
+            rebuild(items);
+            item = select(m_byName, name, items);
+        }
+        return item;
+    }
+
+    T* findCaseInsensitive(const QString& name, const QList<T*>& items) {
+        const QString foldedName = name.toCaseFolded();
+        T* item = select(m_byFoldedName, foldedName, items);
+        if (item != nullptr && item->getName().compare(name, Qt::CaseInsensitive) != 0) {
+            rebuild(items);
+            item = select(m_byFoldedName, foldedName, items);
+        }
+        return item;
+    }
+
+private:
+    static T* select(const QMultiHash<QString, T*>& hash, const QString& key, const QList<T*>& items) {
+        auto range = hash.equal_range(key);
+        if (range.first == range.second) {
+            return nullptr;
+        }
+        T* result = *range.first;
+        if (++range.first == range.second) {
+            return result;
+        }
+        // duplicated names are rare, resolve them by the order of the list
+        qsizetype resultIndex = items.indexOf(result);
+        for (auto it = range.first; it != range.second; ++it) {
+            qsizetype index = items.indexOf(*it);
+            if (index >= 0 && (resultIndex < 0 || index < resultIndex)) {
+                result = *it;
+                resultIndex = index;
+            }
+        }
+        return result;
+    }
+
+    QMultiHash<QString, T*> m_byName;
+    QMultiHash<QString, T*> m_byFoldedName;
+    //! names the items are indexed by, they differ from current ones for renamed items
+    QHash<const T*, QString> m_indexedNames;
+};
+
+#endif // LC_NAMEINDEX_H
@@ -0,0 +1,53 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include "lc_selectionset.h"
+
+#include "rs_entity.h"
+
+void LC_SelectionSet::selectionChanged(RS_Entity* topLevel, const RS_Entity& entity) {
+    if (topLevel->getFlag(RS2::FlagSelected) || entity.getFlag(RS2::FlagSelected)) {
+        m_entities.insert(topLevel);
+    }
+    else if (&entity == topLevel) {
+        // a deselected container deselects all its sub-entities as well
+        m_entities.erase(topLevel);
+    }
+    // a deselected sub-entity of a deselected container: other sub-entities may still be selected
+}
+
+void LC_SelectionSet::entityAdded(RS_Entity* entity) {
+    if (entity != nullptr && entity->getFlag(RS2::FlagSelected)) {
+        m_entities.insert(entity);
+    }
+}
+
+void LC_SelectionSet::entityRemoved(const RS_Entity* entity) {
+    m_entities.erase(const_cast<RS_Entity*>(entity));
+}
+
+void LC_SelectionSet::clear() {
+    m_entities.clear();
+}
+
+std::vector<RS_Entity*> LC_SelectionSet::entities() const {
+    return {m_entities.cbegin(), m_entities.cend()};
+}
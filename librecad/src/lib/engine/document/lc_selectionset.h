@@ -0,0 +1,66 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_SELECTIONSET_H
+#define LC_SELECTIONSET_H
+
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+class RS_Entity;
+
+/**
+ * @brief The LC_SelectionSet class
+ *        Top-level entities of a document that are selected, or contain selected sub-entities.
+ *
+ *        The set is kept up to date by the document on selection changes and on adding or removing
+ *        of entities, so the selection can be enumerated without visiting all entities.
+ *        It may contain entities that are not selected any more (a container with a deselected
+ *        sub-entity, or an entity on a hidden layer), so users still check the selection state.
+ */
+class LC_SelectionSet {
+public:
+    /**
+     * @brief selectionChanged - selection state of the entity, or of one of its sub-entities, was changed
+     * @param topLevel top-level entity of the document
+     * @param entity entity which selection state was changed, topLevel itself or one of its sub-entities
+     */
+    void selectionChanged(RS_Entity* topLevel, const RS_Entity& entity);
+    /**
+     * @brief entityAdded - top-level entity was added to the document, it may be selected already
+     */
+    void entityAdded(RS_Entity* entity);
+    void entityRemoved(const RS_Entity* entity);
+    void clear();
+
+    bool isEmpty() const {return m_entities.empty();}
+    size_t size() const {return m_entities.size();}
+    /**
+     * @return entities of the set in no particular order
+     */
+    std::vector<RS_Entity*> entities() const;
+
+private:
+    std::unordered_set<RS_Entity*> m_entities;
+};
+
+#endif // LC_SELECTIONSET_H
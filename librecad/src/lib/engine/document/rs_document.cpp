@@ -26,8 +26,18 @@
 **********************************************************************/
 
 
+#include <algorithm>
+#include <unordered_set>
+
+#include <QObject>
+
 #include "rs_document.h"
+#include "lc_undoabletransform.h"
 #include "rs_debug.h"
+#include "rs_dialogfactory.h"
+#include "rs_dialogfactoryinterface.h"
+#include "rs_layer.h"
+#include "rs_undocycle.h"
 
 /**
  * Constructor.
@@ -41,12 +51,332 @@ RS_Document::RS_Document(RS_EntityContainer* parent)
     RS_DEBUG->print("RS_Document::RS_Document() ");
 }
 
+RS_Document::~RS_Document() {
+    if (isOwner()) {
+        for (const auto& [entity, place]: m_undoneEntities) {
+            delete entity;
+        }
+    }
+}
+
+void RS_Document::removeUndoable(RS_Undoable* u) {
+    removeUndoables({u});
+}
+
 /**
  * Overwritten to set modified flag when undo cycle finished with undoable(s).
  */
 void RS_Document::endUndoCycle(){
     if (hasUndoable()) {
         setModified(true);
+        // entities may be modified after they were added to the document
+        for (RS_Undoable* u: getCurrentCycle()->getUndoables()) {
+            if (u->undoRtti() == RS2::UndoableEntity) {
+                entityModifiedInPlace(static_cast<RS_Entity*>(u));
+            } else if (u->undoRtti() == RS2::UndoableTransform) {
+                for (RS_Entity* entity: static_cast<LC_UndoableTransform*>(u)->getEntities()) {
+                    entityModifiedInPlace(entity);
+                }
+            }
+        }
+        // entities may still be visited by the enclosing cycle
+        if (!isUndoCycleNested()) {
+            moveUndoneEntities(*getCurrentCycle());
+        }
     }
     RS_Undo::endUndoCycle();
+    if (getCurrentCycle() == nullptr) {
+        setBordersUpdateDeferred(false);
+    }
+}
+
+void RS_Document::startUndoCycle() {
+    setBordersUpdateDeferred(true);
+    RS_Undo::startUndoCycle();
+}
+
+const LC_DocumentChangeLog& RS_Document::getChangeLog() const {
+    // pending in-place changes are reported by the spatial index
+    refreshSpatialIndex();
+    return m_changeLog;
+}
+
+void RS_Document::removeUndoables(const std::vector<RS_Undoable*>& undoables) {
+    std::vector<RS_Entity*> entities;
+    for (RS_Undoable* u: undoables) {
+        if (u && u->undoRtti()==RS2::UndoableEntity && u->isUndone()) {
+            auto* entity = static_cast<RS_Entity*>(u);
+            // undone entities out of the container are deleted directly
+            if (m_undoneEntities.erase(entity) > 0) {
+                if (isOwner()) {
+                    delete entity;
+                }
+            } else {
+                entities.push_back(entity);
+            }
+        }
+    }
+    removeEntities(entities);
+}
+
+std::vector<RS_Entity*> RS_Document::getUndoneEntities() const {
+    std::vector<RS_Entity*> entities;
+    entities.reserve(m_undoneEntities.size());
+    for (const auto& [entity, place]: m_undoneEntities) {
+        entities.push_back(entity);
+    }
+    return entities;
+}
+
+/**
+ * Keeps undone top-level entities of the cycle out of the container, so traversals visit
+ * live entities only. Entities which are live again are inserted after the live entity which
+ * was before them when they were taken out. Undo cycles are undone in reverse order, so that
+ * entity is live again too; unlike a position it keeps its place when the draw order is
+ * changed meanwhile.
+ */
+void RS_Document::moveUndoneEntities(const RS_UndoCycle& cycle) {
+    std::vector<RS_Entity*> undone;
+    std::vector<std::pair<LC_UndoSpillStore::Place, RS_Entity*>> redone;
+    for (RS_Undoable* u: cycle.getUndoables()) {
+        if (u->undoRtti() != RS2::UndoableEntity) {
+            continue;
+        }
+        auto* entity = static_cast<RS_Entity*>(u);
+        if (entity->getParent() != this) {
+            continue;
+        }
+        auto it = m_undoneEntities.find(entity);
+        if (entity->isUndone()) {
+            if (it == m_undoneEntities.end()) {
+                undone.push_back(entity);
+            }
+        } else if (it != m_undoneEntities.end()) {
+            redone.emplace_back(it->second, entity);
+            m_undoneEntities.erase(it);
+        }
+    }
+    insertEntities(positionsOf(std::move(redone)));
+
+    std::vector<unsigned long long> previousIds = previousLiveIds(undone);
+    std::vector<int> positions = takeEntities(undone);
+    for (size_t i = 0; i < undone.size(); i++) {
+        if (positions[i] >= 0) {
+            m_undoneEntities.emplace(undone[i], LC_UndoSpillStore::Place{previousIds[i], positions[i]});
+        }
+    }
+}
+
+/**
+ * @return ids of the entities before the given ones which are not among them, 0 for entities
+ *         at the front or not in the container
+ */
+std::vector<unsigned long long> RS_Document::previousLiveIds(const std::vector<RS_Entity*>& entities) {
+    // a run of adjacent entities shares the entity before the run
+    std::vector<std::pair<int, size_t>> order;
+    for (size_t i = 0; i < entities.size(); i++) {
+        const int position = findEntityIndex(entities[i]);
+        if (position >= 0) {
+            order.emplace_back(position, i);
+        }
+    }
+    std::sort(order.begin(), order.end());
+    std::vector<unsigned long long> previousIds(entities.size(), 0);
+    unsigned long long previousId = 0;
+    for (size_t k = 0; k < order.size(); k++) {
+        const int position = order[k].first;
+        if (k == 0 || order[k - 1].first < position - 1) {
+            previousId = position > 0 ? entityAt(position - 1)->getId() : 0;
+        }
+        previousIds[order[k].second] = previousId;
+    }
+    return previousIds;
+}
+
+/**
+ * @return positions of the entities after inserting them at their places, for insertEntities()
+ */
+std::vector<std::pair<int, RS_Entity*>> RS_Document::positionsOf(
+    std::vector<std::pair<LC_UndoSpillStore::Place, RS_Entity*>> entities) {
+    if (entities.empty()) {
+        return {};
+    }
+    // positions of the entities the given ones are placed after, found in a single pass
+    std::unordered_map<unsigned long long, int> previousPositions;
+    for (const auto& [place, entity]: entities) {
+        if (place.previousId != 0) {
+            previousPositions.emplace(place.previousId, -1);
+        }
+    }
+    if (!previousPositions.empty()) {
+        int position = 0;
+        for (RS_Entity* e: *this) {
+            auto it = previousPositions.find(e->getId());
+            if (it != previousPositions.end()) {
+                it->second = position;
+            }
+            position++;
+        }
+    }
+
+    // entities placed after the same one keep their previous order
+    std::stable_sort(entities.begin(), entities.end(), [](const auto& e1, const auto& e2) {
+        return e1.first.position < e2.first.position;
+    });
+    const int liveCount = static_cast<int>(count());
+    std::vector<std::pair<int, RS_Entity*>> positions;
+    positions.reserve(entities.size());
+    for (const auto& [place, entity]: entities) {
+        int position = 0;
+        if (place.previousId != 0) {
+            const int previous = previousPositions.at(place.previousId);
+            // the entity before it is gone, e.g. removed from the history, its position is kept
+            position = previous >= 0 ? previous + 1 : std::min(place.position, liveCount);
+        }
+        positions.emplace_back(position, entity);
+    }
+    // positions in the container as it is now become positions after the insertion
+    std::stable_sort(positions.begin(), positions.end(), [](const auto& e1, const auto& e2) {
+        return e1.first < e2.first;
+    });
+    for (size_t i = 0; i < positions.size(); i++) {
+        positions[i].first += static_cast<int>(i);
+    }
+    return positions;
+}
+
+void RS_Document::childChanged(const RS_Entity* child) const {
+    if (child != nullptr) {
+        m_changeLog.markChanged(*child);
+    }
+}
+
+void RS_Document::childAreaChanged(const RS_Vector& corner1, const RS_Vector& corner2) const {
+    m_changeLog.markChanged(corner1, corner2);
+}
+
+void RS_Document::childAdded(RS_Entity* child) {
+    m_selectionSet.entityAdded(child);
+}
+
+void RS_Document::childRemoved(RS_Entity* child) {
+    m_selectionSet.entityRemoved(child);
+}
+
+void RS_Document::childrenCleared() {
+    m_selectionSet.clear();
+}
+
+LC_IntersectionCache* RS_Document::intersectionCache() const {
+    m_intersectionCache.sync(getChangeLog());
+    return &m_intersectionCache;
+}
+
+LC_SelectionSet* RS_Document::selectionSet() const {
+    return &m_selectionSet;
+}
+
+void RS_Document::layerChanged(RS_Entity* child, const RS_Layer* oldLayer) {
+    // entities are drawn with attributes of their layer, and infinite on construction layers
+    if (oldLayer != nullptr && oldLayer->isConstruction()) {
+        m_changeLog.markAllChanged();
+    } else {
+        m_changeLog.markChanged(*child);
+    }
+}
+
+void RS_Document::selectionChanged(RS_Entity* topLevel, const RS_Entity& entity) {
+    m_changeLog.markChanged(*topLevel);
+    m_selectionSet.selectionChanged(topLevel, entity);
+}
+
+void RS_Document::cycleUndoStateChanged(const RS_UndoCycle& cycle) {
+    moveUndoneEntities(cycle);
+    for (RS_Undoable* u: cycle.getUndoables()) {
+        if (u->undoRtti() == RS2::UndoableEntity) {
+            m_changeLog.markChanged(*static_cast<RS_Entity*>(u));
+        } else if (u->undoRtti() == RS2::UndoableTransform) {
+            for (RS_Entity* entity: static_cast<LC_UndoableTransform*>(u)->getEntities()) {
+                entityModifiedInPlace(entity);
+            }
+        }
+    }
+}
+
+std::size_t RS_Document::retainedBytes(const RS_UndoCycle& cycle) const {
+    std::size_t bytes = 0;
+    for (RS_Undoable* u: cycle.getUndoables()) {
+        if (u->undoRtti() == RS2::UndoableEntity && u->isUndone()) {
+            bytes += static_cast<RS_Entity*>(u)->getMemoryUsage();
+        }
+    }
+    return bytes;
+}
+
+void RS_Document::selectSpillable(const std::vector<const RS_UndoCycle*>& cycles,
+                                  std::vector<RS_Undoable*>& undoables) const {
+    // transformations of any cycle refer to their entities, which stay in memory, also if
+    // the cycle of the transformation was spilled before
+    std::unordered_set<const RS_Undoable*> transformed;
+    for (const RS_UndoCycle* cycle: cycles) {
+        for (RS_Undoable* u: cycle->getUndoables()) {
+            if (u->undoRtti() == RS2::UndoableTransform) {
+                for (RS_Entity* entity: static_cast<LC_UndoableTransform*>(u)->getEntities()) {
+                    transformed.insert(entity);
+                }
+            }
+        }
+    }
+    undoables.erase(std::remove_if(undoables.begin(), undoables.end(), [this, &transformed](RS_Undoable* u) {
+        if (u->undoRtti() != RS2::UndoableEntity || transformed.count(u) > 0) {
+            return true;
+        }
+        auto* entity = static_cast<RS_Entity*>(u);
+        return m_undoneEntities.count(entity) == 0 || !LC_UndoSpillStore::isSpillable(*entity);
+    }), undoables.end());
+}
+
+int RS_Document::spillUndoables(const std::vector<RS_Undoable*>& undoables) {
+    std::vector<RS_Entity*> entities;
+    std::vector<LC_UndoSpillStore::Place> places;
+    for (RS_Undoable* u: undoables) {
+        auto* entity = static_cast<RS_Entity*>(u);
+        entities.push_back(entity);
+        places.push_back(m_undoneEntities.at(entity));
+    }
+    const int storage = m_undoSpillStore.spill(entities, places);
+    if (storage >= 0) {
+        for (RS_Entity* entity: entities) {
+            m_undoneEntities.erase(entity);
+            if (isOwner()) {
+                delete entity;
+            }
+        }
+    }
+    return storage;
+}
+
+std::vector<RS_Undoable*> RS_Document::restoreUndoables(int storage) {
+    std::vector<LC_UndoSpillStore::Place> places;
+    std::vector<RS_Entity*> entities = m_undoSpillStore.restore(*this, storage, places);
+    for (size_t i = 0; i < entities.size(); i++) {
+        m_undoneEntities.emplace(entities[i], places[i]);
+    }
+    return {entities.cbegin(), entities.cend()};
+}
+
+void RS_Document::discardUndoables(int storage) {
+    m_undoSpillStore.discard(storage);
+}
+
+void RS_Document::undoCyclesLost(std::size_t count) {
+    RS_DIALOGFACTORY->commandMessage(QObject::tr("Undo history could not be read back, %1 undo steps are lost").arg(count));
+}
+
+void RS_Document::entityModifiedInPlace(RS_Entity* entity) {
+    if (!updateSpatialIndex(entity)) {
+        // previous box of an entity modified in place is not known
+        m_changeLog.markAllChanged();
+    }
+    m_changeLog.markChanged(*entity);
 }
@@ -29,6 +29,12 @@
 #ifndef RS_DOCUMENT_H
 #define RS_DOCUMENT_H
 
+#include <unordered_map>
+
+#include "lc_documentchangelog.h"
+#include "lc_intersectioncache.h"
+#include "lc_selectionset.h"
+#include "lc_undospillstore.h"
 #include "rs_entitycontainer.h"
 #include "rs_pen.h"
 #include "rs_undo.h"
@@ -53,6 +59,7 @@ class RS_Document : public RS_EntityContainer,
     public RS_Undo {
 public:
 	RS_Document(RS_EntityContainer* parent=nullptr);
+    ~RS_Document() override;
 
     virtual RS_LayerList* getLayerList()= 0;
     virtual RS_BlockList* getBlockList() = 0;
@@ -72,11 +79,11 @@ public:
      * Removes an entity from the entity container. Implementation
      * from RS_Undo.
      */
-    void removeUndoable(RS_Undoable* u) override {
-        if (u && u->undoRtti()==RS2::UndoableEntity && u->isUndone()) {
-            removeEntity(static_cast<RS_Entity*>(u));
-        }
-    }
+    void removeUndoable(RS_Undoable* u) override;
+    /**
+     * Removes undone entities from the entity container at once.
+     */
+    void removeUndoables(const std::vector<RS_Undoable*>& undoables) override;
 
     /**
      * @return Currently active drawing pen.
@@ -105,11 +112,55 @@ public:
      * Overwritten to set modified flag when undo cycle finished with undoable(s).
      */
      void endUndoCycle() override;
+    /**
+     * Overwritten to defer recalculation of borders on removals until the cycle ends.
+     */
+    void startUndoCycle() override;
+
+    /**
+     * @return revision and changed areas of the drawing, used by views to repaint only changed parts
+     */
+    const LC_DocumentChangeLog& getChangeLog() const;
+    /**
+     * Records a change of the given top-level entity that affects its appearance,
+     * e.g. selection state.
+     */
+    void markChanged(const RS_Entity& entity) {m_changeLog.markChanged(entity);}
+    /**
+     * Records a change of the selection state of the entity, which is the given top-level
+     * entity or one of its sub-entities.
+     */
+    void selectionChanged(RS_Entity* topLevel, const RS_Entity& entity);
+    /**
+     * Records a change of the layer of the given top-level entity.
+     */
+    virtual void layerChanged(RS_Entity* child, const RS_Layer* oldLayer);
 
     void setGraphicView(RS_GraphicView * g) {gv = g;}
     RS_GraphicView* getGraphicView() {return gv;} // fixme - sand -- REALLY BAD DEPENDANCE TO UI here, REWORK!
 
 protected:
+    /**
+     * @return undone top-level entities, which are kept out of the container for the undo history
+     */
+    std::vector<RS_Entity*> getUndoneEntities() const;
+
+    void childChanged(const RS_Entity* child) const override;
+    void childAreaChanged(const RS_Vector& corner1, const RS_Vector& corner2) const override;
+    void childAdded(RS_Entity* child) override;
+    void childRemoved(RS_Entity* child) override;
+    void childrenCleared() override;
+    void cycleUndoStateChanged(const RS_UndoCycle& cycle) override;
+    std::size_t retainedBytes(const RS_UndoCycle& cycle) const override;
+    void selectSpillable(const std::vector<const RS_UndoCycle*>& cycles,
+                         std::vector<RS_Undoable*>& undoables) const override;
+    int spillUndoables(const std::vector<RS_Undoable*>& undoables) override;
+    std::vector<RS_Undoable*> restoreUndoables(int storage) override;
+    void discardUndoables(int storage) override;
+    void undoCyclesLost(std::size_t count) override;
+    LC_IntersectionCache* intersectionCache() const override;
+    LC_SelectionSet* selectionSet() const override;
+
     /** Flag set if the document was modified and not yet saved. */
     bool modified = false;
     /** Active pen. */
@@ -118,5 +169,26 @@ protected:
     //used to read/save current view
     RS_GraphicView * gv = nullptr; // fixme - sand -- REALLY BAD DEPENDANCE TO UI here, REWORK!
 
+private:
+    // updates the spatial index and the change log for an entity whose geometry was modified in place
+    void entityModifiedInPlace(RS_Entity* entity);
+    void moveUndoneEntities(const RS_UndoCycle& cycle);
+    std::vector<unsigned long long> previousLiveIds(const std::vector<RS_Entity*>& entities);
+    std::vector<std::pair<int, RS_Entity*>> positionsOf(
+        std::vector<std::pair<LC_UndoSpillStore::Place, RS_Entity*>> entities);
+
+    /** changes are also reported by const spatial queries of the container */
+    mutable LC_DocumentChangeLog m_changeLog;
+    /** intersection points of entity pairs, invalidated by the change log */
+    mutable LC_IntersectionCache m_intersectionCache;
+    /** selected top-level entities, updated by selection changes of entities */
+    mutable LC_SelectionSet m_selectionSet;
+    /**
+     * undone top-level entities, which are kept out of the container for the undo history,
+     * with their place in the container
+     */
+    std::unordered_map<RS_Entity*, LC_UndoSpillStore::Place> m_undoneEntities;
+    /** undone entities of old undo cycles, moved out of memory */
+    LC_UndoSpillStore m_undoSpillStore;
 };
 #endif
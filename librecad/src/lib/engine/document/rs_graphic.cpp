@@ -24,6 +24,7 @@
 **
 **********************************************************************/
 
+#include <algorithm>
 #include <iostream>
 
 #include "rs_graphic.h"
@@ -115,6 +116,10 @@ RS_Graphic::RS_Graphic(RS_EntityContainer* parent)
         double angleBaseRadians = RS_Math::deg2rad(angleBaseDegrees);
         setAnglesCounterClockwise(anglesCounterClockwise);
         setAnglesBase(angleBaseRadians);
+
+        // undone entities of older undo cycles are moved to a temporary file over the budget
+        const int undoMemoryBudgetMB = LC_GET_INT("UndoMemoryBudget", 512);
+        setUndoMemoryBudget(static_cast<std::size_t>(std::max(undoMemoryBudgetMB, 0)) * 1024 * 1024);
     }
     RS2::Unit unit = getUnit();
 
@@ -183,16 +188,39 @@ unsigned RS_Graphic::countLayerEntities(RS_Layer *layer) const
 {
     unsigned c = 0;
     if (layer) {
-        for (RS_Entity *t: *this) {
-            if (t->getLayer() &&
-                t->getLayer()->getName() == layer->getName()) {
-                c += t->countDeep();
-            }
+        for (RS_Entity *t: m_layerIndex.entities(layer)) {
+            c += t->countDeep();
         }
     }
     return c;
 }
 
+std::vector<RS_Entity*> RS_Graphic::getEntitiesOnLayer(const RS_Layer* layer) const {
+    std::vector<RS_Entity*> result = m_layerIndex.entities(layer);
+    sortInContainerOrder(result);
+    return result;
+}
+
+void RS_Graphic::layerChanged(RS_Entity* child, const RS_Layer* oldLayer) {
+    RS_Document::layerChanged(child, oldLayer);
+    m_layerIndex.layerChanged(child, oldLayer);
+}
+
+void RS_Graphic::childAdded(RS_Entity* child) {
+    RS_Document::childAdded(child);
+    m_layerIndex.add(child);
+}
+
+void RS_Graphic::childRemoved(RS_Entity* child) {
+    RS_Document::childRemoved(child);
+    m_layerIndex.remove(child);
+}
+
+void RS_Graphic::childrenCleared() {
+    RS_Document::childrenCleared();
+    m_layerIndex.clear();
+}
+
 /**
  * Removes the given layer and undoes all m_entities on it.
  */
@@ -200,14 +228,8 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
     if (layer != nullptr) {
         const QString &layerName = layer->getName();
         if (layerName != "0") {
-            std::vector<RS_Entity *> toRemove;
             //find entities on layer
-            for(RS_Entity *e: *this) {
-                if (e->getLayer() &&
-                    e->getLayer()->getName() == layerName) {
-                    toRemove.push_back(e);
-                }
-            }
+            std::vector<RS_Entity *> toRemove = getEntitiesOnLayer(layer);
             // remove all entities on that layer:
             if (!toRemove.empty()) {
                 startUndoCycle();
@@ -218,6 +240,12 @@ void RS_Graphic::removeLayer(RS_Layer* layer) {
                 }
                 endUndoCycle();
             }
+            // undone entities of the undo history may be redone later
+            for (RS_Entity *e: getUndoneEntities()) {
+                if (e->getLayer(false) == layer) {
+                    e->setLayer("0");
+                }
+            }
 
             toRemove.clear();
             // remove all entities in blocks that are on that layer:
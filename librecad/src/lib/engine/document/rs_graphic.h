@@ -28,6 +28,7 @@
 #include <QDateTime>
 
 #include "lc_dimstyle.h"
+#include "lc_layerindex.h"
 #include "lc_ucslist.h"
 #include "lc_viewslist.h"
 #include "rs_blocklist.h"
@@ -70,6 +71,8 @@ public:
     RS2::EntityType rtti() const override {return RS2::EntityGraphic;}
 
     virtual unsigned countLayerEntities(RS_Layer* layer) const;
+    std::vector<RS_Entity*> getEntitiesOnLayer(const RS_Layer* layer) const override;
+    void layerChanged(RS_Entity* child, const RS_Layer* oldLayer) override;
 
     RS_LayerList* getLayerList() override {return &layerList;}
     RS_BlockList* getBlockList() override {return &blockList;}
@@ -287,9 +290,20 @@ public:
     virtual LC_DimStyle* getResolvedDimStyle(const QString &dimStyleName, RS2::EntityType dimType = RS2::EntityUnknown) const;
     void updateFallbackDimStyle(LC_DimStyle* get_copy);
     void replaceDimStylesList(const QString& defaultStyleName, const QList<LC_DimStyle*>& styles);
+    /**
+     * @return user defined variables of the entities of this graphic
+     */
+    LC_UserDefVars& getUserDefVars() {
+        return m_userDefVars;
+    }
 protected:
     void fireUndoStateChanged(bool undoAvailable, bool redoAvailable) const override;
+    void childAdded(RS_Entity* child) override;
+    void childRemoved(RS_Entity* child) override;
+    void childrenCleared() override;
 private:
+    // declared first, entities of blocks and lists may look it up while they are destroyed
+    LC_UserDefVars m_userDefVars;
     QDateTime lastSaveTime;
     QString currentFileName; //keep a copy of filename for the modifiedTime
 
@@ -302,6 +316,8 @@ private:
     LC_UCSList ucsList;
     LC_DimStylesList dimstyleList;
     LC_TextStyleList textStyleList;
+    /** top-level entities by layer */
+    LC_LayerIndex m_layerIndex;
 
     //if set to true, will refuse to modify paper scale
     bool paperScaleFixed = false;
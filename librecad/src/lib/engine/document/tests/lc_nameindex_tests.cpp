@@ -0,0 +1,84 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD (librecad.org)
+**
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+#include <memory>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "lc_dimstyle.h"
+#include "lc_dimstyleslist.h"
+#include "rs_layer.h"
+#include "rs_layerlist.h"
+
+TEST_CASE("RS_LayerList::find after rename") {
+    std::vector<std::unique_ptr<RS_Layer>> layers;
+    RS_LayerList layerList;
+    for (const char* name: {"0", "walls", "doors"}) {
+        layers.push_back(std::make_unique<RS_Layer>(name));
+        layerList.add(layers.back().get());
+    }
+    RS_Layer* walls = layers[1].get();
+    REQUIRE(layerList.find("walls") == walls);
+
+    SECTION("renamed by the layer tree, announced as any layer") {
+        walls->setName("walls|exterior");
+        layerList.fireEdit(nullptr);
+    }
+    SECTION("renamed by the layer tree, announced as the layer") {
+        walls->setName("walls|exterior");
+        layerList.fireEdit(walls);
+    }
+    SECTION("edited by a copy") {
+        RS_Layer source{*walls};
+        source.setName("walls|exterior");
+        layerList.edit(walls, source);
+    }
+
+    REQUIRE(layerList.find("walls|exterior") == walls);
+    REQUIRE(layerList.find("walls") == nullptr);
+    REQUIRE(layerList.find("doors") == layers[2].get());
+    layerList.clear();
+}
+
+TEST_CASE("LC_DimStylesList::findByName after rename") {
+    LC_DimStylesList stylesList;
+    auto* standard = new LC_DimStyle("Standard");
+    auto* iso = new LC_DimStyle("ISO-25");
+    stylesList.addDimStyle(standard);
+    stylesList.addDimStyle(iso);
+    REQUIRE(stylesList.findByName("iso-25") == iso);
+
+    // style editors rename styles without the list
+    iso->setName("ISO-25 Override");
+    REQUIRE(stylesList.findByName("ISO-25 Override") == iso);
+    REQUIRE(stylesList.findByName("iso-25 override") == iso);
+    REQUIRE(stylesList.findByName("ISO-25") == nullptr);
+    REQUIRE(stylesList.findByName("Standard") == standard);
+
+    // a new style may take the name of the renamed one
+    auto* newIso = new LC_DimStyle("ISO-25");
+    stylesList.addDimStyle(newIso);
+    REQUIRE(stylesList.findByName("ISO-25") == newIso);
+}
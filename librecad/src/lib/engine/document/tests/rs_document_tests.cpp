@@ -0,0 +1,184 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD (librecad.org)
+**
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+#include <memory>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "lc_documentchangelog.h"
+#include "lc_undoabletransform.h"
+#include "rs_graphic.h"
+#include "rs_layer.h"
+#include "rs_line.h"
+#include "rs_settings.h"
+
+namespace {
+RS_Line* addLine(RS_Graphic& graphic, const RS_Vector& start, const RS_Vector& end) {
+    auto* line = new RS_Line(&graphic, {start, end});
+    graphic.addEntity(line);
+    graphic.addUndoable(line);
+    return line;
+}
+
+void remove(RS_Graphic& graphic, RS_Entity* entity) {
+    graphic.startUndoCycle();
+    entity->changeUndoState();
+    graphic.addUndoable(entity);
+    graphic.endUndoCycle();
+}
+
+std::vector<const RS_Entity*> entitiesOf(const RS_Graphic& graphic) {
+    return {graphic.cbegin(), graphic.cend()};
+}
+
+bool contains(const RS_Graphic& graphic, const RS_Entity* entity) {
+    for (const RS_Entity* e: graphic) {
+        if (e == entity) {
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+TEST_CASE("RS_Document::spilled undo cycles") {
+    // graphics read their defaults from the settings
+    if (RS_Settings::instance() == nullptr) {
+        RS_Settings::init("LibreCAD", "LibreCAD_tests");
+    }
+    RS_Graphic graphic;
+    // all cycles but the latest one are moved out of memory
+    graphic.setUndoMemoryBudget(1);
+
+    graphic.startUndoCycle();
+    RS_Line* moved = addLine(graphic, {0., 0.}, {10., 0.});
+    RS_Line* other = addLine(graphic, {0., 5.}, {10., 5.});
+    graphic.endUndoCycle();
+
+    graphic.startUndoCycle();
+    auto transform = std::make_unique<LC_UndoableTransform>(std::vector<RS_Entity*>{moved});
+    REQUIRE(transform->saveGeometry());
+    transform->addMove({3., 4.});
+    transform->apply();
+    graphic.addUndoable(std::move(transform));
+    graphic.endUndoCycle();
+
+    // the deleted line is spilled with its cycle
+    remove(graphic, other);
+    // the moved line stays in memory for the transformation of a cycle spilled before
+    remove(graphic, moved);
+    graphic.startUndoCycle();
+    addLine(graphic, {0., 9.}, {10., 9.});
+    graphic.endUndoCycle();
+    REQUIRE(graphic.count() == 1);
+
+    REQUIRE(graphic.undo());
+    REQUIRE(graphic.undo());
+    REQUIRE(contains(graphic, moved));
+    REQUIRE(moved->getStartpoint() == RS_Vector(3., 4.));
+
+    REQUIRE(graphic.undo());
+    REQUIRE(graphic.count() == 2);
+    REQUIRE(graphic.undo());
+    REQUIRE(moved->getStartpoint() == RS_Vector(0., 0.));
+    REQUIRE(moved->getEndpoint() == RS_Vector(10., 0.));
+    REQUIRE(graphic.undo());
+    REQUIRE(graphic.count() == 0);
+    REQUIRE_FALSE(graphic.undo());
+
+    for (int i = 0; i < 5; i++) {
+        REQUIRE(graphic.redo());
+    }
+    REQUIRE(graphic.count() == 1);
+    REQUIRE(graphic.entityAt(0)->getStartpoint() == RS_Vector(0., 9.));
+}
+
+TEST_CASE("RS_Document::undone entities keep their place in the draw order") {
+    if (RS_Settings::instance() == nullptr) {
+        RS_Settings::init("LibreCAD", "LibreCAD_tests");
+    }
+    RS_Graphic graphic;
+    graphic.startUndoCycle();
+    RS_Line* a = addLine(graphic, {0., 0.}, {1., 0.});
+    RS_Line* b = addLine(graphic, {0., 1.}, {1., 1.});
+    RS_Line* c = addLine(graphic, {0., 2.}, {1., 2.});
+    RS_Line* d = addLine(graphic, {0., 3.}, {1., 3.});
+    RS_Line* e = addLine(graphic, {0., 4.}, {1., 4.});
+    graphic.endUndoCycle();
+
+    // adjacent entities are removed together
+    graphic.startUndoCycle();
+    for (RS_Line* line: {b, c}) {
+        line->changeUndoState();
+        graphic.addUndoable(line);
+    }
+    graphic.endUndoCycle();
+    REQUIRE(entitiesOf(graphic) == std::vector<const RS_Entity*>{a, d, e});
+
+    // the draw order isn't part of the undo history
+    QList<RS_Entity*> raised{e};
+    graphic.moveEntity(0, raised);
+    REQUIRE(entitiesOf(graphic) == std::vector<const RS_Entity*>{e, a, d});
+
+    // removed entities are restored after the entity which was before them
+    REQUIRE(graphic.undo());
+    REQUIRE(entitiesOf(graphic) == std::vector<const RS_Entity*>{e, a, b, c, d});
+
+    REQUIRE(graphic.redo());
+    REQUIRE(entitiesOf(graphic) == std::vector<const RS_Entity*>{e, a, d});
+    REQUIRE(graphic.undo());
+    REQUIRE(entitiesOf(graphic) == std::vector<const RS_Entity*>{e, a, b, c, d});
+}
+
+TEST_CASE("RS_Document::attribute changes are logged") {
+    if (RS_Settings::instance() == nullptr) {
+        RS_Settings::init("LibreCAD", "LibreCAD_tests");
+    }
+    RS_Graphic graphic;
+    auto* line = new RS_Line(&graphic, {{0., 0.}, {10., 5.}});
+    graphic.addEntity(line);
+    const LC_DocumentChangeLog& changeLog = graphic.getChangeLog();
+
+    // the bounding box is kept, so only its area is changed
+    unsigned long long revision = changeLog.getRevision();
+    line->setPen(RS_Pen(RS_Color(255, 0, 0), RS2::Width05, RS2::DashLine));
+    std::vector<LC_Rect> areas;
+    REQUIRE(changeLog.collectChangedAreas(revision, areas));
+    REQUIRE(areas.size() == 1);
+    REQUIRE(areas.front().minP() == RS_Vector(0., 0.));
+    REQUIRE(areas.front().maxP() == RS_Vector(10., 5.));
+
+    revision = changeLog.getRevision();
+    line->setPen(line->getPen(false));
+    REQUIRE(changeLog.getRevision() == revision);
+
+    auto* layer = new RS_Layer("attributes");
+    graphic.addLayer(layer);
+    revision = changeLog.getRevision();
+    line->setLayer(layer);
+    areas.clear();
+    REQUIRE(changeLog.collectChangedAreas(revision, areas));
+    REQUIRE(areas.size() == 1);
+}
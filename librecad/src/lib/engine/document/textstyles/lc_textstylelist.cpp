@@ -32,6 +32,7 @@ unsigned int LC_TextStyleList::count() const {
 
 void LC_TextStyleList::clear() {
     m_styles.clear(); // fixme - sand - check whether items should be deleted!
+    m_nameIndex.clear();
 }
 
 LC_TextStyle* LC_TextStyleList::at(unsigned int i) {
@@ -45,6 +46,7 @@ void LC_TextStyleList::addStyle(LC_TextStyle* style) {
     auto* s = find(style->getName());
     if (s == nullptr) {
         m_styles.append(style);
+        m_nameIndex.insert(style);
         setModified(true);
     }
     // fixme - notify it duplicate?
@@ -53,6 +55,7 @@ void LC_TextStyleList::addStyle(LC_TextStyle* style) {
 void LC_TextStyleList::remove(LC_TextStyle* style) {
     if (style != nullptr) {
         m_styles.removeOne(style);
+        m_nameIndex.remove(style);
         setModified(true);
     }
 }
@@ -65,19 +68,14 @@ void LC_TextStyleList::remove(const QString& name) {
 }
 
 LC_TextStyle* LC_TextStyleList::find(const QString& name) {
-    // amount of styles should be small, so linear search should be fine
-    for (auto v : m_styles) {
-        if (v->getName() == name) {
-            // fixme - case sensitivity?
-            return v;
-        }
-    }
-    return nullptr;
+    // fixme - case sensitivity?
+    return m_nameIndex.find(name, m_styles);
 }
 
 void LC_TextStyleList::replace(QList<LC_TextStyle*> newStylesList) {
     qDeleteAll(m_styles);
     m_styles.clear();
     m_styles.append(newStylesList);
+    m_nameIndex.rebuild(m_styles);
     setModified(true);
 }
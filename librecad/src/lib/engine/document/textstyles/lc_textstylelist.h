@@ -25,6 +25,7 @@
 #define LC_TEXTSTYLELIST_H
 #include <QList>
 
+#include "lc_nameindex.h"
 #include "lc_textstyle.h"
 
 class LC_TextStyleList{
@@ -45,6 +46,7 @@ public:
     void setModified(bool modified) {m_modified = modified;}
 private:
     QList<LC_TextStyle*> m_styles;
+    LC_NameIndex<LC_TextStyle> m_nameIndex;
     LC_TextStyle *m_activeStyle = nullptr;
     bool m_modified = false;
 };
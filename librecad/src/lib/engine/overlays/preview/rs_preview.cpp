@@ -29,6 +29,7 @@
 #include "lc_graphicviewport.h"
 #include "rs_color.h"
 #include "rs_line.h"
+#include "rs_painter.h"
 #include "rs_pen.h"
 #include "rs_settings.h"
 
@@ -41,6 +42,7 @@ RS_Preview::RS_Preview(RS_EntityContainer* parent, LC_GraphicViewport* viewport)
 // fixme - sand - ucs - check when preview is created and whether this may be delegated to actio init?
 
     m_maxEntities = LC_GET_ONE_INT("Appearance", "MaxPreview", 100);
+    m_drawTextsAsDraft = LC_GET_ONE_BOOL("Render", "DrawTextsAsDraftInPreview", true);
     RS_Color highLight = QColor(LC_GET_ONE_STR("Colors", "highlight", RS_Settings::highlight));
     setPen(RS_Pen(highLight, RS2::Width00, RS2::SolidLine));
 }
@@ -160,6 +162,8 @@ void RS_Preview::clear() {
     } else {
         m_referenceEntities.clear();
     }
+    m_transformedEntities.clear();
+    m_transformedCount = 0;
     RS_EntityContainer::clear();
 }
 
@@ -199,7 +203,7 @@ void RS_Preview::addAllFrom(RS_EntityContainer& container, [[maybe_unused]]LC_Gr
  */
 void RS_Preview::addSelectionFrom(RS_EntityContainer& container, [[maybe_unused]]LC_GraphicViewport* view) {
     unsigned int c=0;
-    for(auto e: container){ // fixme - sand - wow - iterating over all entities!!! Rework selection
+    for(auto e: container.getSelectionCandidates()){
         if (e->isSelected() && c<m_maxEntities) {
             RS_Entity* clone = e->cloneProxy();
 
@@ -234,31 +238,120 @@ void RS_Preview::addStretchablesFrom(RS_EntityContainer& container, [[maybe_unus
     }
 }
 
+/**
+ * Adds the given entities to the preview as they would be after moving them from the base point to the
+ * insertion point, scaling by the factor and rotating by the angle around the insertion point.
+ * Entities are not cloned: the preview draws them transformed by the painter, so they must stay alive
+ * until the preview is cleared.
+ */
+void RS_Preview::addTransformed(const std::vector<RS_Entity*>& entities, const RS_Vector& basePoint,
+                                const RS_Vector& insertionPoint, double scale, double angle) {
+    TransformedEntities transformed;
+    transformed.basePoint = basePoint;
+    transformed.insertionPoint = insertionPoint;
+    transformed.scale = scale;
+    transformed.angle = angle;
+    transformed.entities.reserve(entities.size());
+
+    // only border preview for complex entities, as in addEntity(), entities added by earlier calls are counted
+    unsigned int count = countDeep() + m_transformedCount;
+    for (RS_Entity* e: entities) {
+        if (e == nullptr || e->isUndone()) {
+            continue;
+        }
+        bool addBorder = false;
+        switch (e->rtti()) {
+            case RS2::EntityHatch:
+                addBorder = true;
+                break;
+            case RS2::EntitySpline:
+            case RS2::EntityMText:
+            case RS2::EntityText:
+            case RS2::EntityPoint:
+                break;
+            default:
+                if (e->isContainer()) {
+                    addBorder = count > m_maxEntities || e->countDeep() > m_maxEntities - count;
+                }
+        }
+        if (addBorder) {
+            RS_Vector min = e->getMin();
+            RS_Vector max = e->getMax();
+            RS_Vector c2{max.x, min.y};
+            RS_Vector c4{min.x, max.y};
+            if (m_viewport->hasUCS()) {
+                calcRectCorners(min, max, c2, c4);
+            }
+            transformed.borders.push_back({min, c2, max, c4});
+            count += 4;
+        }
+        else {
+            transformed.entities.push_back(e);
+            count += e->countDeep();
+        }
+    }
+    m_transformedCount = count - countDeep();
+    m_transformedEntities.push_back(std::move(transformed));
+}
+
 void RS_Preview::draw(RS_Painter* painter) {
 //    bool drawTextsAsDraftsForPreview = view->isDrawTextsAsDraftForPreview();
 // fixme - ucs - achieve view - store as field? This temporary for compilation...
     bool drawTextsAsDraftsForPreview = false;
 
     for (auto e: std::as_const(*this)) {
-        int type = e->rtti();
-        switch (type) {
-            case RS2::EntityMText:
-            case RS2::EntityText: {
-                if (drawTextsAsDraftsForPreview){
-                    e->drawDraft(painter);
-                }
-                else {
-                    e->draw(painter);
-                }
-                break;
-            }
-            case RS2::EntityImage: {
+        drawPreviewEntity(painter, e, drawTextsAsDraftsForPreview);
+    }
+    if (!m_transformedEntities.empty()) {
+        drawTransformed(painter);
+    }
+}
+
+void RS_Preview::drawPreviewEntity(RS_Painter* painter, RS_Entity* e, bool textsAsDraft) {
+    int type = e->rtti();
+    switch (type) {
+        case RS2::EntityMText:
+        case RS2::EntityText: {
+            if (textsAsDraft){
                 e->drawDraft(painter);
-                break;
             }
-            default:
+            else {
                 e->draw(painter);
+            }
+            break;
+        }
+        case RS2::EntityImage: {
+            e->drawDraft(painter);
+            break;
+        }
+        default:
+            e->draw(painter);
+    }
+}
+
+/**
+ * Draws entities added by addTransformed(). Entities of the document are selected, so they are drawn
+ * as an unselected instance. As for clones, entities are drawn with the pen of the preview and their
+ * children with their own pen and layer.
+ */
+void RS_Preview::drawTransformed(RS_Painter* painter) {
+    RS_Painter::BlockInstance instance;
+    instance.ownAttributes = true;
+
+    for (const TransformedEntities& transformed: m_transformedEntities) {
+        painter->beginBlockInstance(transformed.insertionPoint, transformed.scale, transformed.angle,
+                                    transformed.basePoint, instance);
+        for (RS_Entity* e: transformed.entities) {
+            if (!e->isUndone()) {
+                drawPreviewEntity(painter, e, m_drawTextsAsDraft);
+            }
+        }
+        for (const auto& corners: transformed.borders) {
+            for (size_t i = 0; i < corners.size(); i++) {
+                painter->drawLineWCS(corners[i], corners[(i + 1) % corners.size()]);
+            }
         }
+        painter->endBlockInstance();
     }
 }
 
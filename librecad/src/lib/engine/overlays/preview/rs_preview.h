@@ -28,6 +28,8 @@
 #ifndef RS_PREVIEW_H
 #define RS_PREVIEW_H
 
+#include <array>
+
 #include "rs_entitycontainer.h"
 
 class LC_GraphicViewport;
@@ -53,12 +55,35 @@ public:
     void addAllFrom(RS_EntityContainer& container, LC_GraphicViewport* view);
     void addStretchablesFrom(RS_EntityContainer& container, LC_GraphicViewport* view,
                                      const RS_Vector& v1, const RS_Vector& v2);
+    void addTransformed(const std::vector<RS_Entity*>& entities, const RS_Vector& basePoint,
+                        const RS_Vector& insertionPoint, double scale, double angle);
     void draw(RS_Painter* painter) override;
     void addReferenceEntitiesToContainer(RS_EntityContainer* container);
     void clear() override;
     int getMaxAllowedEntities();
 private:
+    /**
+     * Entities previewed without cloning: they are drawn by the painter moved from the base point to the
+     * insertion point, scaled and rotated around it, in the same way as entities of a block for an insert.
+     */
+    struct TransformedEntities {
+        std::vector<RS_Entity*> entities;
+        /** corners of border rectangles drawn instead of complex entities */
+        std::vector<std::array<RS_Vector, 4>> borders;
+        RS_Vector basePoint;
+        RS_Vector insertionPoint;
+        double scale = 1.;
+        double angle = 0.;
+    };
+
+    void drawPreviewEntity(RS_Painter* painter, RS_Entity* e, bool textsAsDraft);
+    void drawTransformed(RS_Painter* painter);
+
     unsigned int m_maxEntities {0};
+    bool m_drawTextsAsDraft = true;
+    std::vector<TransformedEntities> m_transformedEntities;
+    /** count of entities and border lines added by addTransformed(), for the limit of previewed entities */
+    unsigned int m_transformedCount = 0;
     QList<RS_Entity*> m_referenceEntities;
     LC_GraphicViewport* m_viewport {nullptr};
 };
@@ -551,7 +551,8 @@ namespace RS2 {
     enum UndoableType {
         UndoableUnknown,    /**< Unknown undoable */
         UndoableEntity,     /**< Entity */
-        UndoableLayer       /**< Layer */
+        UndoableLayer,      /**< Layer */
+        UndoableTransform   /**< In-place transformation of entities */
     };
 
     /**
@@ -913,8 +914,10 @@ namespace RS2 {
         enum RedrawMethod {
                 RedrawNone = 0,
                 RedrawGrid = 1,
+                RedrawBackground = RedrawGrid, // background layer: background colour, paper and grid
                 RedrawOverlay = 2,
                 RedrawDrawing = 4,
+                RedrawViewport = 8, // only offset or zoom were changed, drawing content may be reused
                 RedrawAll = 0xffff
         };
 
@@ -0,0 +1,101 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include "lc_undoabletransform.h"
+
+#include "lc_entitygeometry.h"
+#include "rs_entity.h"
+
+LC_UndoableTransform::LC_UndoableTransform(std::vector<RS_Entity*> entities):
+    m_entities{std::move(entities)} {
+}
+
+LC_UndoableTransform::~LC_UndoableTransform() = default;
+
+void LC_UndoableTransform::addMove(const RS_Vector& offset) {
+    m_steps.push_back({Step::Move, offset, 0.});
+}
+
+void LC_UndoableTransform::addRotate(const RS_Vector& center, double angle) {
+    m_steps.push_back({Step::Rotate, center, angle});
+}
+
+void LC_UndoableTransform::addScale(const RS_Vector& center, double factor) {
+    m_steps.push_back({Step::Scale, center, factor});
+}
+
+bool LC_UndoableTransform::saveGeometry() {
+    m_geometry.clear();
+    m_geometry.reserve(m_entities.size());
+    for (const RS_Entity* e: m_entities) {
+        std::unique_ptr<LC_EntityGeometry> geometry = e->saveGeometry();
+        if (geometry == nullptr) {
+            m_geometry.clear();
+            return false;
+        }
+        m_geometry.push_back(std::move(geometry));
+    }
+    return true;
+}
+
+void LC_UndoableTransform::apply() {
+    for (const Step& step: m_steps) {
+        applyStep(step);
+    }
+}
+
+/**
+ * Restores the saved geometry on undo, applies the steps again on redo. Reverting the steps
+ * would accumulate rounding errors with each undo and redo.
+ */
+void LC_UndoableTransform::undoStateChanged(bool undone) {
+    if (!undone) {
+        apply();
+        return;
+    }
+    for (size_t i = 0; i < m_entities.size() && i < m_geometry.size(); i++) {
+        m_entities[i]->restoreGeometry(*m_geometry[i]);
+    }
+}
+
+void LC_UndoableTransform::applyStep(const Step& step) {
+    switch (step.type) {
+        case Step::Move: {
+            for (RS_Entity* e: m_entities) {
+                e->move(step.vector);
+            }
+            break;
+        }
+        case Step::Rotate: {
+            for (RS_Entity* e: m_entities) {
+                e->rotate(step.vector, step.value);
+            }
+            break;
+        }
+        case Step::Scale: {
+            RS_Vector factorVector{step.value, step.value};
+            for (RS_Entity* e: m_entities) {
+                e->scale(step.vector, factorVector);
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_UNDOABLETRANSFORM_H
+#define LC_UNDOABLETRANSFORM_H
+
+#include <memory>
+#include <vector>
+
+#include "rs_undoable.h"
+#include "rs_vector.h"
+
+class LC_EntityGeometry;
+class RS_Entity;
+
+/**
+ * Transformation of entities modified in place. Instead of the undone originals and their
+ * transformed clones, the undo cycle keeps the entities, their geometry before the transformation
+ * and the transformation. Undo restores the saved geometry, so entities are exactly as before,
+ * and redo applies the transformation again to the same geometry.
+ */
+class LC_UndoableTransform : public RS_Undoable {
+public:
+    explicit LC_UndoableTransform(std::vector<RS_Entity*> entities);
+    ~LC_UndoableTransform() override;
+
+    RS2::UndoableType undoRtti() const override {
+        return RS2::UndoableTransform;
+    }
+
+    void addMove(const RS_Vector& offset);
+    void addRotate(const RS_Vector& center, double angle);
+    void addScale(const RS_Vector& center, double factor);
+
+    /**
+     * Saves the geometry of the entities, which must be done before the transformation is applied.
+     * @return false if some entity doesn't support it, see RS_Entity::saveGeometry()
+     */
+    bool saveGeometry();
+    /**
+     * Applies the transformation to the entities
+     */
+    void apply();
+    void undoStateChanged(bool undone) override;
+
+    const std::vector<RS_Entity*>& getEntities() const {
+        return m_entities;
+    }
+
+private:
+    /** elementary transformation, see RS_Entity::move(), rotate() and scale() */
+    struct Step {
+        enum Type {
+            Move,
+            Rotate,
+            Scale
+        };
+        Type type = Move;
+        /** offset of the move, center of the rotation or scale */
+        RS_Vector vector;
+        /** angle of the rotation or factor of the scale */
+        double value = 0.;
+    };
+
+    void applyStep(const Step& step);
+
+    std::vector<RS_Entity*> m_entities;
+    /** geometry of the entities before the transformation */
+    std::vector<std::unique_ptr<LC_EntityGeometry>> m_geometry;
+    std::vector<Step> m_steps;
+};
+
+#endif // LC_UNDOABLETRANSFORM_H
@@ -54,3 +54,9 @@ void LC_UndoSection::addUndoable(RS_Undoable *undoable){
         document->addUndoable( undoable);
     }
 }
+
+void LC_UndoSection::addUndoable(std::unique_ptr<RS_Undoable> undoable){
+    if (valid) {
+        document->addUndoable(std::move(undoable));
+    }
+}
@@ -26,6 +26,7 @@
 #ifndef LC_UNDOSECTION_H
 #define LC_UNDOSECTION_H
 
+#include <memory>
 
 class RS_Document;
 class RS_Undoable;
@@ -48,6 +49,7 @@ public:
     ~LC_UndoSection();
 
     void addUndoable(RS_Undoable * undoable);
+    void addUndoable(std::unique_ptr<RS_Undoable> undoable);
 
 private:
     RS_Document *document {nullptr};
@@ -0,0 +1,562 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#include <cmath>
+
+#include <QColor>
+#include <QDataStream>
+#include <QFile>
+#include <QTemporaryFile>
+#include <QThreadPool>
+
+#include "lc_entitygeometry.h"
+#include "lc_undospillstore.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+#include "rs_debug.h"
+#include "rs_document.h"
+#include "rs_ellipse.h"
+#include "rs_insert.h"
+#include "rs_line.h"
+#include "rs_mtext.h"
+#include "rs_pen.h"
+#include "rs_point.h"
+#include "rs_polyline.h"
+#include "rs_solid.h"
+#include "rs_system.h"
+#include "rs_text.h"
+
+namespace {
+constexpr quint32 g_magic = 0x4c435553; // "LCUS"
+constexpr quint32 g_version = 2;
+
+// arcs of polylines with tiny bulges would be created as lines, see RS_Polyline::createVertex()
+bool isArcBulge(double bulge) {
+    return std::abs(bulge) >= RS_TOLERANCE && std::abs(bulge) < RS_MAXDOUBLE;
+}
+
+void write(QDataStream& stream, const RS_Vector& v) {
+    stream << v.x << v.y << v.z << v.valid;
+}
+
+void read(QDataStream& stream, RS_Vector& v) {
+    stream >> v.x >> v.y >> v.z >> v.valid;
+}
+
+template <class Enum>
+void writeEnum(QDataStream& stream, Enum value) {
+    stream << static_cast<qint32>(value);
+}
+
+template <class Enum>
+void readEnum(QDataStream& stream, Enum& value) {
+    qint32 v = 0;
+    stream >> v;
+    value = static_cast<Enum>(v);
+}
+
+void write(QDataStream& stream, const RS_Pen& pen) {
+    const RS_Color color = pen.getColor();
+    stream << static_cast<const QColor&>(color) << static_cast<quint32>(color.getFlags());
+    writeEnum(stream, pen.getWidth());
+    writeEnum(stream, pen.getLineType());
+    stream << static_cast<quint32>(pen.getFlags()) << pen.getAlpha() << pen.getScreenWidth() << pen.dashOffset();
+}
+
+void read(QDataStream& stream, RS_Pen& pen) {
+    QColor qcolor;
+    quint32 colorFlags = 0, flags = 0;
+    RS2::LineWidth width{};
+    RS2::LineType lineType{};
+    float alpha = 1.f;
+    double screenWidth = 0., dashOffset = 0.;
+    stream >> qcolor >> colorFlags;
+    readEnum(stream, width);
+    readEnum(stream, lineType);
+    stream >> flags >> alpha >> screenWidth >> dashOffset;
+    RS_Color color{qcolor};
+    color.setFlags(colorFlags);
+    pen = RS_Pen{color, width, lineType};
+    pen.setFlags(flags);
+    pen.setAlpha(alpha);
+    pen.setScreenWidth(screenWidth);
+    pen.setDashOffset(dashOffset);
+}
+
+void writeData(QDataStream& stream, const RS_Entity& entity);
+std::unique_ptr<RS_Entity> readData(QDataStream& stream, RS2::EntityType type, RS_EntityContainer* parent);
+
+/**
+ * Writes the type, attributes and borders of the entity, followed by its data
+ */
+void writeEntity(QDataStream& stream, const RS_Entity& entity) {
+    writeEnum(stream, entity.rtti());
+    stream << static_cast<quint64>(entity.getId());
+    stream << static_cast<quint32>(entity.getFlags());
+    const RS_Layer* layer = entity.getLayer(false);
+    stream << (layer != nullptr) << (layer != nullptr ? layer->getName() : QString{});
+    write(stream, entity.getPen(false));
+    const std::vector<QString> keys = entity.getAllKeys();
+    stream << static_cast<quint32>(keys.size());
+    for (const QString& key: keys) {
+        stream << key << entity.getUserDefVar(key);
+    }
+    write(stream, entity.getMin());
+    write(stream, entity.getMax());
+    writeData(stream, entity);
+}
+
+/**
+ * @return the entity written by writeEntity(), nullptr on failure
+ */
+std::unique_ptr<RS_Entity> readEntity(QDataStream& stream, RS_EntityContainer* parent) {
+    RS2::EntityType type{};
+    quint64 id = 0;
+    quint32 flags = 0, keyCount = 0;
+    bool hasLayer = false;
+    QString layer;
+    RS_Pen pen;
+    std::vector<std::pair<QString, QString>> vars;
+    RS_Vector minV, maxV;
+    readEnum(stream, type);
+    stream >> id >> flags >> hasLayer >> layer;
+    read(stream, pen);
+    stream >> keyCount;
+    for (quint32 i = 0; i < keyCount && stream.status() == QDataStream::Ok; i++) {
+        QString key, value;
+        stream >> key >> value;
+        vars.emplace_back(key, value);
+    }
+    read(stream, minV);
+    read(stream, maxV);
+    std::unique_ptr<RS_Entity> entity = readData(stream, type, parent);
+    if (entity == nullptr || stream.status() != QDataStream::Ok) {
+        return nullptr;
+    }
+
+    // places of other undone entities refer to the id
+    entity->restoreId(id);
+    // layers are found by name, a layer may be removed while entities are spilled
+    if (hasLayer) {
+        entity->setLayer(layer);
+    } else {
+        entity->setLayer(static_cast<RS_Layer*>(nullptr));
+    }
+    entity->setPen(pen);
+    entity->setFlags(flags);
+    for (const auto& [key, value]: vars) {
+        entity->setUserDefVar(key, value);
+    }
+    // exact borders, calculated ones may differ from moved borders in the last bits.
+    // Inserts and texts create their sub-entities on restoring the geometry
+    std::unique_ptr<LC_EntityGeometry> geometry = entity->saveGeometry();
+    if (geometry == nullptr) {
+        return nullptr;
+    }
+    geometry->minV = minV;
+    geometry->maxV = maxV;
+    entity->restoreGeometry(*geometry);
+    return entity;
+}
+
+void writePolyline(QDataStream& stream, const RS_Polyline& polyline) {
+    const RS_PolylineData data = polyline.getData();
+    write(stream, data.startpoint);
+    write(stream, data.endpoint);
+    stream << static_cast<quint32>(data.getFlags());
+
+    const std::vector<RS_Polyline::Vertex>& vertices = polyline.getVertices();
+    stream << static_cast<quint32>(vertices.size());
+    for (const RS_Polyline::Vertex& vertex: vertices) {
+        stream << vertex.x << vertex.y << vertex.bulge;
+    }
+    if (!vertices.empty()) {
+        return;
+    }
+    stream << static_cast<quint32>(polyline.count());
+    for (const RS_Entity* segment: polyline) {
+        stream << (segment->rtti() == RS2::EntityArc ? static_cast<const RS_Arc*>(segment)->getBulge() : 0.);
+        writeEntity(stream, *segment);
+    }
+}
+
+/**
+ * Creates the polyline as vertices are added to it, so the closing segment is known to it,
+ * and sets the exact state of its segments.
+ */
+std::unique_ptr<RS_Entity> readPolyline(QDataStream& stream, RS_EntityContainer* parent) {
+    RS_PolylineData data;
+    quint32 flags = 0, vertexCount = 0, segmentCount = 0;
+    read(stream, data.startpoint);
+    read(stream, data.endpoint);
+    stream >> flags >> vertexCount;
+    data.setFlags(flags);
+
+    const bool closed = data.getFlag(RS2::FlagClosed);
+    auto polyline = std::make_unique<RS_Polyline>(parent, RS_PolylineData{RS_Vector{false}, RS_Vector{false}, closed});
+    std::vector<std::pair<RS_Vector, double>> vertices;
+    for (quint32 i = 0; i < vertexCount && stream.status() == QDataStream::Ok; i++) {
+        double x = 0., y = 0., bulge = 0.;
+        stream >> x >> y >> bulge;
+        vertices.emplace_back(RS_Vector{x, y}, bulge);
+    }
+    if (vertexCount > 0) {
+        polyline->appendVertexs(vertices);
+    } else {
+        stream >> segmentCount;
+        std::vector<double> bulges;
+        std::vector<std::unique_ptr<RS_Entity>> segments;
+        for (quint32 i = 0; i < segmentCount && stream.status() == QDataStream::Ok; i++) {
+            double bulge = 0.;
+            stream >> bulge;
+            std::unique_ptr<RS_Entity> segment = readEntity(stream, polyline.get());
+            if (segment == nullptr) {
+                return nullptr;
+            }
+            bulges.push_back(bulge);
+            segments.push_back(std::move(segment));
+        }
+        if (!segments.empty()) {
+            polyline->addVertex(segments.front()->getStartpoint(), bulges.front());
+            // the last segment of a closed polyline is added by the polyline
+            const size_t regular = closed ? segments.size() - 1 : segments.size();
+            for (size_t i = 0; i < regular; i++) {
+                polyline->addVertex(segments[i]->getEndpoint(), i + 1 < segments.size() ? bulges[i + 1] : 0.);
+            }
+        }
+        if (polyline->count() != segments.size()) {
+            return nullptr;
+        }
+        size_t i = 0;
+        for (RS_Entity* segment: *polyline) {
+            const RS_Entity& source = *segments[i++];
+            std::unique_ptr<LC_EntityGeometry> geometry = source.saveGeometry();
+            if (segment->rtti() != source.rtti() || geometry == nullptr) {
+                return nullptr;
+            }
+            segment->restoreGeometry(*geometry);
+            segment->setLayer(source.getLayer(false));
+            segment->setPen(source.getPen(false));
+            segment->setFlags(source.getFlags());
+            for (const QString& key: source.getAllKeys()) {
+                segment->setUserDefVar(key, source.getUserDefVar(key));
+            }
+        }
+    }
+    polyline->getData() = data;
+    return polyline;
+}
+
+void writeData(QDataStream& stream, const RS_Entity& entity) {
+    switch (entity.rtti()) {
+        case RS2::EntityPoint:
+            write(stream, static_cast<const RS_Point&>(entity).getData().pos);
+            break;
+        case RS2::EntityLine: {
+            const RS_LineData data = static_cast<const RS_Line&>(entity).getData();
+            write(stream, data.startpoint);
+            write(stream, data.endpoint);
+            break;
+        }
+        case RS2::EntityArc: {
+            const RS_ArcData& data = static_cast<const RS_Arc&>(entity).getData();
+            write(stream, data.center);
+            stream << data.radius << data.angle1 << data.angle2 << data.reversed
+                   << data.startAngleDegrees << data.otherAngleDegrees << data.angularLength;
+            break;
+        }
+        case RS2::EntityCircle: {
+            const RS_CircleData& data = static_cast<const RS_Circle&>(entity).getData();
+            write(stream, data.center);
+            stream << data.radius;
+            break;
+        }
+        case RS2::EntityEllipse: {
+            const RS_EllipseData& data = static_cast<const RS_Ellipse&>(entity).getData();
+            write(stream, data.center);
+            write(stream, data.majorP);
+            stream << data.ratio << data.angle1 << data.angle2 << data.reversed << data.isArc
+                   << data.angleDegrees << data.startAngleDegrees << data.otherAngleDegrees << data.angularLength;
+            break;
+        }
+        case RS2::EntitySolid:
+            for (const RS_Vector& corner: static_cast<const RS_Solid&>(entity).getData().corner) {
+                write(stream, corner);
+            }
+            break;
+        case RS2::EntityPolyline:
+            writePolyline(stream, static_cast<const RS_Polyline&>(entity));
+            break;
+        case RS2::EntityInsert: {
+            const RS_InsertData data = static_cast<const RS_Insert&>(entity).getData();
+            stream << data.name;
+            write(stream, data.insertionPoint);
+            write(stream, data.scaleFactor);
+            stream << data.angle << data.cols << data.rows;
+            write(stream, data.spacing);
+            writeEnum(stream, data.updateMode);
+            break;
+        }
+        case RS2::EntityText: {
+            const RS_TextData data = static_cast<const RS_Text&>(entity).getData();
+            write(stream, data.insertionPoint);
+            write(stream, data.secondPoint);
+            stream << data.height << data.widthRel;
+            writeEnum(stream, data.valign);
+            writeEnum(stream, data.halign);
+            writeEnum(stream, data.textGeneration);
+            stream << data.text << data.style << data.angle;
+            writeEnum(stream, data.updateMode);
+            break;
+        }
+        case RS2::EntityMText: {
+            const RS_MTextData data = static_cast<const RS_MText&>(entity).getData();
+            write(stream, data.insertionPoint);
+            stream << data.height << data.width;
+            writeEnum(stream, data.valign);
+            writeEnum(stream, data.halign);
+            writeEnum(stream, data.drawingDirection);
+            writeEnum(stream, data.lineSpacingStyle);
+            stream << data.lineSpacingFactor << data.text << data.style << data.angle;
+            writeEnum(stream, data.updateMode);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+std::unique_ptr<RS_Entity> readData(QDataStream& stream, RS2::EntityType type, RS_EntityContainer* parent) {
+    switch (type) {
+        case RS2::EntityPoint: {
+            RS_PointData data;
+            read(stream, data.pos);
+            return std::make_unique<RS_Point>(parent, data);
+        }
+        case RS2::EntityLine: {
+            RS_LineData data;
+            read(stream, data.startpoint);
+            read(stream, data.endpoint);
+            return std::make_unique<RS_Line>(parent, data);
+        }
+        case RS2::EntityArc: {
+            RS_ArcData data;
+            read(stream, data.center);
+            stream >> data.radius >> data.angle1 >> data.angle2 >> data.reversed
+                   >> data.startAngleDegrees >> data.otherAngleDegrees >> data.angularLength;
+            return std::make_unique<RS_Arc>(parent, data);
+        }
+        case RS2::EntityCircle: {
+            RS_CircleData data;
+            read(stream, data.center);
+            stream >> data.radius;
+            return std::make_unique<RS_Circle>(parent, data);
+        }
+        case RS2::EntityEllipse: {
+            RS_EllipseData data;
+            read(stream, data.center);
+            read(stream, data.majorP);
+            stream >> data.ratio >> data.angle1 >> data.angle2 >> data.reversed >> data.isArc
+                   >> data.angleDegrees >> data.startAngleDegrees >> data.otherAngleDegrees >> data.angularLength;
+            return std::make_unique<RS_Ellipse>(parent, data);
+        }
+        case RS2::EntitySolid: {
+            RS_SolidData data;
+            for (RS_Vector& corner: data.corner) {
+                read(stream, corner);
+            }
+            return std::make_unique<RS_Solid>(parent, data);
+        }
+        case RS2::EntityPolyline:
+            return readPolyline(stream, parent);
+        case RS2::EntityInsert: {
+            RS_InsertData data;
+            stream >> data.name;
+            read(stream, data.insertionPoint);
+            read(stream, data.scaleFactor);
+            stream >> data.angle >> data.cols >> data.rows;
+            read(stream, data.spacing);
+            readEnum(stream, data.updateMode);
+            return std::make_unique<RS_Insert>(parent, data);
+        }
+        case RS2::EntityText: {
+            RS_TextData data;
+            read(stream, data.insertionPoint);
+            read(stream, data.secondPoint);
+            stream >> data.height >> data.widthRel;
+            readEnum(stream, data.valign);
+            readEnum(stream, data.halign);
+            readEnum(stream, data.textGeneration);
+            stream >> data.text >> data.style >> data.angle;
+            readEnum(stream, data.updateMode);
+            return std::make_unique<RS_Text>(parent, data);
+        }
+        case RS2::EntityMText: {
+            RS_MTextData data;
+            read(stream, data.insertionPoint);
+            stream >> data.height >> data.width;
+            readEnum(stream, data.valign);
+            readEnum(stream, data.halign);
+            readEnum(stream, data.drawingDirection);
+            readEnum(stream, data.lineSpacingStyle);
+            stream >> data.lineSpacingFactor >> data.text >> data.style >> data.angle;
+            readEnum(stream, data.updateMode);
+            return std::make_unique<RS_MText>(parent, data);
+        }
+        default:
+            return nullptr;
+    }
+}
+}
+
+LC_UndoSpillStore::LC_UndoSpillStore() = default;
+
+LC_UndoSpillStore::~LC_UndoSpillStore() {
+    if (m_writer != nullptr) {
+        m_writer->waitForDone();
+    }
+    for (const auto& [id, file]: m_files) {
+        QFile::remove(file.fileName);
+    }
+}
+
+bool LC_UndoSpillStore::isSpillable(const RS_Entity& entity) {
+    switch (entity.rtti()) {
+        case RS2::EntityPoint:
+        case RS2::EntityLine:
+        case RS2::EntityArc:
+        case RS2::EntityCircle:
+        case RS2::EntityEllipse:
+        case RS2::EntitySolid:
+        case RS2::EntityText:
+        case RS2::EntityMText:
+            return true;
+        case RS2::EntityInsert:
+            // the block list of other inserts isn't known to a restored insert
+            return static_cast<const RS_Insert&>(entity).getData().blockSource == nullptr;
+        case RS2::EntityPolyline:
+            // segments are created again by adding vertices; a compact polyline has no segments
+            // to iterate, they are visited
+            return static_cast<const RS_Polyline&>(entity).visitEntities([](const RS_Entity* segment) {
+                if (segment->rtti() == RS2::EntityArc) {
+                    return isArcBulge(static_cast<const RS_Arc*>(segment)->getBulge());
+                }
+                return segment->rtti() == RS2::EntityLine;
+            });
+        default:
+            return false;
+    }
+}
+
+int LC_UndoSpillStore::spill(const std::vector<RS_Entity*>& entities, const std::vector<Place>& places) {
+    QTemporaryFile file{RS_System::getTempDir() + "/librecad_undo_XXXXXX"};
+    file.setAutoRemove(false);
+    if (!file.open()) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_UndoSpillStore::spill: can't create temporary file");
+        return -1;
+    }
+    SpillFile spilled{file.fileName(), places, std::make_shared<std::atomic<bool>>(false)};
+    file.close();
+
+    // entities are deleted after this call, they are serialized before
+    QByteArray bytes;
+    {
+        QDataStream stream{&bytes, QIODevice::WriteOnly};
+        stream << g_magic << g_version << static_cast<quint32>(entities.size());
+        for (const RS_Entity* e: entities) {
+            writeEntity(stream, *e);
+        }
+    }
+
+    if (m_writer == nullptr) {
+        m_writer = std::make_unique<QThreadPool>();
+        m_writer->setMaxThreadCount(1);
+    }
+    m_writer->start([fileName = spilled.fileName, bytes = std::move(bytes), written = spilled.written]() {
+        QFile out{fileName};
+        if (out.open(QIODevice::WriteOnly) && out.write(bytes) == bytes.size() && out.flush()) {
+            written->store(true);
+        }
+    });
+
+    const int id = m_nextId++;
+    m_files.emplace(id, std::move(spilled));
+    return id;
+}
+
+std::vector<RS_Entity*> LC_UndoSpillStore::restore(RS_Document& document, int id, std::vector<Place>& places) {
+    auto it = m_files.find(id);
+    if (it == m_files.end()) {
+        return {};
+    }
+    SpillFile spilled = std::move(it->second);
+    m_files.erase(it);
+
+    if (m_writer != nullptr) {
+        m_writer->waitForDone();
+    }
+    QByteArray bytes;
+    if (spilled.written->load()) {
+        QFile in{spilled.fileName};
+        if (in.open(QIODevice::ReadOnly)) {
+            bytes = in.readAll();
+        }
+    }
+    QFile::remove(spilled.fileName);
+
+    std::vector<std::unique_ptr<RS_Entity>> entities;
+    QDataStream stream{bytes};
+    quint32 magic = 0, version = 0, count = 0;
+    stream >> magic >> version >> count;
+    if (magic == g_magic && version == g_version && count == spilled.places.size()) {
+        for (quint32 i = 0; i < count; i++) {
+            std::unique_ptr<RS_Entity> entity = readEntity(stream, &document);
+            if (entity == nullptr) {
+                break;
+            }
+            entities.push_back(std::move(entity));
+        }
+    }
+    if (entities.size() != spilled.places.size()) {
+        RS_DEBUG->print(RS_Debug::D_WARNING, "LC_UndoSpillStore::restore: can't read %s",
+                        spilled.fileName.toLatin1().data());
+        return {};
+    }
+
+    std::vector<RS_Entity*> result;
+    for (std::unique_ptr<RS_Entity>& entity: entities) {
+        result.push_back(entity.release());
+    }
+    places = std::move(spilled.places);
+    return result;
+}
+
+void LC_UndoSpillStore::discard(int id) {
+    auto it = m_files.find(id);
+    if (it == m_files.end()) {
+        return;
+    }
+    // after the file is written
+    m_writer->start([fileName = it->second.fileName]() {
+        QFile::remove(fileName);
+    });
+    m_files.erase(it);
+}
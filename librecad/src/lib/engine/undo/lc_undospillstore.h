@@ -0,0 +1,96 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD.org
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+**********************************************************************/
+
+#ifndef LC_UNDOSPILLSTORE_H
+#define LC_UNDOSPILLSTORE_H
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QString>
+
+class QThreadPool;
+class RS_Document;
+class RS_Entity;
+
+/**
+ * Temporary files with undone entities of the undo history, which are moved out of
+ * memory when the history exceeds its memory budget, see RS_Undo::setUndoMemoryBudget().
+ * Entities are written in a binary format with their exact data, borders and attributes,
+ * so they are read back as they were. Files are written by a worker thread.
+ */
+class LC_UndoSpillStore {
+public:
+    LC_UndoSpillStore();
+    ~LC_UndoSpillStore();
+    LC_UndoSpillStore(const LC_UndoSpillStore&) = delete;
+    LC_UndoSpillStore& operator=(const LC_UndoSpillStore&) = delete;
+
+    /**
+     * Place of an undone top-level entity in the document: the id of the live entity before
+     * it, 0 at the front, and its position, which is used if that entity is gone
+     */
+    struct Place {
+        unsigned long long previousId = 0;
+        int position = 0;
+    };
+
+    /**
+     * @return true, if the entity and its sub-entities can be written to a file
+     */
+    static bool isSpillable(const RS_Entity& entity);
+
+    /**
+     * Writes entities to a temporary file, with their places in the document. The entities
+     * are serialized at once, the file is written in the background.
+     * @return id of the file, or -1 if the file can't be created
+     */
+    int spill(const std::vector<RS_Entity*>& entities, const std::vector<Place>& places);
+    /**
+     * Reads the entities of the file back as undone entities of the document, which are
+     * not added to the container. They keep the ids of the spilled entities, so places of
+     * other entities refer to them. The file is removed.
+     * @return the entities in the order given to spill(), or an empty list on failure,
+     *         e.g. if the file couldn't be written
+     */
+    std::vector<RS_Entity*> restore(RS_Document& document, int id, std::vector<Place>& places);
+    /**
+     * Removes the file
+     */
+    void discard(int id);
+
+private:
+    struct SpillFile {
+        QString fileName;
+        /** places of the entities in the document */
+        std::vector<Place> places;
+        /** set by the worker once the file is written */
+        std::shared_ptr<std::atomic<bool>> written;
+    };
+    std::map<int, SpillFile> m_files;
+    int m_nextId = 0;
+    /** single worker, so files are written and removed in order */
+    std::unique_ptr<QThreadPool> m_writer;
+};
+
+#endif // LC_UNDOSPILLSTORE_H
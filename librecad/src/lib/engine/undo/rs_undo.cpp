@@ -27,6 +27,8 @@
 
 #include<iostream>
 #include "rs_undo.h"
+#include <algorithm>
+#include <unordered_map>
 #include <unordered_set>
 #include "rs_debug.h"
 #include "rs_undocycle.h"
@@ -57,6 +59,12 @@ bool RS_Undo::hasUndoable()
     return  nullptr != currentCycle && !currentCycle->empty();
 }
 
+void RS_Undo::removeUndoables(const std::vector<RS_Undoable*>& undoables) {
+    for (RS_Undoable* undoable: undoables) {
+        removeUndoable(undoable);
+    }
+}
+
 /**
  * Adds an Undo Cycle at the current position in the list.
  * All Cycles after the new one are removed and the Undoabels
@@ -68,6 +76,8 @@ void RS_Undo::addUndoCycle(std::shared_ptr<RS_UndoCycle> undoCycle) {
 //    undoList.insert(++undoPointer, i);
     undoList.push_back(std::move(undoCycle));
     m_redoPointer = undoList.cend();
+    undoList.back()->retainedBytes = retainedBytes(*undoList.back());
+    enforceMemoryBudget();
 
     updateUndoState();
 
@@ -88,28 +98,7 @@ void RS_Undo::startUndoCycle(){
     // if there are undo cycles behind undoPointer
     // remove obsolete entities and undoCycles
     if (undoList.cend() != m_redoPointer) {
-        // collect remaining undoables
-        std::unordered_set<RS_Undoable*> keep;
-        for (auto it = undoList.begin(); it != m_redoPointer; ++it) {
-            for (RS_Undoable* undoable: (*it)->getUndoables()){
-                keep.insert(undoable);
-            }
-        }
-
-        // collect obsolete undoables
-        std::unordered_set<RS_Undoable*> obsolete;
-        for (auto it = m_redoPointer; it != undoList.end(); ++it) {
-            for (RS_Undoable* undoable: (*it)->getUndoables()){
-                obsolete.insert(undoable);
-            }
-        }
-
-        // delete obsolete undoables which are not in keep list
-        for (RS_Undoable* undoable: obsolete) {
-            if (keep.end() == keep.find(undoable)) {
-                removeUndoable(undoable);
-            }
-        }
+        removeUndoablesOfCycles(std::distance(undoList.cbegin(), m_redoPointer), undoList.size());
         // clean up obsolete undoCycles
         undoList.erase(m_redoPointer, undoList.cend());
         m_redoPointer = undoList.cend();
@@ -133,6 +122,14 @@ void RS_Undo::addUndoable(RS_Undoable* u) {
     RS_DEBUG->print("RS_Undo::%s(): end", __func__);
 }
 
+void RS_Undo::addUndoable(std::unique_ptr<RS_Undoable> u) {
+    if( nullptr == currentCycle) {
+        RS_DEBUG->print( RS_Debug::D_CRITICAL, "RS_Undo::%s(): invalid currentCycle, possibly missing startUndoCycle()", __func__);
+        return;
+    }
+    currentCycle->addUndoable(std::move(u));
+}
+
 /**
  * Ends the current undo cycle.
  */
@@ -167,11 +164,17 @@ bool RS_Undo::undo() {
     if (m_redoPointer == undoList.cbegin())
         return false;
 
+    if (!restoreCycles(std::distance(undoList.cbegin(), m_redoPointer) - 1)) {
+        updateUndoState();
+        return false;
+    }
+
     m_redoPointer = std::prev(m_redoPointer);
     std::shared_ptr<RS_UndoCycle> uc = *m_redoPointer;
 
 	updateUndoState();
 	uc->changeUndoState();
+	cycleUndoStateChanged(*uc);
 	return true;
 }
 
@@ -188,6 +191,7 @@ bool RS_Undo::redo() {
 
 		updateUndoState();
 		uc->changeUndoState();
+		cycleUndoStateChanged(*uc);
 		return true;
 	}
     return false;
@@ -210,6 +214,188 @@ void RS_Undo::collectUndoState(bool& undoAvailable, bool& redoAvailable) const {
     undoAvailable = !undoList.empty() && m_redoPointer != undoList.cbegin();
 }
 
+void RS_Undo::setUndoMemoryBudget(std::size_t bytes) {
+    m_memoryBudget = bytes;
+    enforceMemoryBudget();
+}
+
+std::size_t RS_Undo::getUndoMemoryUsage() const {
+    const auto undoCount = static_cast<std::size_t>(std::distance(undoList.cbegin(), m_redoPointer));
+    std::size_t bytes = 0;
+    for (std::size_t i = spilledCycleCount(); i < undoCount; ++i) {
+        bytes += undoList[i]->retainedBytes;
+    }
+    return bytes;
+}
+
+std::size_t RS_Undo::spilledCycleCount() const {
+    return m_spilledCycles.empty() ? 0 : m_spilledCycles.back().endCycle;
+}
+
+/**
+ * Moves undoables of the oldest cycles in memory out of memory, until the undo
+ * history fits into the budget. The latest cycle, which is undone next, is kept.
+ */
+void RS_Undo::enforceMemoryBudget() {
+    if (m_memoryBudget == 0) {
+        return;
+    }
+    std::size_t usage = getUndoMemoryUsage();
+    const auto undoCount = static_cast<std::size_t>(std::distance(undoList.cbegin(), m_redoPointer));
+    if (usage <= m_memoryBudget || undoCount == 0) {
+        return;
+    }
+    const std::size_t begin = spilledCycleCount();
+    std::size_t end = begin;
+    while (end + 1 < undoCount && usage > m_memoryBudget) {
+        usage -= std::min(usage, undoList[end]->retainedBytes);
+        ++end;
+    }
+    if (end > begin) {
+        spillCycles(begin, end);
+    }
+}
+
+void RS_Undo::spillCycles(std::size_t begin, std::size_t end) {
+    RS_DEBUG->print("RS_Undo::spillCycles: %zu - %zu", begin, end);
+
+    // undone undoables of the cycles, with the cycles they belong to
+    std::unordered_map<RS_Undoable*, std::vector<std::size_t>> undoableCycles;
+    std::vector<RS_Undoable*> undoables;
+    for (std::size_t i = begin; i < end; ++i) {
+        for (RS_Undoable* undoable: undoList[i]->getUndoables()) {
+            if (undoable->isUndone()) {
+                std::vector<std::size_t>& cycles = undoableCycles[undoable];
+                if (cycles.empty()) {
+                    undoables.push_back(undoable);
+                }
+                cycles.push_back(i);
+            }
+        }
+    }
+    // undoables of other cycles stay in memory
+    for (std::size_t i = 0; i < undoList.size(); ++i) {
+        if (i < begin || i >= end) {
+            for (RS_Undoable* undoable: undoList[i]->getUndoables()) {
+                undoableCycles.erase(undoable);
+            }
+        }
+    }
+    undoables.erase(std::remove_if(undoables.begin(), undoables.end(), [&undoableCycles](RS_Undoable* undoable) {
+        return undoableCycles.count(undoable) == 0;
+    }), undoables.end());
+
+    std::vector<const RS_UndoCycle*> cycles;
+    for (const std::shared_ptr<RS_UndoCycle>& cycle: undoList) {
+        cycles.push_back(cycle.get());
+    }
+    selectSpillable(cycles, undoables);
+
+    SpilledCycles spilled;
+    spilled.endCycle = end;
+    if (!undoables.empty()) {
+        // the cycles refer to spilled undoables by their index in the storage
+        for (RS_Undoable* undoable: undoables) {
+            for (std::size_t i: undoableCycles[undoable]) {
+                undoList[i]->removeUndoable(undoable);
+            }
+        }
+        spilled.storage = spillUndoables(undoables);
+        if (spilled.storage < 0) {
+            // spilling is tried again at the next check of the budget
+            RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Undo::spillCycles: undoables are kept in memory");
+            for (RS_Undoable* undoable: undoables) {
+                for (std::size_t i: undoableCycles[undoable]) {
+                    undoList[i]->addUndoable(undoable);
+                }
+            }
+            return;
+        }
+        for (RS_Undoable* undoable: undoables) {
+            spilled.undoableCycles.push_back(std::move(undoableCycles[undoable]));
+        }
+    }
+    for (std::size_t i = begin; i < end; ++i) {
+        undoList[i]->retainedBytes = retainedBytes(*undoList[i]);
+    }
+    m_spilledCycles.push_back(std::move(spilled));
+}
+
+bool RS_Undo::restoreCycles(std::size_t index) {
+    while (!m_spilledCycles.empty() && m_spilledCycles.back().endCycle > index) {
+        SpilledCycles spilled = std::move(m_spilledCycles.back());
+        m_spilledCycles.pop_back();
+        if (spilled.storage < 0) {
+            continue;
+        }
+        RS_DEBUG->print("RS_Undo::restoreCycles: %zu", spilled.endCycle);
+        std::vector<RS_Undoable*> undoables = restoreUndoables(spilled.storage);
+        if (undoables.size() != spilled.undoableCycles.size()) {
+            // only the cycles of this batch refer to the lost undoables, older cycles are kept
+            const std::size_t begin = spilledCycleCount();
+            RS_DEBUG->print(RS_Debug::D_WARNING, "RS_Undo::restoreCycles: undo cycles %zu - %zu are lost",
+                            begin, spilled.endCycle);
+            removeUndoables(undoables);
+            removeCycles(begin, spilled.endCycle);
+            undoCyclesLost(spilled.endCycle - begin);
+            return false;
+        }
+        for (std::size_t k = 0; k < undoables.size(); ++k) {
+            for (std::size_t i: spilled.undoableCycles[k]) {
+                undoList[i]->addUndoable(undoables[k]);
+            }
+        }
+        for (std::size_t i = spilledCycleCount(); i < spilled.endCycle; ++i) {
+            undoList[i]->retainedBytes = retainedBytes(*undoList[i]);
+        }
+    }
+    return true;
+}
+
+void RS_Undo::removeCycles(std::size_t begin, std::size_t end) {
+    auto redoIndex = static_cast<std::size_t>(std::distance(undoList.cbegin(), m_redoPointer));
+    if (redoIndex >= end) {
+        redoIndex -= end - begin;
+    } else {
+        redoIndex = std::min(redoIndex, begin);
+    }
+    removeUndoablesOfCycles(begin, end);
+    undoList.erase(undoList.cbegin() + begin, undoList.cbegin() + end);
+    m_redoPointer = undoList.cbegin() + redoIndex;
+}
+
+/**
+ * Deletes undoables of the given cycles, which no other cycle refers to
+ */
+void RS_Undo::removeUndoablesOfCycles(std::size_t begin, std::size_t end) {
+    // collect remaining undoables
+    std::unordered_set<RS_Undoable*> keep;
+    for (std::size_t i = 0; i < undoList.size(); ++i) {
+        if (i < begin || i >= end) {
+            for (RS_Undoable* undoable: undoList[i]->getUndoables()) {
+                keep.insert(undoable);
+            }
+        }
+    }
+
+    // collect obsolete undoables
+    std::unordered_set<RS_Undoable*> obsolete;
+    for (std::size_t i = begin; i < end; ++i) {
+        for (RS_Undoable* undoable: undoList[i]->getUndoables()) {
+            obsolete.insert(undoable);
+        }
+    }
+
+    // delete obsolete undoables which are not in keep list
+    std::vector<RS_Undoable*> toRemove;
+    for (RS_Undoable* undoable: obsolete) {
+        if (keep.end() == keep.find(undoable)) {
+            toRemove.push_back(undoable);
+        }
+    }
+    removeUndoables(toRemove);
+}
+
 /**
  * Dumps the undo list to stdout.
  */
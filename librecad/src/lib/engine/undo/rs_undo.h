@@ -30,6 +30,7 @@
 #ifndef RS_UNDO_H
 #define RS_UNDO_H
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -56,6 +57,11 @@ public:
 
     virtual void startUndoCycle();
     virtual void addUndoable(RS_Undoable* u);
+    /**
+     * Adds an undoable owned by the current undo cycle, it's deleted
+     * when the cycle is no longer in the undo buffer.
+     */
+    void addUndoable(std::unique_ptr<RS_Undoable> u);
     virtual void endUndoCycle();
 
     /**
@@ -64,6 +70,11 @@ public:
      * for Undoables that are no longer in the undo buffer.
      */
     virtual void removeUndoable(RS_Undoable* u) = 0;
+    /**
+     * Deletes all given Undoables, which are no longer in the undo buffer.
+     * Implementing classes may override it to remove them at once.
+     */
+    virtual void removeUndoables(const std::vector<RS_Undoable*>& undoables);
 
     /**
 	  *\brief enable/disable redo/undo buttons in main application window
@@ -71,13 +82,112 @@ public:
       **/
 	void updateUndoState() const;
     void collectUndoState(bool &undoAvailable, bool &redoAvailable) const;
+
+    /**
+     * Sets the memory in bytes which undone undoables of the undo history may take, 0 for
+     * no limit. Undoables of the oldest cycles over the budget are moved out of memory, see
+     * spillUndoables(), and are restored when these cycles are undone.
+     */
+    void setUndoMemoryBudget(std::size_t bytes);
+    std::size_t getUndoMemoryBudget() const {
+        return m_memoryBudget;
+    }
+    /**
+     * @return memory retained by the cycles of the undo history which are kept in memory
+     */
+    std::size_t getUndoMemoryUsage() const;
     friend std::ostream& operator << (std::ostream& os, RS_Undo& a);
     static bool test();
 protected:
     virtual void fireUndoStateChanged([[maybe_unused]]bool undoAvailable, [[maybe_unused]] bool redoAvailable) const {};
+    /**
+     * Called after the undoables of the cycle were undone or redone
+     */
+    virtual void cycleUndoStateChanged([[maybe_unused]] const RS_UndoCycle& cycle) {};
+    /**
+     * @return the undo cycle currently being recorded, or nullptr outside of start-/endUndoCycle()
+     */
+    const RS_UndoCycle* getCurrentCycle() const {
+        return currentCycle.get();
+    }
+    /**
+     * @return true while an undo cycle started inside of another one is recorded
+     */
+    bool isUndoCycleNested() const {
+        return refCount > 1;
+    }
+
+    /**
+     * @return memory retained by the undone undoables of the cycle, which is freed when
+     *         they are no longer in the undo buffer
+     */
+    virtual std::size_t retainedBytes([[maybe_unused]] const RS_UndoCycle& cycle) const {
+        return 0;
+    }
+    /**
+     * Removes undoables from the list which can't be moved out of memory. The undoables
+     * are undone and only referenced by the cycles which are spilled. The given cycles are
+     * all cycles of the undo buffer, including spilled ones, as their other undoables may
+     * still refer to the undoables.
+     */
+    virtual void selectSpillable([[maybe_unused]] const std::vector<const RS_UndoCycle*>& cycles,
+                                 std::vector<RS_Undoable*>& undoables) const {
+        undoables.clear();
+    }
+    /**
+     * Moves the undoables out of memory, they are deleted.
+     * @return id of the storage for restoreUndoables(), or a negative number on failure,
+     *         in which case the undoables are kept
+     */
+    virtual int spillUndoables([[maybe_unused]] const std::vector<RS_Undoable*>& undoables) {
+        return -1;
+    }
+    /**
+     * @return undoables of the storage in the order given to spillUndoables(), or an empty
+     *         list on failure. The storage is released in both cases.
+     */
+    virtual std::vector<RS_Undoable*> restoreUndoables([[maybe_unused]] int storage) {
+        return {};
+    }
+    /**
+     * Releases the storage of undoables which are no longer in the undo buffer
+     */
+    virtual void discardUndoables([[maybe_unused]] int storage) {}
+    /**
+     * Called after undoables moved out of memory couldn't be restored. The given number of
+     * cycles which referred to them were removed from the undo buffer.
+     */
+    virtual void undoCyclesLost([[maybe_unused]] std::size_t count) {}
+
 private:
+    /**
+     * Undoables of the oldest undo cycles, which are moved out of memory
+     */
+    struct SpilledCycles {
+        /** index after the last cycle */
+        std::size_t endCycle = 0;
+        /** for each undoable of the storage, the indexes of the cycles it belongs to */
+        std::vector<std::vector<std::size_t>> undoableCycles;
+        /** storage of the undoables, negative if none of the undoables could be moved */
+        int storage = -1;
+    };
 
     void addUndoCycle(std::shared_ptr<RS_UndoCycle> undoCycle);
+    void removeUndoablesOfCycles(std::size_t begin, std::size_t end);
+    /** @return number of the oldest cycles which are spilled */
+    std::size_t spilledCycleCount() const;
+    void enforceMemoryBudget();
+    void spillCycles(std::size_t begin, std::size_t end);
+    /**
+     * Restores the spilled undoables of the cycle with the given index and of all cycles after it
+     * @return false if undoables couldn't be restored, the cycles of their batch are removed
+     *         from the undo buffer then
+     */
+    bool restoreCycles(std::size_t index);
+    /**
+     * Removes the cycles from begin to end from the undo buffer, none of them may be spilled
+     */
+    void removeCycles(std::size_t begin, std::size_t end);
 
     //! List of undo list items. every item is something that can be undone.
 	std::vector<std::shared_ptr<RS_UndoCycle>> undoList;
@@ -94,6 +204,10 @@ private:
     std::shared_ptr<RS_UndoCycle> currentCycle;
 
     int refCount {0}; ///< reference counter for nested start/end calls
+
+    std::size_t m_memoryBudget = 0;
+    /** batches of spilled cycles, from the oldest */
+    std::vector<SpilledCycles> m_spilledCycles;
 };
 
 
@@ -41,6 +41,13 @@ void RS_UndoCycle::addUndoable(RS_Undoable* u) {
         undoables.insert(u);
 }
 
+void RS_UndoCycle::addUndoable(std::unique_ptr<RS_Undoable> u) {
+    if (u != nullptr) {
+        undoables.insert(u.get());
+        ownedUndoables.push_back(std::move(u));
+    }
+}
+
 /**
  * Removes an undoable from the list.
  */
@@ -29,8 +29,11 @@
 #ifndef RS_UNDOLISTITEM_H
 #define RS_UNDOLISTITEM_H
 
+#include <cstddef>
 #include <iosfwd>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "rs_undoable.h"
 
@@ -59,6 +62,10 @@ public:
      * more Undoables.
      */
     void addUndoable(RS_Undoable* u);
+    /**
+     * Adds an Undoable owned by this Undo Cycle, it's deleted with the cycle.
+     */
+    void addUndoable(std::unique_ptr<RS_Undoable> u);
 
     /**
      * Removes an undoable from the list.
@@ -86,6 +93,10 @@ private:
     //RS2::UndoType type;
     //! List of entity id's that were affected by this action
     std::set<RS_Undoable*> undoables;
+    //! Undoables which exist for this cycle only, like transformations of entities
+    std::vector<std::unique_ptr<RS_Undoable>> ownedUndoables;
+    //! Memory of undone undoables kept in memory for this cycle, see RS_Undo::retainedBytes()
+    std::size_t retainedBytes = 0;
 };
 
 #endif
@@ -0,0 +1,192 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD (librecad.org)
+**
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+#include <memory>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "lc_undospillstore.h"
+#include "rs_arc.h"
+#include "rs_circle.h"
+#include "rs_ellipse.h"
+#include "rs_graphic.h"
+#include "rs_insert.h"
+#include "rs_layer.h"
+#include "rs_line.h"
+#include "rs_point.h"
+#include "rs_polyline.h"
+#include "rs_settings.h"
+#include "rs_solid.h"
+
+namespace {
+void addPoint(std::vector<double>& coordinates, const RS_Vector& v) {
+    coordinates.push_back(v.x);
+    coordinates.push_back(v.y);
+}
+
+// reference points and borders of the entity and its children
+std::vector<double> coordinates(const RS_Entity& entity) {
+    std::vector<double> result;
+    const RS_VectorSolutions refPoints = entity.getRefPoints();
+    for (size_t i = 0; i < refPoints.size(); i++) {
+        addPoint(result, refPoints.get(i));
+    }
+    addPoint(result, entity.getMin());
+    addPoint(result, entity.getMax());
+    if (entity.isContainer()) {
+        static_cast<const RS_EntityContainer&>(entity).visitEntities([&result](const RS_Entity* child) {
+            std::vector<double> childCoordinates = coordinates(*child);
+            result.insert(result.end(), childCoordinates.cbegin(), childCoordinates.cend());
+            return true;
+        });
+    }
+    return result;
+}
+
+void requireSameAttributes(const RS_Entity& restored, const RS_Entity& original) {
+    REQUIRE(restored.rtti() == original.rtti());
+    REQUIRE(restored.getFlags() == original.getFlags());
+    REQUIRE(restored.getLayer(false) == original.getLayer(false));
+    const RS_Pen pen = original.getPen(false);
+    REQUIRE(restored.getPen(false).isSameAs(pen, pen.dashOffset()));
+    REQUIRE(restored.getPen(false).getColor().getFlags() == pen.getColor().getFlags());
+    REQUIRE(restored.getAllKeys() == original.getAllKeys());
+    for (const QString& key: original.getAllKeys()) {
+        REQUIRE(restored.getUserDefVar(key) == original.getUserDefVar(key));
+    }
+}
+}
+
+TEST_CASE("LC_UndoSpillStore::spill and restore") {
+    // graphics read their defaults from the settings
+    if (RS_Settings::instance() == nullptr) {
+        RS_Settings::init("LibreCAD", "LibreCAD_tests");
+    }
+    RS_Graphic graphic;
+    auto* walls = new RS_Layer("walls");
+    graphic.addLayer(walls);
+
+    std::vector<std::unique_ptr<RS_Entity>> entities;
+    entities.push_back(std::make_unique<RS_Line>(&graphic, RS_LineData{{0.1, 0.7}, {13.3, -2.9}}));
+    entities.push_back(std::make_unique<RS_Arc>(&graphic, RS_ArcData{{1.3, 2.1}, 3.7, 0.3, 2.9, false}));
+    entities.push_back(std::make_unique<RS_Circle>(&graphic, RS_CircleData{{-4.4, 0.9}, 1.1}));
+    entities.push_back(std::make_unique<RS_Ellipse>(&graphic, RS_EllipseData{{2.5, -1.5}, {3.1, 0.7}, 0.35,
+                                                                              0.2, 4.1, false}));
+    entities.push_back(std::make_unique<RS_Point>(&graphic, RS_PointData{{7.7, 3.3}}));
+    entities.push_back(std::make_unique<RS_Solid>(&graphic, RS_SolidData{{0.1, 0.2}, {5.3, 0.4}, {2.9, 4.7}}));
+    entities.push_back(std::make_unique<RS_Insert>(&graphic, RS_InsertData{"door", {1.1, 2.2}, {1.5, 1.5}, 0.4,
+                                                                            1, 1, {0., 0.}, nullptr, RS2::NoUpdate}));
+    auto segmented = std::make_unique<RS_Polyline>(&graphic, RS_PolylineData{RS_Vector{}, RS_Vector{}, true});
+    segmented->addVertex({0.3, 0.1}, 0.);
+    segmented->addVertex({10.7, 0.3}, 0.5);
+    segmented->addVertex({9.9, 10.1}, -0.3);
+    entities.push_back(std::move(segmented));
+    auto compact = std::make_unique<RS_Polyline>(&graphic, RS_PolylineData{RS_Vector{}, RS_Vector{}, false});
+    compact->appendVertexs({{{0.3, 0.1}, 0.}, {{4.7, 1.3}, 0.7}, {{8.1, -2.9}, 0.}});
+    entities.push_back(std::move(compact));
+
+    std::vector<RS_Entity*> spilled;
+    std::vector<LC_UndoSpillStore::Place> places;
+    for (const auto& e: entities) {
+        // borders of transformed entities aren't calculated again
+        e->rotate({0.3, -1.7}, 0.7);
+        e->scale({2.2, 1.1}, {1.3, 1.3});
+        e->move({0.1, 0.2});
+        e->setLayer(walls);
+        RS_Pen pen{RS_Color(12, 34, 56), RS2::Width25, RS2::DashLine};
+        pen.setAlpha(0.5f);
+        pen.setDashOffset(1.75);
+        e->setPen(pen);
+        e->setFlag(RS2::FlagUndone);
+        e->setUserDefVar("owner", "spill");
+        REQUIRE(LC_UndoSpillStore::isSpillable(*e));
+        spilled.push_back(e.get());
+        places.push_back({e->getId() + 1, static_cast<int>(places.size()) * 3});
+    }
+    // an entity by layer, without a layer
+    entities.front()->setPen(RS_Pen{RS_Color(RS2::FlagByLayer), RS2::WidthByLayer, RS2::LineByLayer});
+    entities.front()->setLayer(static_cast<RS_Layer*>(nullptr));
+
+    LC_UndoSpillStore store;
+    const int id = store.spill(spilled, places);
+    REQUIRE(id >= 0);
+
+    std::vector<LC_UndoSpillStore::Place> restoredPlaces;
+    std::vector<RS_Entity*> restored = store.restore(graphic, id, restoredPlaces);
+    REQUIRE(restored.size() == entities.size());
+    REQUIRE(restoredPlaces.size() == places.size());
+    for (size_t i = 0; i < places.size(); i++) {
+        REQUIRE(restoredPlaces[i].previousId == places[i].previousId);
+        REQUIRE(restoredPlaces[i].position == places[i].position);
+    }
+    std::vector<std::unique_ptr<RS_Entity>> owned(restored.cbegin(), restored.cend());
+    for (size_t i = 0; i < entities.size(); i++) {
+        const RS_Entity* entity = restored[i];
+        requireSameAttributes(*entity, *entities[i]);
+        // places of other entities refer to the id
+        REQUIRE(entity->getId() == entities[i]->getId());
+        // coordinates are bit-identical
+        REQUIRE(coordinates(*entity) == coordinates(*entities[i]));
+        REQUIRE(entity->getParent() == &graphic);
+        if (entity->isContainer()) {
+            const auto& original = static_cast<const RS_EntityContainer&>(*entities[i]);
+            const auto& container = static_cast<const RS_EntityContainer&>(*entity);
+            REQUIRE(container.hasDeferredEntities() == original.hasDeferredEntities());
+            REQUIRE(container.count() == original.count());
+            std::vector<std::unique_ptr<RS_Entity>> children;
+            std::vector<std::unique_ptr<RS_Entity>> originalChildren;
+            container.visitEntities([&children](RS_Entity* child) {
+                children.emplace_back(child->clone());
+                return true;
+            });
+            original.visitEntities([&originalChildren](RS_Entity* child) {
+                originalChildren.emplace_back(child->clone());
+                return true;
+            });
+            REQUIRE(children.size() == original.count());
+            for (size_t j = 0; j < children.size(); j++) {
+                requireSameAttributes(*children[j], *originalChildren[j]);
+            }
+        }
+    }
+    REQUIRE(static_cast<const RS_Insert*>(restored[6])->getName() == "door");
+
+    // files are read once
+    REQUIRE(store.restore(graphic, id, restoredPlaces).empty());
+}
+
+TEST_CASE("LC_UndoSpillStore::discard") {
+    if (RS_Settings::instance() == nullptr) {
+        RS_Settings::init("LibreCAD", "LibreCAD_tests");
+    }
+    RS_Graphic graphic;
+    RS_Line line{&graphic, {{0., 0.}, {1., 1.}}};
+    LC_UndoSpillStore store;
+    const int id = store.spill({&line}, {{0, 0}});
+    REQUIRE(id >= 0);
+    store.discard(id);
+    std::vector<LC_UndoSpillStore::Place> places;
+    REQUIRE(store.restore(graphic, id, places).empty());
+}
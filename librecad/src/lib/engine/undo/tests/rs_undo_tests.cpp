@@ -0,0 +1,132 @@
+/****************************************************************************
+**
+** This file is part of the LibreCAD project, a 2D CAD program
+**
+** Copyright (C) 2025 LibreCAD (librecad.org)
+**
+**
+** This program is free software; you can redistribute it and/or
+** modify it under the terms of the GNU General Public License
+** as published by the Free Software Foundation; either version 2
+** of the License, or (at your option) any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+**
+** This copyright notice MUST APPEAR in all copies of the script!
+**
+**********************************************************************/
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "rs_undo.h"
+#include "rs_undoable.h"
+#include "rs_undocycle.h"
+
+namespace {
+struct TestUndoable: RS_Undoable {
+    void undoStateChanged([[maybe_unused]] bool undone) override {}
+};
+
+// keeps spilled undoables in memory, storages may be made unreadable or fail
+class TestUndo: public RS_Undo {
+public:
+    RS_Undoable* addRemovedUndoable() {
+        m_undoables.push_back(std::make_unique<TestUndoable>());
+        RS_Undoable* undoable = m_undoables.back().get();
+        undoable->changeUndoState();
+        startUndoCycle();
+        addUndoable(undoable);
+        endUndoCycle();
+        return undoable;
+    }
+
+    void removeUndoable([[maybe_unused]] RS_Undoable* u) override {}
+
+    bool failSpilling = false;
+    std::set<int> unreadable;
+    std::size_t lostCycles = 0;
+
+protected:
+    std::size_t retainedBytes(const RS_UndoCycle& cycle) const override {
+        std::size_t bytes = 0;
+        for (const RS_Undoable* undoable: cycle.getUndoables()) {
+            bytes += undoable->isUndone() ? 1 : 0;
+        }
+        return bytes;
+    }
+    void selectSpillable([[maybe_unused]] const std::vector<const RS_UndoCycle*>& cycles,
+                         [[maybe_unused]] std::vector<RS_Undoable*>& undoables) const override {}
+    int spillUndoables(const std::vector<RS_Undoable*>& undoables) override {
+        if (failSpilling) {
+            return -1;
+        }
+        m_storages.push_back(undoables);
+        return static_cast<int>(m_storages.size()) - 1;
+    }
+    std::vector<RS_Undoable*> restoreUndoables(int storage) override {
+        if (unreadable.count(storage) > 0) {
+            return {};
+        }
+        return m_storages.at(storage);
+    }
+    void undoCyclesLost(std::size_t count) override {
+        lostCycles += count;
+    }
+
+private:
+    std::vector<std::unique_ptr<RS_Undoable>> m_undoables;
+    std::vector<std::vector<RS_Undoable*>> m_storages;
+};
+}
+
+TEST_CASE("RS_Undo::spilling is retried after a failure") {
+    TestUndo undo;
+    undo.setUndoMemoryBudget(1);
+    undo.failSpilling = true;
+    undo.addRemovedUndoable();
+    undo.addRemovedUndoable();
+    REQUIRE(undo.getUndoMemoryUsage() == 2);
+
+    undo.failSpilling = false;
+    undo.addRemovedUndoable();
+    // only the latest cycle is kept in memory
+    REQUIRE(undo.getUndoMemoryUsage() == 1);
+}
+
+TEST_CASE("RS_Undo::unreadable spilled cycles are removed alone") {
+    TestUndo undo;
+    undo.setUndoMemoryBudget(1);
+    std::vector<RS_Undoable*> undoables;
+    for (int i = 0; i < 4; i++) {
+        undoables.push_back(undo.addRemovedUndoable());
+    }
+    // each of the first three cycles is spilled to its own storage
+    undo.unreadable.insert(1);
+
+    REQUIRE(undo.undo());
+    REQUIRE(undo.undo());
+    REQUIRE_FALSE(undoables[2]->isUndone());
+    REQUIRE_FALSE(undo.undo());
+    REQUIRE(undo.lostCycles == 1);
+    REQUIRE(undo.countUndoCycles() == 1);
+    REQUIRE(undo.countRedoCycles() == 2);
+
+    // the cycle before the lost one is still undone
+    REQUIRE(undo.undo());
+    REQUIRE_FALSE(undoables[0]->isUndone());
+    REQUIRE(undo.countUndoCycles() == 0);
+    for (int i = 0; i < 3; i++) {
+        REQUIRE(undo.redo());
+    }
+    REQUIRE(undoables[3]->isUndone());
+}
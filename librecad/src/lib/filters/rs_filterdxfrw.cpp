@@ -172,6 +172,7 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, [[maybe_unus
     m_graphic = &g;
     m_currentContainer = m_graphic;
     m_dummyContainer = new RS_EntityContainer(nullptr, true);
+    m_resolvedAttributes.clear();
 
     this->m_file = file;
     // add some variables that need to be there for DXF drawings:
@@ -238,6 +239,7 @@ bool RS_FilterDXFRW::fileImport(RS_Graphic& g, const QString& file, [[maybe_unus
 #endif
 
     delete m_dummyContainer;
+    m_resolvedAttributes.clear();
     /*set current layer */
     auto cl = m_graphic->findLayer(m_graphic->getVariableString("$CLAYER", "0"));
 	if (cl ){
@@ -3718,15 +3720,29 @@ void RS_FilterDXFRW::writeArc(RS_Arc* a) {
  * Writes the given polyline entity to the file as lwpolyline.
  */
 void RS_FilterDXFRW::writeLWPolyline(RS_Polyline* l) {
-    //skip if are empty polyline
-    if (l->isEmpty()) {
-        return;
-    }
     // version 12 are old style polyline
     if (m_version == 1009) {
         writePolyline(l);
         return;
     }
+    // compact polylines are written from their vertices, without creating segments
+    if (l->hasDeferredEntities()) {
+        DRW_LWPolyline pol;
+        for (const RS_Polyline::Vertex& v: l->getVertices()) {
+            pol.addVertex(DRW_Vertex2D(v.x, v.y, v.bulge));
+        }
+        if (l->isClosed()) {
+            pol.flags = 1;
+        }
+        pol.vertexnum = pol.vertlist.size();
+        getEntityAttributes(&pol, l);
+        m_dxfW->writeLWPolyline(&pol);
+        return;
+    }
+    //skip if are empty polyline
+    if (l->isEmpty()) {
+        return;
+    }
     bool has_ellipse = false;
     for (RS_Entity* e=l->firstEntity(RS2::ResolveNone); e; e=l->nextEntity(RS2::ResolveNone)) {
         if (e->rtti() == RS2::EntityEllipse) {
@@ -3790,6 +3806,15 @@ void RS_FilterDXFRW::writePolyline(RS_Polyline* p) {
         pol.flags = 1;
     }
 
+    if (p->hasDeferredEntities()) {
+        for (const RS_Polyline::Vertex& v: p->getVertices()) {
+            pol.addVertex(DRW_Vertex(v.x, v.y, 0.0, v.bulge));
+        }
+        getEntityAttributes(&pol, p);
+        m_dxfW->writePolyline(&pol);
+        return;
+    }
+
     RS_Entity* nextEntity = nullptr;
     for (RS_Entity* e=p->firstEntity(RS2::ResolveNone); e != nullptr; e=nextEntity) {
         nextEntity = p->nextEntity(RS2::ResolveNone);
@@ -4613,37 +4638,62 @@ void RS_FilterDXFRW::setEntityAttributes(RS_Entity* entity,
                                        const DRW_Entity* attrib) {
     RS_DEBUG->print("RS_FilterDXF::setEntityAttributes");
 
-    RS_Pen pen;
-    pen.setColor(Qt::black);
-    pen.setLineType(RS2::SolidLine);
-    QString layName = toNativeString(QString::fromUtf8(attrib->layer.c_str()));
+    AttributesKey key{attrib->layer, attrib->lineType, attrib->color, attrib->color24, attrib->lWeight};
+    auto it = m_resolvedAttributes.find(key);
+    if (it == m_resolvedAttributes.end()) {
+        ResolvedAttributes resolved;
+        QString layName = toNativeString(QString::fromUtf8(attrib->layer.c_str()));
+
+        // Layer: add layer in case it doesn't exist:
+        if (!m_graphic->findLayer(layName)) {
+            DRW_Layer lay;
+            lay.name = attrib->layer;
+            addLayer(lay);
+        }
+        // layers are updated in place by later definitions, so the pointer stays valid during import
+        resolved.layer = m_graphic->findLayer(layName);
+
+        RS_Pen& pen = resolved.pen;
+        // Color:
+        if (attrib->color24 >= 0) {
+            pen.setColor(RS_Color(attrib->color24 >> 16,
+                                  attrib->color24 >> 8 & 0xFF,
+                                  attrib->color24 & 0xFF));
+        }
+        else {
+            pen.setColor(numberToColor(attrib->color));
+        }
 
-    // Layer: add layer in case it doesn't exist:
-    if (!m_graphic->findLayer(layName)) {
-        DRW_Layer lay;
-        lay.name = attrib->layer;
-        addLayer(lay);
-    }
-    entity->setLayer(layName);
+        // Linetype:
+        pen.setLineType(nameToLineType( QString::fromUtf8(attrib->lineType.c_str()) ));
 
-    // Color:
-    if (attrib->color24 >= 0) {
-        pen.setColor(RS_Color(attrib->color24 >> 16,
-                              attrib->color24 >> 8 & 0xFF,
-                              attrib->color24 & 0xFF));
-    }
-    else {
-        pen.setColor(numberToColor(attrib->color));
+        // Width:
+        pen.setWidth(numberToWidth(attrib->lWeight));
+
+        it = m_resolvedAttributes.emplace(std::move(key), resolved).first;
     }
 
-    // Linetype:
-    pen.setLineType(nameToLineType( QString::fromUtf8(attrib->lineType.c_str()) ));
+    // orphan entities are not in the graphic, they get no layer
+    entity->setLayer(entity->getGraphic() != nullptr ? it->second.layer : nullptr);
+    entity->setPen(it->second.pen);
+    RS_DEBUG->print("RS_FilterDXF::setEntityAttributes: OK");
+}
 
-    // Width:
-    pen.setWidth(numberToWidth(attrib->lWeight));
+bool RS_FilterDXFRW::AttributesKey::operator == (const AttributesKey& other) const {
+    return color == other.color && color24 == other.color24 && lWeight == other.lWeight
+           && layer == other.layer && lineType == other.lineType;
+}
 
-    entity->setPen(pen);
-    RS_DEBUG->print("RS_FilterDXF::setEntityAttributes: OK");
+size_t RS_FilterDXFRW::AttributesKeyHash::operator()(const AttributesKey& key) const {
+    size_t seed = std::hash<std::string>{}(key.layer);
+    auto combine = [&seed](size_t h) {
+        seed ^= h + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    };
+    combine(std::hash<std::string>{}(key.lineType));
+    combine(std::hash<int>{}(key.color));
+    combine(std::hash<int>{}(key.color24));
+    combine(std::hash<int>{}(key.lWeight));
+    return seed;
 }
 
 /**
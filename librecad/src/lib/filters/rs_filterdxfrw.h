@@ -27,15 +27,20 @@
 #ifndef RS_FILTERDXFRW_H
 #define RS_FILTERDXFRW_H
 
+#include <string>
+#include <unordered_map>
+
 #include "rs_filterinterface.h"
 
 #include "rs_color.h"
 #include "rs_dimension.h"
+#include "rs_pen.h"
 #include "drw_interface.h"
 #include "lc_extentitydata.h"
 #include "libdxfrw.h"
 
 class LC_DimStyle;
+class RS_Layer;
 class LC_Hyperbola;
 class RS_Point;
 class RS_Line;
@@ -235,6 +240,24 @@ protected:
     QString toHexStr(int n);
     void addDimStyleOverrideToExtendedData(LC_ExtEntityData* extEntityData, LC_DimStyle* styleOverride);
 private:
+    /** Raw attributes of an imported entity, see setEntityAttributes() */
+    struct AttributesKey {
+        std::string layer;
+        std::string lineType;
+        int color = 0;
+        int color24 = -1;
+        int lWeight = 0;
+        bool operator == (const AttributesKey& other) const;
+    };
+    struct AttributesKeyHash {
+        size_t operator()(const AttributesKey& key) const;
+    };
+    /** Layer and pen the raw attributes are resolved to */
+    struct ResolvedAttributes {
+        RS_Layer* layer = nullptr;
+        RS_Pen pen;
+    };
+
     void prepareBlocks();
     void writeEntity(RS_Entity* e);
 #ifdef DWGSUPPORT
@@ -275,6 +298,8 @@ private:
     QHash<int, RS_EntityContainer*> m_blockHash;
     /** Pointer to entity container to store possible orphan entities like paper space */
     RS_EntityContainer* m_dummyContainer = nullptr;
+    /** attributes of entities resolved during import, entities mostly share a few sets of attributes */
+    std::unordered_map<AttributesKey, ResolvedAttributes, AttributesKeyHash> m_resolvedAttributes;
     void applyParsedDimStyleExtData(LC_DimStyle* dimStyle, const QString& appName, const std::vector<DRW_Variant>& vector);
     LC_DimStyle *createDimStyle(const DRW_Dimstyle &s);
     void addPolylineSegment(RS_Polyline& polyline, RS_Vector prev_pos, RS_Vector curr_pos, double bulge, const std::vector<std::shared_ptr<DRW_Variant>>& extData, bool isClosedSegment);
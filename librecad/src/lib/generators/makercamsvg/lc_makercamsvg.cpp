@@ -220,14 +220,11 @@ void LC_MakerCamSVG::writeEntities(RS_Document* document, RS_Layer* layer) {
 
     RS_DEBUG->print("RS_MakerCamSVG::writeEntities: Writing entities from layer ...");
 
-	for (auto e: *document) {
+    for (auto e: document->getEntitiesOnLayer(layer)) {
 
-        if (e->getLayer() == layer) {
+        if (!(e->getFlag(RS2::FlagUndone))) {
 
-            if (!(e->getFlag(RS2::FlagUndone))) {
-
-                writeEntity(e);
-            }
+            writeEntity(e);
         }
     }
 }
@@ -49,7 +49,7 @@ void LC_PrintViewportRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
     isVisibleTimer.start();
 #endif
     // entity is not visible:
-    bool visible = e->isVisible();
+    bool visible = isEntityVisible(painter, e);
 #ifdef DEBUG_RENDERING
     isVisibleTime += isVisibleTimer.nsecsElapsed();
 #endif
@@ -60,15 +60,15 @@ void LC_PrintViewportRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
 #ifdef DEBUG_RENDERING
     isConstructionTimer.start();
 #endif
-    bool constructionEntity = e->isConstruction();
+    bool constructionEntity = isEntityConstruction(painter, e);
 #ifdef DEBUG_RENDERING
     isConstructionTime += isConstructionTimer.nsecsElapsed();
 #endif
     // do not draw construction layer on print preview or print
-    if (!e->isPrint() || constructionEntity)
+    if (!isEntityPrint(painter, e) || constructionEntity)
         return;
 
-    if (isOutsideOfBoundingClipRect(e, constructionEntity)) {
+    if (isOutsideOfBoundingClipRect(painter, e, constructionEntity)) {
         return;
     }
     setPenForPrintingEntity(painter, e);
@@ -80,7 +80,7 @@ void LC_PrintViewportRenderer::setPenForPrintingEntity(RS_Painter *painter, RS_E
     setPenTimer.start();
 #endif
     // Getting pen from entity (or layer)
-    RS_Pen pen = e->getPenResolved();
+    RS_Pen pen = getEntityPen(painter, e);
     RS_Pen originalPen = pen;
 
     double patternOffset = painter->currentDashOffset();
@@ -108,7 +108,7 @@ void LC_PrintViewportRenderer::setPenForPrintingEntity(RS_Painter *painter, RS_E
                     wf = 1.0 / paperScale;
                 }
             }
-            double screenWidth = painter->toGuiDX(width * unitFactor100 * wf);
+            double screenWidth = painter->toGuiLineWidth(width * unitFactor100 * wf);
 
             /*// prevent drawing with 1-width which is slow:
             if (RS_Math::round(pen.getScreenWidth()) == 1) {
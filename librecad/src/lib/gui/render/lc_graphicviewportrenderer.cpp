@@ -27,6 +27,7 @@
 #include "lc_linemath.h"
 #include "rs_entity.h"
 #include "rs_graphic.h"
+#include "rs_insert.h"
 #include "rs_painter.h"
 #include "rs_units.h"
 
@@ -62,10 +63,15 @@ void LC_GraphicViewportRenderer::loadSettings() {
 }
 
 LC_Rect LC_GraphicViewportRenderer::prepareBoundingClipRect(){
-    int width = viewport->getWidth();
-    int height = viewport->getHeight();
-    const RS_Vector ucsViewportLeftBottom = viewport->toUCSFromGui(0, 0);
-    const RS_Vector ucsViewportRightTop = viewport->toUCSFromGui(width, height);
+    return prepareBoundingClipRect(0, 0, viewport->getWidth(), viewport->getHeight());
+}
+
+/**
+ * Bounding rect in world coordinates for the given rect in gui coordinates
+ */
+LC_Rect LC_GraphicViewportRenderer::prepareBoundingClipRect(double uiLeft, double uiTop, double uiRight, double uiBottom) const{
+    const RS_Vector ucsViewportLeftBottom = viewport->toUCSFromGui(uiLeft, uiTop);
+    const RS_Vector ucsViewportRightTop = viewport->toUCSFromGui(uiRight, uiBottom);
 
     if (viewport->hasUCS()){
         // here were extend (enlarge) clipping rect to ensure that if there is shift/rotation in ucs, resulting bounding box cover the entire screen
@@ -84,34 +90,70 @@ LC_Rect LC_GraphicViewportRenderer::prepareBoundingClipRect(){
     }
 }
 
-bool LC_GraphicViewportRenderer::isOutsideOfBoundingClipRect(RS_Entity* e, bool constructionEntity){
+bool LC_GraphicViewportRenderer::isOutsideOfBoundingClipRect(RS_Painter *painter, RS_Entity* e, bool constructionEntity){
+    // clip rect of the painter is in coordinates of the block for instances of blocks
+    const LC_Rect &clipRect = painter->getWcsBoundingRect();
     // test if the entity is in the viewport
     switch (e->rtti()){
         /* case RS2::EntityGraphic:
              break;*/
         case RS2::EntityLine:{
             if (constructionEntity){
-                if (!LC_LineMath::hasIntersectionLineRect(e->getMin(), e->getMax(), renderBoundingClipRect.minP(), renderBoundingClipRect.maxP())){
+                if (!LC_LineMath::hasIntersectionLineRect(e->getMin(), e->getMax(), clipRect.minP(), clipRect.maxP())){
                     return true;
                 }
             }
             else{ // normal line
-                if (e->getMax().x < renderBoundingClipRect.minP().x || e->getMin().x > renderBoundingClipRect.maxP().x ||
-                    e->getMin().y > renderBoundingClipRect.maxP().y || e->getMax().y < renderBoundingClipRect.minP().y){
+                if (e->getMax().x < clipRect.minP().x || e->getMin().x > clipRect.maxP().x ||
+                    e->getMin().y > clipRect.maxP().y || e->getMax().y < clipRect.minP().y){
                     return true;
                 }
             }
             break;
         }
         default:
-            if (e->getMax().x < renderBoundingClipRect.minP().x || e->getMin().x > renderBoundingClipRect.maxP().x ||
-                e->getMin().y > renderBoundingClipRect.maxP().y || e->getMax().y < renderBoundingClipRect.minP().y){
+            if (e->getMax().x < clipRect.minP().x || e->getMin().x > clipRect.maxP().x ||
+                e->getMin().y > clipRect.maxP().y || e->getMax().y < clipRect.minP().y){
                 return true;
             }
     }
+    m_renderStatistics.drawn++;
     return false;
 }
 
+RS_Pen LC_GraphicViewportRenderer::getEntityPen(RS_Painter *painter, RS_Entity *e) const{
+    const RS_Painter::BlockInstance* instance = painter->getBlockInstance();
+    if (instance == nullptr || instance->ownAttributes){
+        return e->getPenResolved();
+    }
+    return RS_Insert::getInstancePen(e, instance->pen, instance->layer);
+}
+
+bool LC_GraphicViewportRenderer::isEntitySelected(RS_Painter *painter, RS_Entity *e) const{
+    const RS_Painter::BlockInstance* instance = painter->getBlockInstance();
+    return instance == nullptr ? e->getFlag(RS2::FlagSelected) : instance->selected;
+}
+
+bool LC_GraphicViewportRenderer::isEntityHighlighted(RS_Painter *painter, RS_Entity *e) const{
+    const RS_Painter::BlockInstance* instance = painter->getBlockInstance();
+    return instance == nullptr ? e->getFlag(RS2::FlagHighlighted) : instance->highlighted;
+}
+
+bool LC_GraphicViewportRenderer::isEntityVisible(RS_Painter *painter, RS_Entity *e) const{
+    const RS_Painter::BlockInstance* instance = painter->getBlockInstance();
+    return instance == nullptr || instance->ownAttributes ? e->isVisible() : RS_Insert::isInstanceVisible(e, instance->layer);
+}
+
+bool LC_GraphicViewportRenderer::isEntityConstruction(RS_Painter *painter, RS_Entity *e) const{
+    const RS_Painter::BlockInstance* instance = painter->getBlockInstance();
+    return instance == nullptr || instance->ownAttributes ? e->isConstruction() : RS_Insert::isInstanceConstruction(e, instance->layer);
+}
+
+bool LC_GraphicViewportRenderer::isEntityPrint(RS_Painter *painter, RS_Entity *e) const{
+    const RS_Painter::BlockInstance* instance = painter->getBlockInstance();
+    return instance == nullptr || instance->ownAttributes ? e->isPrint() : RS_Insert::isInstancePrint(e, instance->layer);
+}
+
 /**
  * Draws an entity.
  * The painter must be initialized and all the attributes (pen) must be set.
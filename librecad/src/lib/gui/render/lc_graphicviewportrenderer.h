@@ -43,6 +43,15 @@ class QPaintDevice;
 
 class LC_GraphicViewportRenderer{
   public:
+    /**
+     * Counters of the last entities pass: entities handed to the renderer by the container
+     * (including both normal and selected passes) and entities that passed the clip rect test.
+     */
+    struct RenderStatistics {
+        int visited = 0;
+        int drawn = 0;
+    };
+
     explicit LC_GraphicViewportRenderer(LC_GraphicViewport* viewport, QPaintDevice* painterDevice);
     virtual ~LC_GraphicViewportRenderer() = default;
     virtual void loadSettings();
@@ -52,6 +61,7 @@ class LC_GraphicViewportRenderer{
     void justDrawEntity(RS_Painter *painter, RS_Entity *e);
     void setBackground(const RS_Color &bg);
     const LC_Rect &getBoundingClipRect() const {return renderBoundingClipRect;}
+    const RenderStatistics &getRenderStatistics() const {return m_renderStatistics;}
 
     virtual bool isTextLineNotRenderable(double uiLineHeight) const = 0;
 
@@ -68,6 +78,7 @@ protected:
     RS_Graphic* graphic = nullptr;
 
     LC_Rect renderBoundingClipRect;
+    RenderStatistics m_renderStatistics;
 
     /** background color (any color) */
     RS_Color m_colorBackground;
@@ -77,6 +88,7 @@ protected:
     RS_Pen lastPaintEntityPen = {};
 
     LC_Rect prepareBoundingClipRect();
+    LC_Rect prepareBoundingClipRect(double uiLeft, double uiTop, double uiRight, double uiBottom) const;
     virtual void doRender() = 0;
 
     // painting cached values
@@ -102,7 +114,18 @@ protected:
     void updateJoinStyle(const RS_Graphic *graphic);
     void updatePointEntitiesStyle(RS_Graphic *graphic);
     void updateUnitAndDefaultWidthFactors(const RS_Graphic *g);
-    bool isOutsideOfBoundingClipRect(RS_Entity *e, bool constructionEntity);
+    bool isOutsideOfBoundingClipRect(RS_Painter *painter, RS_Entity *e, bool constructionEntity);
+
+    /**
+     * Attributes of the entity to draw. Entities of blocks drawn as instances of inserts
+     * take them from the insert, see RS_Painter::beginBlockInstance().
+     */
+    RS_Pen getEntityPen(RS_Painter *painter, RS_Entity *e) const;
+    bool isEntitySelected(RS_Painter *painter, RS_Entity *e) const;
+    bool isEntityHighlighted(RS_Painter *painter, RS_Entity *e) const;
+    bool isEntityVisible(RS_Painter *painter, RS_Entity *e) const;
+    bool isEntityConstruction(RS_Painter *painter, RS_Entity *e) const;
+    bool isEntityPrint(RS_Painter *painter, RS_Entity *e) const;
 
     RS_Graphic* getGraphic(){return graphic;}
 
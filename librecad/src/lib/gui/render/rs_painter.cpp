@@ -791,8 +791,9 @@ void RS_Painter::drawEllipseArcUI(const RS_Vector& uiCenter, const RS_Vector& ui
 
 void RS_Painter::addEllipseArcToPath(QPainterPath& localPath, const RS_Vector& uiRadii, double startAngleDeg, double angularLengthDeg, bool useSpline) {
     if (useSpline) {
-        double startRad = RS_Math::deg2rad(toUCSAngleDegrees(startAngleDeg));
-        double lenRad = RS_Math::deg2rad(toUCSAngleDegrees(angularLengthDeg));
+        // angles are relative to the major axis, which is already rotated
+        double startRad = RS_Math::deg2rad(startAngleDeg);
+        double lenRad = RS_Math::deg2rad(angularLengthDeg);
         drawEllipseSegmentBySplinePointsUI(uiRadii, startRad, lenRad, localPath, false);
     } else {
         QRectF rect(-uiRadii.x, -uiRadii.y, 2 * uiRadii.x, 2 * uiRadii.y);
@@ -1061,7 +1062,8 @@ void RS_Painter::drawEntityPolyline(const RS_Polyline* polyline){
     QPainterPath path;
     path.moveTo(toGuiPointF(polyline->getStartpoint()));
 
-    for(RS_Entity* entity: *polyline) {
+    // segments of compact polylines are not created for drawing
+    polyline->visitSegments([this, &path](RS_Entity* entity) {
         switch(entity->rtti()) {
             case RS2::EntityLine: {
                 path.moveTo(toGuiPointF(entity->getStartpoint()));
@@ -1084,18 +1086,18 @@ void RS_Painter::drawEntityPolyline(const RS_Polyline* polyline){
                 const double uiMajorRadius = toGuiDX(data.majorP.magnitude()); // fixme - sand - render - cache?
                 const double uiMinorRadius = data.ratio * uiMajorRadius;
                 if (data.isArc) {
-                    drawEllipseArcUI(uiCenter, {uiMajorRadius, uiMinorRadius}, toWorldAngleDegrees(data.angleDegrees), /*view.toWorldAngleDegrees(*/data.startAngleDegrees/*)*/,
+                    drawEllipseArcUI(uiCenter, {uiMajorRadius, uiMinorRadius}, toUCSAngleDegrees(data.angleDegrees), /*view.toWorldAngleDegrees(*/data.startAngleDegrees/*)*/,
                                     data.angularLength, data.reversed);
                 }
                 else {
-                    drawEllipseUI(uiCenter, {uiMajorRadius, uiMinorRadius}, toWorldAngleDegrees(data.angleDegrees));
+                    drawEllipseUI(uiCenter, {uiMajorRadius, uiMinorRadius}, toUCSAngleDegrees(data.angleDegrees));
                 }
                 break;
             }
             default:
                 LC_ERR<<"Polyline may contain lines/arcs only: found rtti() ="<<entity->rtti();
         }
-    }
+    });
     QPainter::drawPath(path);
 }
 
@@ -1167,7 +1169,8 @@ void RS_Painter::drawImgUI(QImage& img, const RS_Vector& uiInsert,
     }
 
     wm->scale(factor.x, factor.y);
-    setWorldTransform(*wm);
+    // combined, so images are placed properly by painters rendering to translated devices (tiles)
+    setWorldTransform(*wm, true);
 
     drawImage(0,-img.height(), img);
 }
@@ -1510,7 +1513,8 @@ void RS_Painter::updateDashOffset(RS_Entity *e) {
 }
 
 int RS_Painter::determinePointScreenSize(double pdsize) const{
-    int deviceHeight = getHeight();
+    // size relative to the viewport, as the device may be a part of it only
+    int deviceHeight = static_cast<int>(viewPortHeight);
     if (!std::isnormal(pdsize)){
         int screenPointSize = deviceHeight / 20;
         return screenPointSize;
@@ -1530,7 +1534,7 @@ void RS_Painter::updatePointsScreenSize(double pdSize) {
 }
 
 void RS_Painter::drawInfiniteWCS(RS_Vector startpoint, RS_Vector endpoint) {
-    const LC_Rect viewportRect = renderer->getBoundingClipRect();
+    const LC_Rect viewportRect = wcsBoundingRect;
     RS_Vector start(false);
 
     double offsetX = toGuiDX(0.25); // todo - check why gui coordinates are used there -  while intersection is with WCS coordinates?
@@ -1598,6 +1602,55 @@ void RS_Painter::setViewPort(LC_GraphicViewport *v) {
     viewPortOffsetY = v->getOffsetY();
     m_viewPortOffset.set(viewPortOffsetX, viewPortOffsetY);
     viewPortHeight = v->getHeight();
+    m_lineWidthFactor = m_viewPortFactor.x;
+}
+
+/*
+ * An entity of the block is drawn by the insert at
+ *    wcs = insertionPoint + R(angle) * scale * (p - basePoint),
+ * so its ucs coordinates are
+ *    ucs = R(xAxisAngle) * (insertionPoint - ucsOrigin) + scale * R(xAxisAngle + angle) * (p - basePoint).
+ * That is the same translation to gui coordinates as for the ucs placed at the base point and rotated by
+ * (xAxisAngle + angle), with the factor multiplied by the scale and the offset moved by the first term.
+ */
+void RS_Painter::beginBlockInstance(const RS_Vector& insertionPoint, double scale, double angle,
+                                    const RS_Vector& basePoint, const BlockInstance& instance) {
+    m_blockInstances.push_back({instance, m_viewPortFactor, viewPortOffsetX, viewPortOffsetY,
+                                hasUCS(), getUcsOrigin(), getXAxisAngle(), wcsBoundingRect});
+
+    RS_Vector ucsInsertionPoint = insertionPoint;
+    double ucsAngle = angle;
+    if (hasUCS()) {
+        ucsInsertionPoint = doWCS2UCS(insertionPoint);
+        ucsAngle += getXAxisAngle();
+    }
+    viewPortOffsetX += ucsInsertionPoint.x * viewPortFactorX;
+    viewPortOffsetY += ucsInsertionPoint.y * viewPortFactorY;
+    m_viewPortOffset.set(viewPortOffsetX, viewPortOffsetY);
+    m_viewPortFactor *= scale;
+    update(basePoint, ucsAngle);
+    useUCS(true);
+
+    // clip rect in coordinates of the block
+    auto toBlock = [&](const RS_Vector& corner) {
+        return basePoint + (corner - insertionPoint).rotate(-angle) / scale;
+    };
+    const LC_Rect outerRect = wcsBoundingRect;
+    wcsBoundingRect = LC_Rect{toBlock(outerRect.minP()), toBlock(outerRect.maxP())}
+                          .merge(toBlock(outerRect.upperLeftCorner()))
+                          .merge(toBlock(outerRect.lowerRightCorner()));
+}
+
+void RS_Painter::endBlockInstance() {
+    const BlockInstanceState& state = m_blockInstances.back();
+    m_viewPortFactor = state.factor;
+    viewPortOffsetX = state.offsetX;
+    viewPortOffsetY = state.offsetY;
+    m_viewPortOffset.set(viewPortOffsetX, viewPortOffsetY);
+    update(state.ucsOrigin, state.ucsAngle);
+    useUCS(state.hasUCS);
+    wcsBoundingRect = state.boundingRect;
+    m_blockInstances.pop_back();
 }
 
 // NOTE:
@@ -1708,7 +1761,7 @@ void RS_Painter::disableUCS(){
 }
 
 bool RS_Painter::isFullyWithinBoundingRect(RS_Entity* e){
-    // we have checks LC_GraphicViewportRenderer::isOutsideOfBoundingClipRect(RS_Entity* e, bool constructionEntity)
+    // we have checks LC_GraphicViewportRenderer::isOutsideOfBoundingClipRect(RS_Painter* painter, RS_Entity* e, bool constructionEntity)
     // this check we are not outside view rect. It ensures that max coordinate of entity is larger than min coordinate of viewport (same for min coordinate).
     // Thus, we can use a shorter check - instead checking for ranges, we check that max coordinate of viewport is less than max coordinate of view
 
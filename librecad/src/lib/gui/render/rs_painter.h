@@ -28,6 +28,8 @@
 #ifndef RS_PAINTER_H
 #define RS_PAINTER_H
 
+#include <vector>
+
 #include <QPainter>
 
 #include "lc_coordinates_mapper.h"
@@ -40,6 +42,7 @@ class RS_Color;
 class RS_Ellipse;
 class RS_Entity;
 class RS_EntityContainer;
+class RS_Layer;
 class RS_Pen;
 class RS_Polyline;
 class RS_Spline;
@@ -85,6 +88,10 @@ public:
     void toGui(const RS_Vector& pos, double &x, double &y) const;
     double toGuiDX(double d) const;
     double toGuiDY(double d) const;
+    /**
+     * @return the screen width of the line of the given width, line widths are not scaled by block instances
+     */
+    double toGuiLineWidth(double d) const {return d * m_lineWidthFactor;}
     QTransform getToGuiTransform() const;
 
     bool isPrinting() const
@@ -158,6 +165,37 @@ public:
     void drawAsChild(RS_Entity* entity);
     void drawInfiniteWCS(RS_Vector start, RS_Vector end);
 
+    /**
+     * Attributes of the insert whose block is drawn as an instance, see beginBlockInstance().
+     * Entities of the block take them in the same way as copies of these entities created by the insert.
+     */
+    struct BlockInstance {
+        /** resolved pen of the insert, used for pen attributes of entities set by block */
+        RS_Pen pen;
+        /** resolved layer of the insert, used for entities on layer "0" */
+        RS_Layer* layer = nullptr;
+        bool selected = false;
+        bool highlighted = false;
+        /** entities are drawn with their own pen and layer, as for entities of the document drawn transformed
+         *  by the preview, pen and layer above are not used */
+        bool ownAttributes = false;
+    };
+
+    /**
+     * @brief beginBlockInstance - entities drawn until endBlockInstance() are entities of the block drawn for
+     *        an insert: they are moved from the base point to the insertion point, scaled by the given factor
+     *        and rotated by the given angle around the insertion point. Instances may be nested.
+     */
+    void beginBlockInstance(const RS_Vector& insertionPoint, double scale, double angle,
+                            const RS_Vector& basePoint, const BlockInstance& instance);
+    void endBlockInstance();
+    /**
+     * @return the innermost block instance which is drawn, nullptr if entities are drawn as they are
+     */
+    const BlockInstance* getBlockInstance() const {
+        return m_blockInstances.empty() ? nullptr : &m_blockInstances.back().instance;
+    }
+
     /**
      * Sets the drawing mode.
      */
@@ -421,13 +459,27 @@ protected:
     RS_Vector m_viewPortFactor{1., 1.};
     double& viewPortFactorX = m_viewPortFactor.x;
     double& viewPortFactorY = m_viewPortFactor.y;
-    int viewPortOffsetX = 0;
-    int viewPortOffsetY = 0;
+    double viewPortOffsetX = 0.;
+    double viewPortOffsetY = 0.;
     RS_Vector m_viewPortOffset;
     double viewPortHeight = 0.0;
+    double m_lineWidthFactor = 1.0;
 
     LC_Rect wcsBoundingRect;
 
+    /** block instance with the coordinates translation to restore when the instance ends */
+    struct BlockInstanceState {
+        BlockInstance instance;
+        RS_Vector factor;
+        double offsetX = 0.;
+        double offsetY = 0.;
+        bool hasUCS = false;
+        RS_Vector ucsOrigin;
+        double ucsAngle = 0.;
+        LC_Rect boundingRect;
+    };
+    std::vector<BlockInstanceState> m_blockInstances;
+
     LC_GraphicViewportRenderer* renderer = nullptr;
     LC_GraphicViewport* viewport = nullptr;
 
@@ -37,6 +37,11 @@ LC_GraphicViewRenderer::LC_GraphicViewRenderer(LC_GraphicViewport *viewport, QPa
    :LC_WidgetViewPortRenderer(viewport, p) {
 }
 
+std::unique_ptr<LC_WidgetViewPortRenderer> LC_GraphicViewRenderer::createTileRenderer() const {
+    // the copy is used for drawing of entities only, overlays are never drawn by it
+    return std::make_unique<LC_GraphicViewRenderer>(*this);
+}
+
 void LC_GraphicViewRenderer::loadSettings() {
     LC_WidgetViewPortRenderer::loadSettings();
     //increase grid point size on for DPI>96
@@ -91,14 +96,14 @@ void LC_GraphicViewRenderer::loadSettings() {
 
 void LC_GraphicViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
     // check for selected entity drawing
-    if (/*!e->isContainer() && */(e->getFlag(RS2::FlagSelected) != painter->shouldDrawSelected())) {
+    if (/*!e->isContainer() && */(isEntitySelected(painter, e) != painter->shouldDrawSelected())) {
         return;
     }
 #ifdef DEBUG_RENDERING
     isVisibleTimer.start();
 #endif
     // entity is not visible:
-    bool visible = e->isVisible();
+    bool visible = isEntityVisible(painter, e);
 #ifdef DEBUG_RENDERING
     isVisibleTime += isVisibleTimer.nsecsElapsed();
 #endif
@@ -109,12 +114,12 @@ void LC_GraphicViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
 #ifdef DEBUG_RENDERING
     isConstructionTimer.start();
 #endif
-    bool constructionEntity = e->isConstruction();
+    bool constructionEntity = isEntityConstruction(painter, e);
 #ifdef DEBUG_RENDERING
     isConstructionTime += isConstructionTimer.nsecsElapsed();
 #endif
 
-    if (isOutsideOfBoundingClipRect(e, constructionEntity)) {
+    if (isOutsideOfBoundingClipRect(painter, e, constructionEntity)) {
         return;
     }
 
@@ -184,8 +189,8 @@ void LC_GraphicViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
         }
     }
 
-    // draw reference points:
-    if (e->getFlag(RS2::FlagSelected)) {
+    // draw reference points (entities of block instances are not selected individually):
+    if (e->getFlag(RS2::FlagSelected) && painter->getBlockInstance() == nullptr) {
         if (!e->isParentSelected()) {
             drawEntityReferencePoints(painter, e);
         }
@@ -382,13 +387,13 @@ void LC_GraphicViewRenderer::setPenForEntity(RS_Painter *painter, RS_Entity *e,
     getPenTimer.start();
 #endif
     // Getting pen from entity (or layer)
-    RS_Pen pen = e->getPenResolved();
+    RS_Pen pen = getEntityPen(painter, e);
 #ifdef DEBUG_RENDERING
     getPenTime += getPenTimer.nsecsElapsed();
 #endif
     RS_Pen originalPen = pen;
-    bool highlighted = e->getFlag(RS2::FlagHighlighted);
-    bool selected = e->getFlag(RS2::FlagSelected);
+    bool highlighted = isEntityHighlighted(painter, e);
+    bool selected = isEntitySelected(painter, e);
     bool overlayPaint = inOverlay || m_inOverlayDrawing;
     // try to avoid pen setup if the pen and entity flags are the same as for previous entity. This is important for performance reasons, so we'll reuse
     // painter pen set previously. This check assumed that that all previous entity drawing were performed via this function and no
@@ -415,7 +420,7 @@ void LC_GraphicViewRenderer::setPenForEntity(RS_Painter *painter, RS_Entity *e,
         if (width>0) {
             // todo - sand - ucs - investigate were it's possible to cache calculated screen width at least during the same render pass.
             // The amount of pens widths is limited - so probably accessing precalculated width will be slightly faster
-            double screenWidth = painter->toGuiDX(width * unitFactor100);
+            double screenWidth = painter->toGuiLineWidth(width * unitFactor100);
             // prevent drawing with 1-width which is slow:
             /* if (RS_Math::round(screenWidth) == 1) {
                  screenWidth = 0.0;
@@ -495,10 +500,10 @@ void LC_GraphicViewRenderer::setPenForDraftEntity(RS_Painter *painter, RS_Entity
 #ifdef DEBUG_RENDERING
     setPenTimer.start();
 #endif
-    RS_Pen pen = e->getPenResolved();
+    RS_Pen pen = getEntityPen(painter, e);
     RS_Pen originalPen = pen;
-    bool highlighted = e->getFlag(RS2::FlagHighlighted);
-    bool selected = e->getFlag(RS2::FlagSelected);
+    bool highlighted = isEntityHighlighted(painter, e);
+    bool selected = isEntitySelected(painter, e);
     bool overlayPaint = inOverlay || m_inOverlayDrawing;
 // try to avoid pen setup if the pen and entity flags are the same as for previous entity. This is important for performance reasons, so we'll reuse
     // painter pen set previously. This check assumed that that all previous entity drawing were performed via this function and no
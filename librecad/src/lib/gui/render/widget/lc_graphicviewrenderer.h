@@ -105,6 +105,7 @@ protected:
     LC_OverlayUCSMark m_overlayUCSMark = LC_OverlayUCSMark(&m_ucsMarkOptions);
     LC_OverlayAnglesBaseMark m_overlayAnglesBaseMark = LC_OverlayAnglesBaseMark(&m_anglesBaseOptions);
 
+    std::unique_ptr<LC_WidgetViewPortRenderer> createTileRenderer() const override;
     void doDrawLayerBackground(RS_Painter *painter) override;
     void doDrawLayerOverlays(RS_Painter *painter) override;
     void drawLayerEntitiesOver(RS_Painter *painter) override;
@@ -160,14 +160,14 @@ void LC_PrintPreviewViewRenderer::drawPaper(RS_Painter *painter) {
 void LC_PrintPreviewViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e) {
     // fixme - sand - ucs - is it really necessary for print preview??????
     // check for selected entity drawing
-    if (/*!e->isContainer() && */(e->getFlag(RS2::FlagSelected) != painter->shouldDrawSelected())) {
+    if (/*!e->isContainer() && */(isEntitySelected(painter, e) != painter->shouldDrawSelected())) {
         return;
     }
 #ifdef DEBUG_RENDERING
     isVisibleTimer.start();
 #endif
     // entity is not visible:
-    bool visible = e->isVisible();
+    bool visible = isEntityVisible(painter, e);
 #ifdef DEBUG_RENDERING
     isVisibleTime += isVisibleTimer.nsecsElapsed();
 #endif
@@ -178,15 +178,15 @@ void LC_PrintPreviewViewRenderer::renderEntity(RS_Painter *painter, RS_Entity *e
 #ifdef DEBUG_RENDERING
     isConstructionTimer.start();
 #endif
-    bool constructionEntity = e->isConstruction();
+    bool constructionEntity = isEntityConstruction(painter, e);
 #ifdef DEBUG_RENDERING
     isConstructionTime += isConstructionTimer.nsecsElapsed();
 #endif
 
-    if (!e->isPrint() || constructionEntity)
+    if (!isEntityPrint(painter, e) || constructionEntity)
         return;
 
-    if (isOutsideOfBoundingClipRect(e, constructionEntity)) {
+    if (isOutsideOfBoundingClipRect(painter, e, constructionEntity)) {
         return;
     }
 
@@ -200,7 +200,7 @@ void LC_PrintPreviewViewRenderer::setPenForPrintingEntity(RS_Painter *painter, R
     setPenTimer.start();
 #endif
     // Getting pen from entity (or layer)
-    RS_Pen pen = e->getPenResolved();
+    RS_Pen pen = getEntityPen(painter, e);
     RS_Pen originalPen = pen;
 
     double patternOffset = painter->currentDashOffset();
@@ -228,7 +228,7 @@ void LC_PrintPreviewViewRenderer::setPenForPrintingEntity(RS_Painter *painter, R
                     wf = 1.0 / m_paperScale;
                 }
             }
-            double screenWidth = painter->toGuiDX(width * unitFactor100 * wf);
+            double screenWidth = painter->toGuiLineWidth(width * unitFactor100 * wf);
 
             /*// prevent drawing with 1-width which is slow:
             if (RS_Math::round(pen.getScreenWidth()) == 1) {
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+#include "lc_rendertilecache.h"
+
+#include <cmath>
+
+#include "lc_graphicviewport.h"
+
+void LC_RenderTileCache::update(const LC_GraphicViewport* viewport) {
+    const RS_Vector factor = viewport->getFactor();
+    const bool hasUCS = viewport->hasUCS();
+    const RS_Vector ucsOrigin = viewport->getUcsOrigin();
+    const double ucsAngle = viewport->getXAxisAngle();
+
+    // exact comparison is intended, any change of zoom makes tiles unusable
+    bool sameCanvas = factor.x == m_factor.x && factor.y == m_factor.y && hasUCS == m_hasUCS;
+    if (sameCanvas && hasUCS) {
+        sameCanvas = ucsOrigin.x == m_ucsOrigin.x && ucsOrigin.y == m_ucsOrigin.y && ucsAngle == m_ucsAngle;
+    }
+    if (!sameCanvas) {
+        clear();
+        m_factor = factor;
+        m_hasUCS = hasUCS;
+        m_ucsOrigin = ucsOrigin;
+        m_ucsAngle = ucsAngle;
+    }
+}
+
+void LC_RenderTileCache::clear() {
+    m_tiles.clear();
+    m_revisionKnown = false;
+}
+
+const QPixmap* LC_RenderTileCache::find(int tileX, int tileY) const {
+    auto it = m_tiles.constFind(QPoint(tileX, tileY));
+    return it == m_tiles.cend() ? nullptr : &it.value();
+}
+
+void LC_RenderTileCache::insert(int tileX, int tileY, const QPixmap& tile) {
+    m_tiles.insert(QPoint(tileX, tileY), tile);
+}
+
+void LC_RenderTileCache::invalidate(int minTileX, int minTileY, int maxTileX, int maxTileY) {
+    for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+        const QPoint& key = it.key();
+        if (key.x() >= minTileX && key.x() <= maxTileX && key.y() >= minTileY && key.y() <= maxTileY) {
+            it = m_tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void LC_RenderTileCache::trim(int minTileX, int minTileY, int maxTileX, int maxTileY) {
+    minTileX -= KEEP_MARGIN;
+    minTileY -= KEEP_MARGIN;
+    maxTileX += KEEP_MARGIN;
+    maxTileY += KEEP_MARGIN;
+    for (auto it = m_tiles.begin(); it != m_tiles.end();) {
+        const QPoint& key = it.key();
+        if (key.x() < minTileX || key.x() > maxTileX || key.y() < minTileY || key.y() > maxTileY) {
+            it = m_tiles.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void LC_RenderTileCache::setRevision(unsigned long long revision) {
+    m_revision = revision;
+    m_revisionKnown = true;
+}
+
+int LC_RenderTileCache::toTileIndex(double canvasCoordinate) {
+    return static_cast<int>(std::floor(canvasCoordinate / TILE_SIZE));
+}
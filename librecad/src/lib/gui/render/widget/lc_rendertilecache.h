@@ -0,0 +1,88 @@
+/*******************************************************************************
+ *
+ This file is part of the LibreCAD project, a 2D CAD program
+
+ Copyright (C) 2025 LibreCAD.org
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ ******************************************************************************/
+
+#ifndef LC_RENDERTILECACHE_H
+#define LC_RENDERTILECACHE_H
+
+#include <QHash>
+#include <QPixmap>
+#include <QPoint>
+
+#include "rs_vector.h"
+
+class LC_GraphicViewport;
+
+/**
+ * Cache of rendered tiles of the entities layer.
+ *
+ * Tiles are placed on a canvas bound to the drawing rather than to the widget:
+ * canvas coordinates are gui coordinates without the viewport offset, so tiles
+ * stay valid while the view is panned. The cache is bound to the state of the
+ * viewport that defines the canvas (zoom factor and UCS) and to the revision of
+ * the document the tiles were rendered for.
+ */
+class LC_RenderTileCache {
+public:
+    static constexpr int TILE_SIZE = 256;
+    /** number of tiles kept around the visible ones */
+    static constexpr int KEEP_MARGIN = 2;
+
+    /**
+     * @brief update - drops all tiles if the canvas of the viewport differs from the canvas of cached tiles
+     */
+    void update(const LC_GraphicViewport* viewport);
+    void clear();
+
+    const QPixmap* find(int tileX, int tileY) const;
+    void insert(int tileX, int tileY, const QPixmap& tile);
+    /**
+     * @brief invalidate - removes tiles within the given range of tile indices (inclusive)
+     */
+    void invalidate(int minTileX, int minTileY, int maxTileX, int maxTileY);
+    /**
+     * @brief trim - removes tiles far from the given range of visible tile indices (inclusive)
+     */
+    void trim(int minTileX, int minTileY, int maxTileX, int maxTileY);
+
+    bool isEmpty() const {return m_tiles.isEmpty();}
+    bool isRevisionKnown() const {return m_revisionKnown;}
+    unsigned long long getRevision() const {return m_revision;}
+    void setRevision(unsigned long long revision);
+
+    /**
+     * @return index of the tile containing the given canvas coordinate
+     */
+    static int toTileIndex(double canvasCoordinate);
+
+private:
+    QHash<QPoint, QPixmap> m_tiles;
+
+    // canvas the tiles are rendered for
+    RS_Vector m_factor{0., 0.};
+    bool m_hasUCS = false;
+    RS_Vector m_ucsOrigin{0., 0.};
+    double m_ucsAngle = 0.0;
+
+    unsigned long long m_revision = 0;
+    bool m_revisionKnown = false;
+};
+
+#endif // LC_RENDERTILECACHE_H
@@ -21,32 +21,83 @@
  ******************************************************************************/
 #include "lc_widgetviewportrenderer.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <unordered_set>
+
+#include <QImage>
 #include <QPixmap>
+#include <QThreadPool>
 
 #include "lc_graphicviewport.h"
+#include "lc_rendertilecache.h"
+#include "rs_document.h"
 #include "rs_entitycontainer.h"
+#include "rs_graphic.h"
+#include "rs_layer.h"
+#include "rs_layerlist.h"
 #include "rs_math.h"
 #include "rs_painter.h"
 #include "rs_settings.h"
 
+namespace {
+    // entities outside of a tile may still touch it with wide pens
+    constexpr int tileMargin = 32;
+}
+
 LC_WidgetViewPortRenderer::LC_WidgetViewPortRenderer(LC_GraphicViewport *viewport, QPaintDevice* paintDevice):
     LC_GraphicViewportRenderer(viewport, paintDevice)
     , pixmapLayerBackground{ std::make_unique<QPixmap>() }
     , pixmapLayerDrawing{ std::make_unique<QPixmap>() }
     , pixmapLayerOverlays{ std::make_unique<QPixmap>() }
     , m_pixmapLayer1{ std::make_unique<QPixmap>(1,1) }
+    , m_tileCache{ std::make_unique<LC_RenderTileCache>() }
 {
 }
 
+LC_WidgetViewPortRenderer::LC_WidgetViewPortRenderer(const LC_WidgetViewPortRenderer& other):
+    LC_GraphicViewportRenderer(other)
+    , antialiasing{other.antialiasing}
+    , classicRenderer{other.classicRenderer}
+    , parallelRenderer{other.parallelRenderer}
+    , pixmapLayerBackground{ std::make_unique<QPixmap>() }
+    , pixmapLayerDrawing{ std::make_unique<QPixmap>() }
+    , pixmapLayerOverlays{ std::make_unique<QPixmap>() }
+    , redrawMethod{other.redrawMethod}
+    , m_render_minRenderableTextHeightInPx{other.m_render_minRenderableTextHeightInPx}
+    , m_render_minCircleDrawingRadius{other.m_render_minCircleDrawingRadius}
+    , m_render_minArcDrawingRadius{other.m_render_minArcDrawingRadius}
+    , m_render_minEllipseMajorRadius{other.m_render_minEllipseMajorRadius}
+    , m_render_minEllipseMinorRadius{other.m_render_minEllipseMinorRadius}
+    , m_render_minLineDrawingLen{other.m_render_minLineDrawingLen}
+    , m_render_arcsInterpolate{other.m_render_arcsInterpolate}
+    , m_render_arcsInterpolateAngleFixed{other.m_render_arcsInterpolateAngleFixed}
+    , m_render_arcsInterpolateAngleValue{other.m_render_arcsInterpolateAngleValue}
+    , m_render_arcsInterpolateMaxSagitta{other.m_render_arcsInterpolateMaxSagitta}
+    , m_render_circlesSameAsArcs{other.m_render_circlesSameAsArcs}
+    , m_pixmapLayer1{ std::make_unique<QPixmap>(1,1) }
+    , m_tileCache{ std::make_unique<LC_RenderTileCache>() }
+{
+    m_renderStatistics = {};
+}
+
 LC_WidgetViewPortRenderer::~LC_WidgetViewPortRenderer() = default;
 
 
+void LC_WidgetViewPortRenderer::setAntialiasing(bool state) {
+    antialiasing = state;
+    m_tileCache->clear();
+}
+
 void LC_WidgetViewPortRenderer::loadSettings() {
     LC_GraphicViewportRenderer::loadSettings();
+    m_tileCache->clear();
     LC_GROUP("Appearance");
     {
         antialiasing  = LC_GET_BOOL("Antialiasing");
         classicRenderer =  LC_GET_BOOL("ClassicRenderer", true);
+        parallelRenderer = LC_GET_BOOL("ParallelRenderer", false);
     }
 
     LC_GROUP("Render");
@@ -100,6 +151,7 @@ void LC_WidgetViewPortRenderer::doRender() {
     drawLayerEntitiesTime = 0;
     drawLayerOverlaysTime = 0;
 #endif
+    m_renderStatistics = {};
     if (antialiasing){
         if (classicRenderer) {
             paintClassicalBuffered(pd);
@@ -116,7 +168,8 @@ void LC_WidgetViewPortRenderer::doRender() {
     LC_ERR<<"Paint:"  << timer.elapsed() <<
     " Layer 1 - Background: "  << drawLayerBackgroundTime <<" Layer 2 - Entities:"  << drawLayerEntitiesTime  <<" Layer 3 - overlays: "  << drawLayerOverlaysTime
     << " Entity Draw: " << entityDrawTime*1e-6 <<  " isVisible: " << isVisibleTime*1e-6 <<  " isConstruction: " << isConstructionTime*1e-6
-    << " setPen: " << setPenTime*1e-6 <<  " getPen: " << getPenTime*1e-6 << " painter setPen: " << painterSetPenTime*1e-6 << " Entities: " << drawEntityCount;
+    << " setPen: " << setPenTime*1e-6 <<  " getPen: " << getPenTime*1e-6 << " painter setPen: " << painterSetPenTime*1e-6 << " Entities: " << drawEntityCount
+    << " Visited: " << m_renderStatistics.visited << " Drawn: " << m_renderStatistics.drawn;
 #endif
 
     redrawMethod=RS2::RedrawNone;
@@ -141,7 +194,7 @@ void LC_WidgetViewPortRenderer::paintSequental(QPaintDevice* pd) {
         redrawMethod=(RS2::RedrawMethod ) (redrawMethod | RS2::RedrawDrawing);
     }
 
-    if (redrawMethod & RS2::RedrawDrawing) {
+    if (redrawMethod & (RS2::RedrawDrawing | RS2::RedrawViewport)) {
         // DRaw layer 2
         *pixmapLayerDrawing = *pixmapLayerBackground;
         RS_Painter painterLayerDrawing(pixmapLayerDrawing.get());
@@ -187,12 +240,12 @@ void LC_WidgetViewPortRenderer::paintClassicalBuffered(QPaintDevice* pd) {
         drawLayerBackground(&painterBackground);
     }
 
-    if (redrawMethod & RS2::RedrawDrawing) {
+    if (redrawMethod & (RS2::RedrawDrawing | RS2::RedrawViewport)) {
         // DRaw layer 2
         m_pixmapLayer2->fill(Qt::transparent);
         RS_Painter painterLayerDrawing(m_pixmapLayer2.get());
         setupPainter(&painterLayerDrawing);
-        drawLayerEntities(&painterLayerDrawing);
+        drawLayerEntitiesTiled(&painterLayerDrawing, redrawMethod & RS2::RedrawDrawing);
         drawLayerEntitiesOver(&painterLayerDrawing);
     }
 
@@ -252,19 +305,282 @@ void LC_WidgetViewPortRenderer::drawLayerEntities(RS_Painter* painter) {
 #endif
 
     RS_EntityContainer *container = viewport->getContainer();
+    // the spatial index of the container gives entities that may intersect the clip rect
+    // (already enlarged for UCS) in drawing order, so off-screen entities are not even visited.
+    // Lines on construction layers are drawn infinite, so boxes can't be used for them and
+    // they are added unculled.
+    // The pass of selected entities visits only the selection tracked by the document.
+    std::vector<RS_Entity*> entities = container->getCandidatesInBox(renderBoundingClipRect.minP(), renderBoundingClipRect.maxP());
+    const std::vector<RS_Entity*> constructionEntities = getConstructionEntities(container);
+    if (!constructionEntities.empty()) {
+        const std::unordered_set<RS_Entity*> candidates{entities.cbegin(), entities.cend()};
+        const size_t candidatesCount = entities.size();
+        for (RS_Entity* e: constructionEntities) {
+            if (candidates.count(e) == 0) {
+                entities.push_back(e);
+            }
+        }
+        if (entities.size() != candidatesCount) {
+            container->sortInContainerOrder(entities);
+        }
+    }
+
     painter->setDrawSelectedOnly(false);
     doSetupBeforeContainerDraw();
-    justDrawEntity(painter, container);
+    drawEntities(painter, entities);
 
     painter->setDrawSelectedOnly(true);
     doSetupBeforeContainerDraw();
-    justDrawEntity(painter, container);
+    drawEntities(painter, container->getSelectionCandidates());
 
 #ifdef DEBUG_RENDERING_DETAILS
     drawLayerEntitiesTime += drawLayerEntitiesTimer.elapsed();
 #endif
 }
 
+/**
+ * Composes the entities layer from cached tiles, only tiles that are missing
+ * (newly exposed by panning, or invalidated by changes) are rendered.
+ */
+void LC_WidgetViewPortRenderer::drawLayerEntitiesTiled(RS_Painter* painter, bool drawingChanged) {
+    updateTileCache(drawingChanged);
+
+    const int tileSize = LC_RenderTileCache::TILE_SIZE;
+    // gui position of the canvas origin
+    const int originX = viewport->getOffsetX();
+    const int originY = viewport->getHeight() - viewport->getOffsetY();
+    const int minTileX = LC_RenderTileCache::toTileIndex(-originX);
+    const int maxTileX = LC_RenderTileCache::toTileIndex(viewport->getWidth() - 1 - originX);
+    const int minTileY = LC_RenderTileCache::toTileIndex(-originY);
+    const int maxTileY = LC_RenderTileCache::toTileIndex(viewport->getHeight() - 1 - originY);
+
+    const LC_Rect viewportClipRect = renderBoundingClipRect;
+    if (!(parallelRenderer && renderTilesConcurrently(minTileX, minTileY, maxTileX, maxTileY))) {
+        for (int tileY = minTileY; tileY <= maxTileY; tileY++) {
+            // missing tiles of a row are rendered by runs, so entities are visited once per run rather than per tile
+            int tileX = minTileX;
+            while (tileX <= maxTileX) {
+                if (m_tileCache->find(tileX, tileY) != nullptr) {
+                    tileX++;
+                    continue;
+                }
+                const int firstTileX = tileX;
+                while (tileX <= maxTileX && m_tileCache->find(tileX, tileY) == nullptr) {
+                    tileX++;
+                }
+                renderTiles(firstTileX, tileX - 1, tileY);
+            }
+        }
+    }
+
+    for (int tileY = minTileY; tileY <= maxTileY; tileY++) {
+        for (int tileX = minTileX; tileX <= maxTileX; tileX++) {
+            painter->drawPixmap(originX + tileX * tileSize, originY + tileY * tileSize, *m_tileCache->find(tileX, tileY));
+        }
+    }
+    renderBoundingClipRect = viewportClipRect;
+    m_tileCache->trim(minTileX, minTileY, maxTileX, maxTileY);
+}
+
+/**
+ * Drops cached tiles affected by changes of the document since the tiles were rendered.
+ */
+void LC_WidgetViewPortRenderer::updateTileCache(bool drawingChanged) {
+    m_tileCache->update(viewport);
+
+    RS_EntityContainer *container = viewport->getContainer();
+    if (!container->isDocument()) {
+        // nothing is known about changes
+        if (drawingChanged) {
+            m_tileCache->clear();
+        }
+        return;
+    }
+
+    const LC_DocumentChangeLog &changeLog = static_cast<RS_Document*>(container)->getChangeLog();
+    const unsigned long long revision = changeLog.getRevision();
+    if (m_tileCache->isRevisionKnown()) {
+        if (revision == m_tileCache->getRevision()) {
+            // redraw without changes of entities, so something else was changed (layers, settings, draft mode...)
+            if (drawingChanged) {
+                m_tileCache->clear();
+            }
+        }
+        else {
+            std::vector<LC_Rect> changedAreas;
+            if (changeLog.collectChangedAreas(m_tileCache->getRevision(), changedAreas)) {
+                for (const LC_Rect &area: changedAreas) {
+                    invalidateTiles(area);
+                }
+            }
+            else {
+                m_tileCache->clear();
+            }
+        }
+    }
+    m_tileCache->setRevision(revision);
+}
+
+void LC_WidgetViewPortRenderer::invalidateTiles(const LC_Rect& wcsArea) {
+    const std::array<RS_Vector, 4> corners{wcsArea.minP(), wcsArea.upperLeftCorner(), wcsArea.maxP(), wcsArea.lowerRightCorner()};
+    const int originX = viewport->getOffsetX();
+    const int originY = viewport->getHeight() - viewport->getOffsetY();
+    double minX = RS_MAXDOUBLE;
+    double minY = RS_MAXDOUBLE;
+    double maxX = RS_MINDOUBLE;
+    double maxY = RS_MINDOUBLE;
+    for (const RS_Vector &corner: corners) {
+        double uiX, uiY;
+        viewport->toUI(corner, uiX, uiY);
+        minX = std::min(minX, uiX - originX);
+        minY = std::min(minY, uiY - originY);
+        maxX = std::max(maxX, uiX - originX);
+        maxY = std::max(maxY, uiY - originY);
+    }
+    m_tileCache->invalidate(LC_RenderTileCache::toTileIndex(minX - tileMargin), LC_RenderTileCache::toTileIndex(minY - tileMargin),
+                            LC_RenderTileCache::toTileIndex(maxX + tileMargin), LC_RenderTileCache::toTileIndex(maxY + tileMargin));
+}
+
+/**
+ * Renders a run of adjacent tiles of one row and puts them to the cache
+ */
+void LC_WidgetViewPortRenderer::renderTiles(int firstTileX, int lastTileX, int tileY) {
+    const int tileSize = LC_RenderTileCache::TILE_SIZE;
+    const int tilesCount = lastTileX - firstTileX + 1;
+    const int uiX = viewport->getOffsetX() + firstTileX * tileSize;
+    const int uiY = viewport->getHeight() - viewport->getOffsetY() + tileY * tileSize;
+
+    QPixmap strip(tilesCount * tileSize, tileSize);
+    strip.fill(Qt::transparent);
+    renderTileStrip(&strip, uiX, uiY);
+
+    for (int i = 0; i < tilesCount; i++) {
+        m_tileCache->insert(firstTileX + i, tileY, strip.copy(i * tileSize, 0, tileSize, tileSize));
+    }
+}
+
+/**
+ * Renders all missing tiles of the given range by the pool of worker threads, each worker
+ * has its own renderer and paints to its own images.
+ * The gui thread takes part in rendering and waits for all workers, so the document can't be
+ * modified while tiles are rendered.
+ * @return false if tiles were not rendered, as there is nothing to gain from concurrency or entities can't be rendered concurrently
+ */
+bool LC_WidgetViewPortRenderer::renderTilesConcurrently(int minTileX, int minTileY, int maxTileX, int maxTileY) {
+    std::vector<QPoint> missingTiles;
+    for (int tileY = minTileY; tileY <= maxTileY; tileY++) {
+        for (int tileX = minTileX; tileX <= maxTileX; tileX++) {
+            if (m_tileCache->find(tileX, tileY) == nullptr) {
+                missingTiles.emplace_back(tileX, tileY);
+            }
+        }
+    }
+    if (missingTiles.size() < 2) {
+        return false;
+    }
+
+    if (m_renderThreadPool == nullptr) {
+        m_renderThreadPool = std::make_unique<QThreadPool>();
+    }
+    const int workersCount = std::min(m_renderThreadPool->maxThreadCount(), static_cast<int>(missingTiles.size()));
+    if (workersCount < 2) {
+        return false;
+    }
+    std::vector<std::unique_ptr<LC_WidgetViewPortRenderer>> workers;
+    for (int i = 0; i < workersCount; i++) {
+        std::unique_ptr<LC_WidgetViewPortRenderer> worker = createTileRenderer();
+        if (worker == nullptr) {
+            return false;
+        }
+        workers.push_back(std::move(worker));
+    }
+
+    // lazy structures of the container should not be built by workers
+    viewport->getContainer()->refreshSpatialIndex();
+
+    const int tileSize = LC_RenderTileCache::TILE_SIZE;
+    // images should have the same resolution as pixmaps, as it affects painting of points and line widths
+    const QPixmap probe(tileSize, tileSize);
+    const int dotsPerMeter = probe.widthMM() > 0 ? qRound(1000.0 * tileSize / probe.widthMM()) : 0;
+    const int originX = viewport->getOffsetX();
+    const int originY = viewport->getHeight() - viewport->getOffsetY();
+
+    std::vector<QImage> images(missingTiles.size());
+    std::atomic<size_t> nextTile{0};
+    auto renderMissingTiles = [&](LC_WidgetViewPortRenderer* worker) {
+        for (size_t i = nextTile++; i < missingTiles.size(); i = nextTile++) {
+            QImage image(tileSize, tileSize, QImage::Format_ARGB32_Premultiplied);
+            if (dotsPerMeter > 0) {
+                image.setDotsPerMeterX(dotsPerMeter);
+                image.setDotsPerMeterY(dotsPerMeter);
+            }
+            image.fill(Qt::transparent);
+            worker->renderTileStrip(&image, originX + missingTiles[i].x() * tileSize, originY + missingTiles[i].y() * tileSize);
+            images[i] = std::move(image);
+        }
+    };
+
+    for (int i = 1; i < workersCount; i++) {
+        LC_WidgetViewPortRenderer* worker = workers[i].get();
+        m_renderThreadPool->start([&renderMissingTiles, worker]() {
+            renderMissingTiles(worker);
+        });
+    }
+    renderMissingTiles(workers.front().get());
+    m_renderThreadPool->waitForDone();
+
+    for (size_t i = 0; i < missingTiles.size(); i++) {
+        m_tileCache->insert(missingTiles[i].x(), missingTiles[i].y(), QPixmap::fromImage(std::move(images[i])));
+    }
+    for (const auto& worker: workers) {
+        m_renderStatistics.visited += worker->getRenderStatistics().visited;
+        m_renderStatistics.drawn += worker->getRenderStatistics().drawn;
+    }
+    return true;
+}
+
+/**
+ * Renders entities to the device which is placed at the given gui position of the viewport
+ */
+void LC_WidgetViewPortRenderer::renderTileStrip(QPaintDevice* device, int uiX, int uiY) {
+    renderBoundingClipRect = prepareBoundingClipRect(uiX - tileMargin, uiY - tileMargin,
+                                                     uiX + device->width() + tileMargin, uiY + device->height() + tileMargin);
+    RS_Painter painter(device);
+    setupPainter(&painter);
+    // entities are painted in gui coordinates of the viewport
+    painter.translate(-uiX, -uiY);
+    drawLayerEntities(&painter);
+}
+
+/**
+ * @return top-level entities of the container placed on construction layers
+ */
+std::vector<RS_Entity*> LC_WidgetViewPortRenderer::getConstructionEntities(const RS_EntityContainer* container) const {
+    std::vector<RS_Entity*> entities;
+    if (graphic == nullptr) {
+        return entities;
+    }
+    for (const RS_Layer* layer: *graphic->getLayerList()) {
+        if (layer->isConstruction()) {
+            const std::vector<RS_Entity*> onLayer = container->getEntitiesOnLayer(layer);
+            entities.insert(entities.end(), onLayer.cbegin(), onLayer.cend());
+        }
+    }
+    return entities;
+}
+
+/**
+ * Draws top-level entities of the container, same as RS_EntityContainer::draw() does for all children
+ */
+void LC_WidgetViewPortRenderer::drawEntities(RS_Painter* painter, const std::vector<RS_Entity*> &entities) {
+    for (RS_Entity* e: entities) {
+        if (e != nullptr && e->getId() != 0) {
+            m_renderStatistics.visited++;
+            painter->drawEntity(e);
+        }
+    }
+}
+
 void LC_WidgetViewPortRenderer::doSetupBeforeContainerDraw() {
     lastPaintEntityPen = RS_Pen{};
     lastPaintEntityPen.setFlags(RS2::FlagInvalid);
@@ -23,9 +23,15 @@
 #ifndef LC_WIDGETVIEWPORTRENDERER_H
 #define LC_WIDGETVIEWPORTRENDERER_H
 
+#include <memory>
+#include <vector>
+
 #include "lc_graphicviewportrenderer.h"
 
+class LC_RenderTileCache;
+class RS_EntityContainer;
 class QPixmap;
+class QThreadPool;
 
 class LC_WidgetViewPortRenderer:public LC_GraphicViewportRenderer
 {
@@ -34,10 +40,20 @@ public:
     ~LC_WidgetViewPortRenderer() override;
     void loadSettings() override;
     void setupPainter(RS_Painter* painter) override;
-    void setAntialiasing(bool state) {antialiasing = state;}
+    void setAntialiasing(bool state);
     void invalidate(RS2::RedrawMethod method) {redrawMethod = static_cast<RS2::RedrawMethod>(redrawMethod | method);}
 protected:
+    /**
+     * Copies settings of entities drawing only, used for renderers of worker threads
+     */
+    LC_WidgetViewPortRenderer(const LC_WidgetViewPortRenderer& other);
+
     void doRender() override;
+    /**
+     * Creates a renderer that draws entities exactly as this one, to be used by a worker thread.
+     * nullptr means that entities can't be rendered concurrently.
+     */
+    virtual std::unique_ptr<LC_WidgetViewPortRenderer> createTileRenderer() const {return nullptr;}
 
     virtual void doSetupBeforeContainerDraw();
     void paintClassicalBuffered(QPaintDevice* pd);
@@ -45,6 +61,14 @@ protected:
 
     void drawLayerBackground(RS_Painter *painter);
     void drawLayerEntities(RS_Painter* painter);
+    void drawLayerEntitiesTiled(RS_Painter* painter, bool drawingChanged);
+    void drawEntities(RS_Painter* painter, const std::vector<RS_Entity*> &entities);
+    std::vector<RS_Entity*> getConstructionEntities(const RS_EntityContainer* container) const;
+    void updateTileCache(bool drawingChanged);
+    void invalidateTiles(const LC_Rect& wcsArea);
+    void renderTiles(int firstTileX, int lastTileX, int tileY);
+    bool renderTilesConcurrently(int minTileX, int minTileY, int maxTileX, int maxTileY);
+    void renderTileStrip(QPaintDevice* device, int uiX, int uiY);
     void drawLayerOverlays(RS_Painter *painter);
 
     virtual void drawLayerEntitiesOver([[maybe_unused]]RS_Painter* painter){}
@@ -66,6 +90,7 @@ protected:
 private:
     bool antialiasing = false;
     bool classicRenderer = true;
+    bool parallelRenderer = false;
 
     std::unique_ptr<QPixmap> pixmapLayerBackground;
     std::unique_ptr<QPixmap> pixmapLayerDrawing;
@@ -90,6 +115,11 @@ private:
     std::unique_ptr<QPixmap> m_pixmapLayer1;  // Used for grids and absolute 0
     std::unique_ptr<QPixmap> m_pixmapLayer2;  // Used for the actual CAD drawing
     std::unique_ptr<QPixmap> m_pixmapLayer3;  // Used for crosshair and actionitems
+
+    // rendered tiles of the entities layer, reused for panning
+    std::unique_ptr<LC_RenderTileCache> m_tileCache;
+    // workers of multithreaded tiles rendering, created on demand
+    std::unique_ptr<QThreadPool> m_renderThreadPool;
 };
 
 #endif // LC_WIDGETVIEWPORTRENDERER_H
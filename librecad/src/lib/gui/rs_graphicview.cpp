@@ -237,7 +237,7 @@ void RS_GraphicView::onViewportChanged() {
     adjustZoomControls();
     QString info = m_viewport->getGrid()->getInfo();
     updateGridStatusWidget(info);
-    redraw();
+    redraw(static_cast<RS2::RedrawMethod>(RS2::RedrawBackground | RS2::RedrawViewport | RS2::RedrawOverlay));
 }
 
 void RS_GraphicView::onViewportRedrawNeeded() {
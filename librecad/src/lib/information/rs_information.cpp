@@ -485,6 +485,14 @@ RS_VectorSolutions RS_Information::getIntersection(RS_Entity const* e1,
         }
     }
 
+    // polylines intersect by their segments, which compact polylines don't create
+    if (e1Type == RS2::EntityPolyline) {
+        return static_cast<const RS_Polyline*>(e1)->getIntersection(e2, onEntities);
+    }
+    if (e2Type == RS2::EntityPolyline) {
+        return static_cast<const RS_Polyline*>(e2)->getIntersection(e1, onEntities);
+    }
+
     auto parentOne = e1->getParent();
     //avoid intersections between line segments the same spline
     /* ToDo: 24 Aug 2011, Dongxu Li, if rtti() is not defined for the parent, the following check for splines may still cause segfault */
@@ -25,12 +25,15 @@
 **
 **********************************************************************/
 // File: rs_modification.cpp
+#include <algorithm>
+
 #include <QSet>
 
 #include "lc_containertraverser.h"
 #include "lc_graphicviewport.h"
 #include "lc_linemath.h"
 #include "lc_splinepoints.h"
+#include "lc_undoabletransform.h"
 #include "lc_undosection.h"
 #include "rs_arc.h"
 #include "rs_atomicentity.h"
@@ -49,6 +52,7 @@
 #include "rs_modification.h"
 #include "rs_mtext.h"
 #include "rs_polyline.h"
+#include "rs_preview.h"
 #include "rs_settings.h"
 #include "rs_text.h"
 #include "rs_units.h"
@@ -110,7 +114,8 @@ namespace {
         if (limitEntity.isContainer()){
             auto ec = static_cast<const RS_EntityContainer *>(&limitEntity);
 
-            for(RS_Entity* e: lc::LC_ContainerTraverser{*ec, RS2::ResolveAll}.entities()) {
+            lc::LC_ContainerTraverser traverser{*ec, RS2::ResolveAll};
+            for(RS_Entity* e: traverser.entities()) {
                 RS_VectorSolutions s2 = RS_Information::getIntersection(&trimEntity,
                                                                         e, false);
 
@@ -865,6 +870,7 @@ bool RS_Modification::pasteContainer(RS_Entity* entity, RS_EntityContainer* cont
 
     // copy content of block/insert to destination
     RS_DEBUG->print(RS_Debug::D_DEBUGGING, "RS_Modification::pasteInsert: copy content to the subcontainer");
+    insert->prepareEntities();
     for(auto* e: *insert) {
 
         if(!e) {
@@ -1741,6 +1747,23 @@ bool RS_Modification::move(RS_MoveData &data, bool previewOnly, [[maybe_unused]]
 bool RS_Modification::move(RS_MoveData& data, const std::vector<RS_Entity*> &entitiesList, bool forPreviewOnly, bool keepSelected) {
 
     int numberOfCopies = data.obtainNumberOfCopies();
+
+    RS_Preview* preview = getTransformPreview(forPreviewOnly);
+    if (preview != nullptr) {
+        for (int num = 1; num <= numberOfCopies; num++) {
+            preview->addTransformed(entitiesList, RS_Vector(0., 0.), data.offset * num, 1., 0.);
+        }
+        return true;
+    }
+
+    if (canTransformInPlace(data, entitiesList, forPreviewOnly)) {
+        auto transform = std::make_unique<LC_UndoableTransform>(entitiesList);
+        transform->addMove(data.offset);
+        if (transformInPlace(std::move(transform), keepSelected)) {
+            return true;
+        }
+    }
+
     std::vector<RS_Entity*> clonesList;
 
     for(auto e: entitiesList){
@@ -1791,6 +1814,62 @@ RS_Entity *RS_Modification::getClone(bool forPreviewOnly, const RS_Entity *e) co
     return result;
 }
 
+/**
+ * @return the preview which draws the entities of the document transformed in place of their transformed clones,
+ * nullptr if clones should be created. Used for transformations the painter may apply to the entities, see
+ * RS_Preview::addTransformed().
+ */
+RS_Preview* RS_Modification::getTransformPreview(bool forPreviewOnly) const {
+    if (!forPreviewOnly || m_container == nullptr || m_container->rtti() != RS2::EntityPreview) {
+        return nullptr;
+    }
+    return static_cast<RS_Preview*>(m_container);
+}
+
+/**
+ * @return true, if the entities may be transformed in place instead of replacing them with transformed
+ * clones: they are moved, not copied, keep their attributes and the undo cycle is recorded for the document
+ * which contains them.
+ */
+bool RS_Modification::canTransformInPlace(const LC_ModifyOperationFlags& data,
+                                          const std::vector<RS_Entity*>& entitiesList, bool forPreviewOnly) const {
+    if (forPreviewOnly || !handleUndo || data.keepOriginals || data.obtainNumberOfCopies() != 1
+        || data.useCurrentLayer || data.useCurrentAttributes) {
+        return false;
+    }
+    if (m_document == nullptr || m_document != m_container || m_viewport == nullptr) {
+        return false;
+    }
+    return std::all_of(entitiesList.cbegin(), entitiesList.cend(), [this](const RS_Entity* e) {
+        return e != nullptr && e->getParent() == m_container && !e->isUndone();
+    });
+}
+
+/**
+ * Applies the transformation to the entities and adds it to the undo cycle, so the document keeps
+ * a single undoable for all the entities instead of their originals and transformed clones.
+ * @return false if the geometry of some entity can't be saved for undo, such entities are transformed
+ *         on clones
+ */
+bool RS_Modification::transformInPlace(std::unique_ptr<LC_UndoableTransform> transform, bool keepSelected) {
+    if (!transform->saveGeometry()) {
+        return false;
+    }
+    LC_UndoSection undo(m_document, m_viewport, handleUndo);
+
+    // since 2.0.4.0: keep selection
+    for (RS_Entity* e: transform->getEntities()) {
+        e->setSelected(keepSelected);
+    }
+    transform->apply();
+    undo.addUndoable(std::move(transform));
+
+    m_container->calculateBorders();
+
+    m_viewport->notifyChanged();
+    return true;
+}
+
 void RS_Modification::setupModifiedClones(
     std::vector<RS_Entity *> &addList, const LC_ModifyOperationFlags &data, bool forPreviewOnly, bool keepSelected) const {
     if (!forPreviewOnly && (data.useCurrentLayer || data.useCurrentAttributes)){
@@ -1919,6 +1998,47 @@ bool RS_Modification::rotate(RS_RotateData& data, const std::vector<RS_Entity*>
     // Create new entities
 
     int numberOfCopies = data.obtainNumberOfCopies();
+
+    RS_Preview* preview = getTransformPreview(forPreviewOnly);
+    if (preview != nullptr) {
+        for (int num = 1; num <= numberOfCopies; num++) {
+            double rotationAngle = data.angle * num;
+            RS_Vector insertionPoint = data.center;
+            if (data.twoRotations && data.refPoint.distanceTo(data.center) >= RS_TOLERANCE) {
+                // the second rotation around the rotated reference point moves the center of the first one
+                RS_Vector rotatedRefPoint = data.refPoint;
+                rotatedRefPoint.rotate(data.center, rotationAngle);
+
+                double secondRotationAngle = data.secondAngle;
+                if (data.secondAngleIsAbsolute){
+                    secondRotationAngle -= rotationAngle;
+                }
+                insertionPoint.rotate(rotatedRefPoint, secondRotationAngle);
+                rotationAngle += secondRotationAngle;
+            }
+            preview->addTransformed(entitiesList, data.center, insertionPoint, 1., rotationAngle);
+        }
+        return true;
+    }
+
+    if (canTransformInPlace(data, entitiesList, forPreviewOnly)) {
+        auto transform = std::make_unique<LC_UndoableTransform>(entitiesList);
+        transform->addRotate(data.center, data.angle);
+        if (data.twoRotations && data.refPoint.distanceTo(data.center) >= RS_TOLERANCE) {
+            RS_Vector rotatedRefPoint = data.refPoint;
+            rotatedRefPoint.rotate(data.center, data.angle);
+
+            double secondRotationAngle = data.secondAngle;
+            if (data.secondAngleIsAbsolute){
+                secondRotationAngle -= data.angle;
+            }
+            transform->addRotate(rotatedRefPoint, secondRotationAngle);
+        }
+        if (transformInPlace(std::move(transform), keepSelected)) {
+            return true;
+        }
+    }
+
     for (auto e: entitiesList) {
         for (int num = 1; num <= numberOfCopies; num++) {
             RS_Entity* ec = getClone(forPreviewOnly, e);
@@ -1974,6 +2094,29 @@ bool RS_Modification::scale(RS_ScaleData& data, bool forPreviewOnly, const bool
  * modification.
  */
 bool RS_Modification::scale(RS_ScaleData& data, const std::vector<RS_Entity*> &entitiesList, bool forPreviewOnly, const bool keepSelected) {
+    // the painter scales uniformly and without reflection only
+    RS_Preview* preview = getTransformPreview(forPreviewOnly);
+    if (preview != nullptr && data.isotropicScaling && data.factor.x > RS_TOLERANCE
+        && std::abs(data.factor.x - data.factor.y) < RS_TOLERANCE) {
+        int numberOfCopies = data.obtainNumberOfCopies();
+        for (int num = 1; num <= numberOfCopies; num++) {
+            preview->addTransformed(entitiesList, data.referencePoint, data.referencePoint,
+                                    RS_Math::pow(data.factor.x, num), 0.);
+        }
+        return true;
+    }
+
+    // circles and arcs are replaced by ellipses for non-isotropic scaling
+    if (data.isotropicScaling && std::abs(data.factor.x) > RS_TOLERANCE
+        && std::abs(data.factor.x - data.factor.y) < RS_TOLERANCE
+        && canTransformInPlace(data, entitiesList, forPreviewOnly)) {
+        auto transform = std::make_unique<LC_UndoableTransform>(entitiesList);
+        transform->addScale(data.referencePoint, data.factor.x);
+        if (transformInPlace(std::move(transform), keepSelected)) {
+            return true;
+        }
+    }
+
     std::vector<RS_Entity*> selectedList,clonesList;
 
     for(auto ec: entitiesList){
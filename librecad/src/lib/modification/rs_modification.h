@@ -33,6 +33,7 @@
 #include "rs_vector.h"
 
 class LC_GraphicViewport;
+class LC_UndoableTransform;
 class RS_Arc;
 class RS_AtomicEntity;
 class RS_Document;
@@ -44,6 +45,7 @@ class RS_Insert;
 class RS_Line;
 class RS_MText;
 class RS_Polyline;
+class RS_Preview;
 class RS_Text;
 
 struct LC_ModifyOperationFlags{
@@ -408,6 +410,10 @@ protected:
                              bool forPreviewOnly, bool keepSelected) const;
 
     RS_Entity* getClone(bool forPreviewOnly, const RS_Entity* e) const;
+    RS_Preview* getTransformPreview(bool forPreviewOnly) const;
+    bool canTransformInPlace(const LC_ModifyOperationFlags& data, const std::vector<RS_Entity*>& entitiesList,
+                             bool forPreviewOnly) const;
+    bool transformInPlace(std::unique_ptr<LC_UndoableTransform> transform, bool keepSelected);
 };
 
 #endif
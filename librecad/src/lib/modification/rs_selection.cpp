@@ -26,16 +26,23 @@
 #include "rs_selection.h"
 
 #include "lc_containertraverser.h"
+#include "lc_endpointindex.h"
 #include "lc_graphicviewport.h"
 #include "qc_applicationwindow.h"
 #include "qg_dialogfactory.h"
 #include "rs_dialogfactory.h"
 #include "rs_entitycontainer.h"
+#include "rs_graphic.h"
 #include "rs_information.h"
 #include "rs_insert.h"
 #include "rs_layer.h"
 #include "rs_line.h"
 
+namespace {
+// end points of entities closer than that are connected in a contour
+constexpr double contourTolerance = 1.0e-4;
+}
+
 /**
  * Default constructor.
  *
@@ -251,57 +258,37 @@ void RS_Selection::selectContour(RS_Entity *e){
     }
 
     bool select = !e->isSelected();
-    auto *ae = (RS_AtomicEntity *) e;
-    RS_Vector p1 = ae->getStartpoint();
-    RS_Vector p2 = ae->getEndpoint();
-    bool found = false;
+    RS_Vector p1 = e->getStartpoint();
+    RS_Vector p2 = e->getEndpoint();
 
     // (de)select 1st entity:
     e->setSelected(select);
 
-    do {// fixme - hm...iterating over all entities of drawing in cycle???? too nice for me...
-        found = false;
-        // fixme - iterating over all entities of drawing
-        for (auto en: *m_container) {
-
-            if (en && en->isVisible() &&
-                en->isAtomic() && en->isSelected() != select &&
-                (!(en->getLayer() && en->getLayer()->isLocked()))){
-
-                ae = (RS_AtomicEntity *) en;
-                bool doit = false;
-
-                // startpoint connects to 1st point
-                if (ae->getStartpoint().distanceTo(p1) < 1.0e-4){
-                    doit = true;
-                    p1 = ae->getEndpoint();
-                }
-
-                    // endpoint connects to 1st point
-                else if (ae->getEndpoint().distanceTo(p1) < 1.0e-4){
-                    doit = true;
-                    p1 = ae->getStartpoint();
-                }
-
-                    // startpoint connects to 2nd point
-                else if (ae->getStartpoint().distanceTo(p2) < 1.0e-4){
-                    doit = true;
-                    p2 = ae->getEndpoint();
-                }
-
-                    // endpoint connects to 1st point
-                else if (ae->getEndpoint().distanceTo(p2) < 1.0e-4){
-                    doit = true;
-                    p2 = ae->getStartpoint();
-                }
+    // entities which may be added to the contour, found by their end points
+    LC_EndpointIndex endpoints{contourTolerance};
+    for (auto en: *m_container) {
+        if (en && en->isVisible() &&
+            en->isAtomic() && en->isSelected() != select &&
+            (!(en->getLayer() && en->getLayer()->isLocked()))){
+            endpoints.insert(en);
+        }
+    }
 
-                if (doit){
-                    ae->setSelected(select);
-                    found = true;
-                }
-            }
+    // extends the contour at one of its ends, the end moves to the other end of the connected entity
+    auto extend = [&endpoints, select](RS_Vector& end) {
+        std::vector<RS_Entity*> connected = endpoints.entitiesAt(end);
+        if (connected.empty()) {
+            return false;
         }
-    } while (found);
+        RS_Entity* en = connected.front();
+        end = (en->getStartpoint().distanceTo(end) < contourTolerance) ? en->getEndpoint() : en->getStartpoint();
+        en->setSelected(select);
+        endpoints.remove(en);
+        return true;
+    };
+    // both ends are followed until no connected entity is left
+    while (extend(p1) || extend(p2)) {
+    }
     m_graphicView->notifyChanged();
 }
 
@@ -326,15 +313,10 @@ void RS_Selection::selectLayer(RS_Entity *e){
  * Selects all entities on the given layer.
  */
 void RS_Selection::selectLayer(const QString &layerName, bool select){
-    for (auto en: *m_container) {
-        // fixme - review and make more efficient... why check for locking upfront? Why just not use layer pointers but names?
-        if (en && en->isVisible() &&
-            en->isSelected() != select &&
-            (!(en->getLayer() && en->getLayer()->isLocked()))){
-
-            RS_Layer *l = en->getLayer(true);
-
-            if (l != nullptr && l->getName() == layerName){
+    RS_Layer* layer = (m_graphic != nullptr) ? m_graphic->findLayer(layerName) : nullptr;
+    if (layer != nullptr && !layer->isLocked()) {
+        for (auto en: m_container->getEntitiesOnLayer(layer)) {
+            if (en->isVisible() && en->isSelected() != select) {
                 en->setSelected(select);
             }
         }
@@ -665,7 +665,9 @@ void Plugin_Entity::getPolylineData(QList<Plug_VertexData> *data){
 
     RS_Entity* nextEntity = 0;
 	RS_AtomicEntity* ae = nullptr;
-    RS_Entity* v = l->firstEntity(RS2::ResolveNone);
+    // the vertices are only read, a compact polyline provides copies of its segments
+    lc::LC_ContainerTraverser traverser{std::as_const(*l), RS2::ResolveNone};
+    RS_Entity* v = traverser.first();
     double bulge=0.0;
 //bad polyline without vertex
 	if (!v) return;
@@ -678,7 +680,6 @@ void Plugin_Entity::getPolylineData(QList<Plug_VertexData> *data){
     data->append(Plug_VertexData(QPointF(ae->getStartpoint().x,
                                          ae->getStartpoint().y),bulge));
 
-    lc::LC_ContainerTraverser traverser{*l, RS2::ResolveNone};
     for (v=traverser.first(); v != nullptr; v=traverser.next()) {
         nextEntity = traverser.next();
         bulge = 0.0;
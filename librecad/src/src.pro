@@ -362,6 +362,11 @@ HEADERS += \
     lib/engine/document/entities/support/lc_dimarrowblock.h \
     lib/engine/document/entities/support/lc_dimarrowblockpoly.h \
     lib/engine/document/lc_graphicvariables.h \
+    lib/engine/document/lc_documentchangelog.h \
+    lib/engine/document/lc_intersectioncache.h \
+    lib/engine/document/lc_layerindex.h \
+    lib/engine/document/lc_selectionset.h \
+    lib/engine/document/lc_nameindex.h \
     lib/engine/document/textstyles/lc_textstyle.h \
     lib/engine/document/textstyles/lc_textstylelist.h \
     lib/engine/document/ucs/lc_ucslist.h \
@@ -410,11 +415,14 @@ HEADERS += \
     lib/engine/document/entities/rs_dimension.h \
     lib/engine/document/entities/rs_dimlinear.h \
     lib/engine/document/entities/lc_dimordinate.h \
+    lib/engine/document/entities/lc_entitygeometry.h \
     lib/engine/document/entities/rs_dimradial.h \
     lib/engine/document/entities/lc_dimarc.h \
     lib/engine/document/rs_document.h \
     lib/engine/document/entities/rs_ellipse.h \
     lib/engine/document/entities/rs_entity.h \
+    lib/engine/document/container/lc_endpointindex.h \
+    lib/engine/document/container/lc_spatialindex.h \
     lib/engine/document/container/rs_entitycontainer.h \
     lib/engine/rs_flags.h \
     lib/engine/document/fonts/rs_font.h \
@@ -446,6 +454,7 @@ HEADERS += \
     lib/engine/rs_system.h \
     lib/engine/document/entities/rs_text.h \
     lib/engine/undo/lc_undoablerelzero.h \
+    lib/engine/undo/lc_undoabletransform.h \
     lib/engine/undo/rs_undo.h \
     lib/engine/undo/rs_undoable.h \
     lib/engine/undo/rs_undocycle.h \
@@ -534,6 +543,7 @@ HEADERS += \
     ui/main/persistence/lc_documentsstorage.h \
     lib/gui/render/widget/lc_graphicviewrenderer.cpp \
     lib/gui/render/widget/lc_printpreviewviewrenderer.cpp \
+    lib/gui/render/widget/lc_rendertilecache.h \
     lib/gui/render/widget/lc_widgetviewportrenderer.cpp \
     lib/modification/lc_align.h \
     ui/action_options/curve/lc_actiondrawarc2poptions.h \
@@ -607,6 +617,7 @@ HEADERS += \
     lib/engine/document/entities/lc_rect.h \
     lib/engine/utils/lc_rtree.h \
     lib/engine/undo/lc_undosection.h \
+    lib/engine/undo/lc_undospillstore.h \
     lib/printing/lc_printing.h \
     main/lc_application.h \
     ui/action_options/curve/lc_ellipsearcoptions.h \
@@ -679,6 +690,10 @@ SOURCES += \
     lib/engine/document/entities/support/lc_dimarrowblock.cpp \
     lib/engine/document/entities/support/lc_dimarrowblockpoly.cpp \
     lib/engine/document/lc_graphicvariables.cpp \
+    lib/engine/document/lc_documentchangelog.cpp \
+    lib/engine/document/lc_intersectioncache.cpp \
+    lib/engine/document/lc_layerindex.cpp \
+    lib/engine/document/lc_selectionset.cpp \
     lib/engine/document/textstyles/lc_textstyle.cpp \
     lib/engine/document/textstyles/lc_textstylelist.cpp \
     lib/engine/document/ucs/lc_ucslist.cpp \
@@ -693,6 +708,7 @@ SOURCES += \
     lib/engine/overlays/ucs_mark/lc_ucs_mark.cpp \
     lib/engine/settings/lc_settingsexporter.cpp \
     lib/engine/undo/lc_undoablerelzero.cpp \
+    lib/engine/undo/lc_undoabletransform.cpp \
     lib/engine/utils/lc_rectregion.cpp \
     lib/filters/lc_hyperbolaspline.cpp \
     lib/generators/layers/lc_layersexporter.cpp \
@@ -763,6 +779,7 @@ SOURCES += \
     lib/gui/render/lc_graphicviewportrenderer.cpp \
     lib/gui/render/widget/lc_graphicviewrenderer.cpp \
     lib/gui/render/widget/lc_printpreviewviewrenderer.cpp \
+    lib/gui/render/widget/lc_rendertilecache.cpp \
     lib/gui/render/widget/lc_widgetviewportrenderer.cpp \
     lib/modification/lc_align.cpp \
     ui/action_options/curve/lc_actiondrawarc2poptions.cpp \
@@ -817,6 +834,8 @@ SOURCES += \
     lib/engine/document/rs_document.cpp \
     lib/engine/document/entities/rs_ellipse.cpp \
     lib/engine/document/entities/rs_entity.cpp \
+    lib/engine/document/container/lc_endpointindex.cpp \
+    lib/engine/document/container/lc_spatialindex.cpp \
     lib/engine/document/container/rs_entitycontainer.cpp \
     lib/engine/document/fonts/rs_font.cpp \
     lib/engine/document/fonts/rs_fontlist.cpp \
@@ -919,6 +938,7 @@ SOURCES += \
     lib/engine/document/entities/lc_rect.cpp \
     lib/engine/utils/lc_rtree.cpp \
     lib/engine/undo/lc_undosection.cpp \
+    lib/engine/undo/lc_undospillstore.cpp \
     lib/engine/rs.cpp \
     lib/printing/lc_printing.cpp \
     main/lc_application.cpp \
@@ -202,6 +202,9 @@ void QG_DlgOptionsGeneral::init(){
         checked = LC_GET_BOOL("ClassicRenderer", true);
         cbClassicRendering->setChecked(checked);
 
+        checked = LC_GET_BOOL("ParallelRenderer", false);
+        cbParallelRendering->setChecked(checked);
+
         checked = LC_GET_BOOL("UnitlessGrid");
         cb_unitless_grid->setChecked(checked);
 
@@ -555,6 +558,7 @@ void QG_DlgOptionsGeneral::init(){
         cbAngleSnapStep->setCurrentIndex(LC_GET_INT("AngleSnapStep", 3));
 
         cbNewDrawingGridOff->setChecked(LC_GET_BOOL("GridOffForNewDrawing", false));
+        sbUndoMemoryBudget->setValue(LC_GET_INT("UndoMemoryBudget", 512));
 
         bool defaultIsometricGrid = LC_GET_BOOL("IsometricGrid", false);
         int defaultIsoView = LC_GET_INT("IsoGridView", RS2::IsoGridViewType::IsoTop);
@@ -702,6 +706,7 @@ void QG_DlgOptionsGeneral::ok(){
             LC_SET("UnitlessGrid", cb_unitless_grid->isChecked());
             LC_SET("Antialiasing", cb_antialiasing->isChecked());
             LC_SET("ClassicRenderer", cbClassicRendering->isChecked());
+            LC_SET("ParallelRenderer", cbParallelRendering->isChecked());
             LC_SET("Autopanning", cb_autopanning->isChecked());
             LC_SET("ScrollBars", scrollbars_check_box->isChecked());
             LC_SET("ShowKeyboardShortcutsInTooltips", cbShowKeyboardShortcutsInToolTips->isChecked());
@@ -872,6 +877,7 @@ void QG_DlgOptionsGeneral::ok(){
             LC_SET("InvertZoomDirection", cbInvertZoomDirection->isChecked());
             LC_SET("AngleSnapStep", cbAngleSnapStep->currentIndex());
             LC_SET("GridOffForNewDrawing", cbNewDrawingGridOff->isChecked());
+            LC_SET("UndoMemoryBudget", sbUndoMemoryBudget->value());
 
             bool defaultIsometricGrid = !rbGridOrtho->isChecked();
             LC_SET("IsometricGrid", defaultIsometricGrid);
@@ -790,16 +790,17 @@ void LC_QuickInfoEntityData::collectPolylineProperties(RS_Polyline *l){
 
     addProperty(tr("Closed"), closed ? tr("Yes") : tr("No"), OTHER);
 
-    RS_Entity *v = l->firstEntity(RS2::ResolveNone);
     //bad polyline without vertex
-    if (!v) return;
+    if (l->isEmpty()) return;
 
     int index = 0;
     int entitiesCount = l->count();
     addProperty(tr("Segments"), formatInt(entitiesCount), OTHER);
     addVectorProperty(tr("Vertex - 0:"), l->getStartpoint());
 
-    for(RS_Entity* entity: lc::LC_ContainerTraverser{*l, RS2::ResolveAll}.entities()) {
+    // the segments are only read, a compact polyline provides copies of them
+    lc::LC_ContainerTraverser traverser{std::as_const(*l), RS2::ResolveAll};
+    for(RS_Entity* entity: traverser.entities()) {
         index++;
         if (!entity->isAtomic()){
             continue;
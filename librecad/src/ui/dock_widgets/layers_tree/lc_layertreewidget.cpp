@@ -1423,8 +1423,8 @@ void LC_LayerTreeWidget::deselectEntitiesOnLockedLayer(RS_Layer *layer){
     if (layer == nullptr) return;
     if (!layer->isLocked()) return;
 
-    for (auto e: *m_document) {
-        if (e != nullptr && e->isVisible() && e->getLayer() == layer){
+    for (auto e: m_document->getEntitiesOnLayer(layer)) {
+        if (e->isVisible()){
             e->setSelected(false);
         }
     }
@@ -1438,8 +1438,8 @@ void LC_LayerTreeWidget::deselectEntitiesOnLockedLayer(RS_Layer *layer){
 void LC_LayerTreeWidget::deselectEntities(RS_Layer *layer){
     if (layer == nullptr) return;
 
-    for (auto entity: *m_document) {
-        if (entity != nullptr && entity->isVisible() && entity->getLayer() == layer){
+    for (auto entity: m_document->getEntitiesOnLayer(layer)) {
+        if (entity->isVisible()){
             entity->setSelected(false);
         }
     }
@@ -1547,10 +1547,12 @@ void LC_LayerTreeWidget::doSelectLayersEntities(QList<RS_Layer *> &layers){
     // NOTE:  actually, the more correct location for this logic is RS_Selection class or something like that...
     // yet leave it for now here to reduce amount of codebase modifications.
 
-    for (auto en: *m_document) {
-        if (en != nullptr && en->isVisible() && !en->isSelected() && (!(en->getLayer() && en->getLayer()->isLocked()))){
-            RS_Layer *l = en->getLayer(true);
-            if (l != nullptr && layers.contains(l)){
+    for (RS_Layer* layer: std::as_const(layers)) {
+        if (layer == nullptr || layer->isLocked()) {
+            continue;
+        }
+        for (auto en: m_document->getEntitiesOnLayer(layer)) {
+            if (en->isVisible() && !en->isSelected()){
                 en->setSelected(true);
             }
         }